@@ -0,0 +1,482 @@
+#include <SDL.h>
+#include <benchmark/benchmark.h>
+#include <glad/glad.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "AllocTracker.h"
+#include "BlockCompression.h"
+#include "Camera.h"
+#include "CookedTexture.h"
+#include "Engine.h"
+#include "GltfImporter.h"
+#include "InputHandler.h"
+#include "Logging.h"
+#include "Mesh.h"
+#include "ObjImporter.h"
+#include "PixelConvert.h"
+#include "Texture.h"
+#include "Volume.h"
+
+// Доступен ли контекст OpenGL для тестов, создающих ресурсы на GPU
+static bool glAvailable = false;
+
+#define REQUIRE_GL(state)                                  \
+    if (!glAvailable) {                                    \
+        state.SkipWithError("OpenGL context unavailable"); \
+        return;                                            \
+    }
+
+// Запись BMP со случайными пикселями
+static std::string writeSyntheticBMP(int width, int height, int bpp) {
+    std::string path = "bench_" + std::to_string(width) + "x" + std::to_string(height) + "_" + std::to_string(bpp) + ".bmp";
+    int rowSize = ((width * bpp / 8) + 3) & ~3;
+    uint32_t dataSize = rowSize * height;
+    uint32_t dataOffset = 14 + 40;
+
+    std::vector<unsigned char> pixels(dataSize);
+    std::mt19937 rng(width * 31 + bpp);
+    for (unsigned char& p : pixels) {
+        p = rng() & 0xFF;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    auto put16 = [&](uint16_t v) { file.write(reinterpret_cast<const char*>(&v), 2); };
+    auto put32 = [&](uint32_t v) { file.write(reinterpret_cast<const char*>(&v), 4); };
+    put16(0x4D42);
+    put32(dataOffset + dataSize);
+    put32(0);
+    put32(dataOffset);
+    put32(40);
+    put32(width);
+    put32(height);
+    put16(1);
+    put16(bpp);
+    put32(0);
+    put32(dataSize);
+    put32(2835);
+    put32(2835);
+    put32(0);
+    put32(0);
+    file.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+    return path;
+}
+
+static void BM_FrustumConstruction(benchmark::State& state) {
+    REngine::Camera camera(1920, 1080);
+    camera.setRotation(10.0f, 30.0f, 0.0f);
+    for (auto _ : state) {
+        REngine::Frustum frustum(camera, 1920.0f / 1080.0f);
+        benchmark::DoNotOptimize(frustum);
+    }
+}
+BENCHMARK(BM_FrustumConstruction);
+
+static void BM_FrustumBoxTest(benchmark::State& state) {
+    REngine::Camera camera(1920, 1080);
+    REngine::Frustum frustum(camera, 1920.0f / 1080.0f);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-50.0f, 50.0f);
+    std::vector<glm::vec3> centers(1024);
+    for (glm::vec3& c : centers) {
+        c = glm::vec3(dist(rng), dist(rng), dist(rng));
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        const glm::vec3& c = centers[i++ & 1023];
+        benchmark::DoNotOptimize(frustum.isBoxInFrustum(c - glm::vec3(0.5f), c + glm::vec3(0.5f)));
+    }
+}
+BENCHMARK(BM_FrustumBoxTest);
+
+static void BM_ModelMatrix(benchmark::State& state) {
+    glm::vec3 position(1.0f, 2.0f, 3.0f);
+    glm::vec3 rotation(10.0f, 20.0f, 30.0f);
+    glm::vec3 scale(2.0f);
+    for (auto _ : state) {
+        // Повторяет вычисления Renderer::draw для одного объекта
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, position);
+        model = glm::rotate(model, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+        model = glm::rotate(model, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+        model = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+        model = glm::scale(model, scale);
+        glm::mat4 normalMatrix = glm::transpose(glm::inverse(model));
+        benchmark::DoNotOptimize(model);
+        benchmark::DoNotOptimize(normalMatrix);
+    }
+}
+BENCHMARK(BM_ModelMatrix);
+
+static void BM_CreateSphere(benchmark::State& state) {
+    REQUIRE_GL(state);
+    int slices = state.range(0);
+    for (auto _ : state) {
+        REngine::Mesh sphere = REngine::Mesh::createSphere(slices, slices);
+        benchmark::DoNotOptimize(sphere);
+    }
+    state.SetItemsProcessed(state.iterations() * (slices + 1) * (slices + 1));
+}
+BENCHMARK(BM_CreateSphere)->Arg(8)->Arg(32)->Arg(100)->Arg(256)->Unit(benchmark::kMicrosecond);
+
+static void BM_ComputeAABB(benchmark::State& state) {
+    REQUIRE_GL(state);
+    int slices = state.range(0);
+    REngine::Mesh sphere = REngine::Mesh::createSphere(slices, slices);
+    for (auto _ : state) {
+        sphere.computeAABB();
+        benchmark::DoNotOptimize(sphere.getMin());
+    }
+    state.SetItemsProcessed(state.iterations() * (slices + 1) * (slices + 1));
+}
+BENCHMARK(BM_ComputeAABB)->Arg(8)->Arg(32)->Arg(100)->Arg(256);
+
+static void BM_LoadBMP(benchmark::State& state) {
+    REQUIRE_GL(state);
+    int size = state.range(0);
+    int bpp = state.range(1);
+    std::string path = writeSyntheticBMP(size, size, bpp);
+    for (auto _ : state) {
+        REngine::Texture texture;
+        benchmark::DoNotOptimize(texture.loadBMP(path));
+    }
+    state.SetBytesProcessed(state.iterations() * size * size * (bpp / 8));
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_LoadBMP)->Args({64, 24})->Args({512, 24})->Args({2048, 24})->Args({512, 32})->Args({2048, 32})->Unit(benchmark::kMillisecond);
+
+// Загрузка подготовленной текстуры со всеми мип-уровнями, формат задаётся вторым аргументом
+static void BM_LoadRTEX(benchmark::State& state) {
+    REQUIRE_GL(state);
+    int size = state.range(0);
+    REngine::TextureFormat format = (REngine::TextureFormat)state.range(1);
+    std::vector<unsigned char> rgba((size_t)size * size * 4);
+    for (size_t i = 0; i < rgba.size(); i++) {
+        rgba[i] = (unsigned char)(i * 31);
+    }
+    REngine::CookedImage image;
+    REngine::CookedTexture::cook(format, rgba.data(), size, size, image);
+    std::string path = "bench_" + std::to_string(size) + ".rtex";
+    REngine::CookedTexture::save(path, image);
+    for (auto _ : state) {
+        REngine::Texture texture;
+        benchmark::DoNotOptimize(texture.loadRTEX(path));
+    }
+    state.SetBytesProcessed(state.iterations() * image.data.size());
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_LoadRTEX)
+    ->ArgsProduct({{512, 2048}, {(int)REngine::TextureFormat::RGB8, (int)REngine::TextureFormat::BC1}})
+    ->Unit(benchmark::kMillisecond);
+
+// Прежний загрузчик: чтение через ifstream и поканальная перестановка в отдельный буфер
+static bool loadBMPLegacy(const std::string& path, GLuint& texture) {
+    std::ifstream file(path, std::ios::binary);
+    unsigned char header[54];
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    int32_t width, height;
+    uint16_t bpp;
+    uint32_t dataOffset;
+    std::memcpy(&dataOffset, header + 10, 4);
+    std::memcpy(&width, header + 18, 4);
+    std::memcpy(&height, header + 22, 4);
+    std::memcpy(&bpp, header + 28, 2);
+
+    int rowSize = ((width * bpp / 8) + 3) & ~3;
+    std::vector<unsigned char> pixels(rowSize * height);
+    file.seekg(dataOffset, std::ios::beg);
+    file.read(reinterpret_cast<char*>(pixels.data()), pixels.size());
+    if (file.fail()) {
+        return false;
+    }
+
+    int pixelSize = bpp / 8;
+    std::vector<unsigned char> rgbData(width * height * pixelSize);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int bmpOffset = y * rowSize + x * pixelSize;
+            int rgbOffset = (y * width + x) * pixelSize;
+            rgbData[rgbOffset] = pixels[bmpOffset + 2];
+            rgbData[rgbOffset + 1] = pixels[bmpOffset + 1];
+            rgbData[rgbOffset + 2] = pixels[bmpOffset];
+            if (bpp == 32) {
+                rgbData[rgbOffset + 3] = pixels[bmpOffset + 3];
+            }
+        }
+    }
+
+    GLenum format = bpp == 24 ? GL_RGB : GL_RGBA;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, rgbData.data());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+static void BM_LoadBMPLegacy(benchmark::State& state) {
+    REQUIRE_GL(state);
+    int size = state.range(0);
+    int bpp = state.range(1);
+    std::string path = writeSyntheticBMP(size, size, bpp);
+    for (auto _ : state) {
+        GLuint texture = 0;
+        benchmark::DoNotOptimize(loadBMPLegacy(path, texture));
+        glDeleteTextures(1, &texture);
+    }
+    state.SetBytesProcessed(state.iterations() * size * size * (bpp / 8));
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_LoadBMPLegacy)->Args({512, 24})->Args({2048, 24})->Args({512, 32})->Args({2048, 32})->Unit(benchmark::kMillisecond);
+
+static void BM_DecodeBMP(benchmark::State& state) {
+    int size = state.range(0);
+    int bpp = state.range(1);
+    std::string path = writeSyntheticBMP(size, size, bpp);
+    REngine::PixelConvert::setSimdLevel((REngine::SimdLevel)state.range(2));
+    std::vector<unsigned char> pixels;
+    int width, height, channels;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(REngine::Texture::decodeBMP(path, pixels, width, height, channels));
+    }
+    state.SetBytesProcessed(state.iterations() * size * size * (bpp / 8));
+    REngine::PixelConvert::setSimdLevel(REngine::SimdLevel::AVX2);
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_DecodeBMP)
+    ->ArgsProduct({{2048}, {24, 32}, {(int)REngine::SimdLevel::Scalar, (int)REngine::SimdLevel::SSSE3, (int)REngine::SimdLevel::AVX2}})
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_CompressBlocks(benchmark::State& state) {
+    const int size = 512;
+    REngine::BlockFormat format = (REngine::BlockFormat)state.range(0);
+    std::vector<unsigned char> rgba(size * size * 4);
+    std::mt19937 rng(7);
+    for (size_t i = 0; i < rgba.size(); i++) {
+        // Плавный градиент с шумом, похожий на фотографическую текстуру
+        rgba[i] = (unsigned char)((i / 4 % size) / 2 + (i / 4 / size) / 4 + rng() % 16);
+    }
+    std::vector<unsigned char> blocks(REngine::BlockCompressor::getImageSize(format, size, size));
+    for (auto _ : state) {
+        REngine::BlockCompressor::compress(format, rgba.data(), size, size, blocks.data(), state.range(1));
+        benchmark::DoNotOptimize(blocks.data());
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+BENCHMARK(BM_CompressBlocks)
+    ->ArgsProduct({{(int)REngine::BlockFormat::BC1, (int)REngine::BlockFormat::BC3, (int)REngine::BlockFormat::BC7}, {1, 4}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Запись OBJ с сеткой size x size четырёхугольников с UV и нормалями
+static std::string writeSyntheticOBJ(int size) {
+    std::string path = "bench_" + std::to_string(size) + ".obj";
+    std::ofstream file(path);
+    char line[160];
+    for (int y = 0; y <= size; y++) {
+        for (int x = 0; x <= size; x++) {
+            std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn 0.000000 0.000000 1.000000\n", x * 0.01f, y * 0.01f,
+                          std::sin(x * 0.1f) * 0.1f, (float)x / size, (float)y / size);
+            file << line;
+        }
+    }
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int a = y * (size + 1) + x + 1, b = a + 1, c = a + size + 2, d = a + size + 1;
+            std::snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c, d, d, d);
+            file << line;
+        }
+    }
+    return path;
+}
+
+static void BM_ImportOBJ(benchmark::State& state) {
+    std::string path = writeSyntheticOBJ(state.range(0));
+    size_t size = std::filesystem::file_size(path);
+    REngine::ObjModel model;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(REngine::ObjImporter::parse(path, model, state.range(1)));
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+    std::remove(path.c_str());
+}
+// 800 x 800 даёт файл около 100 МБ
+BENCHMARK(BM_ImportOBJ)->ArgsProduct({{100, 800}, {1, 4, 0}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Запись GLB с той же сеткой, что у writeSyntheticOBJ, вершины сразу в формате сетки
+static std::string writeSyntheticGLB(int size) {
+    std::vector<float> vertices;
+    for (int y = 0; y <= size; y++) {
+        for (int x = 0; x <= size; x++) {
+            float vertex[8] = {x * 0.01f, y * 0.01f, std::sin(x * 0.1f) * 0.1f, 0.0f, 0.0f, 1.0f, (float)x / size, 1.0f - (float)y / size};
+            vertices.insert(vertices.end(), vertex, vertex + 8);
+        }
+    }
+    std::vector<uint32_t> indices;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            uint32_t a = y * (size + 1) + x, b = a + 1, c = a + size + 2, d = a + size + 1;
+            uint32_t quad[6] = {a, b, c, a, c, d};
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+    size_t vertexCount = vertices.size() / 8;
+    bool shortIndices = vertexCount <= 65536;
+    std::string bin(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(float));
+    for (uint32_t index : indices) {
+        bin.append(reinterpret_cast<const char*>(&index), shortIndices ? 2 : 4);
+    }
+    bin.append((4 - bin.size() % 4) % 4, '\0');
+
+    char json[1024];
+    std::snprintf(json, sizeof(json),
+                  "{\"asset\":{\"version\":\"2.0\"},\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+                  "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},\"indices\":3}]}],"
+                  "\"buffers\":[{\"byteLength\":%zu}],\"bufferViews\":[{\"buffer\":0,\"byteLength\":%zu,\"byteStride\":32},"
+                  "{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu}],\"accessors\":["
+                  "{\"bufferView\":0,\"componentType\":5126,\"count\":%zu,\"type\":\"VEC3\"},"
+                  "{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5126,\"count\":%zu,\"type\":\"VEC3\"},"
+                  "{\"bufferView\":0,\"byteOffset\":24,\"componentType\":5126,\"count\":%zu,\"type\":\"VEC2\"},"
+                  "{\"bufferView\":1,\"componentType\":%d,\"count\":%zu,\"type\":\"SCALAR\"}]}",
+                  bin.size(), vertices.size() * sizeof(float), vertices.size() * sizeof(float),
+                  indices.size() * (shortIndices ? 2 : 4), vertexCount, vertexCount, vertexCount, shortIndices ? 5123 : 5125,
+                  indices.size());
+    std::string chunk = json;
+    chunk.append((4 - chunk.size() % 4) % 4, ' ');
+
+    std::string path = "bench_" + std::to_string(size) + ".glb";
+    std::ofstream file(path, std::ios::binary);
+    uint32_t header[5] = {GLB_MAGIC, GLB_VERSION, (uint32_t)(12 + 8 + chunk.size() + 8 + bin.size()), (uint32_t)chunk.size(),
+                          GLB_CHUNK_JSON};
+    uint32_t binHeader[2] = {(uint32_t)bin.size(), GLB_CHUNK_BIN};
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file << chunk;
+    file.write(reinterpret_cast<const char*>(binHeader), sizeof(binHeader));
+    file << bin;
+    return path;
+}
+
+static void BM_ImportGLB(benchmark::State& state) {
+    std::string path = writeSyntheticGLB(state.range(0));
+    size_t size = std::filesystem::file_size(path);
+    for (auto _ : state) {
+        REngine::GltfModel model;
+        benchmark::DoNotOptimize(REngine::GltfImporter::parse(path, model));
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_ImportGLB)->Arg(100)->Arg(800)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Загрузка одной и той же сетки в сцену из OBJ (0) и GLB (1) вместе с передачей в OpenGL.
+// Выделенная за загрузку память в куче показывается при сборке с ALLOC_TRACKING
+static void BM_LoadModel(benchmark::State& state) {
+    REQUIRE_GL(state);
+    bool glb = state.range(0) == 1;
+    std::string path = glb ? writeSyntheticGLB(state.range(1)) : writeSyntheticOBJ(state.range(1));
+    REngine::AllocStats heap;
+    for (auto _ : state) {
+        REngine::Scene scene;
+        REngine::AllocStats start = REngine::AllocTracker::getStats();
+        if (glb) {
+            REngine::GltfImporter importer;
+            benchmark::DoNotOptimize(importer.load(path, scene));
+            glFinish();
+        } else {
+            REngine::ObjImporter importer;
+            benchmark::DoNotOptimize(importer.load(path, scene));
+            glFinish();
+        }
+        heap = REngine::AllocTracker::getStats() - start;
+    }
+    state.counters["fileBytes"] = (double)std::filesystem::file_size(path);
+    if (REngine::AllocTracker::isEnabled()) {
+        // Сумма всех выделений за загрузку, а не пиковый объём кучи
+        state.counters["allocatedBytes"] = (double)heap.bytes;
+    }
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_LoadModel)->ArgsProduct({{0, 1}, {100, 800}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_CameraRotateRelative(benchmark::State& state) {
+    REngine::Camera camera(1920, 1080);
+    float angle = 0.5f;
+    for (auto _ : state) {
+        camera.rotateRelative(angle, -angle * 0.5f, 0.0f);
+        angle = -angle;
+        benchmark::DoNotOptimize(camera);
+    }
+}
+BENCHMARK(BM_CameraRotateRelative);
+
+static void BM_InputHandlerDispatch(benchmark::State& state) {
+    int pressed = 0;
+    REngine::InputHandler::setKeyDownCallback(SDLK_w, [&pressed]() { pressed++; });
+    REngine::InputHandler::setMouseMotionCallback([&pressed](int x, int y, int xrel, int yrel) { pressed += xrel; });
+
+    SDL_Event keyEvent = {};
+    keyEvent.type = SDL_KEYDOWN;
+    keyEvent.key.keysym.sym = SDLK_w;
+    SDL_Event motionEvent = {};
+    motionEvent.type = SDL_MOUSEMOTION;
+    motionEvent.motion.xrel = 1;
+
+    for (auto _ : state) {
+        REngine::InputHandler::handleEvent(keyEvent);
+        REngine::InputHandler::handleEvent(motionEvent);
+    }
+    benchmark::DoNotOptimize(pressed);
+    state.SetItemsProcessed(state.iterations() * 2);
+
+    REngine::InputHandler::setKeyDownCallback(SDLK_w, nullptr);
+    REngine::InputHandler::setMouseMotionCallback(nullptr);
+}
+BENCHMARK(BM_InputHandlerDispatch);
+
+static void BM_LogInfo(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        REngine::Log::setOutputFile("bench_log.txt");
+    }
+    unsigned long dropped = REngine::Log::getDropped();
+    int i = 0;
+    for (auto _ : state) {
+        INFO("Benchmark message " << i++ << " value " << 0.5f);
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        // При переполнении очереди сообщения отбрасываются, а не блокируют поток
+        state.counters["dropped"] = (double)(REngine::Log::getDropped() - dropped);
+        REngine::Log::flush();
+        REngine::Log::setOutputFile("");
+    }
+}
+BENCHMARK(BM_LogInfo)->Threads(1)->Threads(4);
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    glAvailable = REngine::createHeadless(64, 64) == 0;
+    benchmark::RunSpecifiedBenchmarks();
+    if (glAvailable) {
+        REngine::destroyWindow();
+    }
+
+    benchmark::Shutdown();
+    return 0;
+}
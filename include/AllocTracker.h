@@ -0,0 +1,58 @@
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+#include <cstddef>
+
+namespace REngine {
+/// @brief Счётчики выделений памяти
+struct AllocStats {
+    /// @brief Количество выделений
+    unsigned long long allocations = 0;
+    /// @brief Количество освобождений
+    unsigned long long frees = 0;
+    /// @brief Выделено байт
+    unsigned long long bytes = 0;
+
+    /// @brief Разность счётчиков
+    /// @param other Более ранние счётчики
+    /// @return Счётчики за прошедший промежуток
+    AllocStats operator-(const AllocStats& other) const {
+        return {allocations - other.allocations, frees - other.frees, bytes - other.bytes};
+    }
+};
+
+/// @brief Класс для подсчёта выделений памяти в куче
+/// @details Подсчёт ведётся заменой глобальных operator new и operator delete,
+/// которые компилируются только с RENGINE_ALLOC_TRACKING
+class AllocTracker {
+public:
+    /// @brief Проверка, ведётся ли подсчёт
+    /// @return true, если операторы выделения заменены
+    static bool isEnabled();
+
+    /// @brief Получение счётчиков всех потоков
+    /// @return Счётчики с начала работы программы
+    static AllocStats getStats();
+
+    /// @brief Получение счётчиков текущего потока
+    /// @return Счётчики с начала работы потока
+    static AllocStats getThreadStats();
+};
+
+/// @brief Подсчёт выделений памяти текущего потока на время жизни объекта
+class AllocScope {
+public:
+    /// @brief Конструктор
+    AllocScope() : start(AllocTracker::getThreadStats()) {}
+
+    /// @brief Получение счётчиков с момента создания объекта
+    /// @return Счётчики
+    AllocStats getStats() const { return AllocTracker::getThreadStats() - start; }
+
+private:
+    /// @brief Счётчики при создании
+    AllocStats start;
+};
+}
+
+#endif
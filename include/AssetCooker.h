@@ -0,0 +1,76 @@
+#ifndef ASSET_COOKER_H
+#define ASSET_COOKER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Texture.h"
+
+#define COOK_VERSION 1
+#define COOK_MANIFEST ".cook/manifest"
+
+namespace REngine {
+/// @brief Параметры подготовки ресурсов
+struct CookOptions {
+    /// @brief Формат текстур
+    TextureFormat format = TextureFormat::BC1;
+    /// @brief Задан ли формат, иначе BC1 для изображений без альфа-канала и BC3 для остальных
+    bool formatSet = false;
+    /// @brief Количество потоков, 0 для выбора по количеству ядер
+    int threads = 0;
+    /// @brief Количества сегментов сфер, сохраняемых в архив
+    std::vector<int> slices;
+};
+
+/// @brief Результат подготовки ресурса
+struct CookedAsset {
+    /// @brief Путь внутри архива
+    std::string name;
+    /// @brief Вид ресурса: texture, shader, mesh или copy
+    const char* kind = "";
+    /// @brief Размер исходника в байтах, для шейдеров после раскрытия #include
+    size_t sourceSize = 0;
+    /// @brief Размер в архиве до сжатия LZ4
+    size_t cookedSize = 0;
+    /// @brief Время подготовки
+    double milliseconds = 0.0;
+    /// @brief Взят ли ресурс из прошлого архива без изменений
+    bool cached = false;
+};
+
+/// @brief Класс подготовки каталога ресурсов в один архив .rpak
+/// @details BMP сжимаются в RTEX с мип-уровнями, из шейдеров удаляются комментарии и раскрываются
+/// #include, сферы сохраняются в RMSH. Неизменившиеся ресурсы берутся из прошлого архива по хэшу содержимого
+class AssetCooker {
+public:
+    /// @brief Подготовка каталога ресурсов на нескольких потоках
+    /// @param source Каталог ресурсов
+    /// @param output Путь к архиву, прошлый архив по этому пути используется как кэш
+    /// @param options Параметры подготовки
+    /// @param assets Результат, ресурсы по возрастанию пути в архиве
+    /// @return true на успех, false если хотя бы один ресурс не подготовлен или архив не записан
+    static bool cook(const std::string& source, const std::string& output, const CookOptions& options, std::vector<CookedAsset>& assets);
+
+    /// @brief Раскрытие #include "файл" относительно включающего файла
+    /// @details Повторное включение пропускается, директивы внутри комментариев не раскрываются
+    /// @param path Путь к шейдеру
+    /// @param output Результат, текст с содержимым включённых файлов
+    /// @return true на успех, false если файл не прочитан или директива некорректна
+    static bool expandIncludes(const std::string& path, std::string& output);
+
+    /// @brief Удаление комментариев, пробелов в конце строк и пустых строк
+    /// @details Переводы строк внутри директив сохраняются
+    /// @param source Текст шейдера
+    /// @return Текст без комментариев
+    static std::string stripShader(const std::string& source);
+
+    /// @brief Разбор списка количеств сегментов сфер вида 8-24,100
+    /// @param text Список
+    /// @param slices Результат, количества сегментов
+    /// @return true на успех, false для количеств вне 3..1024
+    static bool parseSlices(const std::string& text, std::vector<int>& slices);
+};
+}
+
+#endif
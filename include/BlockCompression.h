@@ -0,0 +1,114 @@
+#ifndef BLOCK_COMPRESSION_H
+#define BLOCK_COMPRESSION_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Texture.h"
+
+namespace REngine {
+/// @brief Сжатое изображение со всеми мип-уровнями
+/// @note Строки блоков идут снизу вверх, как в OpenGL
+struct CompressedImage {
+    /// @brief Формат сжатия
+    BlockFormat format = BlockFormat::BC1;
+    /// @brief Мип-уровни
+    std::vector<TextureLevel> levels;
+    /// @brief Данные всех уровней подряд
+    std::vector<unsigned char> data;
+};
+
+/// @brief Класс для блочного сжатия текстур на CPU
+/// @details Конечные точки блока выбираются по главной оси цветов и уточняются
+/// методом наименьших квадратов. BC7 кодируется в режиме 6 с одним подмножеством
+class BlockCompressor {
+public:
+    /// @brief Получение размера блока
+    /// @param format Формат сжатия
+    /// @return Размер блока 4x4 в байтах
+    static size_t getBlockSize(BlockFormat format) { return format == BlockFormat::BC1 ? 8 : 16; }
+
+    /// @brief Получение размера сжатого изображения
+    /// @param format Формат сжатия
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @return Размер в байтах
+    static size_t getImageSize(BlockFormat format, int width, int height) {
+        return (size_t)((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+    }
+
+    /// @brief Получение названия формата
+    /// @param format Формат сжатия
+    /// @return Название
+    static const char* getFormatName(BlockFormat format);
+
+    /// @brief Сжатие блока
+    /// @param format Формат сжатия
+    /// @param rgba 16 пикселей RGBA по строкам
+    /// @param block Результат, getBlockSize байт
+    static void encodeBlock(BlockFormat format, const unsigned char* rgba, unsigned char* block);
+
+    /// @brief Распаковка блока
+    /// @param format Формат сжатия
+    /// @param block Сжатый блок
+    /// @param rgba 16 пикселей RGBA по строкам
+    /// @return true на успех, false для режимов BC7, которые не создаёт кодировщик
+    static bool decodeBlock(BlockFormat format, const unsigned char* block, unsigned char* rgba);
+
+    /// @brief Сжатие изображения
+    /// @param format Формат сжатия
+    /// @param rgba Пиксели RGBA без выравнивания строк
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @param blocks Результат, getImageSize байт
+    /// @param threads Количество потоков, 0 для выбора по количеству ядер
+    static void compress(BlockFormat format, const unsigned char* rgba, int width, int height,
+                         unsigned char* blocks, int threads = 0);
+
+    /// @brief Распаковка изображения
+    /// @param format Формат сжатия
+    /// @param blocks Сжатые блоки
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @param rgba Результат, пиксели RGBA без выравнивания строк
+    /// @return true на успех, false на неудачу
+    static bool decompress(BlockFormat format, const unsigned char* blocks, int width, int height,
+                           std::vector<unsigned char>& rgba);
+
+    /// @brief Сжатие изображения со всеми мип-уровнями
+    /// @param format Формат сжатия
+    /// @param rgba Пиксели RGBA без выравнивания строк
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @param image Результат
+    /// @param threads Количество потоков, 0 для выбора по количеству ядер
+    static void compressMipChain(BlockFormat format, const unsigned char* rgba, int width, int height,
+                                 CompressedImage& image, int threads = 0);
+
+    /// @brief Вычисление пикового отношения сигнал/шум
+    /// @param a Первое изображение
+    /// @param b Второе изображение
+    /// @param size Размер изображений в байтах
+    /// @param stride Количество байтов на пиксель
+    /// @param channels Количество сравниваемых каналов пикселя
+    /// @return PSNR в децибелах, бесконечность для одинаковых изображений
+    static double computePSNR(const unsigned char* a, const unsigned char* b, size_t size, int stride = 4, int channels = 3);
+
+    /// @brief Запись изображения в файл DDS
+    /// @param path Путь к файлу
+    /// @param image Изображение
+    /// @return true на успех, false на неудачу
+    static bool saveDDS(const std::string& path, const CompressedImage& image);
+
+    /// @brief Разбор файла DDS
+    /// @param data Содержимое файла
+    /// @param size Размер файла в байтах
+    /// @param image Результат, данные уровней указывают внутрь data
+    /// @param pixels Начало данных уровней в data
+    /// @return true на успех, false на неудачу
+    static bool parseDDS(const unsigned char* data, size_t size, CompressedImage& image, const unsigned char*& pixels);
+};
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+#include "Camera.h"
+
+namespace REngine {
+/// @brief Ключевой кадр пути камеры
+struct CameraKeyframe {
+    /// @brief Время в секундах от начала пути
+    float time = 0.0f;
+    /// @brief Позиция камеры
+    glm::vec3 position = glm::vec3(0.0f);
+    /// @brief Наклон камеры в градусах
+    float pitch = 0.0f;
+    /// @brief Поворот камеры в градусах
+    float yaw = -90.0f;
+};
+
+/// @brief Класс для пути камеры по ключевым кадрам
+/// @details Позиция и ориентация между ключевыми кадрами интерполируются сплайном Катмулла-Рома
+class CameraPath {
+public:
+    /// @brief Загрузка пути из файла
+    /// @details Каждая строка задаёт ключевой кадр: время, x, y, z, наклон, поворот.
+    /// Строки, начинающиеся с #, пропускаются
+    /// @param path Путь к файлу
+    /// @return true на успех, false на неудачу
+    bool loadFromFile(const std::string& path);
+
+    /// @brief Добавление ключевого кадра
+    /// @param keyframe Ключевой кадр, время должно быть больше времени предыдущего
+    /// @return true на успех, false на неудачу
+    bool addKeyframe(const CameraKeyframe& keyframe);
+
+    /// @brief Получение ключевых кадров
+    /// @return Ключевые кадры
+    const std::vector<CameraKeyframe>& getKeyframes() const { return keyframes; }
+
+    /// @brief Получение длительности пути
+    /// @return Время последнего ключевого кадра в секундах
+    float getDuration() const { return keyframes.empty() ? 0.0f : keyframes.back().time; }
+
+    /// @brief Вычисление положения камеры на пути
+    /// @param time Время в секундах, ограничивается длительностью пути
+    /// @return Интерполированный ключевой кадр
+    CameraKeyframe sample(float time) const;
+
+    /// @brief Установка камеры в положение на пути
+    /// @param camera Камера
+    /// @param time Время в секундах
+    void apply(Camera& camera, float time) const;
+
+private:
+    /// @brief Ключевые кадры в порядке времени
+    std::vector<CameraKeyframe> keyframes;
+};
+}
+
+#endif
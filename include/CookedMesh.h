@@ -0,0 +1,85 @@
+#ifndef COOKED_MESH_H
+#define COOKED_MESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define RMSH_MAGIC 0x48534D52 // "RMSH"
+#define RMSH_VERSION 1
+#define RMSH_CACHE_SIZE 32
+
+namespace REngine {
+/// @brief Заголовок файла .rmesh
+/// @details За заголовком идут vertexCount вершин RMeshVertex, затем indexCount индексов
+/// по indexSize байт. Вершины упорядочены по первому использованию
+struct RMeshHeader {
+    uint32_t magic;          // Сигнатура RMSH_MAGIC
+    uint32_t version;        // Версия формата RMSH_VERSION
+    uint32_t vertexCount;    // Количество вершин
+    uint32_t indexCount;     // Количество индексов
+    uint32_t indexSize;      // Размер индекса, 2 или 4 байта
+    uint32_t reserved;       // Не используется
+    float positionMin[3];    // Наименьшие координаты
+    float positionScale[3];  // Размер AABB
+    float uvMin[2];          // Наименьшие UV
+    float uvScale[2];        // Размер диапазона UV
+};
+
+/// @brief Квантованная вершина файла .rmesh
+struct RMeshVertex {
+    uint16_t position[3];    // Координаты внутри AABB, 0..65535
+    uint16_t padding;        // Не используется
+    int8_t normal[4];        // Нормаль, -127..127
+    uint16_t uv[2];          // UV внутри диапазона, 0..65535
+};
+
+/// @brief Класс для подготовки и чтения сеток .rmesh
+/// @details Вершины в формате сетки: координаты, нормаль и UV, 8 чисел на вершину
+class CookedMesh {
+public:
+    /// @brief Переупорядочивание треугольников для кэша вершин
+    /// @details Алгоритм Форсайта: следующим выбирается треугольник с вершинами, недавно попавшими
+    /// в кэш размера RMSH_CACHE_SIZE, и с наименьшим числом оставшихся треугольников
+    /// @param indices Индексы треугольников
+    /// @param vertexCount Количество вершин
+    static void optimizeVertexCache(std::vector<unsigned>& indices, size_t vertexCount);
+
+    /// @brief Переупорядочивание вершин по первому использованию
+    /// @details Неиспользуемые вершины удаляются
+    /// @param vertices Вершины
+    /// @param indices Индексы треугольников
+    static void optimizeVertexFetch(std::vector<float>& vertices, std::vector<unsigned>& indices);
+
+    /// @brief Получение среднего количества промахов кэша вершин на треугольник
+    /// @param indices Индексы треугольников
+    /// @param vertexCount Количество вершин
+    /// @param cacheSize Размер кэша FIFO
+    /// @return От 0.5 для идеального порядка до 3
+    static double getACMR(const std::vector<unsigned>& indices, size_t vertexCount, int cacheSize = RMSH_CACHE_SIZE);
+
+    /// @brief Подготовка сетки
+    /// @param vertices Вершины
+    /// @param indices Индексы треугольников
+    /// @param data Содержимое файла .rmesh
+    static void cook(std::vector<float> vertices, std::vector<unsigned> indices, std::vector<unsigned char>& data);
+
+    /// @brief Разбор файла .rmesh
+    /// @param data Содержимое файла
+    /// @param size Размер файла в байтах
+    /// @param vertices Восстановленные вершины
+    /// @param indices Индексы треугольников
+    /// @return true на успех, false на неудачу
+    static bool parse(const unsigned char* data, size_t size, std::vector<float>& vertices, std::vector<unsigned>& indices);
+
+    /// @brief Загрузка файла .rmesh через VirtualFS
+    /// @param path Путь к файлу
+    /// @param vertices Восстановленные вершины
+    /// @param indices Индексы треугольников
+    /// @return true на успех, false если файла нет или он повреждён
+    static bool load(const std::string& path, std::vector<float>& vertices, std::vector<unsigned>& indices);
+};
+}
+
+#endif
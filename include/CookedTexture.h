@@ -0,0 +1,98 @@
+#ifndef COOKED_TEXTURE_H
+#define COOKED_TEXTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Texture.h"
+
+#define RTEX_MAGIC 0x58455452 // "RTEX"
+#define RTEX_VERSION 1
+#define RTEX_LEVELS_MAX 16
+#define RTEX_ALIGNMENT 16
+
+namespace REngine {
+/// @brief Заголовок файла .rtex
+/// @details За заголовком идут levelCount записей RTexLevel, затем данные уровней,
+/// выровненные до RTEX_ALIGNMENT байт
+struct RTexHeader {
+    uint32_t magic;          // Сигнатура RTEX_MAGIC
+    uint32_t version;        // Версия формата RTEX_VERSION
+    uint32_t format;         // Формат пикселей TextureFormat
+    uint32_t width;          // Ширина нулевого уровня
+    uint32_t height;         // Высота нулевого уровня
+    uint32_t levelCount;     // Количество мип-уровней
+};
+
+/// @brief Описание мип-уровня в файле .rtex
+struct RTexLevel {
+    uint32_t width;          // Ширина уровня
+    uint32_t height;         // Высота уровня
+    uint64_t offset;         // Смещение данных от начала файла
+    uint64_t size;           // Размер данных в байтах
+};
+
+/// @brief Подготовленное изображение со всеми мип-уровнями в формате видеопамяти
+/// @note Строки идут снизу вверх без выравнивания
+struct CookedImage {
+    /// @brief Формат пикселей
+    TextureFormat format = TextureFormat::RGBA8;
+    /// @brief Мип-уровни
+    std::vector<TextureLevel> levels;
+    /// @brief Данные всех уровней подряд
+    std::vector<unsigned char> data;
+};
+
+/// @brief Класс для подготовки и чтения файлов .rtex
+class CookedTexture {
+public:
+    /// @brief Получение названия формата
+    /// @param format Формат пикселей
+    /// @return Название
+    static const char* getFormatName(TextureFormat format);
+
+    /// @brief Получение формата пикселей для формата сжатия
+    /// @param format Формат сжатия
+    /// @return Формат пикселей
+    static TextureFormat fromBlockFormat(BlockFormat format);
+
+    /// @brief Получение размера уровня
+    /// @param format Формат пикселей
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @return Размер в байтах
+    static size_t getLevelSize(TextureFormat format, int width, int height);
+
+    /// @brief Подготовка изображения со всеми мип-уровнями
+    /// @param format Формат пикселей
+    /// @param rgba Пиксели RGBA без выравнивания строк, строки снизу вверх
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @param image Результат
+    /// @param threads Количество потоков сжатия, 0 для выбора по количеству ядер
+    static void cook(TextureFormat format, const unsigned char* rgba, int width, int height, CookedImage& image, int threads = 0);
+
+    /// @brief Получение содержимого файла .rtex
+    /// @param image Изображение
+    /// @param data Содержимое файла
+    /// @return true на успех, false если уровней нет или их слишком много
+    static bool serialize(const CookedImage& image, std::vector<unsigned char>& data);
+
+    /// @brief Запись изображения в файл .rtex
+    /// @param path Путь к файлу
+    /// @param image Изображение
+    /// @return true на успех, false на неудачу
+    static bool save(const std::string& path, const CookedImage& image);
+
+    /// @brief Разбор файла .rtex
+    /// @param data Содержимое файла
+    /// @param size Размер файла в байтах
+    /// @param image Результат, смещения уровней отсчитываются от data, данные не копируются
+    /// @return true на успех, false на неудачу
+    static bool parse(const unsigned char* data, size_t size, CookedImage& image);
+};
+}
+
+#endif
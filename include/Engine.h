@@ -2,6 +2,10 @@
 #define ENGINE_H
 
 #include "Scene.h"
+#include "FrameSync.h"
+#include "FrameClock.h"
+#include "FrameStats.h"
+#include "CameraPath.h"
 
 namespace REngine {
     enum WindowError {
@@ -18,9 +22,35 @@ namespace REngine {
     /// @return 0 при успехе, код ошибки при неудаче
     int createWindow(const char* title, int width = 0, int height = 0);
 
+    /// @brief Создание контекста OpenGL без вывода на экран
+    /// @details Отрисовка идёт во внеэкранный буфер кадра фиксированного размера.
+    /// Без дисплея в Linux используется драйвер SDL offscreen (EGL)
+    /// @param width Ширина буфера кадра
+    /// @param height Высота буфера кадра
+    /// @return 0 при успехе, код ошибки при неудаче
+    int createHeadless(int width, int height);
+
+    /// @brief Проверка работы без вывода на экран
+    /// @return true, если контекст создан через createHeadless
+    bool isHeadless();
+
     /// @brief Основной цикл
     void mainLoop();
 
+    /// @brief Отрисовка заданного количества кадров
+    /// @param frames Количество кадров
+    /// @return Сводка времени отрисованных кадров
+    REngine::FrameSummary runFrames(unsigned long frames);
+
+    /// @brief Пролёт камеры сцены по пути
+    /// @details Камера проходит путь с фиксированным шагом на кадр независимо от
+    /// реального времени, поэтому каждый прогон отрисовывает одинаковые виды
+    /// @param path Путь камеры
+    /// @param timeStep Шаг по пути в секундах на кадр
+    /// @param reportPath Путь к отчёту CSV о времени кадров вдоль пути, NULL чтобы не записывать
+    /// @return Сводка времени отрисованных кадров
+    REngine::FrameSummary runFlyThrough(const REngine::CameraPath& path, double timeStep = 1.0 / 60.0, const char* reportPath = NULL);
+
     /// @brief Установка сцены
     /// @param scene Указатель на сцену
     void setScene(REngine::Scene* scene);
@@ -38,6 +68,33 @@ namespace REngine {
     /// @return Указатель на шейдер
     REngine::Shader* getShader();
 
+    /// @brief Установка количества кадров в полёте
+    /// @param count Количество кадров, на которое CPU может опережать GPU
+    /// @note Меньшее значение снижает задержку, большее повышает пропускную способность
+    void setFramesInFlight(int count);
+
+    /// @brief Получение синхронизатора кадров
+    /// @return Указатель на синхронизатор кадров
+    REngine::FrameSync* getFrameSync();
+
+    /// @brief Установка режима вывода кадров
+    /// @param mode Режим вывода
+    /// @param targetFps Целевая частота кадров для режима PresentMode::TargetFPS
+    void setPresentMode(REngine::PresentMode mode, double targetFps = 0.0);
+
+    /// @brief Установка шага симуляции
+    /// @param seconds Шаг в секундах
+    void setFixedTimeStep(double seconds);
+
+    /// @brief Получение статистики кадров
+    /// @return Указатель на статистику кадров
+    REngine::FrameStats* getFrameStats();
+
+    /// @brief Установка файлов для записи статистики кадров при уничтожении окна
+    /// @param csvPath Путь к файлу CSV, NULL чтобы не записывать
+    /// @param jsonPath Путь к файлу JSON, NULL чтобы не записывать
+    void setFrameStatsOutput(const char* csvPath, const char* jsonPath);
+
     /// @brief Уничтожение окна
     void destroyWindow();
 }
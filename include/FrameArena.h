@@ -0,0 +1,108 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#define FRAME_ARENA_DEFAULT_CAPACITY (1 << 20)
+
+namespace REngine {
+/// @brief Линейный распределитель памяти для данных одного кадра
+/// @details Выделение сдвигает указатель в непрерывном буфере, а вся память
+/// освобождается разом сбросом в начале кадра. Если буфера не хватает, память
+/// временно берётся из кучи, а при сбросе буфер увеличивается до пикового объёма
+/// @note Не потокобезопасен, у каждого потока свой распределитель
+class FrameArena {
+public:
+    /// @brief Конструктор
+    /// @param capacity Размер буфера в байтах
+    FrameArena(size_t capacity = FRAME_ARENA_DEFAULT_CAPACITY);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /// @brief Выделение памяти
+    /// @param size Размер в байтах
+    /// @param alignment Выравнивание, степень двойки
+    /// @return Указатель на память, действительный до сброса
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /// @brief Выделение массива
+    /// @tparam T Тип элементов, конструкторы не вызываются
+    /// @param count Количество элементов
+    /// @return Указатель на массив, действительный до сброса
+    template <typename T>
+    T* allocate(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /// @brief Освобождение всей памяти
+    void reset();
+
+    /// @brief Получение объёма памяти, выделенного с последнего сброса
+    /// @return Объём в байтах, включая отступы выравнивания
+    size_t getUsed() const { return used; }
+
+    /// @brief Получение размера буфера
+    /// @return Размер в байтах
+    size_t getCapacity() const { return capacity; }
+
+    /// @brief Получение пикового объёма памяти за кадр
+    /// @return Объём в байтах
+    size_t getHighWater() const { return highWater; }
+
+    /// @brief Получение распределителя текущего потока
+    /// @return Распределитель
+    static FrameArena& getThreadArena();
+
+private:
+    /// @brief Буфер
+    std::unique_ptr<unsigned char[]> buffer;
+    /// @brief Размер буфера
+    size_t capacity;
+    /// @brief Смещение свободной памяти в буфере
+    size_t offset = 0;
+    /// @brief Объём, выделенный с последнего сброса, включая кучу и отступы выравнивания
+    size_t used = 0;
+    /// @brief Пиковый объём
+    size_t highWater = 0;
+    /// @brief Блоки из кучи, выделенные при нехватке буфера
+    std::vector<std::unique_ptr<unsigned char[]>> overflow;
+};
+
+/// @brief Распределитель для контейнеров стандартной библиотеки поверх FrameArena
+/// @details Освобождение ничего не делает, память возвращается при сбросе
+/// @tparam T Тип элементов
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    /// @brief Конструктор
+    /// @param arena Распределитель кадра
+    ArenaAllocator(FrameArena& arena = FrameArena::getThreadArena()) : arena(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count) { return arena->allocate<T>(count); }
+
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+    /// @brief Распределитель кадра
+    FrameArena* arena;
+};
+
+/// @brief Вектор в памяти кадра
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+}
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef FRAME_CLOCK_H
+#define FRAME_CLOCK_H
+
+#include <SDL.h>
+
+// Максимальное время кадра, учитываемое симуляцией, в секундах. После долгого кадра
+// симуляция отстаёт от реального времени, но не пытается догнать его всё большим числом шагов
+#define FIXED_UPDATE_MAX_FRAME_TIME 0.25
+
+namespace REngine {
+/// @brief Режимы вывода кадров
+enum class PresentMode {
+    /// @brief Вертикальная синхронизация
+    VSync,
+    /// @brief Адаптивная вертикальная синхронизация
+    AdaptiveVSync,
+    /// @brief Без ограничения частоты кадров
+    Uncapped,
+    /// @brief Ограничение частоты кадров заданным значением
+    TargetFPS
+};
+
+/// @brief Класс для измерения времени кадров
+/// @details Использует SDL_GetPerformanceCounter и ограничивает частоту кадров
+/// сочетанием сна и активного ожидания
+class FrameClock {
+public:
+    /// @brief Конструктор
+    FrameClock();
+
+    /// @brief Начало нового кадра
+    /// @return Время с прошлого кадра в секундах
+    double tick();
+
+    /// @brief Получение времени с прошлого кадра
+    /// @return Время в секундах
+    double getDeltaTime() const { return deltaTime; }
+
+    /// @brief Получение времени, прошедшего с начала текущего кадра
+    /// @return Время в секундах
+    double getFrameElapsed() const;
+
+    /// @brief Получение времени с момента создания часов
+    /// @return Время в секундах
+    double getTime() const;
+
+    /// @brief Установка целевой частоты кадров
+    /// @param fps Частота кадров, 0 для отключения ограничения
+    void setTargetFrameRate(double fps);
+
+    /// @brief Ожидание окончания бюджета текущего кадра
+    /// @details Спит до порога активного ожидания, затем опрашивает счётчик
+    void limit();
+
+    /// @brief Перевод тиков счётчика в секунды
+    /// @param ticks Количество тиков
+    /// @return Время в секундах
+    static double toSeconds(Uint64 ticks);
+
+private:
+    /// @brief Частота счётчика
+    Uint64 frequency;
+    /// @brief Значение счётчика при создании
+    Uint64 startCounter;
+    /// @brief Значение счётчика в начале кадра
+    Uint64 frameCounter;
+    /// @brief Крайний срок окончания кадра
+    Uint64 deadline;
+    /// @brief Бюджет кадра в тиках, 0 если ограничение отключено
+    Uint64 framePeriod;
+    /// @brief Время с прошлого кадра в секундах
+    double deltaTime;
+};
+
+/// @brief Класс для симуляции с фиксированным шагом
+/// @details Накапливает время кадров и отдаёт его целыми шагами, остаток задаёт
+/// долю интерполяции между двумя последними шагами
+class FixedTimeStep {
+public:
+    /// @brief Конструктор
+    /// @param step Шаг симуляции в секундах
+    FixedTimeStep(double step);
+
+    /// @brief Накопление времени кадра
+    /// @param deltaTime Время кадра в секундах
+    /// @param clamp Ограничивать ли время кадра FIXED_UPDATE_MAX_FRAME_TIME
+    /// @return Количество шагов симуляции, которые нужно выполнить в этом кадре
+    int advance(double deltaTime, bool clamp = true);
+
+    /// @brief Получение шага симуляции
+    /// @return Шаг в секундах
+    double getStep() const { return step; }
+
+    /// @brief Получение доли интерполяции между двумя последними шагами
+    /// @return Значение от 0 до 1
+    double getAlpha() const { return accumulator / step; }
+
+    /// @brief Получение времени симуляции после выполненных шагов
+    /// @return Время в секундах
+    double getSimulationTime() const { return simulationTime; }
+
+    /// @brief Получение времени симуляции вместе с ещё не обработанным остатком
+    /// @return Время в секундах
+    double getInterpolatedTime() const { return simulationTime + accumulator; }
+
+private:
+    /// @brief Шаг симуляции в секундах
+    double step;
+    /// @brief Время, ещё не обработанное симуляцией, в секундах
+    double accumulator;
+    /// @brief Время симуляции в секундах
+    double simulationTime;
+};
+}
+
+#endif
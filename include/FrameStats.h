@@ -0,0 +1,183 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#define FRAME_STATS_GPU_SCOPES_MAX 16
+
+namespace REngine {
+struct GpuScopeResult;
+
+/// @brief Статистика одного кадра
+struct FrameRecord {
+    /// @brief Номер кадра
+    unsigned long frame = 0;
+    /// @brief Время кадра в миллисекундах
+    float frameTime = 0.0f;
+    /// @brief Время работы CPU в миллисекундах
+    float cpuTime = 0.0f;
+    /// @brief Время работы GPU в миллисекундах
+    /// @note Заполняется с задержкой в несколько кадров, 0 если ещё неизвестно
+    float gpuTime = 0.0f;
+    /// @brief Количество вызовов отрисовки
+    unsigned int drawCalls = 0;
+    /// @brief Количество треугольников
+    unsigned int triangles = 0;
+    /// @brief Количество отсечённых объектов
+    unsigned int culledNodes = 0;
+    /// @brief Количество привязок текстур
+    unsigned int textureBinds = 0;
+    /// @brief Объём загруженных из файлов текстур в видеопамяти
+    unsigned long long residentTextureBytes = 0;
+    /// @brief Количество вытесненных текстур
+    unsigned int textureEvictions = 0;
+    /// @brief Количество повторно загружаемых текстур
+    unsigned int textureReloads = 0;
+    /// @brief Количество выделений памяти в куче за кадр в потоке отрисовки
+    /// @note Считается только с RENGINE_ALLOC_TRACKING
+    unsigned long long allocations = 0;
+    /// @brief Выделено байт в куче за кадр в потоке отрисовки
+    unsigned long long allocatedBytes = 0;
+    /// @brief Использовано байт памяти кадра основного потока
+    unsigned int arenaBytes = 0;
+};
+
+/// @brief Сводка времени кадров за окно
+struct FrameSummary {
+    /// @brief Количество кадров в окне
+    size_t frames = 0;
+    /// @brief Среднее время кадра в миллисекундах
+    double mean = 0.0;
+    /// @brief Медиана времени кадра в миллисекундах
+    double p50 = 0.0;
+    /// @brief 95-й процентиль времени кадра в миллисекундах
+    double p95 = 0.0;
+    /// @brief 99-й процентиль времени кадра в миллисекундах
+    double p99 = 0.0;
+    /// @brief Максимальное время кадра в миллисекундах
+    double max = 0.0;
+    /// @brief Количество рывков
+    size_t hitches = 0;
+    /// @brief Среднее время CPU в миллисекундах
+    double cpuMean = 0.0;
+    /// @brief Среднее время GPU в миллисекундах по кадрам с известным временем
+    double gpuMean = 0.0;
+};
+
+/// @brief Класс для сбора статистики кадров
+/// @details Хранит последние кадры в кольцевом буфере и вычисляет процентили времени кадра
+class FrameStats {
+public:
+    /// @brief Конструктор
+    /// @param capacity Количество хранимых кадров
+    FrameStats(size_t capacity = 4096);
+
+    /// @brief Установка количества хранимых кадров
+    /// @param capacity Количество кадров
+    /// @note Очищает накопленную статистику
+    void setCapacity(size_t capacity);
+
+    /// @brief Получение количества хранимых кадров
+    /// @return Ёмкость буфера
+    size_t getCapacity() const { return records.size(); }
+
+    /// @brief Установка порога рывка
+    /// @param factor Кадр считается рывком, если он дольше медианы окна в factor раз
+    void setHitchFactor(float factor) { hitchFactor = factor; }
+
+    /// @brief Добавление кадра
+    /// @param record Статистика кадра
+    void record(const FrameRecord& record);
+
+    /// @brief Запись времени GPU для ранее добавленного кадра
+    /// @param frame Номер кадра
+    /// @param gpuTime Время GPU в миллисекундах
+    void setGpuTime(unsigned long frame, float gpuTime);
+
+    /// @brief Запись времени областей GPU для ранее добавленного кадра
+    /// @param frame Номер кадра
+    /// @param results Результаты профилировщика GPU
+    /// @note Области с одинаковым названием суммируются, области с новыми названиями сверх
+    /// FRAME_STATS_GPU_SCOPES_MAX отбрасываются с однократным предупреждением
+    void setGpuScopeTimes(unsigned long frame, const std::vector<GpuScopeResult>& results);
+
+    /// @brief Получение названий областей GPU
+    /// @return Названия в порядке первого появления
+    const std::vector<const char*>& getGpuScopeNames() const { return scopeNames; }
+
+    /// @brief Получение времени области GPU для кадра из буфера
+    /// @param index Индекс кадра, 0 для самого старого
+    /// @param scope Индекс области в getGpuScopeNames
+    /// @return Время в миллисекундах
+    float getGpuScopeTime(size_t index, size_t scope) const;
+
+    /// @brief Получение среднего времени области GPU
+    /// @param name Название области
+    /// @param window Количество последних кадров, 0 для всего буфера
+    /// @return Время в миллисекундах по кадрам с известным временем
+    double getGpuScopeMean(const char* name, size_t window = 0) const;
+
+    /// @brief Получение количества кадров в буфере
+    /// @return Количество кадров
+    size_t size() const { return count; }
+
+    /// @brief Получение кадра из буфера
+    /// @param index Индекс, 0 для самого старого кадра
+    /// @return Статистика кадра
+    const FrameRecord& get(size_t index) const;
+
+    /// @brief Получение последнего кадра
+    /// @return Статистика кадра
+    const FrameRecord& last() const { return get(count - 1); }
+
+    /// @brief Вычисление сводки
+    /// @param window Количество последних кадров, 0 для всего буфера
+    /// @return Сводка времени кадров
+    FrameSummary summarize(size_t window = 0) const;
+
+    /// @brief Очистка статистики
+    void clear();
+
+    /// @brief Запись кадров в CSV
+    /// @param path Путь к файлу
+    /// @return true на успех, false на неудачу
+    bool dumpCSV(const std::string& path) const;
+
+    /// @brief Запись сводки и кадров в JSON
+    /// @param path Путь к файлу
+    /// @return true на успех, false на неудачу
+    bool dumpJSON(const std::string& path) const;
+
+private:
+    /// @brief Кольцевой буфер кадров
+    std::vector<FrameRecord> records;
+    /// @brief Индекс следующей записи
+    size_t head = 0;
+    /// @brief Количество кадров в буфере
+    size_t count = 0;
+    /// @brief Порог рывка относительно медианы
+    float hitchFactor = 2.0f;
+    /// @brief Буфер для сортировки времени кадров
+    mutable std::vector<float> scratch;
+    /// @brief Названия областей GPU
+    std::vector<const char*> scopeNames;
+    /// @brief Выводилось ли предупреждение об областях сверх FRAME_STATS_GPU_SCOPES_MAX
+    bool scopesDropped = false;
+    /// @brief Время областей GPU, FRAME_STATS_GPU_SCOPES_MAX значений на кадр
+    std::vector<float> scopeTimes;
+
+    /// @brief Поиск кадра в кольцевом буфере
+    /// @param frame Номер кадра
+    /// @return Индекс в кольцевом буфере или -1
+    long findSlot(unsigned long frame) const;
+
+    /// @brief Получение индекса в кольцевом буфере
+    /// @param index Индекс кадра, 0 для самого старого
+    /// @return Индекс в кольцевом буфере
+    size_t slotOf(size_t index) const { return (head + records.size() - count + index) % records.size(); }
+};
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef FRAME_SYNC_H
+#define FRAME_SYNC_H
+
+#include <glad/glad.h>
+
+#define FRAMES_IN_FLIGHT_MAX 4
+
+namespace REngine {
+/// @brief Класс для управления кадрами в полёте
+/// @details Ограничивает опережение GPU центральным процессором с помощью
+/// барьеров glFenceSync и измеряет время ожидания CPU и простоя GPU
+class FrameSync {
+public:
+    /// @brief Конструктор
+    /// @param framesInFlight Количество кадров в полёте
+    FrameSync(int framesInFlight = 2);
+
+    /// @brief Деструктор
+    ~FrameSync();
+
+    /// @brief Установка количества кадров в полёте
+    /// @param count Количество кадров (от 1 до FRAMES_IN_FLIGHT_MAX)
+    /// @note Дожидается завершения всех кадров в полёте
+    void setFramesInFlight(int count);
+
+    /// @brief Получение количества кадров в полёте
+    /// @return Количество кадров в полёте
+    int getFramesInFlight() const { return framesInFlight; }
+
+    /// @brief Начало кадра
+    /// @details Блокирует CPU, пока GPU не завершит кадр, ранее занимавший текущий слот
+    void beginFrame();
+
+    /// @brief Конец кадра
+    /// @details Устанавливает барьер для текущего слота
+    void endFrame();
+
+    /// @brief Ожидание завершения всех кадров в полёте
+    void waitIdle();
+
+    /// @brief Ожидание завершения самого старого кадра в полёте
+    /// @details Время кадра на GPU доступно через getGpuFrameTime и getResolvedFrameNumber
+    /// до следующего вызова, поэтому в цикле можно записать время всех кадров
+    /// @return true, если кадр был в полёте, false если все кадры завершены
+    bool resolveOldest();
+
+    /// @brief Получение индекса текущего слота
+    /// @return Индекс слота для выбора динамических буферов кадра
+    int getFrameSlot() const { return slot; }
+
+    /// @brief Получение номера текущего кадра
+    /// @return Номер кадра
+    unsigned long getFrameNumber() const { return frameNumber; }
+
+    /// @brief Получение времени ожидания барьера в последнем кадре
+    /// @return Время ожидания CPU в миллисекундах
+    double getFenceWaitTime() const { return fenceWaitTime; }
+
+    /// @brief Получение времени простоя GPU перед последним завершённым кадром
+    /// @return Время простоя GPU в миллисекундах
+    double getGpuIdleTime() const { return gpuIdleTime; }
+
+    /// @brief Получение времени выполнения последнего завершённого кадра на GPU
+    /// @return Время GPU в миллисекундах
+    double getGpuFrameTime() const { return gpuFrameTime; }
+
+    /// @brief Получение номера последнего завершённого на GPU кадра
+    /// @return Номер кадра
+    unsigned long getResolvedFrameNumber() const { return resolvedFrameNumber; }
+
+private:
+    /// @brief Количество кадров в полёте
+    int framesInFlight;
+    /// @brief Индекс текущего слота
+    int slot;
+    /// @brief Номер текущего кадра
+    unsigned long frameNumber;
+    /// @brief Барьеры кадров
+    GLsync fences[FRAMES_IN_FLIGHT_MAX];
+    /// @brief Номера кадров, занимающих слоты
+    unsigned long slotFrames[FRAMES_IN_FLIGHT_MAX];
+    /// @brief Запросы времени начала кадров на GPU
+    GLuint beginQueries[FRAMES_IN_FLIGHT_MAX];
+    /// @brief Запросы времени окончания кадров на GPU
+    GLuint endQueries[FRAMES_IN_FLIGHT_MAX];
+    /// @brief Время окончания предыдущего завершённого кадра на GPU в наносекундах
+    GLuint64 lastGpuEnd;
+    /// @brief Номер последнего завершённого на GPU кадра
+    unsigned long resolvedFrameNumber;
+    /// @brief Время ожидания барьера в миллисекундах
+    double fenceWaitTime;
+    /// @brief Время простоя GPU в миллисекундах
+    double gpuIdleTime;
+    /// @brief Время выполнения кадра на GPU в миллисекундах
+    double gpuFrameTime;
+
+    /// @brief Ожидание барьера слота и чтение его запросов времени
+    /// @param index Индекс слота
+    void resolveSlot(int index);
+};
+}
+
+#endif
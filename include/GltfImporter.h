@@ -0,0 +1,148 @@
+#ifndef GLTF_IMPORTER_H
+#define GLTF_IMPORTER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Scene.h"
+#include "VirtualFS.h"
+
+#define GLB_MAGIC 0x46546C67 // "glTF"
+#define GLB_VERSION 2
+#define GLB_CHUNK_JSON 0x4E4F534A
+#define GLB_CHUNK_BIN 0x004E4942
+#define GLTF_DEPTH_MAX 64
+
+namespace REngine {
+/// @brief Часть сетки glTF с одним материалом
+struct GltfPrimitive {
+    /// @brief Номер материала в GltfModel::materials или -1
+    int material = -1;
+    /// @brief Вершины в формате сетки в файле, если раскладка совпадает, иначе nullptr и вершины в vertices
+    const float* vertexData = nullptr;
+    /// @brief Количество вершин
+    size_t vertexCount = 0;
+    /// @brief Вершины, преобразованные из раскладки файла
+    std::vector<float> vertices;
+    /// @brief Нужно ли при загрузке заменить V на 1 - V, в glTF начало UV в верхнем левом углу
+    bool flipTexCoords = false;
+    /// @brief Индексы в файле, если они плотно упакованы, иначе nullptr и индексы в indices
+    const void* indexData = nullptr;
+    /// @brief Количество индексов
+    size_t indexCount = 0;
+    /// @brief Размер индекса: 1, 2 или 4 байта
+    int indexSize = 4;
+    /// @brief Индексы, созданные для сетки без индексов или преобразованные
+    std::vector<unsigned> indices;
+};
+
+/// @brief Сетка glTF
+struct GltfMesh {
+    /// @brief Имя сетки
+    std::string name;
+    /// @brief Части сетки
+    std::vector<GltfPrimitive> primitives;
+};
+
+/// @brief Материал glTF
+struct GltfMaterial {
+    /// @brief Имя материала
+    std::string name;
+    /// @brief Путь к текстуре baseColorTexture
+    std::string texturePath;
+    /// @brief Путь к текстуре отражений specularColorTexture из KHR_materials_specular
+    std::string specularPath;
+    /// @brief Степень блеска, пересчитанная из шероховатости
+    float shininess = 32.0f;
+};
+
+/// @brief Узел иерархии glTF
+struct GltfNode {
+    /// @brief Имя узла
+    std::string name;
+    /// @brief Номер сетки в GltfModel::meshes или -1
+    int mesh = -1;
+    /// @brief Дочерние узлы
+    std::vector<int> children;
+    /// @brief Преобразование относительно родителя
+    glm::mat4 local = glm::mat4(1.0f);
+    /// @brief Преобразование в мировых координатах
+    glm::mat4 world = glm::mat4(1.0f);
+};
+
+/// @brief Содержимое файла GLB
+/// @note Данные частей сеток могут указывать в отображение файла, поэтому модель не копируется
+struct GltfModel {
+    GltfModel() = default;
+    GltfModel(const GltfModel&) = delete;
+    GltfModel& operator=(const GltfModel&) = delete;
+
+    /// @brief Файл модели
+    AssetFile file;
+    /// @brief Сетки
+    std::vector<GltfMesh> meshes;
+    /// @brief Материалы
+    std::vector<GltfMaterial> materials;
+    /// @brief Узлы
+    std::vector<GltfNode> nodes;
+    /// @brief Корневые узлы отображаемой сцены
+    std::vector<int> roots;
+};
+
+/// @brief Класс для импорта моделей glTF 2.0 в двоичном формате GLB
+/// @details Файл отображается в память. Если вершины уже лежат в формате сетки движка, а индексы
+/// плотно упакованы, они передаются в OpenGL прямо из отображения, иначе преобразуются
+/// @note load требует контекст OpenGL. Сетки принадлежат импортёру и удаляются вместе с ним
+class GltfImporter {
+public:
+    /// @brief Конструктор
+    GltfImporter() = default;
+
+    /// @brief Деструктор
+    ~GltfImporter();
+
+    GltfImporter(const GltfImporter&) = delete;
+    GltfImporter& operator=(const GltfImporter&) = delete;
+
+    /// @brief Разбор файла GLB через VirtualFS
+    /// @details Пути текстур отсчитываются от каталога файла, встроенные изображения не поддерживаются
+    /// @param path Путь к файлу
+    /// @param model Результат
+    /// @return true на успех, false на неудачу
+    static bool parse(const std::string& path, GltfModel& model);
+
+    /// @brief Разбор содержимого файла GLB
+    /// @param data Содержимое файла, должно оставаться доступным, пока используется модель
+    /// @param size Размер в байтах
+    /// @param directory Каталог файла с разделителем в конце
+    /// @param model Результат
+    /// @return true на успех, false на неудачу
+    static bool parse(const unsigned char* data, size_t size, const std::string& directory, GltfModel& model);
+
+    /// @brief Разложение матрицы на параметры объекта сцены
+    /// @details Поворот раскладывается в углы Эйлера в порядке осей X, Y, Z, как их собирает Renderer
+    /// @param matrix Матрица сдвига, поворота и масштаба
+    /// @param node Объект сцены, заполняются position, rotation и scale
+    static void decompose(const glm::mat4& matrix, SceneNode& node);
+
+    /// @brief Загрузка модели в сцену
+    /// @details Каждая часть сетки каждого узла становится объектом сцены, узлы с одной сеткой используют общие сетки
+    /// @param path Путь к файлу
+    /// @param scene Сцена, объекты добавляются к существующим
+    /// @return true на успех, false на неудачу
+    bool load(const std::string& path, Scene& scene);
+
+    /// @brief Получение созданных сеток
+    /// @return Сетки
+    const std::vector<Mesh*>& getMeshes() const { return meshes; }
+
+private:
+    /// @brief Созданные сетки
+    std::vector<Mesh*> meshes;
+};
+}
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <glad/glad.h>
+#include <vector>
+
+#include "FrameSync.h"
+
+#define GPU_PROFILER_SCOPES_MAX 64
+#define GPU_PROFILER_LATENCY (FRAMES_IN_FLIGHT_MAX + 1)
+
+namespace REngine {
+/// @brief Результат измерения области на GPU
+struct GpuScopeResult {
+    /// @brief Название области
+    const char* name;
+    /// @brief Глубина вложенности
+    int depth;
+    /// @brief Время выполнения в миллисекундах
+    double time;
+};
+
+/// @brief Класс для измерения времени выполнения областей кадра на GPU
+/// @details Оборачивает именованные области запросами GL_TIMESTAMP, что допускает
+/// вложенность. Запросы хранятся для нескольких кадров, а их результаты читаются
+/// только после готовности, поэтому чтение никогда не блокирует CPU
+class GpuProfiler {
+public:
+    /// @brief Конструктор
+    GpuProfiler();
+
+    /// @brief Деструктор
+    ~GpuProfiler();
+
+    /// @brief Начало кадра
+    /// @param frame Номер кадра
+    void beginFrame(unsigned long frame);
+
+    /// @brief Конец кадра
+    void endFrame();
+
+    /// @brief Начало области
+    /// @param name Название области, строка должна существовать до чтения результатов
+    /// @return Индекс области или -1, если измерение невозможно
+    int beginScope(const char* name);
+
+    /// @brief Конец области
+    /// @param index Индекс области
+    void endScope(int index);
+
+    /// @brief Включение измерения групп отрисовки
+    /// @details Подряд идущие вызовы одной корзины сетки и материала измеряются одной областью,
+    /// количество названий ограничено RENDERER_DRAW_SCOPES
+    /// @param detailed true для измерения групп
+    void setDetailed(bool detailed) { this->detailed = detailed; }
+
+    /// @brief Проверка измерения групп отрисовки
+    /// @return true, если измеряются группы
+    bool isDetailed() const { return detailed; }
+
+    /// @brief Получение результатов кадра, полученного последним вызовом consumeResults
+    /// @return Результаты в порядке начала областей
+    const std::vector<GpuScopeResult>& getResults() const { return results; }
+
+    /// @brief Получение номера кадра, полученного последним вызовом consumeResults
+    /// @return Номер кадра
+    unsigned long getResolvedFrame() const { return resolvedFrame; }
+
+    /// @brief Переход к самому старому прочитанному, но не полученному кадру
+    /// @details За один кадр может стать готовым несколько кадров, поэтому вызывается в цикле,
+    /// пока возвращает true. Неполученные кадры сверх GPU_PROFILER_LATENCY отбрасываются
+    /// @return true, если результаты следующего кадра доступны через getResults
+    bool consumeResults();
+
+    /// @brief Получение суммарного времени областей с заданным названием
+    /// @param name Название области
+    /// @return Время в миллисекундах
+    double getScopeTime(const char* name) const;
+
+    /// @brief Получение количества кадров, результаты которых были отброшены
+    /// @return Количество кадров
+    unsigned long getDroppedFrames() const { return droppedFrames; }
+
+private:
+    /// @brief Запросы одного кадра
+    struct FrameQueries {
+        /// @brief Номер кадра
+        unsigned long frame = 0;
+        /// @brief Количество областей
+        int scopeCount = 0;
+        /// @brief Ожидает ли кадр чтения
+        bool pending = false;
+        /// @brief Последний отправленный запрос
+        GLuint lastQuery = 0;
+        /// @brief Названия областей
+        const char* names[GPU_PROFILER_SCOPES_MAX];
+        /// @brief Глубина вложенности областей
+        int depths[GPU_PROFILER_SCOPES_MAX];
+        /// @brief Запросы начала и конца областей
+        GLuint queries[GPU_PROFILER_SCOPES_MAX * 2];
+    };
+
+    /// @brief Прочитанный кадр, ожидающий consumeResults
+    struct ResolvedFrame {
+        /// @brief Номер кадра
+        unsigned long frame = 0;
+        /// @brief Количество областей
+        int scopeCount = 0;
+        /// @brief Результаты областей
+        GpuScopeResult scopes[GPU_PROFILER_SCOPES_MAX];
+    };
+
+    /// @brief Запросы кадров
+    FrameQueries frames[GPU_PROFILER_LATENCY];
+    /// @brief Очередь прочитанных кадров
+    ResolvedFrame ready[GPU_PROFILER_LATENCY];
+    /// @brief Индекс самого старого кадра в очереди
+    int readyStart = 0;
+    /// @brief Количество кадров в очереди
+    int readyCount = 0;
+    /// @brief Индекс текущего кадра
+    int current = -1;
+    /// @brief Идёт ли запись кадра
+    bool inFrame = false;
+    /// @brief Текущая глубина вложенности
+    int depth = 0;
+    /// @brief Измерение групп отрисовки
+    bool detailed = false;
+    /// @brief Выводилось ли предупреждение об областях сверх GPU_PROFILER_SCOPES_MAX
+    bool scopesDropped = false;
+    /// @brief Результаты кадра, полученного consumeResults
+    std::vector<GpuScopeResult> results;
+    /// @brief Номер кадра, полученного consumeResults
+    unsigned long resolvedFrame = 0;
+    /// @brief Количество отброшенных кадров
+    unsigned long droppedFrames = 0;
+
+    /// @brief Чтение готовых кадров
+    void resolve();
+
+    /// @brief Попытка прочитать результаты кадра
+    /// @param queries Запросы кадра
+    /// @return true, если результаты готовы и прочитаны
+    bool tryResolve(FrameQueries& queries);
+};
+
+/// @brief Область измерения на GPU на время жизни объекта
+class GpuScope {
+public:
+    /// @brief Конструктор
+    /// @param profiler Профилировщик, может быть nullptr
+    /// @param name Название области
+    GpuScope(GpuProfiler* profiler, const char* name)
+        : profiler(profiler), index(profiler ? profiler->beginScope(name) : -1) {}
+
+    /// @brief Деструктор
+    ~GpuScope() {
+        if (profiler) {
+            profiler->endScope(index);
+        }
+    }
+
+private:
+    /// @brief Профилировщик
+    GpuProfiler* profiler;
+    /// @brief Индекс области
+    int index;
+};
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define INPUT_HANDLER_H
 
 #include <functional>
+#include <string>
 #include <unordered_map>
 #include <SDL.h>
 #include <glm/glm.hpp>
@@ -31,9 +32,17 @@ public:
     static bool handleEvent(const SDL_Event& event);
 
     /// @brief Обновление состояния ввода
+    /// @details Эквивалентно вызову pollEvents и updateHeldKeys
     /// @param deltaTime Время с прошлого кадра
     static void update(float deltaTime);
 
+    /// @brief Обработка накопившихся событий SDL
+    static void pollEvents();
+
+    /// @brief Вызов методов для удерживаемых клавиш
+    /// @param deltaTime Шаг симуляции в секундах
+    static void updateHeldKeys(float deltaTime);
+
     /// @brief Установка метода для нажатия клавиши
     /// @param key Код клавиши SDL
     /// @param callback Функция-обработчик
@@ -72,6 +81,48 @@ public:
     /// @return true, если клавиша нажата
     static bool isKeyDown(SDL_Keycode key);
 
+    /// @brief Проверка нажатия кнопки мыши
+    /// @param button Код кнопки мыши SDL
+    /// @return true, если кнопка нажата
+    /// @note Состояние берётся из обработанных событий, поэтому совпадает при воспроизведении
+    static bool isMouseButtonDown(Uint8 button);
+
+    /// @brief Начало записи ввода
+    /// @details Обработанные события ввода и время каждого кадра записываются
+    /// в компактном двоичном формате
+    /// @param path Путь к файлу записи
+    /// @return true на успех, false на неудачу
+    static bool startRecording(const std::string& path);
+
+    /// @brief Окончание записи ввода
+    static void stopRecording();
+
+    /// @brief Проверка записи ввода
+    /// @return true, если идёт запись
+    static bool isRecording();
+
+    /// @brief Начало воспроизведения ввода
+    /// @details Пока идёт воспроизведение, события SDL отбрасываются, а вместо них
+    /// обрабатываются записанные события в тех же кадрах, что и при записи
+    /// @param path Путь к файлу записи
+    /// @return true на успех, false на неудачу
+    static bool startReplay(const std::string& path);
+
+    /// @brief Окончание воспроизведения ввода
+    static void stopReplay();
+
+    /// @brief Проверка воспроизведения ввода
+    /// @return true, если идёт воспроизведение
+    static bool isReplaying();
+
+    /// @brief Начало кадра ввода
+    /// @details При записи сохраняет время кадра, при воспроизведении заменяет его записанным.
+    /// При записи время округляется до точности, с которой оно хранится в файле,
+    /// чтобы запись и воспроизведение давали одинаковую симуляцию
+    /// @param deltaTime Время с прошлого кадра в секундах
+    /// @return false, если записанные кадры закончились
+    static bool beginFrame(double& deltaTime);
+
     /// @brief Получение позиции мыши
     /// @return Позиция мыши в виде glm::vec2
     static glm::vec2 getMousePosition();
@@ -91,6 +142,7 @@ private:
     static MouseWheelCallback mouseWheelCallback_;
     static glm::vec2 mousePosition_;
     static glm::vec2 mouseRelativeMotion_;
+    static Uint32 mouseButtons_;
 };
 
 }
@@ -1,13 +1,182 @@
 #pragma once
-#include <iostream>
-#define DEBUG_MODE
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
-#ifdef DEBUG_MODE
-    #define DEBUG(TEXT) (std::cout << "[DEBUG] " << TEXT << std::endl)
-#else
-    #define DEBUG(TEXT)
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_FATAL 4
+
+// Сообщения ниже этого уровня не компилируются
+#ifndef RENGINE_LOG_LEVEL
+    #if defined(DEBUG_MODE) || !defined(NDEBUG)
+        #define RENGINE_LOG_LEVEL LOG_LEVEL_DEBUG
+    #else
+        #define RENGINE_LOG_LEVEL LOG_LEVEL_INFO
+    #endif
 #endif
-#define INFO(TEXT) (std::cout << "[INFO] " << TEXT << std::endl)
-#define WARN(TEXT) (std::cout << "[WARN] " << TEXT << std::endl)
-#define ERROR(TEXT) (std::cerr << "[ERROR] " << TEXT << std::endl)
-#define FATAL(TEXT) (std::cerr << "[FATAL] " << TEXT << std::endl)
\ No newline at end of file
+
+// Размер записи в очереди и количество записей, степень двойки
+#define LOG_RECORD_SIZE 256
+#define LOG_QUEUE_SIZE 4096
+
+#define LOG_AT(LEVEL, TEXT)                                  \
+    do {                                                     \
+        if constexpr (LEVEL >= RENGINE_LOG_LEVEL) {          \
+            REngine::LogRecord logRecord(LEVEL);             \
+            logRecord << TEXT;                               \
+        }                                                    \
+    } while (0)
+
+#define DEBUG(TEXT) LOG_AT(LOG_LEVEL_DEBUG, TEXT)
+#define INFO(TEXT) LOG_AT(LOG_LEVEL_INFO, TEXT)
+#define WARN(TEXT) LOG_AT(LOG_LEVEL_WARN, TEXT)
+#define ERROR(TEXT) LOG_AT(LOG_LEVEL_ERROR, TEXT)
+#define FATAL(TEXT) LOG_AT(LOG_LEVEL_FATAL, TEXT)
+
+namespace REngine {
+/// @brief Типы значений в записи журнала
+enum class LogArg : uint8_t { String, HeapString, Signed, Unsigned, Double, Bool, Char, Pointer };
+
+/// @brief Ячейка очереди журнала
+struct LogSlot {
+    /// @brief Номер последовательности для синхронизации производителей и потребителя
+    std::atomic<size_t> sequence;
+    /// @brief Уровень сообщения
+    uint8_t level;
+    /// @brief Занятый размер данных
+    uint16_t size;
+    /// @brief Данные: тип значения и само значение
+    unsigned char payload[LOG_RECORD_SIZE];
+};
+
+/// @brief Класс для асинхронной записи журнала
+/// @details Сообщения кладутся в кольцевую очередь без блокировок вместе с
+/// неотформатированными значениями, а форматирует и пишет их фоновый поток.
+/// При переполнении очереди сообщения отбрасываются, поток не ждёт. Сообщения ERROR и FATAL
+/// вместо этого сразу пишутся в stderr
+class Log {
+public:
+    /// @brief Запись журнала в файл вместо стандартных потоков
+    /// @param path Путь к файлу, пустая строка для возврата к стандартным потокам
+    /// @return true на успех, false на неудачу
+    static bool setOutputFile(const std::string& path);
+
+    /// @brief Ожидание записи всех сообщений, отправленных до вызова
+    static void flush();
+
+    /// @brief Получение количества отброшенных сообщений
+    /// @return Количество сообщений
+    static unsigned long getDropped();
+
+    /// @brief Захват ячейки очереди
+    /// @param level Уровень сообщения, отброшенные сообщения ниже LOG_LEVEL_ERROR учитываются в getDropped
+    /// @return Ячейка или nullptr, если очередь заполнена
+    static LogSlot* acquire(uint8_t level);
+
+    /// @brief Публикация заполненной ячейки
+    /// @param slot Ячейка
+    static void publish(LogSlot* slot);
+
+    /// @brief Синхронная запись сообщения в stderr мимо очереди
+    /// @param slot Заполненная ячейка вне очереди
+    static void writeDirect(const LogSlot& slot);
+};
+
+/// @brief Запись журнала на время жизни объекта
+/// @details Значения копируются в ячейку очереди без форматирования и выделения памяти.
+/// Строки, не поместившиеся в ячейку, копируются в кучу
+class LogRecord {
+public:
+    /// @brief Конструктор
+    /// @param level Уровень сообщения
+    LogRecord(uint8_t level) : slot(Log::acquire(level)) {
+        if (!slot && level >= LOG_LEVEL_ERROR) {
+            // Ошибку нельзя потерять при заполненной очереди, она пишется напрямую
+            slot = &overflow;
+        }
+        if (slot) {
+            slot->level = level;
+            slot->size = 0;
+        }
+    }
+
+    /// @brief Деструктор, публикует запись
+    ~LogRecord() {
+        if (slot == &overflow) {
+            Log::writeDirect(overflow);
+        } else if (slot) {
+            Log::publish(slot);
+        }
+    }
+
+    LogRecord(const LogRecord&) = delete;
+    LogRecord& operator=(const LogRecord&) = delete;
+
+    /// @brief Добавление значения
+    /// @param value Значение
+    /// @return Запись
+    template <typename T>
+    LogRecord& operator<<(const T& value) {
+        if (!slot) {
+            return *this;
+        }
+        if constexpr (std::is_same_v<T, bool>) {
+            put(LogArg::Bool, (uint8_t)value);
+        } else if constexpr (std::is_same_v<T, char>) {
+            put(LogArg::Char, value);
+        } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+            if constexpr (std::is_signed_v<T> || std::is_enum_v<T>) {
+                put(LogArg::Signed, (int64_t)value);
+            } else {
+                put(LogArg::Unsigned, (uint64_t)value);
+            }
+        } else if constexpr (std::is_floating_point_v<T>) {
+            put(LogArg::Double, (double)value);
+        } else if constexpr (std::is_array_v<T> || std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) {
+            putString(std::string_view(value));
+        } else if constexpr (std::is_pointer_v<T> && sizeof(std::remove_pointer_t<T>) == 1 &&
+                             std::is_integral_v<std::remove_pointer_t<T>>) {
+            // Строки C, в том числе GLubyte* от glGetString
+            putString(value ? std::string_view(reinterpret_cast<const char*>(value)) : std::string_view("(null)"));
+        } else if constexpr (std::is_pointer_v<T>) {
+            put(LogArg::Pointer, (uint64_t)(uintptr_t)value);
+        } else {
+            // Прочие типы форматируются сразу
+            std::ostringstream stream;
+            stream << value;
+            putString(stream.str());
+        }
+        return *this;
+    }
+
+private:
+    /// @brief Ячейка очереди, overflow или nullptr, если сообщение отброшено
+    LogSlot* slot;
+    /// @brief Ячейка для ошибок при заполненной очереди
+    LogSlot overflow;
+
+    /// @brief Добавление значения фиксированного размера
+    /// @param type Тип значения
+    /// @param value Значение
+    template <typename T>
+    void put(LogArg type, T value) {
+        if (slot->size + 1 + sizeof(T) > LOG_RECORD_SIZE) {
+            return;
+        }
+        slot->payload[slot->size] = (unsigned char)type;
+        std::memcpy(slot->payload + slot->size + 1, &value, sizeof(T));
+        slot->size += 1 + sizeof(T);
+    }
+
+    /// @brief Добавление строки
+    /// @param text Строка
+    void putString(std::string_view text);
+};
+}
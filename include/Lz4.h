@@ -0,0 +1,33 @@
+#ifndef LZ4_H
+#define LZ4_H
+
+#include <cstddef>
+#include <vector>
+
+namespace REngine {
+/// @brief Класс для сжатия данных в блочном формате LZ4
+/// @details Совпадения ищутся жадно по хэшу четырёх байт, сжатые данные совместимы с LZ4_decompress_safe
+class Lz4 {
+public:
+    /// @brief Получение наибольшего размера сжатых данных
+    /// @param size Размер исходных данных в байтах
+    /// @return Размер в байтах
+    static size_t getBound(size_t size) { return size + size / 255 + 16; }
+
+    /// @brief Сжатие блока
+    /// @param data Исходные данные
+    /// @param size Размер исходных данных в байтах
+    /// @param compressed Результат
+    static void compress(const unsigned char* data, size_t size, std::vector<unsigned char>& compressed);
+
+    /// @brief Распаковка блока
+    /// @param data Сжатые данные
+    /// @param size Размер сжатых данных в байтах
+    /// @param output Буфер для распакованных данных
+    /// @param outputSize Размер распакованных данных в байтах
+    /// @return true на успех, false если данные повреждены или не совпадает размер
+    static bool decompress(const unsigned char* data, size_t size, unsigned char* output, size_t outputSize);
+};
+}
+
+#endif
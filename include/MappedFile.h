@@ -0,0 +1,57 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace REngine {
+/// @brief Файл, отображённый в память только для чтения
+/// @details Содержимое читается напрямую из страничного кэша без копирования в буфер
+class MappedFile {
+public:
+    /// @brief Конструктор по умолчанию
+    MappedFile() = default;
+
+    /// @brief Конструктор, открывающий файл
+    /// @param path Путь к файлу
+    MappedFile(const std::string& path) { open(path); }
+
+    /// @brief Деструктор
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// @brief Отображение файла в память
+    /// @param path Путь к файлу
+    /// @return true на успех, false на неудачу
+    bool open(const std::string& path);
+
+    /// @brief Закрытие файла
+    void close();
+
+    /// @brief Проверка, открыт ли файл
+    /// @return true, если файл отображён в память
+    bool isOpen() const { return bytes != nullptr; }
+
+    /// @brief Получение содержимого файла
+    /// @return Указатель на начало файла
+    const unsigned char* data() const { return bytes; }
+
+    /// @brief Получение размера файла
+    /// @return Размер в байтах
+    size_t size() const { return length; }
+
+private:
+    /// @brief Содержимое файла
+    const unsigned char* bytes = nullptr;
+    /// @brief Размер файла
+    size_t length = 0;
+#ifdef _WIN32
+    /// @brief Дескриптор отображения
+    void* mapping = nullptr;
+#endif
+};
+}
+
+#endif
@@ -4,7 +4,29 @@
 #include "Shader.h"
 #include "Texture.h"
 
+#define MESH_INSTANCE_ATTRIBUTE 3
+#define MESH_DIFFUSE_ARRAY_UNIT 2
+#define MESH_SPECULAR_ARRAY_UNIT 3
+#define MESH_SOURCE_TEXTURE -1.0f
+#define MESH_SOURCE_COLOR -2.0f
+
 namespace REngine {
+/// @brief Данные объекта для отрисовки нескольких объектов одним вызовом
+struct InstanceData {
+    /// @brief Матрица модели
+    glm::mat4 model;
+    /// @brief Матрица нормалей
+    glm::mat4 normalMatrix;
+    /// @brief Источник цвета текстуры и текстуры отражений из getMaterialSource, степень блеска и искажение
+    glm::vec4 material;
+    /// @brief Наименьшие загруженные уровни текстуры и текстуры отражений
+    glm::vec2 minLod;
+    /// @brief Сплошной цвет текстуры
+    glm::vec3 diffuseColor;
+    /// @brief Сплошной цвет текстуры отражений
+    glm::vec3 specularColor;
+};
+
 /// @brief Класс для геометрических примитивов
 /// @details Предоставляет интерфейс для инициализации и отрисовки 3D объектов
 class Mesh {
@@ -14,6 +36,18 @@ public:
     /// @param indices Вектор индексов
     Mesh(std::vector<float> vertices, std::vector<unsigned> indices);
 
+    /// @brief Конструктор из данных без копирования в куче
+    /// @details Данные передаются в OpenGL напрямую, например из отображённого в память файла.
+    /// AABB вычисляется сразу, computeAABB для такой сетки ничего не делает
+    /// @param vertices Вершины: координаты, нормаль и UV
+    /// @param vertexCount Количество вершин
+    /// @param indices Индексы
+    /// @param indexCount Количество индексов
+    /// @param indexType Тип индексов: GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT или GL_UNSIGNED_INT
+    /// @param flipTexCoords Заменить V на 1 - V при передаче в видеопамять
+    Mesh(const float* vertices, size_t vertexCount, const void* indices, size_t indexCount, unsigned int indexType,
+         bool flipTexCoords = false);
+
     /// @brief Деструктор
     ~Mesh();
 
@@ -26,6 +60,13 @@ public:
     /// @param shader Используемый шейдер
     void draw(const Shader& shader);
 
+    /// @brief Отрисовка нескольких объектов одним вызовом
+    /// @details Данные объектов читаются атрибутами с MESH_INSTANCE_ATTRIBUTE, текстуры привязывает вызывающий
+    /// @param instanceBuffer Буфер с массивом InstanceData
+    /// @param offset Смещение данных первого объекта в байтах
+    /// @param count Количество объектов
+    void drawInstanced(unsigned int instanceBuffer, size_t offset, int count);
+
     /// @brief Вычисление AABB
     void computeAABB();
 
@@ -36,14 +77,39 @@ public:
     /// @return Максимальные координаты AABB
     const glm::vec3& getMax() const { return max; }
 
+    /// @brief Получение количества индексов
+    /// @return Количество индексов
+    unsigned int getIndexCount() const { return indexSize; }
+
+    /// @brief Получение плотности UV
+    /// @return Единиц UV на единицу длины сетки
+    float getUVDensity() const { return uvDensity; }
+
+    /// @brief Получение источника цвета материала для шейдера
+    /// @param texture Текстура материала
+    /// @return Слой массива, MESH_SOURCE_TEXTURE для отдельной текстуры или MESH_SOURCE_COLOR для сплошного цвета
+    static float getMaterialSource(const Texture* texture);
+
     /// @brief Создание куба
     /// @return Куб
     static Mesh createCube();
     /// @brief Создание сферы
+    /// @details Сначала ищется подготовленная сетка getSphereName, иначе сфера строится tessellateSphere
     /// @param vslices Количество вертикальных сегментов
     /// @param hslices Количество горизонтальных сегментов
     /// @return Сфера
     static Mesh createSphere(int vslices = 100, int hslices = 100);
+    /// @brief Построение вершин и индексов сферы без создания буферов
+    /// @param vslices Количество вертикальных сегментов
+    /// @param hslices Количество горизонтальных сегментов
+    /// @param vertices Вектор вершин
+    /// @param indices Вектор индексов
+    static void tessellateSphere(int vslices, int hslices, std::vector<float>& vertices, std::vector<unsigned>& indices);
+    /// @brief Получение пути к подготовленной сфере
+    /// @param vslices Количество вертикальных сегментов
+    /// @param hslices Количество горизонтальных сегментов
+    /// @return Путь к файлу .rmesh
+    static std::string getSphereName(int vslices, int hslices);
 private:
     /// @brief Вектор вершин
     std::vector<float> vertices;
@@ -55,6 +121,10 @@ private:
     unsigned int EBO;
     /// @brief Количество индексов
     unsigned int indexSize;
+    /// @brief Тип индексов
+    unsigned int indexType;
+    /// @brief Плотность UV
+    float uvDensity = 1.0f;
     /// @brief Минимальные координаты AABB
     glm::vec3 min;
     /// @brief Максимальные координаты AABB
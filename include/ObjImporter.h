@@ -0,0 +1,96 @@
+#ifndef OBJ_IMPORTER_H
+#define OBJ_IMPORTER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Scene.h"
+
+#define OBJ_CHUNK_MIN (1 << 20)
+
+namespace REngine {
+/// @brief Материал из файла MTL
+struct ObjMaterial {
+    /// @brief Имя материала
+    std::string name;
+    /// @brief Путь к текстуре map_Kd
+    std::string texturePath;
+    /// @brief Путь к текстуре отражений map_Ks
+    std::string specularPath;
+    /// @brief Степень блеска Ns
+    float shininess = 32.0f;
+};
+
+/// @brief Часть модели с одним материалом
+struct ObjShape {
+    /// @brief Имя первого объекта или группы с этим материалом
+    std::string name;
+    /// @brief Номер материала в ObjModel::materials или -1
+    int material = -1;
+    /// @brief Вершины в формате сетки: координаты, нормаль и UV
+    std::vector<float> vertices;
+    /// @brief Индексы треугольников
+    std::vector<unsigned> indices;
+};
+
+/// @brief Содержимое файла OBJ
+struct ObjModel {
+    /// @brief Части модели в порядке первого использования материала
+    std::vector<ObjShape> shapes;
+    /// @brief Материалы из всех подключённых файлов MTL
+    std::vector<ObjMaterial> materials;
+};
+
+/// @brief Класс для импорта моделей Wavefront OBJ с материалами MTL
+/// @details Файл разбирается в нескольких потоках по фрагментам не меньше OBJ_CHUNK_MIN байт,
+/// одинаковые сочетания координат, UV и нормали становятся одной вершиной
+/// @note load требует контекст OpenGL. Сетки принадлежат импортёру и удаляются вместе с ним
+class ObjImporter {
+public:
+    /// @brief Конструктор
+    ObjImporter() = default;
+
+    /// @brief Деструктор
+    ~ObjImporter();
+
+    ObjImporter(const ObjImporter&) = delete;
+    ObjImporter& operator=(const ObjImporter&) = delete;
+
+    /// @brief Разбор файла OBJ через VirtualFS
+    /// @details Многоугольники разбиваются веером на треугольники, без нормалей в файле
+    /// вычисляются сглаженные нормали. Пути текстур отсчитываются от каталога файла MTL
+    /// @param path Путь к файлу
+    /// @param model Результат
+    /// @param threads Количество потоков, 0 для выбора по количеству ядер
+    /// @return true на успех, false на неудачу
+    static bool parse(const std::string& path, ObjModel& model, int threads = 0);
+
+    /// @brief Разбор содержимого файла OBJ
+    /// @param data Содержимое файла
+    /// @param size Размер в байтах
+    /// @param directory Каталог файла для поиска MTL с разделителем в конце
+    /// @param model Результат
+    /// @param threads Количество потоков, 0 для выбора по количеству ядер
+    /// @return true на успех, false на неудачу
+    static bool parse(const char* data, size_t size, const std::string& directory, ObjModel& model, int threads = 0);
+
+    /// @brief Загрузка модели в сцену
+    /// @details Каждая часть модели становится объектом сцены с текстурами и степенью блеска материала
+    /// @param path Путь к файлу
+    /// @param scene Сцена, объекты добавляются к существующим
+    /// @param threads Количество потоков разбора, 0 для выбора по количеству ядер
+    /// @return true на успех, false на неудачу
+    bool load(const std::string& path, Scene& scene, int threads = 0);
+
+    /// @brief Получение созданных сеток
+    /// @return Сетки
+    const std::vector<Mesh*>& getMeshes() const { return meshes; }
+
+private:
+    /// @brief Созданные сетки
+    std::vector<Mesh*> meshes;
+};
+}
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef PACK_ARCHIVE_H
+#define PACK_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+#define RPAK_MAGIC 0x4B415052 // "RPAK"
+#define RPAK_VERSION 1
+#define RPAK_ALIGNMENT 16
+#define RPAK_FLAG_LZ4 1
+
+namespace REngine {
+/// @brief Заголовок файла .rpak
+/// @details За заголовком идут данные файлов, выровненные до RPAK_ALIGNMENT байт,
+/// затем entryCount записей RPakEntry по возрастанию хэша и имена файлов
+struct RPakHeader {
+    uint32_t magic;          // Сигнатура RPAK_MAGIC
+    uint32_t version;        // Версия формата RPAK_VERSION
+    uint32_t entryCount;     // Количество файлов
+    uint32_t reserved;       // Не используется
+    uint64_t tableOffset;    // Смещение таблицы файлов
+    uint64_t namesOffset;    // Смещение имён файлов
+};
+
+/// @brief Описание файла в архиве .rpak
+struct RPakEntry {
+    uint64_t hash;           // Хэш имени PackArchive::hashName
+    uint64_t offset;         // Смещение данных от начала архива
+    uint64_t size;           // Размер файла в байтах
+    uint64_t storedSize;     // Размер данных в архиве
+    uint32_t nameOffset;     // Смещение имени от namesOffset
+    uint32_t nameLength;     // Длина имени
+    uint32_t flags;          // RPAK_FLAG_LZ4, если данные сжаты
+    uint32_t reserved;       // Не используется
+};
+
+/// @brief Файл для записи в архив
+struct PackFile {
+    /// @brief Путь внутри архива
+    std::string name;
+    /// @brief Содержимое
+    std::vector<unsigned char> data;
+    /// @brief Сжимать ли LZ4, файл остаётся несжатым, если это не уменьшает размер
+    bool compress = false;
+};
+
+/// @brief Архив файлов ресурсов, отображённый в память
+/// @details Файл ищется двоичным поиском по хэшу имени без обращений к файловой системе,
+/// несжатые данные читаются из отображения без копирования
+class PackArchive {
+public:
+    /// @brief Приведение пути к виду, в котором он хранится в архиве
+    /// @param path Путь к файлу
+    /// @return Путь с разделителями '/' без компонентов "." и "..", для путей от корня только с заменой разделителей
+    static std::string normalizeName(const std::string& path);
+
+    /// @brief Хэш имени файла FNV-1a
+    /// @param name Путь внутри архива
+    /// @return 64-битный хэш
+    static uint64_t hashName(const std::string& name);
+
+    /// @brief Запись архива
+    /// @param path Путь к файлу
+    /// @param files Файлы, имена не должны повторяться
+    /// @return true на успех, false на неудачу
+    static bool save(const std::string& path, const std::vector<PackFile>& files);
+
+    /// @brief Открытие архива
+    /// @param path Путь к файлу
+    /// @return true на успех, false если файл не найден или повреждён
+    bool open(const std::string& path);
+
+    /// @brief Закрытие архива
+    void close();
+
+    /// @brief Проверка, открыт ли архив
+    /// @return true, если архив отображён в память
+    bool isOpen() const { return file.isOpen(); }
+
+    /// @brief Поиск файла
+    /// @param name Путь внутри архива, приведённый normalizeName
+    /// @return Описание файла или nullptr
+    const RPakEntry* find(const std::string& name) const;
+
+    /// @brief Получение данных файла
+    /// @param entry Описание файла из find
+    /// @param buffer Буфер для распаковки сжатого файла
+    /// @return Содержимое файла в отображении или в buffer, nullptr если данные повреждены
+    const unsigned char* read(const RPakEntry& entry, std::vector<unsigned char>& buffer) const;
+
+    /// @brief Получение количества файлов
+    /// @return Количество файлов
+    size_t getEntryCount() const { return entryCount; }
+
+    /// @brief Получение пути к архиву
+    /// @return Путь к файлу
+    const std::string& getPath() const { return path; }
+
+private:
+    /// @brief Отображение архива
+    MappedFile file;
+    /// @brief Путь к архиву
+    std::string path;
+    /// @brief Таблица файлов в отображении
+    const RPakEntry* entries = nullptr;
+    /// @brief Количество файлов
+    size_t entryCount = 0;
+    /// @brief Имена файлов в отображении
+    const char* names = nullptr;
+};
+}
+
+#endif
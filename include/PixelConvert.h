@@ -0,0 +1,37 @@
+#ifndef PIXEL_CONVERT_H
+#define PIXEL_CONVERT_H
+
+#include <cstddef>
+
+namespace REngine {
+/// @brief Набор инструкций для преобразования пикселей
+enum class SimdLevel { Scalar, SSSE3, AVX2 };
+
+/// @brief Класс для преобразования порядка каналов пикселей
+/// @details Перестановка выполняется инструкцией pshufb, набор инструкций
+/// выбирается при первом вызове по возможностям процессора
+class PixelConvert {
+public:
+    /// @brief Перестановка каналов BGR в RGB и обратно
+    /// @param src Исходные пиксели
+    /// @param dst Результат, может совпадать с src
+    /// @param pixels Количество пикселей
+    static void swapRB24(const unsigned char* src, unsigned char* dst, size_t pixels);
+
+    /// @brief Перестановка каналов BGRA в RGBA и обратно
+    /// @param src Исходные пиксели
+    /// @param dst Результат, может совпадать с src
+    /// @param pixels Количество пикселей
+    static void swapRB32(const unsigned char* src, unsigned char* dst, size_t pixels);
+
+    /// @brief Получение используемого набора инструкций
+    /// @return Набор инструкций
+    static SimdLevel getSimdLevel();
+
+    /// @brief Ограничение набора инструкций, например для сравнения скорости
+    /// @param level Набор инструкций, выше поддерживаемого процессором не поднимается
+    static void setSimdLevel(SimdLevel level);
+};
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <SDL.h>
+#include <atomic>
+#include <string>
+
+#ifdef RENGINE_PROFILING
+    #define PROFILE_CONCAT_IMPL(A, B) A##B
+    #define PROFILE_CONCAT(A, B) PROFILE_CONCAT_IMPL(A, B)
+    #define PROFILE_SCOPE(NAME) REngine::ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(NAME)
+    #define PROFILE_FRAME(FRAME) REngine::Profiler::beginFrame(FRAME)
+    #define PROFILE_THREAD(NAME) REngine::Profiler::setThreadName(NAME)
+#else
+    #define PROFILE_SCOPE(NAME)
+    #define PROFILE_FRAME(FRAME)
+    #define PROFILE_THREAD(NAME)
+#endif
+
+#define PROFILER_THREAD_EVENTS_MAX (1 << 18)
+
+namespace REngine {
+/// @brief Класс для измерения времени областей кода на CPU
+/// @details Каждый поток пишет события в собственный буфер без блокировок.
+/// События записываются только для заданного диапазона кадров и сохраняются
+/// в формате Chrome trace event, который открывается в Perfetto
+/// @note Вызовы следует делать через макросы PROFILE_*, которые без
+/// RENGINE_PROFILING не компилируются в код
+class Profiler {
+public:
+    /// @brief Установка диапазона кадров для записи
+    /// @param firstFrame Первый записываемый кадр
+    /// @param lastFrame Последний записываемый кадр
+    /// @param path Путь к файлу трассировки, записываемому после lastFrame
+    static void setCaptureRange(unsigned long firstFrame, unsigned long lastFrame, const std::string& path);
+
+    /// @brief Начало кадра
+    /// @param frame Номер кадра
+    static void beginFrame(unsigned long frame);
+
+    /// @brief Установка названия текущего потока в трассировке
+    /// @param name Название потока
+    static void setThreadName(const char* name);
+
+    /// @brief Проверка, идёт ли запись
+    /// @return true, если события записываются
+    static bool isCapturing() { return capturing.load(std::memory_order_relaxed); }
+
+    /// @brief Запись события
+    /// @param name Название области, строка должна существовать до записи трассировки
+    /// @param start Значение SDL_GetPerformanceCounter в начале области
+    /// @param end Значение SDL_GetPerformanceCounter в конце области
+    static void record(const char* name, Uint64 start, Uint64 end);
+
+    /// @brief Запись трассировки в формате Chrome trace event
+    /// @param path Путь к файлу
+    /// @return true на успех, false на неудачу
+    static bool writeChromeTrace(const std::string& path);
+
+private:
+    /// @brief Идёт ли запись
+    static std::atomic<bool> capturing;
+};
+
+/// @brief Область измерения на CPU на время жизни объекта
+class ProfileScope {
+public:
+    /// @brief Конструктор
+    /// @param name Название области
+    ProfileScope(const char* name)
+        : name(name), start(Profiler::isCapturing() ? SDL_GetPerformanceCounter() : 0) {}
+
+    /// @brief Деструктор
+    ~ProfileScope() {
+        if (start != 0) {
+            Profiler::record(name, start, SDL_GetPerformanceCounter());
+        }
+    }
+
+private:
+    /// @brief Название области
+    const char* name;
+    /// @brief Начало области
+    Uint64 start;
+};
+}
+
+#endif
@@ -2,11 +2,34 @@
 #define RENDERER_H
 
 #include <glad/glad.h>
+#include <cstdint>
 #include "Camera.h"
 #include "Shader.h"
 #include "Scene.h"
+#include "GpuProfiler.h"
+#include "FrameArena.h"
+#include "FrameSync.h"
+
+// Корзины сеток и материалов, измеряемых отдельно при подробном профилировании GPU. Вместе с
+// областями frame, clear и opaque не превышает FRAME_STATS_GPU_SCOPES_MAX
+#define RENDERER_DRAW_SCOPES 8
 
 namespace REngine {
+/// @brief Счётчики отрисовки кадра
+struct RenderCounters {
+    /// @brief Количество вызовов отрисовки
+    unsigned int drawCalls = 0;
+    /// @brief Количество треугольников
+    unsigned int triangles = 0;
+    /// @brief Количество отсечённых объектов
+    unsigned int culledNodes = 0;
+    /// @brief Количество привязок текстур
+    unsigned int textureBinds = 0;
+    /// @brief Количество выделений памяти при отрисовке
+    /// @note Считается только с RENGINE_ALLOC_TRACKING
+    unsigned long long allocations = 0;
+};
+
 /// @brief Класс для управления рендерингом
 /// @details Предоставляет функционал для рендеринга сцены
 class Renderer {
@@ -19,12 +42,70 @@ private:
     Scene* scene;
     /// @brief Указатель на шейдер для рендеринга
     Shader* shader;
+    /// @brief Счётчики последнего кадра
+    RenderCounters counters;
+    /// @brief Профилировщик GPU
+    GpuProfiler* gpuProfiler;
+    /// @brief Внеэкранный буфер кадра, 0 для буфера окна
+    GLuint framebuffer;
+    /// @brief Буфер цвета внеэкранного буфера кадра
+    GLuint colorBuffer;
+    /// @brief Буфер глубины внеэкранного буфера кадра
+    GLuint depthBuffer;
+    /// @brief Буферы данных объектов для отрисовки группами, по одному на слот кадра FrameSync
+    GLuint instanceBuffers[FRAMES_IN_FLIGHT_MAX];
+    /// @brief Размеры буферов данных объектов в байтах
+    size_t instanceBufferSizes[FRAMES_IN_FLIGHT_MAX];
+    /// @brief Поддерживает ли шейдер отрисовку группами и массивы текстур
+    bool instancing;
+    /// @brief Получает ли шейдер сплошные цвета в переменных diffuseSolidColor и specularSolidColor
+    bool solidColors;
+
+    /// @brief Пакет отрисовки видимого объекта
+    struct DrawPacket {
+        /// @brief Ключ сортировки: сетка и массивы текстур в старших битах, расстояние до камеры в младших
+        uint64_t sortKey;
+        /// @brief Объект сцены
+        SceneNode* node;
+        /// @brief Текстура
+        Texture* diffuse;
+        /// @brief Текстура отражений
+        Texture* specular;
+        /// @brief Матрица модели
+        glm::mat4 model;
+        /// @brief Матрица нормалей
+        glm::mat4 normalMatrix;
+    };
+
+    /// @brief Запись данных объектов в буфер слота кадра
+    /// @details Барьер слота уже пройден, поэтому буфер отображается без синхронизации с GPU
+    /// @param frameSlot Слот кадра
+    /// @param instances Данные объектов
+    /// @param count Количество объектов
+    /// @return Буфер с данными объектов
+    GLuint writeInstances(int frameSlot, const InstanceData* instances, size_t count);
+
+    /// @brief Отсечение объектов вне области видимости камеры
+    /// @param packets Пакеты видимых объектов в памяти кадра
+    void cull(ArenaVector<DrawPacket>& packets);
+
+    /// @brief Проверка, можно ли нарисовать объект в группе
+    /// @param packet Пакет объекта
+    /// @return true, если обе текстуры хранятся в массивах или заданы цветом, а шейдер поддерживает группы
+    /// и сплошные цвета
+    bool isBatchable(const DrawPacket& packet) const {
+        return instancing && (packet.diffuse->getArray() || (solidColors && packet.diffuse->isSolid())) &&
+               (packet.specular->getArray() || (solidColors && packet.specular->isSolid()));
+    }
 public:
     /// @brief Конструктор движка
     /// @param width Ширина окна
     /// @param height Высота окна
     Renderer(int width, int height);
 
+    /// @brief Деструктор
+    ~Renderer();
+
     /// @brief Получение сцены
     /// @return Указатель на сцену
     Scene* getScene() { return scene; }
@@ -34,6 +115,8 @@ public:
     void setScene(Scene* scene);
 
     /// @brief Установка шейдера
+    /// @details Если шейдер читает текстуры из массивов (переменная instanced), текстуры размещаются
+    /// в TexturePool, а объекты с одной сеткой и массивами текстур рисуются одним вызовом
     /// @param vertexPath Путь к вершинному шейдеру
     /// @param fragmentPath Путь к фрагментному шейдеру
     void setShader(const char* vertexPath, const char* fragmentPath);
@@ -50,9 +133,26 @@ public:
     /// @return Высота окна
     int getHeight() { return height; }
 
+    /// @brief Получение счётчиков последнего кадра
+    /// @return Счётчики отрисовки
+    const RenderCounters& getCounters() const { return counters; }
+
+    /// @brief Создание внеэкранного буфера кадра размером с окно
+    /// @return true на успех, false на неудачу
+    bool createOffscreenTarget();
+
+    /// @brief Получение внеэкранного буфера кадра
+    /// @return Идентификатор буфера кадра, 0 если отрисовка идёт в окно
+    GLuint getFramebuffer() { return framebuffer; }
+
+    /// @brief Получение профилировщика GPU
+    /// @return Указатель на профилировщик GPU
+    GpuProfiler* getGpuProfiler() { return gpuProfiler; }
+
     /// @brief Отрисовка сцены
     /// @param ticks Текущее время в миллисекундах
-    void draw(unsigned long ticks);
+    /// @param frameSlot Слот кадра из FrameSync::getFrameSlot, барьер которого уже пройден в FrameSync::beginFrame
+    void draw(unsigned long ticks, int frameSlot);
 };
 
 /// @brief Инициализация движка
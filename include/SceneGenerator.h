@@ -0,0 +1,169 @@
+#ifndef SCENE_GENERATOR_H
+#define SCENE_GENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Scene.h"
+
+namespace REngine {
+/// @brief Генератор псевдослучайных чисел PCG32
+/// @details В отличие от распределений стандартной библиотеки даёт одинаковую
+/// последовательность на всех платформах и компиляторах
+class Random {
+public:
+    /// @brief Конструктор
+    /// @param seed Зерно
+    Random(uint64_t seed = 1);
+
+    /// @brief Получение следующего числа
+    /// @return Число от 0 до 2^32-1
+    uint32_t next();
+
+    /// @brief Получение числа в диапазоне [0, 1)
+    /// @return Число
+    float nextFloat();
+
+    /// @brief Получение числа в диапазоне [min, max)
+    /// @param min Нижняя граница
+    /// @param max Верхняя граница
+    /// @return Число
+    float range(float min, float max) { return min + (max - min) * nextFloat(); }
+
+    /// @brief Получение вектора с компонентами в диапазоне [min, max)
+    /// @param min Нижняя граница
+    /// @param max Верхняя граница
+    /// @return Вектор
+    glm::vec3 range3(const glm::vec3& min, const glm::vec3& max);
+
+    /// @brief Получение целого числа в диапазоне [0, n)
+    /// @param n Верхняя граница
+    /// @return Число
+    uint32_t below(uint32_t n);
+
+private:
+    /// @brief Состояние генератора
+    uint64_t state;
+};
+
+/// @brief Расположение объектов сгенерированной сцены
+enum class SceneLayout {
+    /// @brief Равномерная сетка
+    Grid,
+    /// @brief Случайные скопления
+    Clusters,
+    /// @brief Городские кварталы с крупными зданиями-окклюдерами
+    City
+};
+
+/// @brief Параметры генерации сцены
+struct SceneGeneratorConfig {
+    /// @brief Зерно
+    uint64_t seed = 1;
+    /// @brief Количество объектов
+    size_t nodeCount = 1000;
+    /// @brief Расположение объектов
+    SceneLayout layout = SceneLayout::Grid;
+    /// @brief Расстояние между соседними объектами сетки
+    float spacing = 3.0f;
+    /// @brief Количество скоплений
+    size_t clusterCount = 8;
+    /// @brief Радиус скопления
+    float clusterRadius = 15.0f;
+    /// @brief Размер городского квартала
+    float blockSize = 20.0f;
+    /// @brief Ширина улицы
+    float streetWidth = 8.0f;
+    /// @brief Максимальная высота здания
+    float buildingHeight = 30.0f;
+    /// @brief Количество точечных источников света, не больше POINT_LIGHTS_MAX
+    size_t lightCount = 8;
+    /// @brief Радиус действия точечного источника света
+    float lightRange = 30.0f;
+    /// @brief Доля объектов с общими сетками, остальные получают собственную сетку
+    float sharedMeshFraction = 1.0f;
+    /// @brief Доля сфер среди объектов
+    float sphereFraction = 0.25f;
+    /// @brief Количество сегментов сфер
+    int sphereSlices = 16;
+    /// @brief Пути к текстурам, назначаемым объектам
+    /// @note Объекты без текстуры получают цвет по умолчанию
+    std::vector<std::string> texturePaths;
+    /// @brief Пути к текстурам отражений, назначаемым объектам
+    std::vector<std::string> specularPaths;
+};
+
+/// @brief Класс для генерации сцен для нагрузочного тестирования
+/// @details Одинаковые параметры и зерно всегда дают одинаковую сцену
+/// @note Требует контекст OpenGL. Сетки принадлежат генератору и удаляются вместе с ним
+class SceneGenerator {
+public:
+    /// @brief Конструктор
+    /// @param config Параметры генерации
+    SceneGenerator(const SceneGeneratorConfig& config);
+
+    /// @brief Деструктор
+    ~SceneGenerator();
+
+    /// @brief Заполнение сцены
+    /// @param scene Сцена, прежние объекты и источники света удаляются
+    void generate(Scene& scene);
+
+    /// @brief Получение созданных сеток
+    /// @return Сетки
+    const std::vector<Mesh*>& getMeshes() const { return meshes; }
+
+    /// @brief Получение центра сгенерированной сцены
+    /// @return Центр
+    const glm::vec3& getCenter() const { return center; }
+
+    /// @brief Получение размера сгенерированной сцены
+    /// @return Размер по каждой оси
+    const glm::vec3& getExtent() const { return extent; }
+
+private:
+    /// @brief Параметры генерации
+    SceneGeneratorConfig config;
+    /// @brief Генератор случайных чисел
+    Random random;
+    /// @brief Созданные сетки
+    std::vector<Mesh*> meshes;
+    /// @brief Общий куб
+    Mesh* sharedCube = nullptr;
+    /// @brief Общая сфера
+    Mesh* sharedSphere = nullptr;
+    /// @brief Центр сцены
+    glm::vec3 center = glm::vec3(0.0f);
+    /// @brief Размер сцены
+    glm::vec3 extent = glm::vec3(0.0f);
+
+    /// @brief Создание объекта
+    /// @param position Позиция
+    /// @param scale Масштаб
+    /// @param sphere true для сферы, false для куба
+    /// @return Объект
+    SceneNode makeNode(const glm::vec3& position, const glm::vec3& scale, bool sphere);
+
+    /// @brief Расположение объектов сеткой
+    /// @param scene Сцена
+    void generateGrid(Scene& scene);
+
+    /// @brief Расположение объектов скоплениями
+    /// @param scene Сцена
+    void generateClusters(Scene& scene);
+
+    /// @brief Расположение объектов кварталами
+    /// @param scene Сцена
+    void generateCity(Scene& scene);
+
+    /// @brief Добавление точечных источников света
+    /// @param scene Сцена
+    void generateLights(Scene& scene);
+
+    /// @brief Удаление созданных сеток
+    void clearMeshes();
+};
+}
+
+#endif
@@ -25,27 +25,57 @@ public:
     /// @param name Имя переменной
     /// @param value Значение
     void setBool(const std::string &name, bool value) const;
+
+    /// @brief Установка булевого значения
+    /// @param name Имя переменной без создания временной строки
+    /// @param value Значение
+    void setBool(const char* name, bool value) const;
     
     /// @brief Установка целочисленного значения
     /// @param name Имя переменной
     /// @param value Значение
     void setInt(const std::string &name, int value) const;
+
+    /// @brief Установка целочисленного значения
+    /// @param name Имя переменной без создания временной строки
+    /// @param value Значение
+    void setInt(const char* name, int value) const;
     
     /// @brief Установка числового значения
     /// @param name Имя переменной
     /// @param value Значение
     void setFloat(const std::string &name, float value) const;
+
+    /// @brief Установка числового значения
+    /// @param name Имя переменной без создания временной строки
+    /// @param value Значение
+    void setFloat(const char* name, float value) const;
     
     /// @brief Установка матрицы 4x4
     /// @param name Имя переменной
     /// @param mat Матрица
     void setMat4(const std::string &name, const glm::mat4 &mat) const;
+
+    /// @brief Установка матрицы 4x4
+    /// @param name Имя переменной без создания временной строки
+    /// @param mat Матрица
+    void setMat4(const char* name, const glm::mat4 &mat) const;
     
     /// @brief Установка вектора из 3 компонентов
     /// @param name Имя переменной
     /// @param value Вектор
     void setVec3(const std::string &name, const glm::vec3 &value) const;
+
+    /// @brief Установка вектора из 3 компонентов
+    /// @param name Имя переменной без создания временной строки
+    /// @param value Вектор
+    void setVec3(const char* name, const glm::vec3 &value) const;
     
+    /// @brief Проверка наличия переменной в программе
+    /// @param name Имя переменной
+    /// @return true, если переменная используется шейдером
+    bool hasUniform(const char* name) const;
+
     /// @brief Проверка валидности шейдера
     /// @return true если шейдер валиден, false в противном случае
     bool isValid() const { return ID != 0; }
@@ -4,9 +4,10 @@
 #include <string>
 #include <cstdint>
 #include <vector>
-#include <unordered_map>
 
 namespace REngine {
+class TextureArray;
+
 /// @brief Заголовок файла BMP
 struct BMPFileHeader {
     uint16_t signature;      // Сигнатура файла
@@ -30,6 +31,58 @@ struct BMPInfoHeader {
     uint32_t colorsImportant;// Количество важных цветов
 };
 
+/// @brief Формат блочного сжатия текстур
+enum class BlockFormat {
+    /// @brief S3TC DXT1, RGB, 8 байт на блок 4x4
+    BC1,
+    /// @brief S3TC DXT5, RGBA, 16 байт на блок 4x4
+    BC3,
+    /// @brief BPTC, RGBA, 16 байт на блок 4x4
+    BC7
+};
+
+/// @brief Формат пикселей текстуры в видеопамяти
+enum class TextureFormat : uint32_t {
+    /// @brief 3 байта на пиксель
+    RGB8,
+    /// @brief 4 байта на пиксель
+    RGBA8,
+    /// @brief Сжатие BC1
+    BC1,
+    /// @brief Сжатие BC3
+    BC3,
+    /// @brief Сжатие BC7
+    BC7
+};
+
+/// @brief Мип-уровень изображения в памяти
+struct TextureLevel {
+    /// @brief Ширина в пикселях
+    int width;
+    /// @brief Высота в пикселях
+    int height;
+    /// @brief Смещение данных уровня
+    size_t offset;
+    /// @brief Размер данных уровня в байтах
+    size_t size;
+};
+
+/// @brief Изображение BMP, указывающее на данные файла
+struct BMPImage {
+    /// @brief Начало данных пикселей
+    const unsigned char* pixels = nullptr;
+    /// @brief Ширина в пикселях
+    int width = 0;
+    /// @brief Высота в пикселях
+    int height = 0;
+    /// @brief Количество битов на пиксель, 24 или 32
+    int bpp = 0;
+    /// @brief Размер строки в байтах с выравниванием до 4
+    int rowSize = 0;
+    /// @brief Хранятся ли строки сверху вниз
+    bool topDown = false;
+};
+
 /// @brief Класс текстуры
 class Texture {
 public:
@@ -44,42 +97,246 @@ public:
     ~Texture();
 
     /// @brief Загрузка текстуры из файла
+    /// @details Файл отображается в память и передаётся в OpenGL в формате BGR или BGRA без копирования
     /// @param path Путь к файлу текстуры
     /// @return true на успех, false на неудачу
     bool loadBMP(const std::string& path);
 
+    /// @brief Разбор заголовков BMP
+    /// @param data Содержимое файла
+    /// @param size Размер файла в байтах
+    /// @param image Результат, указывает внутрь data
+    /// @return true на успех, false на неудачу
+    static bool parseBMP(const unsigned char* data, size_t size, BMPImage& image);
+
+    /// @brief Загрузка BMP в память в формате RGB или RGBA
+    /// @param path Путь к файлу
+    /// @param pixels Пиксели без выравнивания строк, строки снизу вверх
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @param channels Количество каналов, 3 или 4
+    /// @return true на успех, false на неудачу
+    static bool decodeBMP(const std::string& path, std::vector<unsigned char>& pixels, int& width, int& height, int& channels);
+
+    /// @brief Декодирование уже прочитанного BMP в формат RGB или RGBA
+    /// @param data Содержимое файла
+    /// @param size Размер файла в байтах
+    /// @param pixels Пиксели без выравнивания строк, строки снизу вверх
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @param channels Количество каналов, 3 или 4
+    /// @return true на успех, false на неудачу
+    static bool decodeBMP(const unsigned char* data, size_t size, std::vector<unsigned char>& pixels, int& width, int& height,
+                          int& channels);
+
+    /// @brief Загрузка сжатой текстуры из файла DDS
+    /// @details Уровни передаются в OpenGL прямо из отображённого в память файла.
+    /// Если формат не поддерживается драйвером, блоки распаковываются на CPU
+    /// @param path Путь к файлу текстуры
+    /// @return true на успех, false на неудачу
+    bool loadDDS(const std::string& path);
+
+    /// @brief Проверка поддержки формата сжатия драйвером
+    /// @param format Формат сжатия
+    /// @return true, если формат можно передать в glCompressedTexImage2D
+    static bool isFormatSupported(BlockFormat format);
+
+    /// @brief Получение внутреннего формата OpenGL для формата сжатия
+    /// @param format Формат сжатия
+    /// @return Внутренний формат
+    static unsigned int getGLFormat(BlockFormat format);
+
+    /// @brief Загрузка подготовленной текстуры из файла .rtex
+    /// @details Уровни передаются в OpenGL прямо из отображённого в память файла без преобразований
+    /// @param path Путь к файлу текстуры
+    /// @return true на успех, false на неудачу
+    bool loadRTEX(const std::string& path);
+
+    /// @brief Проверка поддержки формата пикселей драйвером
+    /// @param format Формат пикселей
+    /// @return true, если уровни можно передать без распаковки
+    static bool isFormatSupported(TextureFormat format);
+
+    /// @brief Получение внутреннего формата OpenGL
+    /// @param format Формат пикселей
+    /// @return Внутренний формат
+    static unsigned int getGLFormat(TextureFormat format);
+
+    /// @brief Получение формата сжатия
+    /// @param format Формат пикселей
+    /// @param blockFormat Результат для сжатых форматов
+    /// @return true, если формат сжатый
+    static bool getBlockFormat(TextureFormat format, BlockFormat& blockFormat);
+
+    /// @brief Проверка поддержки неизменяемой памяти текстур
+    /// @return true, если доступен glTexStorage2D
+    static bool hasImmutableStorage();
+
+    /// @brief Выделение памяти под мип-уровни привязанной текстуры
+    /// @details С OpenGL 4.2 память выделяется неизменяемой через glTexStorage2D,
+    /// иначе каждый уровень задаётся при передаче
+    /// @param format Формат пикселей, должен поддерживаться драйвером
+    /// @param width Ширина нулевого уровня в пикселях
+    /// @param height Высота нулевого уровня в пикселях
+    /// @param levelCount Количество уровней
+    /// @return true, если память выделена заранее
+    static bool allocateLevels(TextureFormat format, int width, int height, int levelCount);
+
+    /// @brief Передача мип-уровня привязанной текстуры
+    /// @param format Формат пикселей, должен поддерживаться драйвером
+    /// @param allocated Результат allocateLevels
+    /// @param level Номер уровня
+    /// @param info Размеры уровня или передаваемой полосы строк
+    /// @param data Плотно упакованные данные уровня или смещение в буфере пикселей
+    /// @param y Первая строка полосы, для y > 0 память уровня должна быть уже выделена
+    static void uploadLevel(TextureFormat format, bool allocated, int level, const TextureLevel& info, const void* data, int y = 0);
+
+    /// @brief Построение мип-уровней усреднением 2x2 пикселей
+    /// @param pixels Пиксели нулевого уровня без выравнивания строк, уровни дописываются в конец
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @param channels Количество каналов
+    /// @param levels Описание всех уровней, включая нулевой
+    static void buildMipChain(std::vector<unsigned char>& pixels, int width, int height, int channels, std::vector<TextureLevel>& levels);
+
     /// @brief Генерация текстуры из цвета
     /// @param r Красный канал
     /// @param g Зеленый канал
     /// @param b Синий канал
+    /// @param pooled Размещать ли текстуру в TexturePool, если он включён
     /// @return true на успех, false на неудачу
-    bool genFromColor(float r, float g, float b);
+    bool genFromColor(float r, float g, float b, bool pooled = true);
+
+    /// @brief Передача во владение готовой текстуры OpenGL
+    /// @param id ID текстуры
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @param bpp Количество битов на пиксель
+    /// @param memorySize Объём всех мип-уровней в видеопамяти в байтах
+    void adopt(unsigned int id, int width, int height, int bpp, size_t memorySize);
+
+    /// @brief Передача во владение слоя массива текстур
+    /// @param array Массив текстур
+    /// @param layer Номер слоя, освобождается вместе с текстурой
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @param bpp Количество битов на пиксель
+    /// @param memorySize Объём всех мип-уровней слоя в видеопамяти в байтах, включая незагруженные
+    void adoptLayer(TextureArray* array, int layer, int width, int height, int bpp, size_t memorySize);
+
+    /// @brief Отказ от слоя массива без его освобождения
+    /// @note Вызывается TexturePool::clear перед удалением массивов, после чего текстура пуста
+    void detachLayer();
+
+    /// @brief Замена текстуры сплошным цветом
+    /// @details Текстура OpenGL не создаётся, шейдер получает цвет в параметрах материала или
+    /// из getColorTexture, если таких параметров у него нет
+    /// @param r Красный канал
+    /// @param g Зеленый канал
+    /// @param b Синий канал
+    void setColor(float r, float g, float b);
+
+    /// @brief Использование содержимого другой текстуры
+    /// @details Все запросы к текстуре передаются source, своих ресурсов OpenGL у неё нет
+    /// @param source Текстура с тем же содержимым, не должна удаляться раньше этой
+    void share(Texture* source);
+
+    /// @brief Получение текстуры, хранящей содержимое
+    /// @return source из share или эта текстура
+    Texture* getSource() { return source ? source : this; }
+
+    /// @brief Установка признака асинхронной загрузки
+    /// @param pending true, пока вместо текстуры привязывается заглушка
+    void setPending(bool pending) { this->pending = pending; }
+
+    /// @brief Проверка, загружается ли текстура асинхронно
+    /// @return true, если загрузка ещё не завершена
+    bool isPending() const { return resolved().pending; }
 
     /// @brief Привязка текстуры для использования
+    /// @details Текстура из массива привязывается к GL_TEXTURE_2D_ARRAY, остальные к GL_TEXTURE_2D
     void bind() const;
 
     /// @brief Отвязка текстуры
     static void unbind();
 
     /// @brief Проверка валидности текстуры
-    /// @return true если текстура валидна, false в противном случае
-    bool isValid() const { return textureID != 0; }
+    /// @return true если текстура валидна или ещё загружается, false в противном случае
+    bool isValid() const { return isResident() || isPending(); }
+
+    /// @brief Проверка, загружена ли текстура в видеопамять
+    /// @return true, если привязывается сама текстура, а не заглушка
+    bool isResident() const { return resolved().textureID != 0 || resolved().array != nullptr || resolved().solid; }
+
+    /// @brief Проверка, задана ли текстура сплошным цветом
+    /// @return true, если текстуры OpenGL нет
+    bool isSolid() const { return resolved().solid; }
+
+    /// @brief Получение сплошного цвета
+    /// @return Каналы RGB
+    const float* getColor() const { return resolved().color; }
+
+    /// @brief Получение отдельной текстуры 1x1 со сплошным цветом
+    /// @details Создаётся при первом вызове для шейдеров без переменных сплошного цвета, которые
+    /// читают цвет из material.diffuse и material.specular. Общая для всех объектов с этим цветом
+    /// @return Текстура или nullptr, если текстура не задана цветом
+    const Texture* getColorTexture() const;
+
+    /// @brief Получение массива, в слое которого хранится текстура
+    /// @return Массив текстур или nullptr для отдельной текстуры
+    TextureArray* getArray() const { return resolved().array; }
+
+    /// @brief Получение слоя в массиве
+    /// @return Номер слоя
+    int getLayer() const { return resolved().layer; }
+
+    /// @brief Получение ID текстуры
+    /// @return ID текстуры OpenGL, 0 для текстуры из массива
+    unsigned int getID() const { return resolved().textureID; }
+
+    /// @brief Получение самого детального загруженного мип-уровня
+    /// @return Номер уровня, более детальные уровни не читаются
+    int getBaseLevel() const { return resolved().baseLevel; }
+
+    /// @brief Отметка загрузки более детальных мип-уровней
+    /// @details Отдельной текстуре задаются GL_TEXTURE_BASE_LEVEL и GL_TEXTURE_MAX_LEVEL, для слоя
+    /// массива уровень ограничивается в шейдере, а объём слоя не меняется, так как он выделен целиком
+    /// @param level Самый детальный загруженный уровень
+    /// @param maxLevel Самый мелкий уровень текстуры
+    /// @param bytes Объём добавленных уровней в байтах
+    void setBaseLevel(int level, int maxLevel, size_t bytes = 0);
 
     /// @brief Получение ширины текстуры
     /// @return Ширина в пикселях
-    int getWidth() const { return width; }
+    int getWidth() const { return resolved().width; }
 
     /// @brief Получение высоты текстуры
     /// @return Высота в пикселях
-    int getHeight() const { return height; }
+    int getHeight() const { return resolved().height; }
+
+    /// @brief Получение объёма текстуры в видеопамяти
+    /// @return Объём всех мип-уровней в байтах, 0 для текстуры с содержимым другой текстуры
+    size_t getMemorySize() const { return memorySize; }
+
+    /// @brief Количество привязок текстур
+    static unsigned int bindCount;
 
-    /// @brief Хранение текстур
-    static std::unordered_map<std::string, Texture*> textures;
+    /// @brief ID текстуры-заглушки, привязываемой вместо загружаемых текстур
+    static unsigned int placeholderID;
 
 private:
     /// @brief ID текстуры
     unsigned int textureID;
 
+    /// @brief Массив текстур, в котором хранится текстура
+    TextureArray* array = nullptr;
+
+    /// @brief Слой в массиве текстур
+    int layer = 0;
+
+    /// @brief Загружается ли текстура асинхронно
+    bool pending = false;
+
     /// @brief Ширина текстуры
     int width;
 
@@ -89,11 +346,44 @@ private:
     /// @brief Количество битов на пиксель
     int bpp;
 
+    /// @brief Объём в видеопамяти
+    size_t memorySize = 0;
+
+    /// @brief Самый детальный загруженный мип-уровень
+    int baseLevel = 0;
+
+    /// @brief Задана ли текстура сплошным цветом
+    bool solid = false;
+
+    /// @brief Сплошной цвет
+    float color[3] = {};
+
+    /// @brief Текстура 1x1 со сплошным цветом для шейдеров без переменных сплошного цвета
+    mutable Texture* colorTexture = nullptr;
+
+    /// @brief Текстура с тем же содержимым
+    Texture* source = nullptr;
+
+    /// @brief Получение текстуры, хранящей содержимое
+    /// @return source или эта текстура
+    const Texture& resolved() const { return source ? *source : *this; }
+
+    /// @brief Создание текстуры из готовых мип-уровней
+    /// @details Сжатые уровни, которые драйвер не поддерживает, распаковываются на CPU
+    /// @param format Формат пикселей
+    /// @param levels Мип-уровни
+    /// @param pixels Данные уровней
+    /// @return true на успех, false на неудачу
+    bool loadLevelsToGL(TextureFormat format, const std::vector<TextureLevel>& levels, const unsigned char* pixels);
+
     /// @brief Загрузка текстуры в OpenGL
-    /// @param rgbData Данные текстуры
+    /// @param data Данные текстуры, строки выровнены до 4 байт
+    /// @param format Формат данных
+    /// @param type Тип данных
+    /// @param topDown Хранятся ли строки сверху вниз
     /// @param minFilter Фильтрация при уменьшении
     /// @param magFilter Фильтрация при увеличении
-    void loadToGL(std::vector<unsigned char>& rgbData, int minFilter, int magFilter);
+    void loadToGL(const unsigned char* data, unsigned int format, unsigned int type, bool topDown, int minFilter, int magFilter);
 
     /// @brief Очистка текстуры
     void clear();
@@ -0,0 +1,114 @@
+#ifndef TEXTURE_ARRAY_H
+#define TEXTURE_ARRAY_H
+
+#include <cstddef>
+#include <vector>
+
+#include "Texture.h"
+
+namespace REngine {
+/// @brief Массив текстур одного размера и формата
+/// @details Каждая текстура занимает слой GL_TEXTURE_2D_ARRAY, поэтому объекты с разными
+/// текстурами из одного массива отрисовываются без смены привязки
+class TextureArray {
+public:
+    /// @brief Конструктор
+    /// @param format Формат пикселей, должен поддерживаться драйвером
+    /// @param width Ширина слоя в пикселях
+    /// @param height Высота слоя в пикселях
+    /// @param levelCount Количество мип-уровней
+    /// @param capacity Количество слоёв
+    TextureArray(TextureFormat format, int width, int height, int levelCount, int capacity);
+
+    /// @brief Деструктор
+    ~TextureArray();
+
+    TextureArray(const TextureArray&) = delete;
+    TextureArray& operator=(const TextureArray&) = delete;
+
+    /// @brief Выделение свободного слоя
+    /// @return Номер слоя или -1, если массив заполнен
+    int allocateLayer();
+
+    /// @brief Освобождение слоя
+    /// @param layer Номер слоя
+    void releaseLayer(int layer);
+
+    /// @brief Установка текстуры, занимающей слой
+    /// @param layer Номер выделенного слоя
+    /// @param texture Текстура, которая освобождает слой при удалении
+    void setOwner(int layer, Texture* texture);
+
+    /// @brief Получение текстуры, занимающей слой
+    /// @param layer Номер слоя
+    /// @return Текстура или nullptr, если слой свободен или ещё не передан текстуре
+    Texture* getOwner(int layer) const { return owners[layer]; }
+
+    /// @brief Передача мип-уровня слоя
+    /// @param layer Номер слоя
+    /// @param level Номер уровня
+    /// @param info Размеры уровня или передаваемой полосы строк
+    /// @param data Плотно упакованные данные уровня или смещение в буфере пикселей
+    /// @param y Первая строка полосы
+    void uploadLayer(int layer, int level, const TextureLevel& info, const void* data, int y = 0);
+
+    /// @brief Привязка массива к текущему текстурному блоку
+    void bind() const;
+
+    /// @brief Проверка, подходит ли массив для текстуры
+    /// @param format Формат пикселей
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @param levelCount Количество мип-уровней
+    /// @return true, если параметры совпадают
+    bool matches(TextureFormat format, int width, int height, int levelCount) const {
+        return this->format == format && this->width == width && this->height == height && this->levelCount == levelCount;
+    }
+
+    /// @brief Получение количества слоёв
+    /// @return Ёмкость массива
+    int getCapacity() const { return capacity; }
+
+    /// @brief Получение количества занятых слоёв
+    /// @return Количество слоёв
+    int getUsedLayers() const { return usedLayers; }
+
+    /// @brief Получение объёма массива в видеопамяти
+    /// @return Объём всех слоёв, включая свободные, в байтах
+    size_t getMemorySize() const { return getLayerSize(format, width, height, levelCount) * capacity; }
+
+    /// @brief Вычисление объёма слоя
+    /// @param format Формат пикселей
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @param levelCount Количество мип-уровней
+    /// @return Объём всех мип-уровней слоя в байтах
+    static size_t getLayerSize(TextureFormat format, int width, int height, int levelCount);
+
+    /// @brief Получение ID массива
+    /// @return ID текстуры OpenGL
+    unsigned int getID() const { return textureID; }
+
+private:
+    /// @brief ID текстуры
+    unsigned int textureID = 0;
+    /// @brief Формат пикселей
+    TextureFormat format;
+    /// @brief Ширина слоя
+    int width;
+    /// @brief Высота слоя
+    int height;
+    /// @brief Количество мип-уровней
+    int levelCount;
+    /// @brief Количество слоёв
+    int capacity;
+    /// @brief Количество занятых слоёв
+    int usedLayers = 0;
+    /// @brief Занятость слоёв
+    std::vector<bool> layers;
+    /// @brief Текстуры, занимающие слои
+    std::vector<Texture*> owners;
+};
+}
+
+#endif
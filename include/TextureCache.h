@@ -0,0 +1,84 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Texture.h"
+
+namespace REngine {
+/// @brief Ключ содержимого текстуры
+struct TextureContent {
+    /// @brief Хэш пикселей и параметров
+    uint64_t hash = 0;
+    /// @brief Независимый второй хэш тех же данных, чтобы совпадение одного хэша не объединяло разные текстуры
+    uint64_t check = 0;
+    /// @brief Объём пикселей всех уровней в байтах
+    size_t size = 0;
+
+    bool operator==(const TextureContent& other) const {
+        return hash == other.hash && check == other.check && size == other.size;
+    }
+};
+
+/// @brief Хэш ключа содержимого для unordered_map
+struct TextureContentHash {
+    size_t operator()(const TextureContent& content) const { return (size_t)content.hash; }
+};
+
+/// @brief Потокобезопасный кэш текстур по пути к файлу
+/// @details Поиск берёт разделяемую блокировку, поэтому потоки не мешают друг другу при чтении
+class TextureCache {
+public:
+    /// @brief Поиск текстуры
+    /// @param path Путь к файлу или название текстуры
+    /// @return Текстура или nullptr
+    static Texture* find(const std::string& path);
+
+    /// @brief Добавление текстуры
+    /// @param path Путь к файлу или название текстуры
+    /// @param texture Текстура, кэш становится её владельцем
+    /// @return Текстура из кэша: texture или ранее добавленная, тогда texture не сохраняется
+    static Texture* insert(const std::string& path, Texture* texture);
+
+    /// @brief Получение количества текстур
+    /// @return Количество текстур
+    static size_t size();
+
+    /// @brief Поиск текстуры по содержимому
+    /// @param content Ключ содержимого текстуры
+    /// @return Текстура из кэша или nullptr
+    static Texture* findContent(const TextureContent& content);
+
+    /// @brief Добавление текстуры с содержимым
+    /// @param content Ключ содержимого текстуры
+    /// @param texture Текстура из кэша
+    static void insertContent(const TextureContent& content, Texture* texture);
+
+    /// @brief Удаление содержимого текстуры из поиска
+    /// @details Вызывается, когда содержимое текстуры меняется или не будет загружено
+    /// @param texture Текстура из кэша
+    static void eraseContent(Texture* texture);
+
+    /// @brief Получение количества текстур с уникальным содержимым
+    /// @return Количество текстур
+    static size_t getContentCount();
+
+    /// @brief Удаление всех текстур
+    /// @note Вызывается в потоке с контекстом OpenGL
+    static void clear();
+
+private:
+    /// @brief Мьютекс кэша
+    static std::shared_mutex mutex;
+    /// @brief Текстуры по пути
+    static std::unordered_map<std::string, Texture*> textures;
+    /// @brief Текстуры по содержимому
+    static std::unordered_map<TextureContent, Texture*, TextureContentHash> contents;
+};
+}
+
+#endif
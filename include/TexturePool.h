@@ -0,0 +1,60 @@
+#ifndef TEXTURE_POOL_H
+#define TEXTURE_POOL_H
+
+#include <cstddef>
+#include <vector>
+
+#include "TextureArray.h"
+
+#define TEXTURE_POOL_INITIAL_LAYERS 4
+#define TEXTURE_POOL_ARRAY_BYTES (256 << 20)
+
+namespace REngine {
+/// @brief Класс для размещения текстур в слоях массивов
+/// @details Текстуры с одинаковыми размером, форматом и количеством мип-уровней попадают в один массив.
+/// Заполненный массив не растёт, следующий создаётся вдвое больше, пока не достигнет
+/// TEXTURE_POOL_ARRAY_BYTES или предела слоёв драйвера
+class TexturePool {
+public:
+    /// @brief Включение размещения текстур в массивах
+    /// @param enabled true, если шейдер умеет читать текстуры из массивов
+    /// @note Уже загруженные текстуры не переносятся
+    static void setEnabled(bool enabled) { TexturePool::enabled = enabled; }
+
+    /// @brief Проверка, размещаются ли текстуры в массивах
+    /// @return true, если размещение включено
+    static bool isEnabled() { return enabled; }
+
+    /// @brief Выделение слоя под текстуру
+    /// @param format Формат пикселей, должен поддерживаться драйвером
+    /// @param width Ширина в пикселях
+    /// @param height Высота в пикселях
+    /// @param levelCount Количество мип-уровней
+    /// @param array Результат, массив текстур
+    /// @param layer Результат, номер слоя
+    /// @return true на успех, false если размещение выключено
+    static bool acquire(TextureFormat format, int width, int height, int levelCount, TextureArray*& array, int& layer);
+
+    /// @brief Освобождение слоя, пустой массив удаляется
+    /// @param array Массив текстур, массивы, уже удалённые clear, пропускаются
+    /// @param layer Номер слоя
+    static void release(TextureArray* array, int layer);
+
+    /// @brief Получение количества массивов
+    /// @return Количество массивов
+    static size_t getArrayCount() { return arrays.size(); }
+
+    /// @brief Удаление всех массивов
+    /// @details Текстуры, ещё занимающие слои, отказываются от них и становятся пустыми
+    /// @note Вызывается в потоке с контекстом OpenGL
+    static void clear();
+
+private:
+    /// @brief Включено ли размещение
+    static bool enabled;
+    /// @brief Массивы текстур
+    static std::vector<TextureArray*> arrays;
+};
+}
+
+#endif
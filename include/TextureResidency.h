@@ -0,0 +1,143 @@
+#ifndef TEXTURE_RESIDENCY_H
+#define TEXTURE_RESIDENCY_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Texture.h"
+
+#define TEXTURE_RESIDENCY_BUDGET ((size_t)512 << 20)
+#define TEXTURE_RESIDENCY_LOW_MIP 32
+
+namespace REngine {
+/// @brief Класс для ограничения объёма текстур в видеопамяти
+/// @details При превышении бюджета давно не использованные текстуры заменяются уровнями
+/// не больше TEXTURE_RESIDENCY_LOW_MIP, полная версия загружается снова при следующем использовании.
+/// Из размера объектов на экране определяется самый детальный нужный уровень, более детальные не загружаются
+class TextureResidency {
+public:
+    /// @brief Установка бюджета видеопамяти
+    /// @param bytes Объём в байтах
+    static void setBudget(size_t bytes) { budget = bytes; }
+
+    /// @brief Получение бюджета видеопамяти
+    /// @return Объём в байтах
+    static size_t getBudget() { return budget; }
+
+    /// @brief Добавление загруженной из файла текстуры
+    /// @param texture Текстура из кэша
+    /// @param path Путь к файлу для повторной загрузки
+    static void track(Texture* texture, const std::string& path);
+
+    /// @brief Удаление текстуры из списка
+    /// @param texture Текстура, которая больше не загружается из файла
+    static void untrack(Texture* texture);
+
+    /// @brief Отметка использования текстуры в текущем кадре
+    /// @details Вытесненная текстура ставится в очередь на загрузку всех уровней
+    /// @param texture Текстура
+    /// @param texelSize Нужный размер текстуры в пикселях экрана на единицу UV, 0 если неизвестен
+    static void touch(Texture* texture, float texelSize = 0.0f);
+
+    /// @brief Вытеснение текстур сверх бюджета и загрузка недостающих уровней, вызывается раз в кадр после отрисовки
+    /// @note Текстуры, использованные в текущем кадре, не вытесняются
+    static void update();
+
+    /// @brief Получение нужного размера текстуры за прошлый кадр
+    /// @param texture Текстура
+    /// @return Пикселей экрана на единицу UV, 0 если текстура не использовалась или размер неизвестен
+    static float getRequiredSize(const Texture* texture);
+
+    /// @brief Получение самого детального нужного мип-уровня
+    /// @param texture Текстура
+    /// @param width Ширина нулевого уровня в пикселях
+    /// @param height Высота нулевого уровня в пикселях
+    /// @return Номер уровня, 0 если размер неизвестен
+    static int getRequiredLevel(const Texture* texture, int width, int height);
+
+    /// @brief Получение объёма отслеживаемых текстур
+    /// @details Массив текстур учитывается целиком вместе со свободными слоями
+    /// @return Объём в байтах
+    static size_t getResidentBytes();
+
+    /// @brief Получение количества отслеживаемых текстур
+    /// @return Количество текстур
+    static size_t getTrackedCount() { return entries.size(); }
+
+    /// @brief Получение количества вытесненных текстур в последнем кадре
+    /// @return Количество текстур
+    static unsigned int getFrameEvictions() { return frameEvictions; }
+
+    /// @brief Получение количества повторных загрузок в последнем кадре
+    /// @return Количество текстур
+    static unsigned int getFrameReloads() { return frameReloads; }
+
+    /// @brief Получение количества текстур, для которых в последнем кадре запрошены детальные уровни
+    /// @return Количество текстур
+    static unsigned int getFrameRefines() { return frameRefines; }
+
+    /// @brief Получение количества вытеснений за всё время
+    /// @return Количество вытеснений
+    static unsigned long long getEvictionCount() { return evictionCount; }
+
+    /// @brief Получение количества повторных загрузок за всё время
+    /// @return Количество загрузок
+    static unsigned long long getReloadCount() { return reloadCount; }
+
+    /// @brief Очистка списка текстур и счётчиков
+    /// @note Вызывается до удаления текстур из кэша
+    static void clear();
+
+private:
+    /// @brief Отслеживаемая текстура
+    struct Entry {
+        /// @brief Путь к файлу
+        std::string path;
+        /// @brief Кадр последнего использования
+        unsigned long lastUsed = 0;
+        /// @brief Загружены ли только мелкие уровни
+        bool reduced = false;
+        /// @brief Нужный размер в текущем кадре
+        float frameSize = 0.0f;
+        /// @brief Нужный размер в прошлом кадре
+        float requiredSize = 0.0f;
+    };
+
+    /// @brief Бюджет в байтах
+    static size_t budget;
+    /// @brief Номер текущего кадра
+    static unsigned long frame;
+    /// @brief Текстуры
+    static std::unordered_map<Texture*, Entry> entries;
+    /// @brief Кандидаты на вытеснение, хранятся между кадрами, чтобы не выделять память
+    static std::vector<std::pair<unsigned long, Texture*>> candidates;
+    /// @brief Массивы отслеживаемых текстур и количество их слоёв, хранятся между кадрами
+    static std::vector<std::pair<TextureArray*, int>> arrayLayers;
+    /// @brief Повторные загрузки с начала кадра
+    static unsigned int pendingReloads;
+    /// @brief Вытеснения в последнем кадре
+    static unsigned int frameEvictions;
+    /// @brief Повторные загрузки в последнем кадре
+    static unsigned int frameReloads;
+    /// @brief Загрузки детальных уровней в последнем кадре
+    static unsigned int frameRefines;
+    /// @brief Вытеснения за всё время
+    static unsigned long long evictionCount;
+    /// @brief Повторные загрузки за всё время
+    static unsigned long long reloadCount;
+
+    /// @brief Подсчёт объёма отслеживаемых текстур
+    /// @param excludeEvicting Не учитывать текстуры, вытеснение которых уже идёт
+    /// @return Объём в байтах, в arrayLayers остаются массивы и количество вытесняемых слоёв
+    static size_t countBytes(bool excludeEvicting);
+
+    /// @brief Поиск массива в arrayLayers
+    /// @param array Массив текстур
+    /// @return Массив и счётчик слоёв
+    static std::pair<TextureArray*, int>& findArray(TextureArray* array);
+};
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <cstddef>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "FrameSync.h"
+#include "Texture.h"
+
+#define TEXTURE_STREAMER_UPLOAD_BUDGET (4 << 20)
+#define TEXTURE_STREAMER_WORKERS_MAX 4
+
+namespace REngine {
+/// @brief Класс для асинхронной загрузки текстур
+/// @details Файлы читаются, декодируются и уменьшаются для мип-уровней в рабочих
+/// потоках. Готовые уровни передаются в OpenGL через буферы пикселей слотов кадров в update с
+/// ограничением объёма за кадр, от мелких уровней к детальным и только до нужного
+/// по размеру на экране. Уровень, не помещающийся в объём кадра, передаётся полосами
+/// строк в нескольких кадрах. До окончания загрузки вместо текстуры привязывается заглушка
+class TextureStreamer {
+public:
+    /// @brief Запуск рабочих потоков и создание заглушки
+    /// @param workers Количество потоков, 0 для выбора по количеству ядер
+    /// @note Вызывается в потоке с контекстом OpenGL
+    static void start(int workers = 0);
+
+    /// @brief Остановка рабочих потоков и удаление ресурсов OpenGL
+    /// @note Незагруженные текстуры остаются заглушками
+    static void stop();
+
+    /// @brief Проверка, запущены ли рабочие потоки
+    /// @return true, если загрузка асинхронная
+    static bool isRunning();
+
+    /// @brief Запрос текстуры
+    /// @param path Путь к файлу BMP или DDS, читается через VirtualFS
+    /// @param fallbackColor Цвет текстуры, если файл не удалось загрузить
+    /// @return Текстура из кэша, до окончания загрузки привязывается заглушка
+    /// @note Без запущенных потоков текстура загружается сразу
+    static Texture* request(const std::string& path, const glm::vec3& fallbackColor);
+
+    /// @brief Повторная загрузка текстуры из кэша
+    /// @details До окончания загрузки привязывается прежнее содержимое текстуры
+    /// @param texture Текстура, которая сейчас не загружается
+    /// @param path Путь к файлу
+    /// @param maxSize Наибольшая сторона нулевого уровня, крупные уровни пропускаются, 0 для всех уровней
+    /// @note Без запущенных потоков текстура загружается сразу
+    static void reload(Texture* texture, const std::string& path, int maxSize = 0);
+
+    /// @brief Загрузка недостающих детальных мип-уровней
+    /// @details Уровни передаются в уже созданную текстуру от мелких к детальным до нужного
+    /// по TextureResidency::getRequiredLevel, базовый уровень текстуры опускается после каждого
+    /// @param texture Загруженная текстура, которая сейчас не загружается
+    /// @param path Путь к файлу
+    /// @note Без запущенных потоков уровни загружаются сразу
+    static void refine(Texture* texture, const std::string& path);
+
+    /// @brief Передача готовых текстур в OpenGL, вызывается раз в кадр
+    /// @param frameSlot Слот кадра из FrameSync::getFrameSlot, барьер которого уже пройден, данные пишутся
+    /// в буфер пикселей слота без синхронизации. -1 для передачи из памяти без буфера пикселей
+    static void update(int frameSlot = -1);
+
+    /// @brief Ожидание загрузки всех запрошенных текстур
+    static void finish();
+
+    /// @brief Установка объёма передачи за кадр
+    /// @param bytes Объём в байтах, хотя бы одна строка пикселей или блоков передаётся всегда
+    static void setUploadBudget(size_t bytes);
+
+    /// @brief Получение количества незагруженных текстур
+    /// @return Количество текстур
+    static size_t getPendingCount();
+
+    /// @brief Получение объёма, переданного в последнем вызове update
+    /// @return Объём в байтах
+    static size_t getFrameUploadBytes();
+};
+}
+
+#endif
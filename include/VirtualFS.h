@@ -0,0 +1,134 @@
+#ifndef VIRTUAL_FS_H
+#define VIRTUAL_FS_H
+
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "PackArchive.h"
+
+namespace REngine {
+/// @brief Содержимое файла ресурса из архива или с диска
+/// @note Несжатый файл из архива читается из отображения архива и доступен, пока архив подключён
+class AssetFile {
+public:
+    /// @brief Конструктор по умолчанию
+    AssetFile() = default;
+
+    /// @brief Конструктор, открывающий файл через VirtualFS
+    /// @param path Путь к файлу
+    AssetFile(const std::string& path) { open(path); }
+
+    AssetFile(const AssetFile&) = delete;
+    AssetFile& operator=(const AssetFile&) = delete;
+
+    /// @brief Открытие файла через VirtualFS
+    /// @param path Путь к файлу
+    /// @return true на успех, false если файл не найден
+    bool open(const std::string& path);
+
+    /// @brief Закрытие файла
+    void close();
+
+    /// @brief Проверка, открыт ли файл
+    /// @return true, если содержимое доступно
+    bool isOpen() const { return bytes != nullptr; }
+
+    /// @brief Проверка, прочитан ли файл из архива
+    /// @return true для файла из архива, false для файла на диске
+    bool isPacked() const { return packed; }
+
+    /// @brief Получение содержимого файла
+    /// @return Указатель на начало файла
+    const unsigned char* data() const { return bytes; }
+
+    /// @brief Получение размера файла
+    /// @return Размер в байтах
+    size_t size() const { return length; }
+
+private:
+    friend class VirtualFS;
+
+    /// @brief Отображение файла с диска
+    MappedFile mapped;
+    /// @brief Распакованное содержимое сжатого файла из архива
+    std::vector<unsigned char> buffer;
+    /// @brief Содержимое файла
+    const unsigned char* bytes = nullptr;
+    /// @brief Размер файла
+    size_t length = 0;
+    /// @brief Прочитан ли файл из архива
+    bool packed = false;
+};
+
+/// @brief Класс для чтения ресурсов из архивов .rpak и с диска
+/// @details Файл сначала ищется в подключённых архивах, начиная с последнего, затем на диске.
+/// Каталоги поиска применяются в обоих случаях. Архивы подключаются и отключаются, пока ресурсы не загружаются
+class VirtualFS {
+public:
+    /// @brief Подключение архива
+    /// @param path Путь к файлу .rpak
+    /// @return true на успех, false если архив не найден или повреждён
+    static bool mount(const std::string& path);
+
+    /// @brief Отключение всех архивов
+    static void clear();
+
+    /// @brief Получение количества подключённых архивов
+    /// @return Количество архивов
+    static size_t getArchiveCount();
+
+    /// @brief Добавление каталога поиска файлов на диске
+    /// @param prefix Префикс пути с разделителем в конце, по умолчанию ищется в "", "textures/" и "../textures/"
+    static void addSearchPath(const std::string& prefix);
+
+    /// @brief Открытие файла
+    /// @param path Путь к файлу
+    /// @param file Результат
+    /// @return true на успех, false если файл не найден
+    static bool open(const std::string& path, AssetFile& file);
+
+    /// @brief Проверка существования файла
+    /// @param path Путь к файлу
+    /// @return true, если файл есть в архиве или на диске
+    static bool exists(const std::string& path);
+
+    /// @brief Проверка наличия файла в подключённых архивах
+    /// @details Диск не проверяется, поэтому без архивов проверка ничего не стоит
+    /// @param path Путь к файлу
+    /// @return true, если файл есть в архиве
+    static bool isPacked(const std::string& path);
+
+    /// @brief Проверка, что файл не старше исходного
+    /// @details Файлы из архива считаются подготовленными из актуальных исходников.
+    /// На диске файлы сравниваются в том каталоге поиска, где найден source
+    /// @param path Путь к производному файлу
+    /// @param source Путь к исходному файлу
+    /// @return true, если path существует и не старше source
+    static bool isNewer(const std::string& path, const std::string& source);
+
+private:
+    /// @brief Мьютекс для доступа к архивам и каталогам поиска
+    static std::shared_mutex mutex;
+    /// @brief Подключённые архивы
+    static std::vector<std::unique_ptr<PackArchive>> archives;
+    /// @brief Каталоги поиска файлов на диске
+    static std::vector<std::string> searchPaths;
+
+    /// @brief Поиск файла в архивах по каталогам поиска
+    /// @param path Путь к файлу, к нему добавляются префиксы каталогов поиска
+    /// @param archive Архив с файлом
+    /// @return Описание файла или nullptr
+    static const RPakEntry* findPacked(const std::string& path, const PackArchive*& archive);
+
+    /// @brief Проверка, задан ли путь от корня
+    /// @param path Путь к файлу
+    /// @return true, если каталоги поиска к пути не применяются
+    static bool isAbsolute(const std::string& path);
+};
+}
+
+#endif
@@ -0,0 +1,177 @@
+#include "AllocTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef RENGINE_ALLOC_TRACKING
+// Счётчики не должны сами выделять память, поэтому используются простые типы
+static std::atomic<unsigned long long> totalAllocations{0};
+static std::atomic<unsigned long long> totalFrees{0};
+static std::atomic<unsigned long long> totalBytes{0};
+static thread_local REngine::AllocStats threadStats;
+
+static void countAllocation(std::size_t size) {
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    totalBytes.fetch_add(size, std::memory_order_relaxed);
+    threadStats.allocations++;
+    threadStats.bytes += size;
+}
+
+static void countFree() {
+    totalFrees.fetch_add(1, std::memory_order_relaxed);
+    threadStats.frees++;
+}
+
+static void* trackedAlloc(std::size_t size) {
+    void* ptr = std::malloc(size ? size : 1);
+    if (ptr) {
+        countAllocation(size);
+    }
+    return ptr;
+}
+
+static void* trackedAlignedAlloc(std::size_t size, std::align_val_t alignment) {
+    std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    void* ptr = _aligned_malloc(size ? size : 1, align);
+#else
+    void* ptr = std::aligned_alloc(align, ((size ? size : 1) + align - 1) / align * align);
+#endif
+    if (ptr) {
+        countAllocation(size);
+    }
+    return ptr;
+}
+
+static void trackedFree(void* ptr) {
+    if (ptr) {
+        countFree();
+        std::free(ptr);
+    }
+}
+
+static void trackedAlignedFree(void* ptr) {
+    if (ptr) {
+        countFree();
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        std::free(ptr);
+#endif
+    }
+}
+
+void* operator new(std::size_t size) {
+    void* ptr = trackedAlloc(size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return trackedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return trackedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* ptr = trackedAlignedAlloc(size, alignment);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return trackedAlignedAlloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return trackedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    trackedAlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    trackedAlignedFree(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    trackedAlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    trackedAlignedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    trackedAlignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    trackedAlignedFree(ptr);
+}
+
+bool REngine::AllocTracker::isEnabled() {
+    return true;
+}
+
+REngine::AllocStats REngine::AllocTracker::getStats() {
+    return {totalAllocations.load(std::memory_order_relaxed), totalFrees.load(std::memory_order_relaxed),
+            totalBytes.load(std::memory_order_relaxed)};
+}
+
+REngine::AllocStats REngine::AllocTracker::getThreadStats() {
+    return threadStats;
+}
+#else
+bool REngine::AllocTracker::isEnabled() {
+    return false;
+}
+
+REngine::AllocStats REngine::AllocTracker::getStats() {
+    return AllocStats();
+}
+
+REngine::AllocStats REngine::AllocTracker::getThreadStats() {
+    return AllocStats();
+}
+#endif
@@ -0,0 +1,407 @@
+#include "AssetCooker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include "CookedMesh.h"
+#include "CookedTexture.h"
+#include "Logging.h"
+#include "Mesh.h"
+#include "PackArchive.h"
+
+enum class AssetKind { Texture, Shader, Mesh, Copy };
+
+struct CookJob {
+    std::string source;    // Путь к исходнику или описание примитива
+    std::string name;      // Путь внутри архива
+    AssetKind kind;
+    int slices = 0;        // Количество сегментов сферы
+    uint64_t key = 0;      // Хэш исходника и параметров подготовки
+    size_t sourceSize = 0;
+    std::string contents;  // Прочитанный исходник текстуры, декодируется без повторного чтения файла
+    REngine::PackFile file;
+    bool cached = false;
+    bool failed = false;
+    double milliseconds = 0.0;
+};
+
+static std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return text;
+}
+
+static const char* getKindName(AssetKind kind) {
+    switch (kind) {
+        case AssetKind::Texture:
+            return "texture";
+        case AssetKind::Shader:
+            return "shader";
+        case AssetKind::Mesh:
+            return "mesh";
+        default:
+            return "copy";
+    }
+}
+
+static bool readFile(const std::filesystem::path& path, std::string& text) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::ostringstream stream;
+    stream << file.rdbuf();
+    text = stream.str();
+    return true;
+}
+
+static uint64_t hashBytes(const void* data, size_t size, uint64_t hash) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// Первый символ кода в строке вне комментариев, состояние блочного комментария переносится между строками
+static size_t findCode(const std::string& line, bool& inComment) {
+    size_t code = std::string::npos;
+    for (size_t i = 0; i < line.size(); i++) {
+        if (inComment) {
+            if (line.compare(i, 2, "*/") == 0) {
+                inComment = false;
+                i++;
+            }
+        } else if (line.compare(i, 2, "/*") == 0) {
+            inComment = true;
+            i++;
+        } else if (line.compare(i, 2, "//") == 0) {
+            break;
+        } else if (code == std::string::npos && line[i] != ' ' && line[i] != '\t' && line[i] != '\r') {
+            code = i;
+        }
+    }
+    return code;
+}
+
+static bool expandFile(const std::filesystem::path& path, std::string& output, std::vector<std::string>& included) {
+    std::string canonical = std::filesystem::weakly_canonical(path).string();
+    if (std::find(included.begin(), included.end(), canonical) != included.end()) {
+        return true;
+    }
+    included.push_back(canonical);
+    std::string text;
+    if (!readFile(path, text)) {
+        ERROR("Failed to read " + path.string());
+        return false;
+    }
+    std::istringstream lines(text);
+    std::string line;
+    bool inComment = false;
+    while (std::getline(lines, line)) {
+        size_t start = findCode(line, inComment);
+        if (start != std::string::npos && line.compare(start, 8, "#include") == 0) {
+            size_t open = line.find('"', start);
+            size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+            if (close == std::string::npos) {
+                ERROR(path.string() + ": malformed #include");
+                return false;
+            }
+            if (!expandFile(path.parent_path() / line.substr(open + 1, close - open - 1), output, included)) {
+                return false;
+            }
+            continue;
+        }
+        output += line;
+        output += '\n';
+    }
+    return true;
+}
+
+static void cookTexture(CookJob& job, REngine::TextureFormat format, bool formatSet) {
+    std::vector<unsigned char> pixels;
+    int width, height, channels;
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(job.contents.data());
+    if (!REngine::Texture::decodeBMP(data, job.contents.size(), pixels, width, height, channels)) {
+        ERROR("Failed to decode BMP file: " + job.source);
+        job.failed = true;
+        return;
+    }
+    // По умолчанию BC1 для изображений без альфа-канала и BC3 для остальных
+    if (!formatSet) {
+        format = channels == 4 ? REngine::TextureFormat::BC3 : REngine::TextureFormat::BC1;
+    }
+    std::vector<unsigned char> rgba((size_t)width * height * 4);
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        for (int c = 0; c < 4; c++) {
+            rgba[i * 4 + c] = c < channels ? pixels[i * channels + c] : 255;
+        }
+    }
+    // Ресурсы уже распределены по потокам, поэтому каждая текстура сжимается в одном
+    REngine::CookedImage image;
+    REngine::CookedTexture::cook(format, rgba.data(), width, height, image, 1);
+    job.failed = !REngine::CookedTexture::serialize(image, job.file.data);
+}
+
+static void cookJob(CookJob& job, REngine::TextureFormat format, bool formatSet) {
+    switch (job.kind) {
+        case AssetKind::Texture:
+            cookTexture(job, format, formatSet);
+            break;
+        case AssetKind::Shader:
+        case AssetKind::Copy:
+            // Содержимое уже прочитано при вычислении ключа
+            break;
+        case AssetKind::Mesh: {
+            std::vector<float> vertices;
+            std::vector<unsigned> indices;
+            REngine::Mesh::tessellateSphere(job.slices, job.slices, vertices, indices);
+            REngine::CookedMesh::cook(vertices, indices, job.file.data);
+            break;
+        }
+    }
+}
+
+// Ключ ресурса: версия инструмента, формат текстур и содержимое исходника
+static bool computeKey(CookJob& job, uint64_t seed) {
+    uint64_t hash = hashBytes(&seed, sizeof(seed), 0xCBF29CE484222325ull);
+    hash = hashBytes(job.name.data(), job.name.size(), hash);
+    if (job.kind == AssetKind::Mesh) {
+        job.key = hashBytes(&job.slices, sizeof(job.slices), hash);
+        return true;
+    }
+    std::string text;
+    if (job.kind == AssetKind::Shader) {
+        if (!REngine::AssetCooker::expandIncludes(job.source, text)) {
+            return false;
+        }
+        // Результат зависит и от включённых файлов, поэтому хэшируется раскрытый текст
+        job.sourceSize = text.size();
+        text = REngine::AssetCooker::stripShader(text);
+    } else if (!readFile(job.source, text)) {
+        ERROR("Failed to read " + job.source);
+        return false;
+    } else {
+        job.sourceSize = text.size();
+    }
+    job.key = hashBytes(text.data(), text.size(), hash);
+    if (job.kind == AssetKind::Texture) {
+        job.contents = std::move(text);
+    } else {
+        job.file.data.assign(text.begin(), text.end());
+    }
+    return true;
+}
+
+static void collectJobs(const std::filesystem::path& root, const std::filesystem::path& output, std::vector<CookJob>& jobs) {
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator(root, error); it != std::filesystem::recursive_directory_iterator();
+         it.increment(error)) {
+        if (!it->is_regular_file(error) || std::filesystem::equivalent(it->path(), output, error)) {
+            continue;
+        }
+        CookJob job;
+        job.source = it->path().string();
+        job.name = REngine::PackArchive::normalizeName(std::filesystem::relative(it->path(), root, error).generic_string());
+        std::string extension = toLower(it->path().extension().string());
+        if (extension == ".bmp") {
+            job.kind = AssetKind::Texture;
+            // Движок ищет подготовленную текстуру рядом с исходником с расширением .rtex
+            job.name = job.name.substr(0, job.name.size() - extension.size()) + ".rtex";
+        } else if (extension == ".vert" || extension == ".frag" || extension == ".glsl") {
+            job.kind = AssetKind::Shader;
+            job.file.compress = true;
+        } else {
+            // DDS и RTEX уже в формате видеопамяти и читаются из архива без копирования
+            job.kind = AssetKind::Copy;
+            job.file.compress = extension != ".dds" && extension != ".rtex";
+        }
+        job.file.name = job.name;
+        jobs.push_back(std::move(job));
+    }
+}
+
+// Чтение прошлого манифеста: ключ, путь в архиве
+static void readManifest(const REngine::PackArchive& archive, std::map<std::string, uint64_t>& manifest) {
+    const REngine::RPakEntry* entry = archive.find(COOK_MANIFEST);
+    std::vector<unsigned char> buffer;
+    const unsigned char* data = entry ? archive.read(*entry, buffer) : nullptr;
+    if (!data) {
+        return;
+    }
+    std::istringstream lines(std::string(reinterpret_cast<const char*>(data), (size_t)entry->size));
+    std::string line;
+    while (std::getline(lines, line)) {
+        size_t tab = line.find('\t');
+        if (tab != std::string::npos) {
+            manifest[line.substr(tab + 1)] = std::strtoull(line.substr(0, tab).c_str(), nullptr, 16);
+        }
+    }
+}
+
+bool REngine::AssetCooker::cook(const std::string& source, const std::string& output, const CookOptions& options,
+                                std::vector<CookedAsset>& assets) {
+    std::vector<CookJob> jobs;
+    collectJobs(source, output, jobs);
+    std::vector<int> slices = options.slices;
+    std::sort(slices.begin(), slices.end());
+    slices.erase(std::unique(slices.begin(), slices.end()), slices.end());
+    for (int count : slices) {
+        CookJob job;
+        job.kind = AssetKind::Mesh;
+        job.slices = count;
+        job.name = Mesh::getSphereName(count, count);
+        job.source = "sphere " + std::to_string(count) + "x" + std::to_string(count);
+        job.file.name = job.name;
+        job.file.compress = true;
+        jobs.push_back(std::move(job));
+    }
+    std::stable_sort(jobs.begin(), jobs.end(), [](const CookJob& a, const CookJob& b) { return a.name < b.name; });
+    // Исходник BMP важнее уже подготовленного файла с тем же именем
+    for (size_t i = 1; i < jobs.size(); i++) {
+        if (jobs[i].name == jobs[i - 1].name) {
+            size_t kept = jobs[i].kind == AssetKind::Texture ? i : i - 1;
+            size_t skipped = kept == i ? i - 1 : i;
+            WARN("Skipping " << jobs[skipped].source << ": " << jobs[kept].name << " is cooked from " << jobs[kept].source);
+            jobs.erase(jobs.begin() + skipped);
+            i--;
+        }
+    }
+
+    PackArchive previous;
+    std::map<std::string, uint64_t> manifest;
+    if (previous.open(output)) {
+        readManifest(previous, manifest);
+    }
+
+    uint64_t seed = ((uint64_t)COOK_VERSION << 32) | (options.formatSet ? (uint64_t)options.format + 1 : 0);
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    auto worker = [&]() {
+        std::vector<unsigned char> buffer;
+        for (size_t i = next++; i < jobs.size(); i = next++) {
+            CookJob& job = jobs[i];
+            auto jobStart = std::chrono::steady_clock::now();
+            if (!computeKey(job, seed)) {
+                job.failed = true;
+            } else {
+                auto it = manifest.find(job.name);
+                const RPakEntry* entry = it != manifest.end() && it->second == job.key ? previous.find(job.name) : nullptr;
+                const unsigned char* data = entry ? previous.read(*entry, buffer) : nullptr;
+                if (data) {
+                    job.file.data.assign(data, data + entry->size);
+                    job.cached = true;
+                } else {
+                    cookJob(job, options.format, options.formatSet);
+                }
+            }
+            job.contents = std::string();
+            job.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - jobStart).count();
+            if (job.failed) {
+                ERROR("Failed to cook " + job.source);
+                failed = true;
+            }
+        }
+    };
+    int threads = options.threads > 0 ? options.threads : (int)std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for (int i = 0; i < std::min(threads, (int)jobs.size()); i++) {
+        workers.emplace_back(worker);
+    }
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    previous.close();
+    if (failed) {
+        return false;
+    }
+
+    std::vector<PackFile> files;
+    std::ostringstream manifestText;
+    assets.clear();
+    for (CookJob& job : jobs) {
+        assets.push_back({job.name, getKindName(job.kind), job.sourceSize, job.file.data.size(), job.milliseconds, job.cached});
+        manifestText << std::hex << job.key << '\t' << job.name << '\n';
+        files.push_back(std::move(job.file));
+    }
+    std::string manifestData = manifestText.str();
+    files.push_back({COOK_MANIFEST, std::vector<unsigned char>(manifestData.begin(), manifestData.end()), true});
+
+    // Запись во временный файл, чтобы прерванная подготовка не портила прошлый архив
+    std::string temporary = output + ".tmp";
+    std::error_code error;
+    bool saved = PackArchive::save(temporary, files);
+    if (saved) {
+        std::filesystem::rename(temporary, output, error);
+        saved = !error;
+    }
+    if (!saved) {
+        ERROR("Failed to write " + output);
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+bool REngine::AssetCooker::expandIncludes(const std::string& path, std::string& output) {
+    std::vector<std::string> included;
+    return expandFile(path, output, included);
+}
+
+std::string REngine::AssetCooker::stripShader(const std::string& source) {
+    std::string code;
+    code.reserve(source.size());
+    for (size_t i = 0; i < source.size(); i++) {
+        if (source.compare(i, 2, "//") == 0) {
+            while (i < source.size() && source[i] != '\n') {
+                i++;
+            }
+        } else if (source.compare(i, 2, "/*") == 0) {
+            size_t end = source.find("*/", i + 2);
+            i = end == std::string::npos ? source.size() : end + 1;
+            code += ' ';
+            continue;
+        }
+        if (i < source.size() && source[i] != '\r') {
+            code += source[i];
+        }
+    }
+
+    std::string output;
+    std::istringstream lines(code);
+    std::string line;
+    while (std::getline(lines, line)) {
+        size_t end = line.find_last_not_of(" \t");
+        if (end != std::string::npos) {
+            output.append(line, 0, end + 1);
+            output += '\n';
+        }
+    }
+    return output;
+}
+
+bool REngine::AssetCooker::parseSlices(const std::string& text, std::vector<int>& slices) {
+    std::istringstream items(text);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        int first = 0, last = 0;
+        size_t dash = item.find('-');
+        first = std::atoi(item.substr(0, dash).c_str());
+        last = dash == std::string::npos ? first : std::atoi(item.substr(dash + 1).c_str());
+        if (first < 3 || last < first || last > 1024) {
+            return false;
+        }
+        for (int i = first; i <= last; i++) {
+            slices.push_back(i);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,656 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+#define DDS_MAGIC 0x20534444
+#define DDS_HEADER_SIZE 124
+#define DDS_PIXELFORMAT_SIZE 32
+#define DDS_FOURCC(A, B, C, D) ((uint32_t)(A) | ((uint32_t)(B) << 8) | ((uint32_t)(C) << 16) | ((uint32_t)(D) << 24))
+#define DXGI_FORMAT_BC1_UNORM 71
+#define DXGI_FORMAT_BC3_UNORM 77
+#define DXGI_FORMAT_BC7_UNORM 98
+
+// Веса интерполяции BC7 для 4-битных индексов
+static const int bc7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+/// @brief Запись битов в блок BC7 начиная с младшего
+struct BitWriter {
+    unsigned char* data;
+    int position = 0;
+
+    void write(uint32_t value, int bits) {
+        for (int i = 0; i < bits; i++, position++) {
+            data[position / 8] |= ((value >> i) & 1) << (position % 8);
+        }
+    }
+};
+
+/// @brief Чтение битов из блока BC7 начиная с младшего
+struct BitReader {
+    const unsigned char* data;
+    int position = 0;
+
+    uint32_t read(int bits) {
+        uint32_t value = 0;
+        for (int i = 0; i < bits; i++, position++) {
+            value |= ((data[position / 8] >> (position % 8)) & 1) << i;
+        }
+        return value;
+    }
+};
+
+// Главная ось облака точек степенным методом
+template <int N>
+static void principalAxis(const float (*points)[4], int count, float* mean, float* axis) {
+    for (int c = 0; c < N; c++) {
+        mean[c] = 0.0f;
+        for (int i = 0; i < count; i++) {
+            mean[c] += points[i][c];
+        }
+        mean[c] /= count;
+    }
+
+    float covariance[N][N] = {};
+    for (int i = 0; i < count; i++) {
+        for (int a = 0; a < N; a++) {
+            for (int b = 0; b < N; b++) {
+                covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+            }
+        }
+    }
+
+    for (int c = 0; c < N; c++) {
+        axis[c] = 1.0f;
+    }
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[N] = {};
+        float length = 0.0f;
+        for (int a = 0; a < N; a++) {
+            for (int b = 0; b < N; b++) {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length = std::max(length, std::fabs(next[a]));
+        }
+        if (length < 1e-6f) {
+            break;
+        }
+        for (int c = 0; c < N; c++) {
+            axis[c] = next[c] / length;
+        }
+    }
+}
+
+// Конечные точки по крайним проекциям на главную ось
+template <int N>
+static void axisEndpoints(const float (*points)[4], int count, float* start, float* end) {
+    float mean[N], axis[N];
+    principalAxis<N>(points, count, mean, axis);
+    float minT = std::numeric_limits<float>::max(), maxT = -minT;
+    for (int i = 0; i < count; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < N; c++) {
+            t += (points[i][c] - mean[c]) * axis[c];
+        }
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    float axisLength = 0.0f;
+    for (int c = 0; c < N; c++) {
+        axisLength += axis[c] * axis[c];
+    }
+    if (axisLength > 0.0f) {
+        minT /= axisLength;
+        maxT /= axisLength;
+    }
+    for (int c = 0; c < N; c++) {
+        start[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+        end[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+    }
+}
+
+// Уточнение конечных точек методом наименьших квадратов при известных весах
+template <int N>
+static bool leastSquaresEndpoints(const float (*points)[4], const float* weights, int count, float* start, float* end) {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[N] = {}, bx[N] = {};
+    for (int i = 0; i < count; i++) {
+        float a = weights[i], b = 1.0f - weights[i];
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < N; c++) {
+            ax[c] += a * points[i][c];
+            bx[c] += b * points[i][c];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f) {
+        return false;
+    }
+    for (int c = 0; c < N; c++) {
+        start[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+        end[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+static uint16_t packRGB565(const float* color) {
+    int r = (int)std::lround(color[0] * 31.0f / 255.0f);
+    int g = (int)std::lround(color[1] * 63.0f / 255.0f);
+    int b = (int)std::lround(color[2] * 31.0f / 255.0f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void unpackRGB565(uint16_t color, int* rgb) {
+    int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Палитра цветового блока BC1/BC3
+static void colorPalette(uint16_t color0, uint16_t color1, bool fourColors, int (*palette)[4]) {
+    unpackRGB565(color0, palette[0]);
+    unpackRGB565(color1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        if (fourColors) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    palette[0][3] = palette[1][3] = palette[2][3] = 255;
+    palette[3][3] = fourColors ? 255 : 0;
+}
+
+// Выбор индексов цветового блока, возвращает суммарную ошибку
+static int colorIndices(const float (*points)[4], uint16_t color0, uint16_t color1, uint32_t& indices) {
+    int palette[4][4];
+    colorPalette(color0, color1, true, palette);
+    int total = 0;
+    indices = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 0, bestError = std::numeric_limits<int>::max();
+        for (int p = 0; p < 4; p++) {
+            int error = 0;
+            for (int c = 0; c < 3; c++) {
+                int d = (int)points[i][c] - palette[p][c];
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                best = p;
+            }
+        }
+        indices |= (uint32_t)best << (i * 2);
+        total += bestError;
+    }
+    return total;
+}
+
+// Кодирование цветового блока в режиме четырёх цветов
+static void encodeColorBlock(const float (*points)[4], unsigned char* block) {
+    float start[3], end[3];
+    axisEndpoints<3>(points, 16, start, end);
+    uint16_t color0 = packRGB565(start), color1 = packRGB565(end);
+    uint32_t indices;
+    int error = colorIndices(points, color0, color1, indices);
+
+    // Веса палитры для индексов 0..3
+    static const float paletteWeights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    float weights[16];
+    for (int i = 0; i < 16; i++) {
+        weights[i] = paletteWeights[(indices >> (i * 2)) & 3];
+    }
+    if (leastSquaresEndpoints<3>(points, weights, 16, start, end)) {
+        uint16_t refined0 = packRGB565(start), refined1 = packRGB565(end);
+        uint32_t refinedIndices;
+        int refinedError = colorIndices(points, refined0, refined1, refinedIndices);
+        if (refinedError < error) {
+            color0 = refined0;
+            color1 = refined1;
+            indices = refinedIndices;
+        }
+    }
+
+    if (color0 < color1) {
+        // Режим четырёх цветов требует color0 > color1: концы меняются, индексы 0<->1 и 2<->3
+        std::swap(color0, color1);
+        indices ^= 0x55555555;
+    } else if (color0 == color1) {
+        indices = 0;
+    }
+
+    std::memcpy(block, &color0, 2);
+    std::memcpy(block + 2, &color1, 2);
+    std::memcpy(block + 4, &indices, 4);
+}
+
+// Кодирование блока альфа-канала BC3 с восемью уровнями
+static void encodeAlphaBlock(const unsigned char* rgba, unsigned char* block) {
+    int alpha0 = 0, alpha1 = 255;
+    for (int i = 0; i < 16; i++) {
+        alpha0 = std::max(alpha0, (int)rgba[i * 4 + 3]);
+        alpha1 = std::min(alpha1, (int)rgba[i * 4 + 3]);
+    }
+    block[0] = (unsigned char)alpha0;
+    block[1] = (unsigned char)alpha1;
+
+    uint64_t indices = 0;
+    if (alpha0 != alpha1) {
+        int palette[8] = {alpha0, alpha1};
+        for (int i = 1; i < 7; i++) {
+            palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+        }
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            for (int p = 1; p < 8; p++) {
+                if (std::abs(palette[p] - rgba[i * 4 + 3]) < std::abs(palette[best] - rgba[i * 4 + 3])) {
+                    best = p;
+                }
+            }
+            indices |= (uint64_t)best << (i * 3);
+        }
+    }
+    for (int i = 0; i < 6; i++) {
+        block[2 + i] = (unsigned char)(indices >> (i * 8));
+    }
+}
+
+// Квантование конечной точки BC7 режима 6 до 7 бит при заданном младшем бите
+static void quantizeBC7Endpoint(const float* value, int pbit, int* quantized) {
+    for (int c = 0; c < 4; c++) {
+        quantized[c] = std::clamp((int)std::lround((value[c] - pbit) / 2.0f), 0, 127);
+    }
+}
+
+/// @brief Конечные точки и индексы блока BC7 режима 6
+struct BC7Mode6 {
+    int endpoints[2][4];
+    int pbits[2];
+    int indices[16];
+    int error;
+};
+
+static void evaluateBC7(const float (*points)[4], BC7Mode6& mode) {
+    int palette[16][4];
+    for (int c = 0; c < 4; c++) {
+        int e0 = (mode.endpoints[0][c] << 1) | mode.pbits[0];
+        int e1 = (mode.endpoints[1][c] << 1) | mode.pbits[1];
+        for (int i = 0; i < 16; i++) {
+            palette[i][c] = ((64 - bc7Weights[i]) * e0 + bc7Weights[i] * e1 + 32) >> 6;
+        }
+    }
+
+    mode.error = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 0, bestError = std::numeric_limits<int>::max();
+        for (int p = 0; p < 16; p++) {
+            int error = 0;
+            for (int c = 0; c < 4; c++) {
+                int d = (int)points[i][c] - palette[p][c];
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                best = p;
+            }
+        }
+        mode.indices[i] = best;
+        mode.error += bestError;
+    }
+}
+
+// Перебор младших битов обеих конечных точек: разные биты дают точные нечётные и чётные значения
+static void fitBC7(const float (*points)[4], const float* start, const float* end, BC7Mode6& mode) {
+    mode.error = std::numeric_limits<int>::max();
+    for (int pbits = 0; pbits < 4; pbits++) {
+        BC7Mode6 candidate;
+        candidate.pbits[0] = pbits & 1;
+        candidate.pbits[1] = pbits >> 1;
+        quantizeBC7Endpoint(start, candidate.pbits[0], candidate.endpoints[0]);
+        quantizeBC7Endpoint(end, candidate.pbits[1], candidate.endpoints[1]);
+        evaluateBC7(points, candidate);
+        if (candidate.error < mode.error) {
+            mode = candidate;
+        }
+    }
+}
+
+static void encodeBC7Block(const float (*points)[4], unsigned char* block) {
+    float start[4], end[4];
+    axisEndpoints<4>(points, 16, start, end);
+    BC7Mode6 mode;
+    fitBC7(points, start, end, mode);
+
+    float weights[16];
+    for (int i = 0; i < 16; i++) {
+        weights[i] = 1.0f - bc7Weights[mode.indices[i]] / 64.0f;
+    }
+    if (leastSquaresEndpoints<4>(points, weights, 16, start, end)) {
+        BC7Mode6 refined;
+        fitBC7(points, start, end, refined);
+        if (refined.error < mode.error) {
+            mode = refined;
+        }
+    }
+
+    // Старший бит индекса первого пикселя не хранится и должен быть нулевым
+    if (mode.indices[0] & 8) {
+        std::swap(mode.endpoints[0], mode.endpoints[1]);
+        std::swap(mode.pbits[0], mode.pbits[1]);
+        for (int& index : mode.indices) {
+            index = 15 - index;
+        }
+    }
+
+    std::memset(block, 0, 16);
+    BitWriter writer{block};
+    writer.write(1 << 6, 7);
+    for (int c = 0; c < 4; c++) {
+        writer.write(mode.endpoints[0][c], 7);
+        writer.write(mode.endpoints[1][c], 7);
+    }
+    writer.write(mode.pbits[0], 1);
+    writer.write(mode.pbits[1], 1);
+    writer.write(mode.indices[0], 3);
+    for (int i = 1; i < 16; i++) {
+        writer.write(mode.indices[i], 4);
+    }
+}
+
+static bool decodeBC7Block(const unsigned char* block, unsigned char* rgba) {
+    if ((block[0] & 0x7F) != 0x40) {
+        return false;
+    }
+    BitReader reader{block};
+    reader.read(7);
+    int endpoints[2][4];
+    for (int c = 0; c < 4; c++) {
+        endpoints[0][c] = reader.read(7) << 1;
+        endpoints[1][c] = reader.read(7) << 1;
+    }
+    int pbit0 = reader.read(1), pbit1 = reader.read(1);
+    for (int c = 0; c < 4; c++) {
+        endpoints[0][c] |= pbit0;
+        endpoints[1][c] |= pbit1;
+    }
+    for (int i = 0; i < 16; i++) {
+        int weight = bc7Weights[reader.read(i == 0 ? 3 : 4)];
+        for (int c = 0; c < 4; c++) {
+            rgba[i * 4 + c] = (unsigned char)(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+        }
+    }
+    return true;
+}
+
+const char* REngine::BlockCompressor::getFormatName(BlockFormat format) {
+    switch (format) {
+        case BlockFormat::BC1:
+            return "BC1";
+        case BlockFormat::BC3:
+            return "BC3";
+        case BlockFormat::BC7:
+            return "BC7";
+    }
+    return "unknown";
+}
+
+void REngine::BlockCompressor::encodeBlock(BlockFormat format, const unsigned char* rgba, unsigned char* block) {
+    float points[16][4];
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            points[i][c] = rgba[i * 4 + c];
+        }
+    }
+
+    switch (format) {
+        case BlockFormat::BC1:
+            encodeColorBlock(points, block);
+            break;
+        case BlockFormat::BC3:
+            encodeAlphaBlock(rgba, block);
+            encodeColorBlock(points, block + 8);
+            break;
+        case BlockFormat::BC7:
+            encodeBC7Block(points, block);
+            break;
+    }
+}
+
+bool REngine::BlockCompressor::decodeBlock(BlockFormat format, const unsigned char* block, unsigned char* rgba) {
+    if (format == BlockFormat::BC7) {
+        return decodeBC7Block(block, rgba);
+    }
+
+    const unsigned char* colorBlock = format == BlockFormat::BC3 ? block + 8 : block;
+    uint16_t color0, color1;
+    uint32_t indices;
+    std::memcpy(&color0, colorBlock, 2);
+    std::memcpy(&color1, colorBlock + 2, 2);
+    std::memcpy(&indices, colorBlock + 4, 4);
+
+    int palette[4][4];
+    colorPalette(color0, color1, format == BlockFormat::BC3 || color0 > color1, palette);
+    for (int i = 0; i < 16; i++) {
+        const int* color = palette[(indices >> (i * 2)) & 3];
+        for (int c = 0; c < 4; c++) {
+            rgba[i * 4 + c] = (unsigned char)color[c];
+        }
+    }
+
+    if (format == BlockFormat::BC3) {
+        int alpha0 = block[0], alpha1 = block[1];
+        int palette[8] = {alpha0, alpha1};
+        for (int i = 1; i < 7; i++) {
+            palette[i + 1] = alpha0 > alpha1 ? ((7 - i) * alpha0 + i * alpha1) / 7
+                                             : (i < 5 ? ((5 - i) * alpha0 + i * alpha1) / 5 : (i == 5 ? 0 : 255));
+        }
+        uint64_t alphaIndices = 0;
+        for (int i = 0; i < 6; i++) {
+            alphaIndices |= (uint64_t)block[2 + i] << (i * 8);
+        }
+        for (int i = 0; i < 16; i++) {
+            rgba[i * 4 + 3] = (unsigned char)palette[(alphaIndices >> (i * 3)) & 7];
+        }
+    }
+    return true;
+}
+
+void REngine::BlockCompressor::compress(BlockFormat format, const unsigned char* rgba, int width, int height,
+                                        unsigned char* blocks, int threads) {
+    int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    size_t blockSize = getBlockSize(format);
+    if (threads <= 0) {
+        threads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, blocksY);
+
+    // Потоки берут строки блоков по очереди
+    std::atomic<int> nextRow{0};
+    auto worker = [&]() {
+        unsigned char pixels[64];
+        for (int by = nextRow++; by < blocksY; by = nextRow++) {
+            for (int bx = 0; bx < blocksX; bx++) {
+                // Блоки на краю дополняются повтором крайних пикселей
+                for (int y = 0; y < 4; y++) {
+                    int sy = std::min(by * 4 + y, height - 1);
+                    for (int x = 0; x < 4; x++) {
+                        int sx = std::min(bx * 4 + x, width - 1);
+                        std::memcpy(pixels + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+                    }
+                }
+                encodeBlock(format, pixels, blocks + ((size_t)by * blocksX + bx) * blockSize);
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+}
+
+bool REngine::BlockCompressor::decompress(BlockFormat format, const unsigned char* blocks, int width, int height,
+                                          std::vector<unsigned char>& rgba) {
+    int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    size_t blockSize = getBlockSize(format);
+    rgba.resize((size_t)width * height * 4);
+
+    unsigned char pixels[64];
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            if (!decodeBlock(format, blocks + ((size_t)by * blocksX + bx) * blockSize, pixels)) {
+                return false;
+            }
+            for (int y = 0; y < 4 && by * 4 + y < height; y++) {
+                for (int x = 0; x < 4 && bx * 4 + x < width; x++) {
+                    std::memcpy(&rgba[((size_t)(by * 4 + y) * width + bx * 4 + x) * 4], pixels + (y * 4 + x) * 4, 4);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void REngine::BlockCompressor::compressMipChain(BlockFormat format, const unsigned char* rgba, int width, int height,
+                                                CompressedImage& image, int threads) {
+    std::vector<unsigned char> pixels(rgba, rgba + (size_t)width * height * 4);
+    std::vector<TextureLevel> sourceLevels;
+    Texture::buildMipChain(pixels, width, height, 4, sourceLevels);
+
+    image.format = format;
+    image.levels.clear();
+    size_t offset = 0;
+    for (const TextureLevel& level : sourceLevels) {
+        size_t size = getImageSize(format, level.width, level.height);
+        image.levels.push_back({level.width, level.height, offset, size});
+        offset += size;
+    }
+    image.data.assign(offset, 0);
+
+    for (size_t i = 0; i < sourceLevels.size(); i++) {
+        const TextureLevel& level = sourceLevels[i];
+        compress(format, pixels.data() + level.offset, level.width, level.height,
+                 image.data.data() + image.levels[i].offset, threads);
+    }
+}
+
+double REngine::BlockCompressor::computePSNR(const unsigned char* a, const unsigned char* b, size_t size, int stride, int channels) {
+    double squaredError = 0.0;
+    size_t samples = 0;
+    for (size_t i = 0; i + stride <= size; i += stride) {
+        for (int c = 0; c < channels; c++) {
+            double d = (double)a[i + c] - b[i + c];
+            squaredError += d * d;
+        }
+        samples += channels;
+    }
+    if (samples == 0 || squaredError == 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return 10.0 * std::log10(255.0 * 255.0 / (squaredError / samples));
+}
+
+bool REngine::BlockCompressor::saveDDS(const std::string& path, const CompressedImage& image) {
+    if (image.levels.empty()) {
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    uint32_t fourCC = image.format == BlockFormat::BC1 ? DDS_FOURCC('D', 'X', 'T', '1')
+                    : image.format == BlockFormat::BC3 ? DDS_FOURCC('D', 'X', 'T', '5')
+                                                       : DDS_FOURCC('D', 'X', '1', '0');
+    uint32_t header[1 + DDS_HEADER_SIZE / 4] = {};
+    header[0] = DDS_MAGIC;
+    header[1] = DDS_HEADER_SIZE;
+    header[2] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;  // CAPS, HEIGHT, WIDTH, PIXELFORMAT, MIPMAPCOUNT, LINEARSIZE
+    header[3] = image.levels[0].height;
+    header[4] = image.levels[0].width;
+    header[5] = (uint32_t)image.levels[0].size;
+    header[7] = (uint32_t)image.levels.size();
+    header[19] = DDS_PIXELFORMAT_SIZE;
+    header[20] = 0x4;  // DDPF_FOURCC
+    header[21] = fourCC;
+    header[27] = 0x1000 | 0x400000 | 0x8;  // TEXTURE, MIPMAP, COMPLEX
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    if (image.format == BlockFormat::BC7) {
+        // Заголовок DX10: формат, двумерная текстура, один слой
+        uint32_t dx10[5] = {DXGI_FORMAT_BC7_UNORM, 3, 0, 1, 0};
+        file.write(reinterpret_cast<const char*>(dx10), sizeof(dx10));
+    }
+    file.write(reinterpret_cast<const char*>(image.data.data()), image.data.size());
+    return !file.fail();
+}
+
+bool REngine::BlockCompressor::parseDDS(const unsigned char* data, size_t size, CompressedImage& image,
+                                        const unsigned char*& pixels) {
+    uint32_t header[1 + DDS_HEADER_SIZE / 4];
+    if (size < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(header, data, sizeof(header));
+    if (header[0] != DDS_MAGIC || header[1] != DDS_HEADER_SIZE || !(header[20] & 0x4)) {
+        return false;
+    }
+
+    size_t offset = sizeof(header);
+    uint32_t fourCC = header[21];
+    uint32_t dxgiFormat = 0;
+    if (fourCC == DDS_FOURCC('D', 'X', '1', '0')) {
+        if (size < offset + 20) {
+            return false;
+        }
+        std::memcpy(&dxgiFormat, data + offset, 4);
+        offset += 20;
+    }
+
+    if (fourCC == DDS_FOURCC('D', 'X', 'T', '1') || dxgiFormat == DXGI_FORMAT_BC1_UNORM) {
+        image.format = BlockFormat::BC1;
+    } else if (fourCC == DDS_FOURCC('D', 'X', 'T', '5') || dxgiFormat == DXGI_FORMAT_BC3_UNORM) {
+        image.format = BlockFormat::BC3;
+    } else if (dxgiFormat == DXGI_FORMAT_BC7_UNORM) {
+        image.format = BlockFormat::BC7;
+    } else {
+        return false;
+    }
+
+    int width = (int)header[4], height = (int)header[3];
+    int levelCount = std::max(1, (int)header[7]);
+    if (width <= 0 || height <= 0 || levelCount > 32) {
+        return false;
+    }
+
+    image.levels.clear();
+    size_t levelOffset = 0;
+    for (int i = 0; i < levelCount; i++) {
+        int levelWidth = std::max(1, width >> i), levelHeight = std::max(1, height >> i);
+        size_t levelSize = getImageSize(image.format, levelWidth, levelHeight);
+        image.levels.push_back({levelWidth, levelHeight, levelOffset, levelSize});
+        levelOffset += levelSize;
+    }
+    if (size - offset < levelOffset) {
+        return false;
+    }
+
+    image.data.clear();
+    pixels = data + offset;
+    return true;
+}
@@ -0,0 +1,116 @@
+#include "CameraPath.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "Logging.h"
+
+template <typename T>
+static T catmullRom(const T& p0, const T& p1, const T& p2, const T& p3, float t) {
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                   (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+bool REngine::CameraPath::loadFromFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        ERROR("Failed to open camera path: " + path);
+        return false;
+    }
+
+    keyframes.clear();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+
+        std::istringstream stream(line);
+        CameraKeyframe keyframe;
+        if (!(stream >> keyframe.time >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z >>
+              keyframe.pitch >> keyframe.yaw)) {
+            ERROR("Invalid camera keyframe at " << path << ":" << lineNumber);
+            keyframes.clear();
+            return false;
+        }
+        if (!addKeyframe(keyframe)) {
+            keyframes.clear();
+            return false;
+        }
+    }
+
+    if (keyframes.empty()) {
+        ERROR("Camera path has no keyframes: " + path);
+        return false;
+    }
+
+    DEBUG("Loaded camera path " << path << " with " << keyframes.size() << " keyframes, " << getDuration() << " s");
+    return true;
+}
+
+bool REngine::CameraPath::addKeyframe(const CameraKeyframe& keyframe) {
+    if (!keyframes.empty() && keyframe.time <= keyframes.back().time) {
+        ERROR("Camera keyframe time " << keyframe.time << " is not after " << keyframes.back().time);
+        return false;
+    }
+
+    CameraKeyframe added = keyframe;
+    if (!keyframes.empty()) {
+        // Поворот разворачивается, чтобы камера шла по кратчайшей дуге
+        float previous = keyframes.back().yaw;
+        while (added.yaw - previous > 180.0f) {
+            added.yaw -= 360.0f;
+        }
+        while (added.yaw - previous < -180.0f) {
+            added.yaw += 360.0f;
+        }
+    }
+    keyframes.push_back(added);
+    return true;
+}
+
+REngine::CameraKeyframe REngine::CameraPath::sample(float time) const {
+    if (keyframes.empty()) {
+        return CameraKeyframe();
+    }
+    if (time <= keyframes.front().time) {
+        CameraKeyframe result = keyframes.front();
+        result.time = time;
+        return result;
+    }
+    if (time >= keyframes.back().time) {
+        CameraKeyframe result = keyframes.back();
+        result.time = time;
+        return result;
+    }
+
+    size_t i = 1;
+    while (keyframes[i].time < time) {
+        i++;
+    }
+
+    // Крайние сегменты используют повторённые ключевые кадры
+    const CameraKeyframe& k0 = keyframes[i > 1 ? i - 2 : 0];
+    const CameraKeyframe& k1 = keyframes[i - 1];
+    const CameraKeyframe& k2 = keyframes[i];
+    const CameraKeyframe& k3 = keyframes[i + 1 < keyframes.size() ? i + 1 : i];
+    float t = (time - k1.time) / (k2.time - k1.time);
+
+    CameraKeyframe result;
+    result.time = time;
+    result.position = catmullRom(k0.position, k1.position, k2.position, k3.position, t);
+    result.pitch = glm::clamp(catmullRom(k0.pitch, k1.pitch, k2.pitch, k3.pitch, t), -89.0f, 89.0f);
+    result.yaw = catmullRom(k0.yaw, k1.yaw, k2.yaw, k3.yaw, t);
+    return result;
+}
+
+void REngine::CameraPath::apply(Camera& camera, float time) const {
+    CameraKeyframe keyframe = sample(time);
+    camera.position = keyframe.position;
+    camera.setRotation(keyframe.pitch, keyframe.yaw, 0.0f);
+}
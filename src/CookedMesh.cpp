@@ -0,0 +1,272 @@
+#include "CookedMesh.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+#include "Logging.h"
+#include "VirtualFS.h"
+
+// Вес вершины по позиции в кэше и количеству оставшихся треугольников
+static float getVertexScore(int cachePosition, unsigned remaining) {
+    if (remaining == 0) {
+        return -1.0f;
+    }
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        // Вершины последнего треугольника получают фиксированный вес, чтобы не выбирать соседний по той же стороне
+        score = cachePosition < 3 ? 0.75f : std::pow(1.0f - (float)(cachePosition - 3) / (RMSH_CACHE_SIZE - 3), 1.5f);
+    }
+    return score + 2.0f / std::sqrt((float)remaining);
+}
+
+void REngine::CookedMesh::optimizeVertexCache(std::vector<unsigned>& indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    std::vector<unsigned> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        remaining[indices[i]]++;
+    }
+    // Треугольники каждой вершины, ещё не выведенные идут первыми
+    std::vector<unsigned> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<unsigned> adjacency(triangleCount * 3);
+    std::vector<unsigned> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++) {
+            adjacency[fill[indices[t * 3 + k]]++] = (unsigned)t;
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        vertexScore[v] = getVertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    size_t best = SIZE_MAX;
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+        if (best == SIZE_MAX || triangleScore[t] > triangleScore[best]) {
+            best = t;
+        }
+    }
+
+    std::vector<unsigned> result;
+    result.reserve(triangleCount * 3);
+    std::vector<unsigned> cache, nextCache;
+    size_t nextUnemitted = 0;
+    auto pushUnique = [&](unsigned vertex) {
+        if (std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end()) {
+            nextCache.push_back(vertex);
+        }
+    };
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+        // Без кандидатов в кэше берётся первый невыведенный треугольник
+        if (best == SIZE_MAX) {
+            while (emitted[nextUnemitted]) {
+                nextUnemitted++;
+            }
+            best = nextUnemitted;
+        }
+        emitted[best] = true;
+        nextCache.clear();
+        for (int k = 0; k < 3; k++) {
+            unsigned vertex = indices[best * 3 + k];
+            result.push_back(vertex);
+            pushUnique(vertex);
+            unsigned* triangles = &adjacency[offsets[vertex]];
+            for (unsigned i = 0; i < remaining[vertex]; i++) {
+                if (triangles[i] == best) {
+                    std::swap(triangles[i], triangles[remaining[vertex] - 1]);
+                    break;
+                }
+            }
+            remaining[vertex]--;
+        }
+        for (unsigned vertex : cache) {
+            pushUnique(vertex);
+        }
+
+        // Вытесненные вершины тоже пересчитываются, их вес падает до веса вне кэша
+        for (size_t i = 0; i < nextCache.size(); i++) {
+            unsigned vertex = nextCache[i];
+            cachePosition[vertex] = i < RMSH_CACHE_SIZE ? (int)i : -1;
+            vertexScore[vertex] = getVertexScore(cachePosition[vertex], remaining[vertex]);
+        }
+        best = SIZE_MAX;
+        for (unsigned vertex : nextCache) {
+            const unsigned* triangles = &adjacency[offsets[vertex]];
+            for (unsigned i = 0; i < remaining[vertex]; i++) {
+                unsigned t = triangles[i];
+                triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+                if (best == SIZE_MAX || triangleScore[t] > triangleScore[best]) {
+                    best = t;
+                }
+            }
+        }
+        cache.assign(nextCache.begin(), nextCache.begin() + std::min(nextCache.size(), (size_t)RMSH_CACHE_SIZE));
+    }
+    indices.swap(result);
+}
+
+void REngine::CookedMesh::optimizeVertexFetch(std::vector<float>& vertices, std::vector<unsigned>& indices) {
+    std::vector<unsigned> remap(vertices.size() / 8, UINT_MAX);
+    std::vector<float> result;
+    result.reserve(vertices.size());
+    unsigned next = 0;
+    for (unsigned& index : indices) {
+        if (remap[index] == UINT_MAX) {
+            remap[index] = next++;
+            result.insert(result.end(), vertices.begin() + index * 8, vertices.begin() + index * 8 + 8);
+        }
+        index = remap[index];
+    }
+    vertices.swap(result);
+}
+
+double REngine::CookedMesh::getACMR(const std::vector<unsigned>& indices, size_t vertexCount, int cacheSize) {
+    if (indices.size() < 3) {
+        return 0.0;
+    }
+    // Вершина в кэше FIFO, если после её загрузки было меньше cacheSize промахов
+    std::vector<size_t> loadedAt(vertexCount, 0);
+    size_t time = (size_t)cacheSize + 1;
+    size_t misses = 0;
+    for (unsigned index : indices) {
+        if (time - loadedAt[index] > (size_t)cacheSize) {
+            loadedAt[index] = time++;
+            misses++;
+        }
+    }
+    return (double)misses / (indices.size() / 3);
+}
+
+// Квантование значения в диапазоне [min, min + scale] в 16 бит
+static uint16_t quantize(float value, float min, float scale) {
+    if (scale <= 0.0f) {
+        return 0;
+    }
+    return (uint16_t)std::lround(std::min(std::max((value - min) / scale, 0.0f), 1.0f) * 65535.0f);
+}
+
+void REngine::CookedMesh::cook(std::vector<float> vertices, std::vector<unsigned> indices, std::vector<unsigned char>& data) {
+    optimizeVertexCache(indices, vertices.size() / 8);
+    optimizeVertexFetch(vertices, indices);
+
+    RMeshHeader header = {};
+    header.magic = RMSH_MAGIC;
+    header.version = RMSH_VERSION;
+    header.vertexCount = (uint32_t)(vertices.size() / 8);
+    header.indexCount = (uint32_t)indices.size();
+    header.indexSize = header.vertexCount <= 65536 ? 2 : 4;
+    float positionMax[3], uvMax[2];
+    for (int c = 0; c < 3; c++) {
+        header.positionMin[c] = positionMax[c] = vertices.empty() ? 0.0f : vertices[c];
+    }
+    for (int c = 0; c < 2; c++) {
+        header.uvMin[c] = uvMax[c] = vertices.empty() ? 0.0f : vertices[6 + c];
+    }
+    for (size_t i = 0; i < vertices.size(); i += 8) {
+        for (int c = 0; c < 3; c++) {
+            header.positionMin[c] = std::min(header.positionMin[c], vertices[i + c]);
+            positionMax[c] = std::max(positionMax[c], vertices[i + c]);
+        }
+        for (int c = 0; c < 2; c++) {
+            header.uvMin[c] = std::min(header.uvMin[c], vertices[i + 6 + c]);
+            uvMax[c] = std::max(uvMax[c], vertices[i + 6 + c]);
+        }
+    }
+    for (int c = 0; c < 3; c++) {
+        header.positionScale[c] = positionMax[c] - header.positionMin[c];
+    }
+    for (int c = 0; c < 2; c++) {
+        header.uvScale[c] = uvMax[c] - header.uvMin[c];
+    }
+
+    data.resize(sizeof(header) + sizeof(RMeshVertex) * header.vertexCount + (size_t)header.indexSize * header.indexCount);
+    std::memcpy(data.data(), &header, sizeof(header));
+    unsigned char* output = data.data() + sizeof(header);
+    for (size_t i = 0; i < vertices.size(); i += 8) {
+        RMeshVertex vertex = {};
+        for (int c = 0; c < 3; c++) {
+            vertex.position[c] = quantize(vertices[i + c], header.positionMin[c], header.positionScale[c]);
+            vertex.normal[c] = (int8_t)std::lround(std::min(std::max(vertices[i + 3 + c], -1.0f), 1.0f) * 127.0f);
+        }
+        for (int c = 0; c < 2; c++) {
+            vertex.uv[c] = quantize(vertices[i + 6 + c], header.uvMin[c], header.uvScale[c]);
+        }
+        std::memcpy(output, &vertex, sizeof(vertex));
+        output += sizeof(vertex);
+    }
+    for (unsigned index : indices) {
+        if (header.indexSize == 2) {
+            uint16_t value = (uint16_t)index;
+            std::memcpy(output, &value, sizeof(value));
+        } else {
+            std::memcpy(output, &index, sizeof(index));
+        }
+        output += header.indexSize;
+    }
+}
+
+bool REngine::CookedMesh::parse(const unsigned char* data, size_t size, std::vector<float>& vertices, std::vector<unsigned>& indices) {
+    RMeshHeader header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != RMSH_MAGIC || header.version != RMSH_VERSION || (header.indexSize != 2 && header.indexSize != 4) ||
+        header.indexCount % 3 != 0) {
+        return false;
+    }
+    size_t vertexBytes = sizeof(RMeshVertex) * header.vertexCount;
+    if ((size - sizeof(header)) < vertexBytes || (size - sizeof(header) - vertexBytes) / header.indexSize < header.indexCount) {
+        return false;
+    }
+
+    const unsigned char* input = data + sizeof(header);
+    vertices.resize((size_t)header.vertexCount * 8);
+    for (size_t i = 0; i < header.vertexCount; i++) {
+        RMeshVertex vertex;
+        std::memcpy(&vertex, input + i * sizeof(vertex), sizeof(vertex));
+        float* output = &vertices[i * 8];
+        for (int c = 0; c < 3; c++) {
+            output[c] = header.positionMin[c] + vertex.position[c] / 65535.0f * header.positionScale[c];
+            output[3 + c] = std::max(vertex.normal[c] / 127.0f, -1.0f);
+        }
+        for (int c = 0; c < 2; c++) {
+            output[6 + c] = header.uvMin[c] + vertex.uv[c] / 65535.0f * header.uvScale[c];
+        }
+    }
+    input += vertexBytes;
+    indices.resize(header.indexCount);
+    for (size_t i = 0; i < header.indexCount; i++) {
+        if (header.indexSize == 2) {
+            uint16_t value;
+            std::memcpy(&value, input + i * 2, sizeof(value));
+            indices[i] = value;
+        } else {
+            std::memcpy(&indices[i], input + i * 4, sizeof(unsigned));
+        }
+        if (indices[i] >= header.vertexCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool REngine::CookedMesh::load(const std::string& path, std::vector<float>& vertices, std::vector<unsigned>& indices) {
+    AssetFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    if (!parse(file.data(), file.size(), vertices, indices)) {
+        ERROR("Invalid mesh file: " + path);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,143 @@
+#include "CookedTexture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "BlockCompression.h"
+
+const char* REngine::CookedTexture::getFormatName(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::RGB8:
+            return "RGB8";
+        case TextureFormat::RGBA8:
+            return "RGBA8";
+        case TextureFormat::BC1:
+            return "BC1";
+        case TextureFormat::BC3:
+            return "BC3";
+        case TextureFormat::BC7:
+            return "BC7";
+    }
+    return "unknown";
+}
+
+REngine::TextureFormat REngine::CookedTexture::fromBlockFormat(BlockFormat format) {
+    switch (format) {
+        case BlockFormat::BC1:
+            return TextureFormat::BC1;
+        case BlockFormat::BC3:
+            return TextureFormat::BC3;
+        case BlockFormat::BC7:
+            return TextureFormat::BC7;
+    }
+    return TextureFormat::BC1;
+}
+
+size_t REngine::CookedTexture::getLevelSize(TextureFormat format, int width, int height) {
+    BlockFormat blockFormat;
+    if (Texture::getBlockFormat(format, blockFormat)) {
+        return BlockCompressor::getImageSize(blockFormat, width, height);
+    }
+    return (size_t)width * height * (format == TextureFormat::RGB8 ? 3 : 4);
+}
+
+void REngine::CookedTexture::cook(TextureFormat format, const unsigned char* rgba, int width, int height, CookedImage& image, int threads) {
+    image.format = format;
+    BlockFormat blockFormat;
+    if (Texture::getBlockFormat(format, blockFormat)) {
+        CompressedImage compressed;
+        BlockCompressor::compressMipChain(blockFormat, rgba, width, height, compressed, threads);
+        image.levels = std::move(compressed.levels);
+        image.data = std::move(compressed.data);
+        return;
+    }
+
+    int channels = format == TextureFormat::RGB8 ? 3 : 4;
+    size_t count = (size_t)width * height;
+    image.data.resize(count * channels);
+    for (size_t i = 0; i < count; i++) {
+        std::memcpy(&image.data[i * channels], rgba + i * 4, channels);
+    }
+    Texture::buildMipChain(image.data, width, height, channels, image.levels);
+}
+
+bool REngine::CookedTexture::serialize(const CookedImage& image, std::vector<unsigned char>& data) {
+    if (image.levels.empty() || image.levels.size() > RTEX_LEVELS_MAX) {
+        return false;
+    }
+
+    RTexHeader header;
+    header.magic = RTEX_MAGIC;
+    header.version = RTEX_VERSION;
+    header.format = (uint32_t)image.format;
+    header.width = image.levels[0].width;
+    header.height = image.levels[0].height;
+    header.levelCount = (uint32_t)image.levels.size();
+
+    // Уровни выравниваются, чтобы отображённый файл можно было передавать без копирования
+    std::vector<RTexLevel> levels;
+    uint64_t offset = sizeof(header) + sizeof(RTexLevel) * image.levels.size();
+    for (const TextureLevel& level : image.levels) {
+        offset = (offset + RTEX_ALIGNMENT - 1) & ~(uint64_t)(RTEX_ALIGNMENT - 1);
+        levels.push_back({(uint32_t)level.width, (uint32_t)level.height, offset, level.size});
+        offset += level.size;
+    }
+
+    data.assign(offset, 0);
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + sizeof(header), levels.data(), sizeof(RTexLevel) * levels.size());
+    for (size_t i = 0; i < levels.size(); i++) {
+        std::memcpy(data.data() + levels[i].offset, image.data.data() + image.levels[i].offset, levels[i].size);
+    }
+    return true;
+}
+
+bool REngine::CookedTexture::save(const std::string& path, const CookedImage& image) {
+    std::vector<unsigned char> data;
+    if (!serialize(image, data)) {
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return !file.fail();
+}
+
+bool REngine::CookedTexture::parse(const unsigned char* data, size_t size, CookedImage& image) {
+    RTexHeader header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != RTEX_MAGIC || header.version != RTEX_VERSION || header.format > (uint32_t)TextureFormat::BC7) {
+        return false;
+    }
+    if (header.width == 0 || header.height == 0 || header.width > (1u << RTEX_LEVELS_MAX) ||
+        header.height > (1u << RTEX_LEVELS_MAX) || header.levelCount == 0 || header.levelCount > RTEX_LEVELS_MAX) {
+        return false;
+    }
+    if (size < sizeof(header) + sizeof(RTexLevel) * header.levelCount) {
+        return false;
+    }
+
+    image.format = (TextureFormat)header.format;
+    image.levels.clear();
+    image.data.clear();
+    for (uint32_t i = 0; i < header.levelCount; i++) {
+        RTexLevel level;
+        std::memcpy(&level, data + sizeof(header) + sizeof(RTexLevel) * i, sizeof(level));
+        // Размеры уровня должны совпадать с цепочкой, которую ожидает OpenGL
+        int width = std::max(1, (int)(header.width >> i)), height = std::max(1, (int)(header.height >> i));
+        if ((int)level.width != width || (int)level.height != height || level.size != getLevelSize(image.format, width, height)) {
+            return false;
+        }
+        if (level.offset > size || size - level.offset < level.size) {
+            return false;
+        }
+        image.levels.push_back({width, height, (size_t)level.offset, (size_t)level.size});
+    }
+    return true;
+}
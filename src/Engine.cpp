@@ -1,14 +1,36 @@
 #include "Engine.h"
 
 #include <SDL.h>
+#include <algorithm>
+#include <fstream>
 
+#include "AllocTracker.h"
+#include "FrameArena.h"
 #include "InputHandler.h"
 #include "Renderer.h"
+#include "TextureCache.h"
+#include "TexturePool.h"
+#include "TextureResidency.h"
+#include "TextureStreamer.h"
 #include "Logging.h"
+#include "Profiler.h"
 
 SDL_Window* window = nullptr;
 SDL_GLContext glContext = nullptr;
+bool headless = false;
+bool quitRequested = false;
 REngine::Renderer* renderer = nullptr;
+REngine::FrameSync* frameSync = nullptr;
+int framesInFlight = 2;
+REngine::FrameClock* frameClock = nullptr;
+REngine::PresentMode presentMode = REngine::PresentMode::VSync;
+double targetFrameRate = 60.0;
+double fixedTimeStep = 1.0 / 120.0;
+REngine::FrameStats frameStats;
+std::string frameStatsCsvPath;
+std::string frameStatsJsonPath;
+const REngine::CameraPath* cameraPath = nullptr;
+double cameraPathStep = 1.0 / 60.0;
 
 void moveCamera(SDL_Keycode key, float deltaTime) {
     glm::vec3 viewPos = glm::vec3(0);
@@ -34,11 +56,39 @@ void moveCamera(SDL_Keycode key, float deltaTime) {
     renderer->getScene()->camera.moveRelative(viewPos.x, viewPos.y, viewPos.z);
 }
 
-int REngine::createWindow(const char* title, int width, int height) {
+void applyPresentMode() {
+    int interval = 0;
+    if (presentMode == REngine::PresentMode::VSync) {
+        interval = 1;
+    } else if (presentMode == REngine::PresentMode::AdaptiveVSync) {
+        interval = -1;
+    }
+
+    if (headless) {
+        // Без вывода на экран кадры не ожидают вертикальной синхронизации
+    } else if (SDL_GL_SetSwapInterval(interval) != 0) {
+        if (interval == -1 && SDL_GL_SetSwapInterval(1) == 0) {
+            WARN("Adaptive Vsync is not supported, falling back to Vsync");
+        } else {
+            ERROR("Couldn't set up swap interval: " << SDL_GetError());
+        }
+    }
+
+    frameClock->setTargetFrameRate(presentMode == REngine::PresentMode::TargetFPS ? targetFrameRate : 0.0);
+}
+
+int createContext(const char* title, int width, int height, bool offscreen) {
     if (window) {
         FATAL("Window already exists");
-        return WINDOW_ALREADY_EXISTS;
+        return REngine::WINDOW_ALREADY_EXISTS;
+    }
+
+#ifdef __linux__
+    // Без дисплея используется драйвер SDL, создающий контекст через EGL без окна
+    if (offscreen && !SDL_getenv("SDL_VIDEODRIVER") && !SDL_getenv("DISPLAY") && !SDL_getenv("WAYLAND_DISPLAY")) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
     }
+#endif
 
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         FATAL("SDL could not initialize! SDL_Error: " << SDL_GetError());
@@ -50,6 +100,11 @@ int REngine::createWindow(const char* title, int width, int height) {
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 
     bool fullscreen = false;
+    if (offscreen && (width == 0 || height == 0)) {
+        FATAL("Headless mode requires a fixed resolution");
+        SDL_Quit();
+        return REngine::WINDOW_CREATE_FAILED;
+    }
     if (width == 0 || height == 0) {
         SDL_DisplayMode displayMode;
         SDL_GetCurrentDisplayMode(0, &displayMode);
@@ -64,49 +119,84 @@ int REngine::createWindow(const char* title, int width, int height) {
         SDL_WINDOWPOS_UNDEFINED,
         width,
         height,
-        SDL_WINDOW_OPENGL | (fullscreen ? SDL_WINDOW_FULLSCREEN : 0)
+        SDL_WINDOW_OPENGL | (fullscreen ? SDL_WINDOW_FULLSCREEN : 0) | (offscreen ? SDL_WINDOW_HIDDEN : 0)
     );
 
     if (!window) {
         FATAL("Window could not be created! SDL_Error: " << SDL_GetError());
-        destroyWindow();
-        return WINDOW_CREATE_FAILED;
+        REngine::destroyWindow();
+        return REngine::WINDOW_CREATE_FAILED;
     }
 
     glContext = SDL_GL_CreateContext(window);
     if (!glContext) {
         FATAL("OpenGL context could not be created! SDL_Error: " << SDL_GetError());
-        destroyWindow();
-        return GL_CONTEXT_CREATE_FAILED;
+        REngine::destroyWindow();
+        return REngine::GL_CONTEXT_CREATE_FAILED;
     }
 
     renderer = REngine::initRenderer(width, height);
     if (!renderer) {
         FATAL("Couldn't initialize renderer");
-        destroyWindow();
-        return RENDERER_INIT_FAILED;
+        REngine::destroyWindow();
+        return REngine::RENDERER_INIT_FAILED;
+    }
+
+    headless = offscreen;
+    if (headless && !renderer->createOffscreenTarget()) {
+        FATAL("Couldn't create offscreen render target");
+        REngine::destroyWindow();
+        return REngine::RENDERER_INIT_FAILED;
     }
 
+    frameSync = new REngine::FrameSync(framesInFlight);
+    REngine::TextureStreamer::start();
+
     // Инициализация системы ввода
-    InputHandler::init();
+    REngine::InputHandler::init();
 
-    if (SDL_GL_SetSwapInterval(1) != 0) {
-        ERROR("Couldn't set up Vsync: " << SDL_GetError());
-    }
+    frameClock = new REngine::FrameClock();
+    applyPresentMode();
 
     return 0;
 }
 
-void REngine::mainLoop() {
-    bool quit = false;  // Флаг выхода из цикла
+int REngine::createWindow(const char* title, int width, int height) {
+    return createContext(title, width, height, false);
+}
+
+int REngine::createHeadless(int width, int height) {
+    int result = createContext("REngine", width, height, true);
+    if (result == 0) {
+        INFO("Headless rendering at " << width << "x" << height << " via " << SDL_GetCurrentVideoDriver());
+    }
+    return result;
+}
+
+bool REngine::isHeadless() {
+    return headless;
+}
+
+// Ожидание всех кадров в полёте, время GPU последних кадров записывается в статистику
+static void finishFrames() {
+    while (frameSync->resolveOldest()) {
+        frameStats.setGpuTime(frameSync->getResolvedFrameNumber(), frameSync->getGpuFrameTime());
+    }
+}
 
-    Uint32 previousTime = SDL_GetTicks();  // Последнее время в миллисекундах
-    double deltaTime = 0.0f;  // Время с последнего кадра в секундах
+unsigned long runLoop(unsigned long maxFrames) {
+    using namespace REngine;
+    quitRequested = false;
+    unsigned long framesRendered = 0;  // Количество кадров, отрисованных в этом цикле
+
+    FixedTimeStep timeStep(fixedTimeStep);  // Симуляция с фиксированным шагом
+    double fpsTime = 0.0;  // Время с последнего вывода FPS в секундах
     int frames = 0;  // Количество кадров за секунду
+    glm::vec3 previousCameraPosition = renderer->getScene()->camera.position;  // Позиция камеры до последнего шага
 
     // Закрытие окна при нажатии на Q
-    InputHandler::setKeyDownCallback(SDLK_q, [&quit]() {
-        quit = true;
+    InputHandler::setKeyDownCallback(SDLK_q, []() {
+        quitRequested = true;
     });
 
     // Перемещение камеры при удержании клавиш
@@ -119,7 +209,7 @@ void REngine::mainLoop() {
 
     // Обработка движения мыши с зажатой правой кнопкой
     InputHandler::setMouseMotionCallback([&](int x, int y, int xrel, int yrel) {
-        if (SDL_GetMouseState(NULL, NULL) & SDL_BUTTON_RMASK) {
+        if (InputHandler::isMouseButtonDown(SDL_BUTTON_RIGHT)) {
             float dx = xrel / 5.0f;
             float dy = yrel / 5.0f;
             renderer->getScene()->camera.rotateRelative(dx, dy, 0);
@@ -143,7 +233,7 @@ void REngine::mainLoop() {
     InputHandler::setKeyDownCallback(SDLK_ESCAPE, []() {
         SDL_SetRelativeMouseMode(SDL_FALSE);
         InputHandler::setMouseMotionCallback([](int x, int y, int xrel, int yrel) {
-            if (SDL_GetMouseState(NULL, NULL) & SDL_BUTTON_RMASK) {
+            if (InputHandler::isMouseButtonDown(SDL_BUTTON_RIGHT)) {
                 float dx = xrel / 5.0f;
                 float dy = yrel / 5.0f;
                 renderer->getScene()->camera.rotateRelative(dx, dy, 0);
@@ -151,25 +241,185 @@ void REngine::mainLoop() {
         });
     });
 
-    while (!quit) {
-        Uint32 currentTime = SDL_GetTicks();  // Текущее время в миллисекундах
-        deltaTime = (currentTime - previousTime) / 1000.0f;
+    frameClock->tick();
+    while (!quitRequested && (maxFrames == 0 || framesRendered < maxFrames)) {
+        PROFILE_FRAME(frameSync->getFrameNumber());
+        PROFILE_SCOPE("frame");
+        double deltaTime = frameClock->tick();  // Время с последнего кадра в секундах
+        if (!InputHandler::beginFrame(deltaTime)) {
+            break;  // Записанный ввод закончился
+        }
+        // Выделения фонового журнала и потоков загрузки текстур в кадр не входят
+        AllocStats frameAllocStart = AllocTracker::getThreadStats();
+        FrameArena& frameArena = FrameArena::getThreadArena();
+        frameArena.reset();
+        // При пролёте по пути симуляция не зависит от реального времени
+        int steps = cameraPath ? timeStep.advance(cameraPathStep, false) : timeStep.advance(deltaTime);
 
         // Обработка ввода
-        InputHandler::update(deltaTime);
+        InputHandler::pollEvents();
 
-        // Вывод FPS
-        if (currentTime / 1000 - previousTime / 1000 >= 1) {
-            INFO("FPS: " << std::to_string(frames));
+        // Симуляция с фиксированным шагом
+        REngine::Camera& camera = renderer->getScene()->camera;
+        for (; steps > 0; steps--) {
+            previousCameraPosition = camera.position;
+            InputHandler::updateHeldKeys(timeStep.getStep());
+        }
+
+        // Вывод сводки статистики за секунду
+        fpsTime += deltaTime;
+        if (fpsTime >= 1.0) {
+            REngine::FrameSummary summary = frameStats.summarize(frames);
+            INFO("FPS: " << frames << ", frame time: mean " << summary.mean << " ms, p99 " << summary.p99
+                 << " ms, max " << summary.max << " ms, CPU " << summary.cpuMean << " ms, GPU " << summary.gpuMean
+                 << " ms, fence wait: " << frameSync->getFenceWaitTime() << " ms"
+                 << ", GPU idle: " << frameSync->getGpuIdleTime() << " ms");
             frames = 0;
+            fpsTime -= 1.0;
         }
         frames++;
-        previousTime = currentTime;
+
+        if (cameraPath) {
+            cameraPath->apply(camera, (float)(framesRendered * cameraPathStep));
+            previousCameraPosition = camera.position;
+        }
+
+        // Интерполяция положения камеры между шагами симуляции
+        glm::vec3 cameraPosition = camera.position;
+        camera.position = glm::mix(previousCameraPosition, cameraPosition, float(timeStep.getAlpha()));
 
         // Отрисовка кадра
-        renderer->draw(currentTime);
-        SDL_GL_SwapWindow(window);
+        {
+            PROFILE_SCOPE("FrameSync::beginFrame");
+            frameSync->beginFrame();
+        }
+        frameStats.setGpuTime(frameSync->getResolvedFrameNumber(), frameSync->getGpuFrameTime());
+        REngine::FrameRecord record;
+        record.frame = frameSync->getFrameNumber();
+
+        {
+            PROFILE_SCOPE("TextureStreamer::update");
+            TextureStreamer::update(frameSync->getFrameSlot());
+        }
+        REngine::GpuProfiler* gpuProfiler = renderer->getGpuProfiler();
+        gpuProfiler->beginFrame(record.frame);
+        renderer->draw((unsigned long)(timeStep.getInterpolatedTime() * 1000.0), frameSync->getFrameSlot());
+        gpuProfiler->endFrame();
+        TextureResidency::update();
+        if (!headless) {
+            PROFILE_SCOPE("swap");
+            SDL_GL_SwapWindow(window);
+        }
+        frameSync->endFrame();
+        framesRendered++;
+
+        while (gpuProfiler->consumeResults()) {
+            frameStats.setGpuScopeTimes(gpuProfiler->getResolvedFrame(), gpuProfiler->getResults());
+        }
+
+        camera.position = cameraPosition;
+
+        const REngine::RenderCounters& counters = renderer->getCounters();
+        record.cpuTime = frameClock->getFrameElapsed() * 1000.0 - frameSync->getFenceWaitTime();
+        record.drawCalls = counters.drawCalls;
+        record.triangles = counters.triangles;
+        record.culledNodes = counters.culledNodes;
+        record.textureBinds = counters.textureBinds;
+        record.residentTextureBytes = TextureResidency::getResidentBytes();
+        record.textureEvictions = TextureResidency::getFrameEvictions();
+        record.textureReloads = TextureResidency::getFrameReloads();
+        AllocStats frameAllocs = AllocTracker::getThreadStats() - frameAllocStart;
+        record.allocations = frameAllocs.allocations;
+        record.allocatedBytes = frameAllocs.bytes;
+        record.arenaBytes = frameArena.getUsed();
+
+        // deltaTime в начале кадра относится к предыдущему кадру, поэтому длительность
+        // этого кадра вместе с ожиданием ограничителя берётся в его конце
+        frameClock->limit();
+        record.frameTime = frameClock->getFrameElapsed() * 1000.0;
+        frameStats.record(record);
+    }
+    return framesRendered;
+}
+
+void REngine::mainLoop() {
+    runLoop(0);
+}
+
+REngine::FrameSummary REngine::runFrames(unsigned long frames) {
+    // Цикл завершается раньше при выходе или окончании записанного ввода
+    unsigned long rendered = runLoop(frames);
+    finishFrames();
+
+    size_t window = std::min<size_t>(rendered, frameStats.size());
+    FrameSummary summary = window > 0 ? frameStats.summarize(window) : FrameSummary();
+    INFO("Rendered " << summary.frames << " frames: mean " << summary.mean << " ms, p50 " << summary.p50
+         << " ms, p95 " << summary.p95 << " ms, p99 " << summary.p99 << " ms, max " << summary.max
+         << " ms, hitches " << summary.hitches);
+    FrameArena& frameArena = FrameArena::getThreadArena();
+    INFO("Frame arena high-water mark: " << frameArena.getHighWater() << " of " << frameArena.getCapacity() << " bytes");
+    return summary;
+}
+
+REngine::FrameSummary REngine::runFlyThrough(const REngine::CameraPath& path, double timeStep, const char* reportPath) {
+    if (path.getKeyframes().empty() || timeStep <= 0.0) {
+        ERROR("Invalid fly-through: " << path.getKeyframes().size() << " keyframes, step " << timeStep);
+        return FrameSummary();
+    }
+
+    unsigned long frames = (unsigned long)(path.getDuration() / timeStep + 1e-6) + 1;
+    if (frameStats.getCapacity() < frames) {
+        frameStats.setCapacity(frames);
     }
+
+    Camera savedCamera = renderer->getScene()->camera;
+    cameraPath = &path;
+    cameraPathStep = timeStep;
+    // При выходе или окончании записанного ввода кадров меньше, чем шагов пути
+    size_t rendered = std::min<size_t>(runLoop(frames), frameStats.size());
+    cameraPath = nullptr;
+    finishFrames();
+    renderer->getScene()->camera = savedCamera;
+
+    size_t first = frameStats.size() - rendered;
+
+    // Самый медленный кадр указывает на вид, требующий разбора. Время кадра записано в конце
+    // того же кадра, поэтому номер записи совпадает с шагом пути, по которому стояла камера
+    size_t slowest = first;
+    for (size_t i = first; i < frameStats.size(); i++) {
+        if (frameStats.get(i).frameTime > frameStats.get(slowest).frameTime) {
+            slowest = i;
+        }
+    }
+    if (rendered > 0) {
+        CameraKeyframe view = path.sample((float)((slowest - first) * timeStep));
+        INFO("Slowest fly-through frame: " << frameStats.get(slowest).frameTime << " ms at " << view.time
+             << " s, position (" << view.position.x << ", " << view.position.y << ", " << view.position.z << ")");
+    }
+
+    if (reportPath) {
+        std::ofstream file(reportPath);
+        if (!file.is_open()) {
+            ERROR("Failed to open fly-through report: " << reportPath);
+        } else {
+            file << "frame,path_time,distance,x,y,z,pitch,yaw,frame_ms,cpu_ms,gpu_ms,draw_calls,triangles,culled_nodes\n";
+            float distance = 0.0f;
+            glm::vec3 previous = path.sample(0.0f).position;
+            for (size_t i = first; i < frameStats.size(); i++) {
+                const FrameRecord& record = frameStats.get(i);
+                CameraKeyframe view = path.sample((float)((i - first) * timeStep));
+                distance += glm::length(view.position - previous);
+                previous = view.position;
+                file << record.frame << "," << view.time << "," << distance << "," << view.position.x << ","
+                     << view.position.y << "," << view.position.z << "," << view.pitch << "," << view.yaw << ","
+                     << record.frameTime << "," << record.cpuTime << "," << record.gpuTime << ","
+                     << record.drawCalls << "," << record.triangles << "," << record.culledNodes << "\n";
+            }
+            INFO("Fly-through report with " << rendered << " frames written to " << reportPath);
+        }
+    }
+
+    return rendered > 0 ? frameStats.summarize(rendered) : FrameSummary();
 }
 
 void REngine::setScene(REngine::Scene* scene) {
@@ -190,12 +440,68 @@ REngine::Shader* REngine::getShader() {
     return renderer->getShader();
 }
 
+void REngine::setFramesInFlight(int count) {
+    framesInFlight = count;
+    if (frameSync) {
+        frameSync->setFramesInFlight(count);
+    }
+}
+
+REngine::FrameSync* REngine::getFrameSync() {
+    return frameSync;
+}
+
+void REngine::setPresentMode(REngine::PresentMode mode, double targetFps) {
+    presentMode = mode;
+    if (targetFps > 0.0) {
+        targetFrameRate = targetFps;
+    }
+    if (frameClock) {
+        applyPresentMode();
+    }
+}
+
+void REngine::setFixedTimeStep(double seconds) {
+    if (seconds <= 0.0) {
+        ERROR("Invalid fixed time step: " << seconds);
+        return;
+    }
+    fixedTimeStep = seconds;
+}
+
+REngine::FrameStats* REngine::getFrameStats() {
+    return &frameStats;
+}
+
+void REngine::setFrameStatsOutput(const char* csvPath, const char* jsonPath) {
+    frameStatsCsvPath = csvPath ? csvPath : "";
+    frameStatsJsonPath = jsonPath ? jsonPath : "";
+}
+
 void REngine::destroyWindow() {
+    InputHandler::stopRecording();
+    if (!frameStatsCsvPath.empty()) {
+        frameStats.dumpCSV(frameStatsCsvPath);
+    }
+    if (!frameStatsJsonPath.empty()) {
+        frameStats.dumpJSON(frameStatsJsonPath);
+    }
+
+    delete frameSync;
+    frameSync = NULL;
+    delete frameClock;
+    frameClock = NULL;
+    // Ресурсы OpenGL рендерера и текстуры освобождаются до удаления контекста
+    REngine::TextureStreamer::stop();
+    REngine::TextureResidency::clear();
+    REngine::TextureCache::clear();
+    REngine::TexturePool::clear();
+    delete renderer;
+    renderer = NULL;
     SDL_GL_DeleteContext(glContext);
     SDL_DestroyWindow(window);
     SDL_Quit();
-    delete renderer;
     window = NULL;
     glContext = NULL;
-    renderer = NULL;
+    headless = false;
 }
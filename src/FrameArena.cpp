@@ -0,0 +1,44 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+
+#include "Logging.h"
+
+REngine::FrameArena::FrameArena(size_t capacity)
+    : buffer(new unsigned char[capacity]), capacity(capacity) {}
+
+void* REngine::FrameArena::allocate(size_t size, size_t alignment) {
+    size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+    // Объём считается как смещение в буфере без нехватки, вместе с отступами выравнивания,
+    // чтобы увеличенного при сбросе буфера хватило на те же выделения
+    used = ((used + alignment - 1) & ~(alignment - 1)) + size;
+    highWater = std::max(highWater, used);
+
+    if (aligned + size <= capacity) {
+        offset = aligned + size;
+        return buffer.get() + aligned;
+    }
+
+    // Буфера не хватило: память берётся из кучи до следующего сброса
+    overflow.emplace_back(new unsigned char[size + alignment]);
+    unsigned char* block = overflow.back().get();
+    return block + ((alignment - (reinterpret_cast<size_t>(block) & (alignment - 1))) & (alignment - 1));
+}
+
+void REngine::FrameArena::reset() {
+    if (!overflow.empty()) {
+        // Запас на рост, чтобы не перевыделять буфер каждые несколько кадров
+        size_t grown = highWater + highWater / 2;
+        WARN("Frame arena overflowed " << capacity << " bytes, growing to " << grown);
+        overflow.clear();
+        buffer.reset(new unsigned char[grown]);
+        capacity = grown;
+    }
+    offset = 0;
+    used = 0;
+}
+
+REngine::FrameArena& REngine::FrameArena::getThreadArena() {
+    static thread_local FrameArena arena;
+    return arena;
+}
@@ -0,0 +1,71 @@
+#include "FrameClock.h"
+
+// Запас до крайнего срока, который выдерживается активным ожиданием
+// вместо сна из-за грубой гранулярности планировщика
+#define FRAME_LIMITER_SPIN_MS 2
+
+REngine::FrameClock::FrameClock()
+    : frequency(SDL_GetPerformanceFrequency()), startCounter(SDL_GetPerformanceCounter()),
+      deadline(0), framePeriod(0), deltaTime(0.0) {
+    frameCounter = startCounter;
+}
+
+double REngine::FrameClock::tick() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    deltaTime = double(now - frameCounter) / frequency;
+    frameCounter = now;
+
+    if (framePeriod != 0) {
+        // Отсчёт от предыдущего срока убирает накопление погрешности сна,
+        // но при отставании больше чем на кадр срок сбрасывается
+        deadline = (deadline != 0 && now - deadline < framePeriod) ? deadline + framePeriod : now + framePeriod;
+    }
+    return deltaTime;
+}
+
+double REngine::FrameClock::getFrameElapsed() const {
+    return double(SDL_GetPerformanceCounter() - frameCounter) / frequency;
+}
+
+double REngine::FrameClock::getTime() const {
+    return double(SDL_GetPerformanceCounter() - startCounter) / frequency;
+}
+
+void REngine::FrameClock::setTargetFrameRate(double fps) {
+    framePeriod = fps > 0.0 ? Uint64(frequency / fps) : 0;
+    deadline = 0;
+}
+
+void REngine::FrameClock::limit() {
+    if (framePeriod == 0 || deadline == 0) {
+        return;
+    }
+
+    Uint64 spinTicks = frequency * FRAME_LIMITER_SPIN_MS / 1000;
+    Uint64 now = SDL_GetPerformanceCounter();
+    while (now < deadline) {
+        Uint64 remaining = deadline - now;
+        if (remaining > spinTicks) {
+            SDL_Delay(Uint32((remaining - spinTicks) * 1000 / frequency));
+        }
+        now = SDL_GetPerformanceCounter();
+    }
+}
+
+double REngine::FrameClock::toSeconds(Uint64 ticks) {
+    return double(ticks) / SDL_GetPerformanceFrequency();
+}
+
+REngine::FixedTimeStep::FixedTimeStep(double step) : step(step), accumulator(0.0), simulationTime(0.0) {
+}
+
+int REngine::FixedTimeStep::advance(double deltaTime, bool clamp) {
+    accumulator += clamp && deltaTime > FIXED_UPDATE_MAX_FRAME_TIME ? FIXED_UPDATE_MAX_FRAME_TIME : deltaTime;
+    int steps = 0;
+    while (accumulator >= step) {
+        simulationTime += step;
+        accumulator -= step;
+        steps++;
+    }
+    return steps;
+}
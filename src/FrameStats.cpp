@@ -0,0 +1,219 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include "GpuProfiler.h"
+#include "Logging.h"
+
+// Процентиль по методу ближайшего ранга в отсортированном массиве
+static double percentile(const std::vector<float>& sorted, double p) {
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+REngine::FrameStats::FrameStats(size_t capacity) {
+    setCapacity(capacity);
+}
+
+void REngine::FrameStats::setCapacity(size_t capacity) {
+    records.assign(std::max<size_t>(capacity, 1), FrameRecord());
+    scopeTimes.assign(records.size() * FRAME_STATS_GPU_SCOPES_MAX, 0.0f);
+    scopeNames.reserve(FRAME_STATS_GPU_SCOPES_MAX);
+    scratch.reserve(records.size());
+    clear();
+}
+
+void REngine::FrameStats::record(const FrameRecord& record) {
+    records[head] = record;
+    std::fill_n(scopeTimes.begin() + head * FRAME_STATS_GPU_SCOPES_MAX, FRAME_STATS_GPU_SCOPES_MAX, 0.0f);
+    head = (head + 1) % records.size();
+    count = std::min(count + 1, records.size());
+}
+
+void REngine::FrameStats::setGpuTime(unsigned long frame, float gpuTime) {
+    long slot = findSlot(frame);
+    if (slot >= 0) {
+        records[slot].gpuTime = gpuTime;
+    }
+}
+
+void REngine::FrameStats::setGpuScopeTimes(unsigned long frame, const std::vector<GpuScopeResult>& results) {
+    long slot = findSlot(frame);
+    if (slot < 0) {
+        return;
+    }
+
+    float* times = &scopeTimes[slot * FRAME_STATS_GPU_SCOPES_MAX];
+    for (const GpuScopeResult& result : results) {
+        size_t scope = 0;
+        while (scope < scopeNames.size() && std::strcmp(scopeNames[scope], result.name) != 0) {
+            scope++;
+        }
+        if (scope == scopeNames.size()) {
+            if (scope == FRAME_STATS_GPU_SCOPES_MAX) {
+                if (!scopesDropped) {
+                    WARN("GPU scope " << result.name << " dropped: more than " << FRAME_STATS_GPU_SCOPES_MAX << " scope names");
+                    scopesDropped = true;
+                }
+                continue;
+            }
+            scopeNames.push_back(result.name);
+        }
+        times[scope] += result.time;
+    }
+}
+
+float REngine::FrameStats::getGpuScopeTime(size_t index, size_t scope) const {
+    return scopeTimes[slotOf(index) * FRAME_STATS_GPU_SCOPES_MAX + scope];
+}
+
+double REngine::FrameStats::getGpuScopeMean(const char* name, size_t window) const {
+    size_t scope = 0;
+    while (scope < scopeNames.size() && std::strcmp(scopeNames[scope], name) != 0) {
+        scope++;
+    }
+    if (scope == scopeNames.size()) {
+        return 0.0;
+    }
+
+    size_t frames = (window == 0 || window > count) ? count : window;
+    double total = 0.0;
+    size_t known = 0;
+    for (size_t i = count - frames; i < count; i++) {
+        float time = getGpuScopeTime(i, scope);
+        if (time > 0.0f) {
+            total += time;
+            known++;
+        }
+    }
+    return known > 0 ? total / known : 0.0;
+}
+
+long REngine::FrameStats::findSlot(unsigned long frame) const {
+    // Время GPU приходит с задержкой, поэтому кадр ищется с конца буфера
+    for (size_t i = count; i > 0; i--) {
+        size_t slot = slotOf(i - 1);
+        if (records[slot].frame == frame) {
+            return slot;
+        }
+        if (records[slot].frame < frame) {
+            break;
+        }
+    }
+    return -1;
+}
+
+const REngine::FrameRecord& REngine::FrameStats::get(size_t index) const {
+    return records[slotOf(index)];
+}
+
+REngine::FrameSummary REngine::FrameStats::summarize(size_t window) const {
+    FrameSummary summary;
+    size_t frames = (window == 0 || window > count) ? count : window;
+    if (frames == 0) {
+        return summary;
+    }
+
+    scratch.clear();
+    double cpuTotal = 0.0;
+    double gpuTotal = 0.0;
+    size_t gpuFrames = 0;
+    for (size_t i = count - frames; i < count; i++) {
+        const FrameRecord& record = get(i);
+        scratch.push_back(record.frameTime);
+        summary.mean += record.frameTime;
+        cpuTotal += record.cpuTime;
+        if (record.gpuTime > 0.0f) {
+            gpuTotal += record.gpuTime;
+            gpuFrames++;
+        }
+    }
+    std::sort(scratch.begin(), scratch.end());
+
+    summary.frames = frames;
+    summary.mean /= frames;
+    summary.p50 = percentile(scratch, 50.0);
+    summary.p95 = percentile(scratch, 95.0);
+    summary.p99 = percentile(scratch, 99.0);
+    summary.max = scratch.back();
+    summary.cpuMean = cpuTotal / frames;
+    summary.gpuMean = gpuFrames > 0 ? gpuTotal / gpuFrames : 0.0;
+
+    double hitchTime = summary.p50 * hitchFactor;
+    summary.hitches = scratch.end() - std::upper_bound(scratch.begin(), scratch.end(), hitchTime);
+    return summary;
+}
+
+void REngine::FrameStats::clear() {
+    head = 0;
+    count = 0;
+}
+
+bool REngine::FrameStats::dumpCSV(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        ERROR("Failed to open frame stats file: " + path);
+        return false;
+    }
+
+    file << "frame,frame_ms,cpu_ms,gpu_ms,draw_calls,triangles,culled_nodes,texture_binds,resident_texture_bytes,texture_evictions,texture_reloads,allocations,allocated_bytes,arena_bytes";
+    for (const char* name : scopeNames) {
+        file << ",gpu_" << name << "_ms";
+    }
+    file << '\n';
+    for (size_t i = 0; i < count; i++) {
+        const FrameRecord& r = get(i);
+        file << r.frame << ',' << r.frameTime << ',' << r.cpuTime << ',' << r.gpuTime << ','
+             << r.drawCalls << ',' << r.triangles << ',' << r.culledNodes << ',' << r.textureBinds << ','
+             << r.residentTextureBytes << ',' << r.textureEvictions << ',' << r.textureReloads << ','
+             << r.allocations << ',' << r.allocatedBytes << ',' << r.arenaBytes;
+        for (size_t scope = 0; scope < scopeNames.size(); scope++) {
+            file << ',' << getGpuScopeTime(i, scope);
+        }
+        file << '\n';
+    }
+    INFO("Frame stats written to " << path);
+    return true;
+}
+
+bool REngine::FrameStats::dumpJSON(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        ERROR("Failed to open frame stats file: " + path);
+        return false;
+    }
+
+    FrameSummary s = summarize();
+    file << "{\n  \"summary\": {"
+         << "\"frames\": " << s.frames << ", \"mean_ms\": " << s.mean
+         << ", \"p50_ms\": " << s.p50 << ", \"p95_ms\": " << s.p95 << ", \"p99_ms\": " << s.p99
+         << ", \"max_ms\": " << s.max << ", \"hitches\": " << s.hitches
+         << ", \"cpu_mean_ms\": " << s.cpuMean << ", \"gpu_mean_ms\": " << s.gpuMean << ", \"gpu_scopes_mean_ms\": {";
+    for (size_t scope = 0; scope < scopeNames.size(); scope++) {
+        file << (scope ? ", " : "") << '"' << scopeNames[scope] << "\": " << getGpuScopeMean(scopeNames[scope]);
+    }
+    file << "}},\n  \"frames\": [";
+    for (size_t i = 0; i < count; i++) {
+        const FrameRecord& r = get(i);
+        file << (i ? ",\n    " : "\n    ")
+             << "{\"frame\": " << r.frame << ", \"frame_ms\": " << r.frameTime
+             << ", \"cpu_ms\": " << r.cpuTime << ", \"gpu_ms\": " << r.gpuTime
+             << ", \"draw_calls\": " << r.drawCalls << ", \"triangles\": " << r.triangles
+             << ", \"culled_nodes\": " << r.culledNodes << ", \"texture_binds\": " << r.textureBinds
+             << ", \"resident_texture_bytes\": " << r.residentTextureBytes << ", \"texture_evictions\": " << r.textureEvictions
+             << ", \"texture_reloads\": " << r.textureReloads
+             << ", \"allocations\": " << r.allocations << ", \"allocated_bytes\": " << r.allocatedBytes
+             << ", \"arena_bytes\": " << r.arenaBytes
+             << ", \"gpu_scopes_ms\": {";
+        for (size_t scope = 0; scope < scopeNames.size(); scope++) {
+            file << (scope ? ", " : "") << '"' << scopeNames[scope] << "\": " << getGpuScopeTime(i, scope);
+        }
+        file << "}}";
+    }
+    file << "\n  ]\n}\n";
+    INFO("Frame stats written to " << path);
+    return true;
+}
@@ -0,0 +1,103 @@
+#include "FrameSync.h"
+
+#include <SDL.h>
+#include <glm/glm.hpp>
+
+#include "Logging.h"
+
+REngine::FrameSync::FrameSync(int framesInFlight)
+    : framesInFlight(1), slot(0), frameNumber(0), lastGpuEnd(0), resolvedFrameNumber(0),
+      fenceWaitTime(0.0), gpuIdleTime(0.0), gpuFrameTime(0.0) {
+    for (int i = 0; i < FRAMES_IN_FLIGHT_MAX; i++) {
+        fences[i] = nullptr;
+        slotFrames[i] = 0;
+    }
+    glGenQueries(FRAMES_IN_FLIGHT_MAX, beginQueries);
+    glGenQueries(FRAMES_IN_FLIGHT_MAX, endQueries);
+    setFramesInFlight(framesInFlight);
+}
+
+REngine::FrameSync::~FrameSync() {
+    waitIdle();
+    glDeleteQueries(FRAMES_IN_FLIGHT_MAX, beginQueries);
+    glDeleteQueries(FRAMES_IN_FLIGHT_MAX, endQueries);
+}
+
+void REngine::FrameSync::setFramesInFlight(int count) {
+    int clamped = glm::clamp(count, 1, FRAMES_IN_FLIGHT_MAX);
+    if (clamped != count) {
+        WARN("Frames in flight clamped to " << clamped);
+    }
+    // Слоты переназначаются, поэтому все кадры в полёте должны завершиться
+    waitIdle();
+    framesInFlight = clamped;
+    DEBUG("Frames in flight: " << framesInFlight);
+}
+
+void REngine::FrameSync::beginFrame() {
+    slot = frameNumber % framesInFlight;
+
+    Uint64 waitStart = SDL_GetPerformanceCounter();
+    resolveSlot(slot);
+    fenceWaitTime = (SDL_GetPerformanceCounter() - waitStart) * 1000.0 / SDL_GetPerformanceFrequency();
+
+    glQueryCounter(beginQueries[slot], GL_TIMESTAMP);
+}
+
+void REngine::FrameSync::endFrame() {
+    glQueryCounter(endQueries[slot], GL_TIMESTAMP);
+    fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slotFrames[slot] = frameNumber;
+    frameNumber++;
+}
+
+void REngine::FrameSync::waitIdle() {
+    while (resolveOldest()) {
+    }
+}
+
+bool REngine::FrameSync::resolveOldest() {
+    // Ожидаются все барьеры кольца независимо от текущего слота, старые кадры разрешаются первыми
+    int oldest = -1;
+    for (int i = 0; i < FRAMES_IN_FLIGHT_MAX; i++) {
+        if (fences[i] && (oldest < 0 || slotFrames[i] < slotFrames[oldest])) {
+            oldest = i;
+        }
+    }
+    if (oldest < 0) {
+        return false;
+    }
+    resolveSlot(oldest);
+    return true;
+}
+
+void REngine::FrameSync::resolveSlot(int index) {
+    if (!fences[index]) {
+        return;
+    }
+
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true) {
+        GLenum result = glClientWaitSync(fences[index], flags, 1000000000);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+            break;
+        }
+        if (result == GL_WAIT_FAILED) {
+            ERROR("Frame fence wait failed");
+            break;
+        }
+        flags = 0;
+    }
+    glDeleteSync(fences[index]);
+    fences[index] = nullptr;
+
+    // Барьер пройден, поэтому результаты запросов уже доступны без ожидания
+    GLuint64 gpuBegin = 0, gpuEnd = 0;
+    glGetQueryObjectui64v(beginQueries[index], GL_QUERY_RESULT, &gpuBegin);
+    glGetQueryObjectui64v(endQueries[index], GL_QUERY_RESULT, &gpuEnd);
+
+    gpuFrameTime = gpuEnd > gpuBegin ? (gpuEnd - gpuBegin) / 1000000.0 : 0.0;
+    gpuIdleTime = (lastGpuEnd != 0 && gpuBegin > lastGpuEnd) ? (gpuBegin - lastGpuEnd) / 1000000.0 : 0.0;
+    lastGpuEnd = gpuEnd;
+    resolvedFrameNumber = slotFrames[index];
+}
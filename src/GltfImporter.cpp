@@ -0,0 +1,816 @@
+#include "GltfImporter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Logging.h"
+
+// Значение JSON, у объекта ключи в keys и значения в items
+struct JsonValue {
+    enum Type { Null, Bool, Number, String, Array, Object } type = Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<std::string> keys;
+    std::vector<JsonValue> items;
+
+    const JsonValue* find(const char* key) const {
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i] == key) {
+                return &items[i];
+            }
+        }
+        return nullptr;
+    }
+};
+
+// Читатель JSON, ошибка останавливает разбор
+struct JsonReader {
+    const char* p;
+    const char* end;
+};
+
+static void skipWhitespace(JsonReader& reader) {
+    while (reader.p < reader.end && (*reader.p == ' ' || *reader.p == '\t' || *reader.p == '\n' || *reader.p == '\r')) {
+        reader.p++;
+    }
+}
+
+static void appendUtf8(std::string& output, uint32_t code) {
+    if (code < 0x80) {
+        output += (char)code;
+    } else if (code < 0x800) {
+        output += (char)(0xC0 | (code >> 6));
+        output += (char)(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        output += (char)(0xE0 | (code >> 12));
+        output += (char)(0x80 | ((code >> 6) & 0x3F));
+        output += (char)(0x80 | (code & 0x3F));
+    } else {
+        output += (char)(0xF0 | (code >> 18));
+        output += (char)(0x80 | ((code >> 12) & 0x3F));
+        output += (char)(0x80 | ((code >> 6) & 0x3F));
+        output += (char)(0x80 | (code & 0x3F));
+    }
+}
+
+static bool parseHex4(JsonReader& reader, uint32_t& code) {
+    if (reader.end - reader.p < 4) {
+        return false;
+    }
+    auto result = std::from_chars(reader.p, reader.p + 4, code, 16);
+    if (result.ptr != reader.p + 4) {
+        return false;
+    }
+    reader.p += 4;
+    return true;
+}
+
+static bool parseJsonString(JsonReader& reader, std::string& output) {
+    reader.p++;
+    while (reader.p < reader.end && *reader.p != '"') {
+        char c = *reader.p++;
+        if (c != '\\') {
+            output += c;
+            continue;
+        }
+        if (reader.p >= reader.end) {
+            return false;
+        }
+        char escape = *reader.p++;
+        switch (escape) {
+        case '"': case '\\': case '/': output += escape; break;
+        case 'b': output += '\b'; break;
+        case 'f': output += '\f'; break;
+        case 'n': output += '\n'; break;
+        case 'r': output += '\r'; break;
+        case 't': output += '\t'; break;
+        case 'u': {
+            uint32_t code;
+            if (!parseHex4(reader, code)) {
+                return false;
+            }
+            // Символ вне базовой плоскости записывается суррогатной парой
+            uint32_t low;
+            if (code >= 0xD800 && code < 0xDC00 && reader.end - reader.p >= 2 && reader.p[0] == '\\' && reader.p[1] == 'u') {
+                reader.p += 2;
+                if (!parseHex4(reader, low) || low < 0xDC00 || low >= 0xE000) {
+                    return false;
+                }
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            appendUtf8(output, code);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    if (reader.p >= reader.end) {
+        return false;
+    }
+    reader.p++;
+    return true;
+}
+
+static bool parseJsonValue(JsonReader& reader, JsonValue& value, int depth) {
+    if (depth > GLTF_DEPTH_MAX) {
+        return false;
+    }
+    skipWhitespace(reader);
+    if (reader.p >= reader.end) {
+        return false;
+    }
+    auto literal = [&](const char* text) {
+        size_t length = std::strlen(text);
+        if ((size_t)(reader.end - reader.p) < length || std::memcmp(reader.p, text, length) != 0) {
+            return false;
+        }
+        reader.p += length;
+        return true;
+    };
+    char c = *reader.p;
+    if (c == '{' || c == '[') {
+        bool object = c == '{';
+        value.type = object ? JsonValue::Object : JsonValue::Array;
+        reader.p++;
+        skipWhitespace(reader);
+        if (reader.p < reader.end && *reader.p == (object ? '}' : ']')) {
+            reader.p++;
+            return true;
+        }
+        while (true) {
+            if (object) {
+                skipWhitespace(reader);
+                if (reader.p >= reader.end || *reader.p != '"') {
+                    return false;
+                }
+                value.keys.emplace_back();
+                if (!parseJsonString(reader, value.keys.back())) {
+                    return false;
+                }
+                skipWhitespace(reader);
+                if (reader.p >= reader.end || *reader.p != ':') {
+                    return false;
+                }
+                reader.p++;
+            }
+            value.items.emplace_back();
+            if (!parseJsonValue(reader, value.items.back(), depth + 1)) {
+                return false;
+            }
+            skipWhitespace(reader);
+            if (reader.p >= reader.end) {
+                return false;
+            }
+            if (*reader.p == ',') {
+                reader.p++;
+            } else if (*reader.p == (object ? '}' : ']')) {
+                reader.p++;
+                return true;
+            } else {
+                return false;
+            }
+        }
+    }
+    if (c == '"') {
+        value.type = JsonValue::String;
+        return parseJsonString(reader, value.string);
+    }
+    if (c == 't' || c == 'f') {
+        value.type = JsonValue::Bool;
+        value.boolean = c == 't';
+        return literal(value.boolean ? "true" : "false");
+    }
+    if (c == 'n') {
+        return literal("null");
+    }
+    value.type = JsonValue::Number;
+    auto result = std::from_chars(reader.p, reader.end, value.number);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    reader.p = result.ptr;
+    return true;
+}
+
+static double getNumber(const JsonValue& object, const char* key, double fallback) {
+    const JsonValue* value = object.find(key);
+    return value && value->type == JsonValue::Number ? value->number : fallback;
+}
+
+static int getIndex(const JsonValue& object, const char* key) {
+    double value = getNumber(object, key, -1.0);
+    return value >= 0.0 && value < INT32_MAX ? (int)value : -1;
+}
+
+static std::string getString(const JsonValue& object, const char* key) {
+    const JsonValue* value = object.find(key);
+    return value && value->type == JsonValue::String ? value->string : "";
+}
+
+// Элемент массива верхнего уровня, например accessors[index]
+static const JsonValue* getElement(const JsonValue& root, const char* key, int index) {
+    const JsonValue* array = root.find(key);
+    if (!array || array->type != JsonValue::Array || index < 0 || (size_t)index >= array->items.size() ||
+        array->items[index].type != JsonValue::Object) {
+        return nullptr;
+    }
+    return &array->items[index];
+}
+
+// Чтение до count чисел из массива, остальные значения не меняются
+static size_t getNumbers(const JsonValue& object, const char* key, float* values, size_t count) {
+    const JsonValue* array = object.find(key);
+    if (!array || array->type != JsonValue::Array) {
+        return 0;
+    }
+    size_t i = 0;
+    for (; i < count && i < array->items.size() && array->items[i].type == JsonValue::Number; i++) {
+        values[i] = (float)array->items[i].number;
+    }
+    return i;
+}
+
+static std::string getDirectory(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+// Данные accessor: элемент i начинается с data + i * stride
+struct GltfAccessor {
+    const unsigned char* data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;
+    int bufferView = -1;
+    size_t offset = 0;
+    int componentType = 0;
+    int components = 0;
+    bool normalized = false;
+};
+
+static int getComponentSize(int componentType) {
+    switch (componentType) {
+    case 5120: case 5121: return 1;
+    case 5122: case 5123: return 2;
+    case 5125: case 5126: return 4;
+    default: return 0;
+    }
+}
+
+static int getComponentCount(const std::string& type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    return 0;
+}
+
+// Разбор accessor с проверкой границ, буфер 0 это двоичный фрагмент GLB
+static bool getAccessor(const JsonValue& root, int index, const unsigned char* bin, size_t binSize, GltfAccessor& accessor) {
+    const JsonValue* json = getElement(root, "accessors", index);
+    if (!json) {
+        ERROR("Invalid glTF accessor " << index);
+        return false;
+    }
+    if (json->find("sparse")) {
+        ERROR("Sparse glTF accessors are not supported");
+        return false;
+    }
+    accessor.bufferView = getIndex(*json, "bufferView");
+    const JsonValue* view = getElement(root, "bufferViews", accessor.bufferView);
+    accessor.componentType = getIndex(*json, "componentType");
+    accessor.components = getComponentCount(getString(*json, "type"));
+    const JsonValue* normalized = json->find("normalized");
+    accessor.normalized = normalized && normalized->type == JsonValue::Bool && normalized->boolean;
+    double count = getNumber(*json, "count", -1.0), offset = getNumber(*json, "byteOffset", 0.0);
+    int componentSize = getComponentSize(accessor.componentType);
+    if (!view || componentSize == 0 || accessor.components == 0 || count < 0.0 || offset < 0.0) {
+        ERROR("Invalid glTF accessor " << index);
+        return false;
+    }
+    if (getIndex(*view, "buffer") != 0 || !bin) {
+        ERROR("External glTF buffers are not supported");
+        return false;
+    }
+    double viewOffset = getNumber(*view, "byteOffset", 0.0), viewLength = getNumber(*view, "byteLength", -1.0);
+    double stride = getNumber(*view, "byteStride", 0.0);
+    if (viewOffset < 0.0 || viewLength < 0.0 || viewOffset + viewLength > (double)binSize || stride < 0.0) {
+        ERROR("Invalid glTF buffer view " << accessor.bufferView);
+        return false;
+    }
+    size_t elementSize = (size_t)componentSize * accessor.components;
+    accessor.count = (size_t)count;
+    accessor.offset = (size_t)offset;
+    accessor.stride = stride > 0.0 ? (size_t)stride : elementSize;
+    if (accessor.count > 0 && (double)accessor.offset + (double)accessor.stride * (accessor.count - 1) + elementSize > viewLength) {
+        ERROR("glTF accessor " << index << " is out of bounds");
+        return false;
+    }
+    accessor.data = bin + (size_t)viewOffset + accessor.offset;
+    return true;
+}
+
+// Чтение компонента как числа с плавающей точкой с учётом нормализации
+static float readFloat(const GltfAccessor& accessor, size_t i, int c) {
+    const unsigned char* p = accessor.data + i * accessor.stride + (size_t)c * getComponentSize(accessor.componentType);
+    switch (accessor.componentType) {
+    case 5120: {
+        int8_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return accessor.normalized ? std::max(value / 127.0f, -1.0f) : value;
+    }
+    case 5121:
+        return accessor.normalized ? *p / 255.0f : *p;
+    case 5122: {
+        int16_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return accessor.normalized ? std::max(value / 32767.0f, -1.0f) : value;
+    }
+    case 5123: {
+        uint16_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return accessor.normalized ? value / 65535.0f : value;
+    }
+    case 5125: {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return (float)value;
+    }
+    default: {
+        float value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    }
+}
+
+static unsigned readIndex(const GltfAccessor& accessor, size_t i) {
+    const unsigned char* p = accessor.data + i * accessor.stride;
+    if (accessor.componentType == 5121) {
+        return *p;
+    }
+    if (accessor.componentType == 5123) {
+        uint16_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Вершины уже в формате сетки, если координаты, нормаль и UV в одном buffer view с шагом 8 float друг за другом
+static bool isEngineLayout(const GltfAccessor& position, const GltfAccessor* normal, const GltfAccessor* texcoord) {
+    if (!normal || !texcoord) {
+        return false;
+    }
+    return position.componentType == 5126 && normal->componentType == 5126 && texcoord->componentType == 5126 &&
+           position.components == 3 && normal->components == 3 && texcoord->components == 2 &&
+           position.bufferView == normal->bufferView && position.bufferView == texcoord->bufferView &&
+           position.stride == 8 * sizeof(float) && normal->stride == position.stride && texcoord->stride == position.stride &&
+           normal->offset == position.offset + 3 * sizeof(float) && texcoord->offset == position.offset + 6 * sizeof(float) &&
+           normal->count == position.count && texcoord->count == position.count &&
+           (uintptr_t)position.data % alignof(float) == 0;
+}
+
+static bool parsePrimitive(const JsonValue& root, const JsonValue& json, const unsigned char* bin, size_t binSize,
+                           REngine::GltfPrimitive& primitive) {
+    const JsonValue* attributes = json.find("attributes");
+    GltfAccessor position, normal, texcoord;
+    if (!attributes || !getAccessor(root, getIndex(*attributes, "POSITION"), bin, binSize, position)) {
+        return false;
+    }
+    bool hasNormal = getIndex(*attributes, "NORMAL") >= 0, hasTexcoord = getIndex(*attributes, "TEXCOORD_0") >= 0;
+    if ((hasNormal && !getAccessor(root, getIndex(*attributes, "NORMAL"), bin, binSize, normal)) ||
+        (hasTexcoord && !getAccessor(root, getIndex(*attributes, "TEXCOORD_0"), bin, binSize, texcoord))) {
+        return false;
+    }
+    if (position.components != 3 || (hasNormal && (normal.components != 3 || normal.count != position.count)) ||
+        (hasTexcoord && (texcoord.components != 2 || texcoord.count != position.count))) {
+        ERROR("Invalid glTF vertex attributes");
+        return false;
+    }
+    primitive.material = getIndex(json, "material");
+    primitive.vertexCount = position.count;
+
+    int indicesIndex = getIndex(json, "indices");
+    if (indicesIndex >= 0) {
+        GltfAccessor indices;
+        if (!getAccessor(root, indicesIndex, bin, binSize, indices)) {
+            return false;
+        }
+        int indexSize = getComponentSize(indices.componentType);
+        if (indices.components != 1 || indices.componentType == 5120 || indices.componentType == 5122 ||
+            indices.componentType == 5126) {
+            ERROR("Invalid glTF index accessor " << indicesIndex);
+            return false;
+        }
+        primitive.indexCount = indices.count - indices.count % 3;
+        for (size_t i = 0; i < primitive.indexCount; i++) {
+            if (readIndex(indices, i) >= primitive.vertexCount) {
+                ERROR("glTF index is out of range in accessor " << indicesIndex);
+                return false;
+            }
+        }
+        if (indices.stride == (size_t)indexSize && (uintptr_t)indices.data % indexSize == 0) {
+            primitive.indexData = indices.data;
+            primitive.indexSize = indexSize;
+        } else {
+            primitive.indices.resize(primitive.indexCount);
+            for (size_t i = 0; i < primitive.indexCount; i++) {
+                primitive.indices[i] = readIndex(indices, i);
+            }
+        }
+    } else {
+        primitive.indexCount = position.count - position.count % 3;
+        primitive.indices.resize(primitive.indexCount);
+        for (size_t i = 0; i < primitive.indexCount; i++) {
+            primitive.indices[i] = (unsigned)i;
+        }
+    }
+
+    if (isEngineLayout(position, hasNormal ? &normal : nullptr, hasTexcoord ? &texcoord : nullptr)) {
+        primitive.vertexData = reinterpret_cast<const float*>(position.data);
+        primitive.flipTexCoords = true;
+        return true;
+    }
+
+    primitive.vertices.assign(primitive.vertexCount * 8, 0.0f);
+    for (size_t i = 0; i < primitive.vertexCount; i++) {
+        float* vertex = &primitive.vertices[i * 8];
+        for (int c = 0; c < 3; c++) {
+            vertex[c] = readFloat(position, i, c);
+            vertex[3 + c] = hasNormal ? readFloat(normal, i, c) : 0.0f;
+        }
+        if (hasTexcoord) {
+            vertex[6] = readFloat(texcoord, i, 0);
+            vertex[7] = 1.0f - readFloat(texcoord, i, 1);
+        }
+    }
+    if (!hasNormal) {
+        // Сглаженные нормали: сумма нормалей соседних треугольников с весом по площади
+        auto index = [&](size_t i) {
+            if (!primitive.indices.empty()) {
+                return primitive.indices[i];
+            }
+            const unsigned char* p = static_cast<const unsigned char*>(primitive.indexData) + i * primitive.indexSize;
+            return primitive.indexSize == 1 ? (unsigned)*p
+                   : primitive.indexSize == 2 ? (unsigned)*reinterpret_cast<const uint16_t*>(p)
+                                              : *reinterpret_cast<const uint32_t*>(p);
+        };
+        for (size_t i = 0; i < primitive.indexCount; i += 3) {
+            float* v[3];
+            for (int k = 0; k < 3; k++) {
+                v[k] = &primitive.vertices[(size_t)index(i + k) * 8];
+            }
+            float e1[3], e2[3];
+            for (int c = 0; c < 3; c++) {
+                e1[c] = v[1][c] - v[0][c];
+                e2[c] = v[2][c] - v[0][c];
+            }
+            float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            for (int k = 0; k < 3; k++) {
+                for (int c = 0; c < 3; c++) {
+                    v[k][3 + c] += n[c];
+                }
+            }
+        }
+        for (size_t i = 0; i < primitive.vertices.size(); i += 8) {
+            float* n = &primitive.vertices[i + 3];
+            float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (length > 0.0f) {
+                n[0] /= length;
+                n[1] /= length;
+                n[2] /= length;
+            }
+        }
+    }
+    return true;
+}
+
+static std::string decodeUri(const std::string& uri) {
+    std::string result;
+    for (size_t i = 0; i < uri.size(); i++) {
+        unsigned value;
+        if (uri[i] == '%' && i + 2 < uri.size() &&
+            std::from_chars(uri.data() + i + 1, uri.data() + i + 3, value, 16).ptr == uri.data() + i + 3) {
+            result += (char)value;
+            i += 2;
+        } else {
+            result += uri[i];
+        }
+    }
+    return result;
+}
+
+// Путь к изображению текстуры из объекта textureInfo
+static std::string getTexturePath(const JsonValue& root, const JsonValue* info, const std::string& directory) {
+    if (!info || info->type != JsonValue::Object) {
+        return "";
+    }
+    const JsonValue* texture = getElement(root, "textures", getIndex(*info, "index"));
+    const JsonValue* image = texture ? getElement(root, "images", getIndex(*texture, "source")) : nullptr;
+    if (!image) {
+        WARN("Invalid glTF texture reference");
+        return "";
+    }
+    std::string uri = getString(*image, "uri");
+    if (uri.empty() || uri.compare(0, 5, "data:") == 0) {
+        WARN("Embedded glTF images are not supported");
+        return "";
+    }
+    return directory + decodeUri(uri);
+}
+
+static REngine::GltfMaterial parseMaterial(const JsonValue& root, const JsonValue& json, const std::string& directory) {
+    REngine::GltfMaterial material;
+    material.name = getString(json, "name");
+    float roughness = 1.0f;
+    if (const JsonValue* pbr = json.find("pbrMetallicRoughness")) {
+        material.texturePath = getTexturePath(root, pbr->find("baseColorTexture"), directory);
+        roughness = (float)getNumber(*pbr, "roughnessFactor", 1.0);
+    }
+    const JsonValue* extensions = json.find("extensions");
+    if (const JsonValue* specular = extensions ? extensions->find("KHR_materials_specular") : nullptr) {
+        material.specularPath = getTexturePath(root, specular->find("specularColorTexture"), directory);
+    }
+    // Приближение Блинна-Фонга для распределения GGX с той же шероховатостью
+    float alpha = roughness * roughness;
+    material.shininess = std::min(std::max(2.0f / std::max(alpha * alpha, 1e-4f) - 2.0f, 1.0f), 256.0f);
+    return material;
+}
+
+static glm::mat4 parseTransform(const JsonValue& json) {
+    float matrix[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    if (getNumbers(json, "matrix", matrix, 16) == 16) {
+        return glm::make_mat4(matrix);
+    }
+    float translation[3] = {0, 0, 0}, rotation[4] = {0, 0, 0, 1}, scale[3] = {1, 1, 1};
+    getNumbers(json, "translation", translation, 3);
+    getNumbers(json, "rotation", rotation, 4);
+    getNumbers(json, "scale", scale, 3);
+    glm::mat4 result = glm::translate(glm::mat4(1.0f), glm::vec3(translation[0], translation[1], translation[2]));
+    result = result * glm::mat4_cast(glm::quat(rotation[3], rotation[0], rotation[1], rotation[2]));
+    return glm::scale(result, glm::vec3(scale[0], scale[1], scale[2]));
+}
+
+bool REngine::GltfImporter::parse(const unsigned char* data, size_t size, const std::string& directory, GltfModel& model) {
+    uint32_t header[3], jsonHeader[2];
+    if (size < sizeof(header) + sizeof(jsonHeader)) {
+        ERROR("glTF file is too small");
+        return false;
+    }
+    std::memcpy(header, data, sizeof(header));
+    std::memcpy(jsonHeader, data + sizeof(header), sizeof(jsonHeader));
+    if (header[0] != GLB_MAGIC || header[1] != GLB_VERSION || header[2] > size) {
+        ERROR("Invalid GLB header");
+        return false;
+    }
+    size = header[2];
+    size_t jsonOffset = sizeof(header) + sizeof(jsonHeader);
+    if (jsonHeader[1] != GLB_CHUNK_JSON || jsonHeader[0] > size - jsonOffset) {
+        ERROR("Invalid GLB JSON chunk");
+        return false;
+    }
+    const unsigned char* bin = nullptr;
+    size_t binSize = 0;
+    size_t binOffset = jsonOffset + jsonHeader[0];
+    if (size - binOffset >= 8) {
+        uint32_t binHeader[2];
+        std::memcpy(binHeader, data + binOffset, sizeof(binHeader));
+        if (binHeader[1] == GLB_CHUNK_BIN) {
+            if (binHeader[0] > size - binOffset - 8) {
+                ERROR("Invalid GLB binary chunk");
+                return false;
+            }
+            bin = data + binOffset + 8;
+            binSize = binHeader[0];
+        }
+    }
+
+    JsonValue root;
+    JsonReader reader = {reinterpret_cast<const char*>(data + jsonOffset), reinterpret_cast<const char*>(data + binOffset)};
+    if (!parseJsonValue(reader, root, 0) || root.type != JsonValue::Object) {
+        ERROR("Invalid glTF JSON at offset " << (reader.p - reinterpret_cast<const char*>(data)));
+        return false;
+    }
+    const JsonValue* asset = root.find("asset");
+    if (!asset || getString(*asset, "version").compare(0, 2, "2.") != 0) {
+        ERROR("Unsupported glTF version");
+        return false;
+    }
+    // Буфер 0 без uri это двоичный фрагмент, фрагмент может быть длиннее из-за выравнивания
+    const JsonValue* buffer = getElement(root, "buffers", 0);
+    if (!buffer || buffer->find("uri")) {
+        bin = nullptr;
+    } else if (getNumber(*buffer, "byteLength", 0.0) > (double)binSize) {
+        ERROR("glTF buffer 0 is longer than the binary chunk");
+        return false;
+    }
+
+    const JsonValue* meshes = root.find("meshes");
+    for (size_t m = 0; meshes && meshes->type == JsonValue::Array && m < meshes->items.size(); m++) {
+        const JsonValue& json = meshes->items[m];
+        GltfMesh mesh;
+        mesh.name = getString(json, "name");
+        const JsonValue* primitives = json.find("primitives");
+        for (size_t p = 0; primitives && primitives->type == JsonValue::Array && p < primitives->items.size(); p++) {
+            const JsonValue& primitive = primitives->items[p];
+            if (getNumber(primitive, "mode", 4.0) != 4.0) {
+                WARN("Skipping glTF primitive that is not a triangle list in mesh " << m);
+                continue;
+            }
+            mesh.primitives.emplace_back();
+            if (!parsePrimitive(root, primitive, bin, binSize, mesh.primitives.back())) {
+                return false;
+            }
+        }
+        model.meshes.push_back(std::move(mesh));
+    }
+
+    const JsonValue* materials = root.find("materials");
+    for (size_t i = 0; materials && materials->type == JsonValue::Array && i < materials->items.size(); i++) {
+        model.materials.push_back(parseMaterial(root, materials->items[i], directory));
+    }
+    for (GltfMesh& mesh : model.meshes) {
+        for (GltfPrimitive& primitive : mesh.primitives) {
+            if (primitive.material >= (int)model.materials.size()) {
+                primitive.material = -1;
+            }
+        }
+    }
+
+    const JsonValue* nodes = root.find("nodes");
+    std::vector<bool> hasParent;
+    for (size_t i = 0; nodes && nodes->type == JsonValue::Array && i < nodes->items.size(); i++) {
+        const JsonValue& json = nodes->items[i];
+        GltfNode node;
+        node.name = getString(json, "name");
+        node.mesh = getIndex(json, "mesh");
+        if (node.mesh >= (int)model.meshes.size()) {
+            node.mesh = -1;
+        }
+        node.local = parseTransform(json);
+        const JsonValue* children = json.find("children");
+        for (size_t c = 0; children && children->type == JsonValue::Array && c < children->items.size(); c++) {
+            double child = children->items[c].number;
+            if (children->items[c].type != JsonValue::Number || child < 0.0 || child >= (double)nodes->items.size()) {
+                ERROR("Invalid glTF child node in node " << i);
+                return false;
+            }
+            node.children.push_back((int)child);
+        }
+        model.nodes.push_back(std::move(node));
+    }
+    hasParent.assign(model.nodes.size(), false);
+    for (const GltfNode& node : model.nodes) {
+        for (int child : node.children) {
+            hasParent[child] = true;
+        }
+    }
+
+    const JsonValue* scene = getElement(root, "scenes", std::max(getIndex(root, "scene"), 0));
+    if (scene) {
+        const JsonValue* sceneNodes = scene->find("nodes");
+        for (size_t i = 0; sceneNodes && sceneNodes->type == JsonValue::Array && i < sceneNodes->items.size(); i++) {
+            double index = sceneNodes->items[i].number;
+            if (sceneNodes->items[i].type == JsonValue::Number && index >= 0.0 && index < (double)model.nodes.size()) {
+                model.roots.push_back((int)index);
+            }
+        }
+    } else {
+        for (size_t i = 0; i < model.nodes.size(); i++) {
+            if (!hasParent[i]) {
+                model.roots.push_back((int)i);
+            }
+        }
+    }
+
+    // Обход от корней, узел дважды означает цикл или общий дочерний узел, что glTF запрещает
+    std::vector<bool> visited(model.nodes.size(), false);
+    std::vector<int> stack(model.roots.rbegin(), model.roots.rend());
+    for (int root : model.roots) {
+        model.nodes[root].world = model.nodes[root].local;
+    }
+    while (!stack.empty()) {
+        int index = stack.back();
+        stack.pop_back();
+        if (visited[index]) {
+            ERROR("glTF node " << index << " has more than one parent");
+            return false;
+        }
+        visited[index] = true;
+        GltfNode& node = model.nodes[index];
+        for (auto it = node.children.rbegin(); it != node.children.rend(); ++it) {
+            model.nodes[*it].world = node.world * model.nodes[*it].local;
+            stack.push_back(*it);
+        }
+    }
+    return true;
+}
+
+bool REngine::GltfImporter::parse(const std::string& path, GltfModel& model) {
+    if (!model.file.open(path)) {
+        ERROR("Failed to open glTF file: " + path);
+        return false;
+    }
+    if (!parse(model.file.data(), model.file.size(), getDirectory(path), model)) {
+        ERROR("Failed to import glTF file: " + path);
+        return false;
+    }
+    return true;
+}
+
+void REngine::GltfImporter::decompose(const glm::mat4& matrix, SceneNode& node) {
+    node.position = glm::vec3(matrix[3][0], matrix[3][1], matrix[3][2]);
+    glm::vec3 axes[3];
+    for (int i = 0; i < 3; i++) {
+        axes[i] = glm::vec3(matrix[i][0], matrix[i][1], matrix[i][2]);
+        node.scale[i] = glm::length(axes[i]);
+    }
+    // Отражение переносится в масштаб по X, чтобы остаток был поворотом
+    if (glm::dot(glm::cross(axes[0], axes[1]), axes[2]) < 0.0f) {
+        node.scale.x = -node.scale.x;
+    }
+    for (int i = 0; i < 3; i++) {
+        if (node.scale[i] != 0.0f) {
+            axes[i] = axes[i] * (1.0f / node.scale[i]);
+        }
+    }
+    // Поворот Rx * Ry * Rz, axes[столбец][строка]
+    float x, y, z;
+    y = std::asin(std::min(std::max(axes[2][0], -1.0f), 1.0f));
+    if (std::abs(axes[2][0]) < 0.9999f) {
+        x = std::atan2(-axes[2][1], axes[2][2]);
+        z = std::atan2(-axes[1][0], axes[0][0]);
+    } else {
+        x = std::atan2(axes[1][2], axes[1][1]);
+        z = 0.0f;
+    }
+    node.rotation = glm::vec3(glm::degrees(x), glm::degrees(y), glm::degrees(z));
+}
+
+REngine::GltfImporter::~GltfImporter() {
+    for (Mesh* mesh : meshes) {
+        delete mesh;
+    }
+}
+
+bool REngine::GltfImporter::load(const std::string& path, Scene& scene) {
+    GltfModel model;
+    if (!parse(path, model)) {
+        return false;
+    }
+    // Сетка создаётся при первом узле, который на неё ссылается
+    std::vector<std::vector<Mesh*>> created(model.meshes.size());
+    size_t direct = 0, primitiveCount = 0, objectCount = 0;
+    std::vector<int> stack(model.roots.rbegin(), model.roots.rend());
+    while (!stack.empty()) {
+        const GltfNode& node = model.nodes[stack.back()];
+        stack.pop_back();
+        stack.insert(stack.end(), node.children.rbegin(), node.children.rend());
+        if (node.mesh < 0) {
+            continue;
+        }
+        const GltfMesh& mesh = model.meshes[node.mesh];
+        if (created[node.mesh].empty()) {
+            for (const GltfPrimitive& primitive : mesh.primitives) {
+                const float* vertices = primitive.vertexData ? primitive.vertexData : primitive.vertices.data();
+                const void* indices = primitive.indexData ? primitive.indexData : primitive.indices.data();
+                unsigned int indexType = !primitive.indexData || primitive.indexSize == 4 ? GL_UNSIGNED_INT
+                                         : primitive.indexSize == 2                       ? GL_UNSIGNED_SHORT
+                                                                                          : GL_UNSIGNED_BYTE;
+                meshes.push_back(new Mesh(vertices, primitive.vertexCount, indices, primitive.indexCount, indexType,
+                                          primitive.flipTexCoords));
+                direct += primitive.vertexData != nullptr;
+                primitiveCount++;
+            }
+            created[node.mesh].assign(meshes.end() - mesh.primitives.size(), meshes.end());
+        }
+        for (size_t p = 0; p < mesh.primitives.size(); p++) {
+            SceneNode object;
+            object.mesh = created[node.mesh][p];
+            decompose(node.world, object);
+            if (mesh.primitives[p].material >= 0) {
+                const GltfMaterial& material = model.materials[mesh.primitives[p].material];
+                object.texturePath = material.texturePath;
+                object.specularPath = material.specularPath;
+                object.shininess = material.shininess;
+            }
+            scene.nodes.push_back(object);
+            objectCount++;
+        }
+    }
+    DEBUG("Imported " << path << ": " << primitiveCount << " meshes (" << direct << " without conversion), " << objectCount
+                      << " objects, " << model.materials.size() << " materials");
+    return true;
+}
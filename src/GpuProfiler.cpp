@@ -0,0 +1,132 @@
+#include "GpuProfiler.h"
+
+#include <cstring>
+
+#include "Logging.h"
+
+REngine::GpuProfiler::GpuProfiler() {
+    for (FrameQueries& queries : frames) {
+        glGenQueries(GPU_PROFILER_SCOPES_MAX * 2, queries.queries);
+    }
+    results.reserve(GPU_PROFILER_SCOPES_MAX);
+}
+
+REngine::GpuProfiler::~GpuProfiler() {
+    for (FrameQueries& queries : frames) {
+        glDeleteQueries(GPU_PROFILER_SCOPES_MAX * 2, queries.queries);
+    }
+}
+
+void REngine::GpuProfiler::beginFrame(unsigned long frame) {
+    resolve();
+
+    current = (current + 1) % GPU_PROFILER_LATENCY;
+    FrameQueries& queries = frames[current];
+    if (queries.pending) {
+        // Результаты так и не стали готовы, ждать их означало бы остановить CPU
+        queries.pending = false;
+        droppedFrames++;
+    }
+    queries.frame = frame;
+    queries.scopeCount = 0;
+    depth = 0;
+    inFrame = true;
+}
+
+void REngine::GpuProfiler::endFrame() {
+    if (!inFrame) {
+        return;
+    }
+    inFrame = false;
+    frames[current].pending = frames[current].scopeCount > 0;
+}
+
+int REngine::GpuProfiler::beginScope(const char* name) {
+    if (!inFrame) {
+        return -1;
+    }
+    FrameQueries& queries = frames[current];
+    if (queries.scopeCount >= GPU_PROFILER_SCOPES_MAX) {
+        if (!scopesDropped) {
+            WARN("GPU scope " << name << " dropped: more than " << GPU_PROFILER_SCOPES_MAX << " scopes in frame");
+            scopesDropped = true;
+        }
+        return -1;
+    }
+
+    int index = queries.scopeCount++;
+    queries.names[index] = name;
+    queries.depths[index] = depth++;
+    queries.lastQuery = queries.queries[index * 2];
+    glQueryCounter(queries.lastQuery, GL_TIMESTAMP);
+    return index;
+}
+
+void REngine::GpuProfiler::endScope(int index) {
+    if (!inFrame || index < 0) {
+        return;
+    }
+    FrameQueries& queries = frames[current];
+    depth--;
+    queries.lastQuery = queries.queries[index * 2 + 1];
+    glQueryCounter(queries.lastQuery, GL_TIMESTAMP);
+}
+
+bool REngine::GpuProfiler::consumeResults() {
+    if (readyCount == 0) {
+        return false;
+    }
+    const ResolvedFrame& resolved = ready[readyStart];
+    results.assign(resolved.scopes, resolved.scopes + resolved.scopeCount);
+    resolvedFrame = resolved.frame;
+    readyStart = (readyStart + 1) % GPU_PROFILER_LATENCY;
+    readyCount--;
+    return true;
+}
+
+double REngine::GpuProfiler::getScopeTime(const char* name) const {
+    double time = 0.0;
+    for (const GpuScopeResult& result : results) {
+        if (std::strcmp(result.name, name) == 0) {
+            time += result.time;
+        }
+    }
+    return time;
+}
+
+void REngine::GpuProfiler::resolve() {
+    // Кадры проверяются от самого старого, запросы завершаются по порядку
+    for (int i = 1; i <= GPU_PROFILER_LATENCY; i++) {
+        FrameQueries& queries = frames[(current + i + GPU_PROFILER_LATENCY) % GPU_PROFILER_LATENCY];
+        if (queries.pending && !tryResolve(queries)) {
+            return;
+        }
+    }
+}
+
+bool REngine::GpuProfiler::tryResolve(FrameQueries& queries) {
+    GLint available = 0;
+    glGetQueryObjectiv(queries.lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return false;
+    }
+
+    if (readyCount == GPU_PROFILER_LATENCY) {
+        // Вызывающая сторона не забирает результаты, самый старый кадр вытесняется
+        readyStart = (readyStart + 1) % GPU_PROFILER_LATENCY;
+        readyCount--;
+        droppedFrames++;
+    }
+    ResolvedFrame& resolved = ready[(readyStart + readyCount) % GPU_PROFILER_LATENCY];
+    readyCount++;
+    resolved.frame = queries.frame;
+    resolved.scopeCount = queries.scopeCount;
+    for (int i = 0; i < queries.scopeCount; i++) {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(queries.queries[i * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(queries.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+        resolved.scopes[i] = {queries.names[i], queries.depths[i], end > begin ? (end - begin) / 1000000.0 : 0.0};
+    }
+    queries.pending = false;
+    return true;
+}
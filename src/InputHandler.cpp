@@ -1,5 +1,152 @@
 #include "InputHandler.h"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
 #include "Logging.h"
+#include "Profiler.h"
+
+// Формат записи ввода: заголовок, затем записи, начинающиеся с байта типа.
+// Значения хранятся в порядке байт платформы
+#define INPUT_RECORD_MAGIC "RINP"
+#define INPUT_RECORD_VERSION 1
+#define INPUT_RECORD_FLUSH_SIZE (64 * 1024)
+
+enum InputRecordTag : Uint8 {
+    INPUT_TAG_FRAME,  // float время кадра
+    INPUT_TAG_KEY_DOWN,  // Uint32 время события, Sint32 код клавиши
+    INPUT_TAG_KEY_UP,
+    INPUT_TAG_MOUSE_MOTION,  // Uint32 время события, Sint16 x, y, xrel, yrel
+    INPUT_TAG_MOUSE_BUTTON_DOWN,  // Uint32 время события, Uint8 кнопка, Sint16 x, y
+    INPUT_TAG_MOUSE_BUTTON_UP,
+    INPUT_TAG_MOUSE_WHEEL  // Uint32 время события, Sint16 x, y
+};
+
+static bool recording = false;
+static std::ofstream recordFile;
+static std::vector<unsigned char> recordBuffer;
+
+static bool replaying = false;
+static std::vector<unsigned char> replayBuffer;
+static size_t replayOffset = 0;
+
+template <typename T>
+static void put(T value) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+    recordBuffer.insert(recordBuffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static bool get(T& value) {
+    if (replayOffset + sizeof(T) > replayBuffer.size()) {
+        return false;
+    }
+    std::memcpy(&value, replayBuffer.data() + replayOffset, sizeof(T));
+    replayOffset += sizeof(T);
+    return true;
+}
+
+static void flushRecording() {
+    recordFile.write(reinterpret_cast<const char*>(recordBuffer.data()), recordBuffer.size());
+    recordBuffer.clear();
+}
+
+static void recordEvent(const SDL_Event& event) {
+    switch (event.type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            put<Uint8>(event.type == SDL_KEYDOWN ? INPUT_TAG_KEY_DOWN : INPUT_TAG_KEY_UP);
+            put<Uint32>(event.common.timestamp);
+            put<Sint32>(event.key.keysym.sym);
+            break;
+        case SDL_MOUSEMOTION:
+            put<Uint8>(INPUT_TAG_MOUSE_MOTION);
+            put<Uint32>(event.common.timestamp);
+            put<Sint16>(event.motion.x);
+            put<Sint16>(event.motion.y);
+            put<Sint16>(event.motion.xrel);
+            put<Sint16>(event.motion.yrel);
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            put<Uint8>(event.type == SDL_MOUSEBUTTONDOWN ? INPUT_TAG_MOUSE_BUTTON_DOWN : INPUT_TAG_MOUSE_BUTTON_UP);
+            put<Uint32>(event.common.timestamp);
+            put<Uint8>(event.button.button);
+            put<Sint16>(event.button.x);
+            put<Sint16>(event.button.y);
+            break;
+        case SDL_MOUSEWHEEL:
+            put<Uint8>(INPUT_TAG_MOUSE_WHEEL);
+            put<Uint32>(event.common.timestamp);
+            put<Sint16>(event.wheel.x);
+            put<Sint16>(event.wheel.y);
+            break;
+        default:
+            return;
+    }
+
+    if (recordBuffer.size() >= INPUT_RECORD_FLUSH_SIZE) {
+        flushRecording();
+    }
+}
+
+/// Чтение следующего события текущего кадра
+/// @return false в конце кадра, записи или при повреждённой записи
+static bool readEvent(SDL_Event& event) {
+    if (replayOffset >= replayBuffer.size() || replayBuffer[replayOffset] == INPUT_TAG_FRAME) {
+        return false;
+    }
+
+    Uint8 tag = 0;
+    Uint32 timestamp = 0;
+    Sint32 key = 0;
+    Sint16 x = 0, y = 0, xrel = 0, yrel = 0;
+    Uint8 button = 0;
+    bool valid = get(tag) && get(timestamp);
+
+    event = {};
+    switch (tag) {
+        case INPUT_TAG_KEY_DOWN:
+        case INPUT_TAG_KEY_UP:
+            valid = valid && get(key);
+            event.type = tag == INPUT_TAG_KEY_DOWN ? SDL_KEYDOWN : SDL_KEYUP;
+            event.key.keysym.sym = key;
+            break;
+        case INPUT_TAG_MOUSE_MOTION:
+            valid = valid && get(x) && get(y) && get(xrel) && get(yrel);
+            event.type = SDL_MOUSEMOTION;
+            event.motion.x = x;
+            event.motion.y = y;
+            event.motion.xrel = xrel;
+            event.motion.yrel = yrel;
+            break;
+        case INPUT_TAG_MOUSE_BUTTON_DOWN:
+        case INPUT_TAG_MOUSE_BUTTON_UP:
+            valid = valid && get(button) && get(x) && get(y);
+            event.type = tag == INPUT_TAG_MOUSE_BUTTON_DOWN ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+            event.button.button = button;
+            event.button.x = x;
+            event.button.y = y;
+            break;
+        case INPUT_TAG_MOUSE_WHEEL:
+            valid = valid && get(x) && get(y);
+            event.type = SDL_MOUSEWHEEL;
+            event.wheel.x = x;
+            event.wheel.y = y;
+            break;
+        default:
+            valid = false;
+    }
+
+    if (!valid) {
+        ERROR("Corrupted input record at offset " << replayOffset);
+        replayOffset = replayBuffer.size();
+        return false;
+    }
+    event.common.timestamp = timestamp;
+    return true;
+}
 
 namespace REngine {
 
@@ -14,6 +161,7 @@ InputHandler::MouseMotionCallback InputHandler::mouseMotionCallback_;
 InputHandler::MouseWheelCallback InputHandler::mouseWheelCallback_;
 glm::vec2 InputHandler::mousePosition_;
 glm::vec2 InputHandler::mouseRelativeMotion_;
+Uint32 InputHandler::mouseButtons_ = 0;
 
 void InputHandler::init() {
     SDL_SetRelativeMouseMode(SDL_FALSE);
@@ -26,6 +174,10 @@ void InputHandler::init() {
 }
 
 bool InputHandler::handleEvent(const SDL_Event& event) {
+    if (recording) {
+        recordEvent(event);
+    }
+
     switch (event.type) {
         case SDL_KEYDOWN: {
             SDL_Keycode key = event.key.keysym.sym;
@@ -64,6 +216,7 @@ bool InputHandler::handleEvent(const SDL_Event& event) {
         }
         case SDL_MOUSEBUTTONDOWN: {
             Uint8 button = event.button.button;
+            mouseButtons_ |= SDL_BUTTON(button);
             auto it = mouseButtonDownCallbacks_.find(button);
             if (it != mouseButtonDownCallbacks_.end() && it->second) {
                 it->second(event.button.x, event.button.y, button);
@@ -73,6 +226,7 @@ bool InputHandler::handleEvent(const SDL_Event& event) {
         }
         case SDL_MOUSEBUTTONUP: {
             Uint8 button = event.button.button;
+            mouseButtons_ &= ~SDL_BUTTON(button);
             auto it = mouseButtonUpCallbacks_.find(button);
             if (it != mouseButtonUpCallbacks_.end() && it->second) {
                 it->second(event.button.x, event.button.y, button);
@@ -94,13 +248,32 @@ bool InputHandler::handleEvent(const SDL_Event& event) {
 }
 
 void InputHandler::update(float deltaTime) {
+    pollEvents();
+    updateHeldKeys(deltaTime);
+}
+
+void InputHandler::pollEvents() {
+    PROFILE_SCOPE("InputHandler::pollEvents");
     mouseRelativeMotion_ = glm::vec2(0, 0);
 
     SDL_Event e;
+    if (replaying) {
+        // Живые события отбрасываются, чтобы не смешиваться с записанными
+        while (SDL_PollEvent(&e) != 0) {
+        }
+        while (readEvent(e)) {
+            handleEvent(e);
+        }
+        return;
+    }
+
     while (SDL_PollEvent(&e) != 0) {
         handleEvent(e);
     }
+}
 
+void InputHandler::updateHeldKeys(float deltaTime) {
+    PROFILE_SCOPE("InputHandler::updateHeldKeys");
     // Обрабатываем удержание клавиш
     for (auto& [key, callback] : keyHoldCallbacks_) {
         if (keyStates_[key]) {
@@ -142,6 +315,113 @@ bool InputHandler::isKeyDown(SDL_Keycode key) {
     return it != keyStates_.end() ? it->second : false;
 }
 
+bool InputHandler::isMouseButtonDown(Uint8 button) {
+    return (mouseButtons_ & SDL_BUTTON(button)) != 0;
+}
+
+bool InputHandler::startRecording(const std::string& path) {
+    if (recording || replaying) {
+        ERROR("Input is already being recorded or replayed");
+        return false;
+    }
+
+    recordFile.open(path, std::ios::binary | std::ios::trunc);
+    if (!recordFile.is_open()) {
+        ERROR("Failed to open input record: " + path);
+        return false;
+    }
+
+    recordBuffer.clear();
+    recordBuffer.insert(recordBuffer.end(), INPUT_RECORD_MAGIC, INPUT_RECORD_MAGIC + 4);
+    put<Uint8>(INPUT_RECORD_VERSION);
+    recording = true;
+    INFO("Recording input to " << path);
+    return true;
+}
+
+void InputHandler::stopRecording() {
+    if (!recording) {
+        return;
+    }
+    flushRecording();
+    recordFile.close();
+    recording = false;
+    DEBUG("Input recording stopped");
+}
+
+bool InputHandler::isRecording() {
+    return recording;
+}
+
+bool InputHandler::startReplay(const std::string& path) {
+    if (recording || replaying) {
+        ERROR("Input is already being recorded or replayed");
+        return false;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        ERROR("Failed to open input record: " + path);
+        return false;
+    }
+    replayBuffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    if (replayBuffer.size() < 5 || std::memcmp(replayBuffer.data(), INPUT_RECORD_MAGIC, 4) != 0 ||
+        replayBuffer[4] != INPUT_RECORD_VERSION) {
+        ERROR("Invalid input record: " + path);
+        replayBuffer.clear();
+        return false;
+    }
+
+    replayOffset = 5;
+    replaying = true;
+    keyStates_.clear();
+    mouseButtons_ = 0;
+    INFO("Replaying input from " << path);
+    return true;
+}
+
+void InputHandler::stopReplay() {
+    if (!replaying) {
+        return;
+    }
+    replaying = false;
+    replayBuffer.clear();
+    keyStates_.clear();
+    mouseButtons_ = 0;
+    DEBUG("Input replay stopped");
+}
+
+bool InputHandler::isReplaying() {
+    return replaying;
+}
+
+bool InputHandler::beginFrame(double& deltaTime) {
+    if (recording) {
+        float stored = (float)deltaTime;
+        deltaTime = stored;
+        put<Uint8>(INPUT_TAG_FRAME);
+        put<float>(stored);
+    }
+
+    if (replaying) {
+        // Необработанные события прошлого кадра пропускаются
+        SDL_Event skipped;
+        while (readEvent(skipped)) {
+        }
+
+        Uint8 tag = 0;
+        float stored = 0.0f;
+        if (!get(tag) || !get(stored)) {
+            INFO("Input replay finished");
+            stopReplay();
+            return false;
+        }
+        deltaTime = stored;
+    }
+    return true;
+}
+
 glm::vec2 InputHandler::getMousePosition() {
     return mousePosition_;
 }
@@ -0,0 +1,265 @@
+#include "Logging.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+static_assert((LOG_QUEUE_SIZE & (LOG_QUEUE_SIZE - 1)) == 0, "LOG_QUEUE_SIZE must be a power of two");
+
+// Ожидание фонового потока при пустой очереди
+#define LOG_WRITER_IDLE_MS 1
+
+static const char* levelPrefixes[] = {"[DEBUG] ", "[INFO] ", "[WARN] ", "[ERROR] ", "[FATAL] "};
+
+/// @brief Кольцевая очередь с несколькими производителями и одним потребителем
+/// @details Каждая ячейка хранит номер последовательности, по которому производитель
+/// узнаёт, свободна ли ячейка, а потребитель, опубликована ли она
+class LogQueue {
+public:
+    LogQueue() : slots(new REngine::LogSlot[LOG_QUEUE_SIZE]) {
+        for (size_t i = 0; i < LOG_QUEUE_SIZE; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        std::thread(&LogQueue::run, this).detach();
+    }
+
+    REngine::LogSlot* acquire(uint8_t level) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            REngine::LogSlot& slot = slots[pos & (LOG_QUEUE_SIZE - 1)];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return &slot;
+                }
+            } else if (diff < 0) {
+                if (level < LOG_LEVEL_ERROR) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                return nullptr;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publish(REngine::LogSlot* slot) {
+        size_t pos = slot->sequence.load(std::memory_order_relaxed);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    void flush() { drain(); }
+
+    bool setOutputFile(const std::string& path) {
+        flush();
+        std::lock_guard<std::mutex> lock(outputMutex);
+        file.reset();
+        if (path.empty()) {
+            return true;
+        }
+        file = std::make_unique<std::ofstream>(path, std::ios::trunc);
+        if (!file->is_open()) {
+            file.reset();
+            return false;
+        }
+        return true;
+    }
+
+    unsigned long getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+    // Сообщение собирается целиком и пишется одной операцией, чтобы не смешаться с фоновым потоком
+    void writeDirect(const REngine::LogSlot& slot) {
+        std::ostringstream out;
+        format(slot, out);
+        std::cerr << out.str();
+        std::cerr.flush();
+    }
+
+private:
+    std::unique_ptr<REngine::LogSlot[]> slots;
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+    std::atomic<unsigned long> dropped{0};
+    unsigned long reportedDropped = 0;
+    std::mutex outputMutex;
+    std::unique_ptr<std::ofstream> file;
+
+    void run() {
+        while (true) {
+            if (!drain()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(LOG_WRITER_IDLE_MS));
+            }
+        }
+    }
+
+    // Запись всех опубликованных сообщений, возвращает true, если что-то записано.
+    // Вызывается фоновым потоком и из flush, мьютекс оставляет потребителя единственным
+    bool drain() {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        size_t pos = tail.load(std::memory_order_relaxed);
+        bool wrote = false;
+        while (true) {
+            REngine::LogSlot& slot = slots[pos & (LOG_QUEUE_SIZE - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            write(slot);
+            slot.sequence.store(pos + LOG_QUEUE_SIZE, std::memory_order_release);
+            pos++;
+            tail.store(pos, std::memory_order_release);
+            wrote = true;
+        }
+
+        unsigned long droppedNow = getDropped();
+        if (droppedNow != reportedDropped) {
+            stream(LOG_LEVEL_WARN) << levelPrefixes[LOG_LEVEL_WARN] << droppedNow - reportedDropped << " log messages dropped\n";
+            reportedDropped = droppedNow;
+        }
+
+        if (wrote) {
+            if (file) {
+                file->flush();
+            } else {
+                std::cout.flush();
+                std::cerr.flush();
+            }
+        }
+        return wrote;
+    }
+
+    std::ostream& stream(uint8_t level) {
+        if (file) {
+            return *file;
+        }
+        return level >= LOG_LEVEL_ERROR ? std::cerr : std::cout;
+    }
+
+    void write(const REngine::LogSlot& slot) { format(slot, stream(slot.level)); }
+
+    static void format(const REngine::LogSlot& slot, std::ostream& out) {
+        out << levelPrefixes[slot.level < 5 ? slot.level : LOG_LEVEL_FATAL];
+
+        size_t offset = 0;
+        while (offset < slot.size) {
+            REngine::LogArg type = (REngine::LogArg)slot.payload[offset++];
+            const unsigned char* data = slot.payload + offset;
+            switch (type) {
+                case REngine::LogArg::String: {
+                    uint16_t length;
+                    std::memcpy(&length, data, sizeof(length));
+                    out.write(reinterpret_cast<const char*>(data + sizeof(length)), length);
+                    offset += sizeof(length) + length;
+                    break;
+                }
+                case REngine::LogArg::HeapString: {
+                    std::string* text;
+                    std::memcpy(&text, data, sizeof(text));
+                    out << *text;
+                    delete text;
+                    offset += sizeof(text);
+                    break;
+                }
+                case REngine::LogArg::Signed: {
+                    int64_t value;
+                    std::memcpy(&value, data, sizeof(value));
+                    out << value;
+                    offset += sizeof(value);
+                    break;
+                }
+                case REngine::LogArg::Unsigned:
+                case REngine::LogArg::Pointer: {
+                    uint64_t value;
+                    std::memcpy(&value, data, sizeof(value));
+                    if (type == REngine::LogArg::Pointer) {
+                        out << reinterpret_cast<const void*>(value);
+                    } else {
+                        out << value;
+                    }
+                    offset += sizeof(value);
+                    break;
+                }
+                case REngine::LogArg::Double: {
+                    double value;
+                    std::memcpy(&value, data, sizeof(value));
+                    out << value;
+                    offset += sizeof(value);
+                    break;
+                }
+                case REngine::LogArg::Bool:
+                    out << (data[0] != 0);
+                    offset += 1;
+                    break;
+                case REngine::LogArg::Char:
+                    out << (char)data[0];
+                    offset += 1;
+                    break;
+            }
+        }
+        out << '\n';
+    }
+};
+
+static std::atomic<bool> exiting{false};
+
+// Очередь не уничтожается, чтобы журнал работал в деструкторах статических объектов.
+// После начала завершения программы сообщения пишутся синхронно
+static LogQueue& getQueue() {
+    static LogQueue* queue = [] {
+        std::atexit([] {
+            exiting.store(true, std::memory_order_release);
+            getQueue().flush();
+        });
+        return new LogQueue();
+    }();
+    return *queue;
+}
+
+bool REngine::Log::setOutputFile(const std::string& path) {
+    return getQueue().setOutputFile(path);
+}
+
+void REngine::Log::flush() {
+    getQueue().flush();
+}
+
+unsigned long REngine::Log::getDropped() {
+    return getQueue().getDropped();
+}
+
+REngine::LogSlot* REngine::Log::acquire(uint8_t level) {
+    return getQueue().acquire(level);
+}
+
+void REngine::Log::publish(LogSlot* slot) {
+    // После публикации ячейку может занять другой поток, поэтому уровень читается заранее
+    bool fatal = slot->level == LOG_LEVEL_FATAL;
+    getQueue().publish(slot);
+    if (fatal || exiting.load(std::memory_order_acquire)) {
+        // После фатальной ошибки программа может завершиться, поэтому сообщение дописывается сразу
+        flush();
+    }
+}
+
+void REngine::Log::writeDirect(const LogSlot& slot) {
+    getQueue().writeDirect(slot);
+}
+
+void REngine::LogRecord::putString(std::string_view text) {
+    size_t free = LOG_RECORD_SIZE - slot->size;
+    if (1 + sizeof(uint16_t) + text.size() <= free) {
+        uint16_t length = (uint16_t)text.size();
+        slot->payload[slot->size] = (unsigned char)LogArg::String;
+        std::memcpy(slot->payload + slot->size + 1, &length, sizeof(length));
+        std::memcpy(slot->payload + slot->size + 1 + sizeof(length), text.data(), text.size());
+        slot->size += 1 + sizeof(length) + text.size();
+    } else if (1 + sizeof(std::string*) <= free) {
+        // Длинные строки, например журналы компиляции шейдеров, уходят в кучу
+        put(LogArg::HeapString, new std::string(text));
+    }
+}
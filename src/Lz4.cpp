@@ -0,0 +1,141 @@
+#include "Lz4.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_LIMIT 12
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_BITS 12
+
+static uint32_t read32(const unsigned char* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint32_t hash4(uint32_t value) {
+    return (value * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+// Длина от 15 и больше дописывается байтами по 255 и остатком
+static void writeLength(std::vector<unsigned char>& output, size_t length) {
+    while (length >= 255) {
+        output.push_back(255);
+        length -= 255;
+    }
+    output.push_back((unsigned char)length);
+}
+
+// Последовательность из литералов и совпадения, у последней последовательности совпадения нет
+static void writeSequence(std::vector<unsigned char>& output, const unsigned char* literals, size_t literalCount, size_t offset,
+                          size_t matchLength) {
+    size_t matchCode = matchLength > 0 ? matchLength - LZ4_MIN_MATCH : 0;
+    output.push_back((unsigned char)((std::min(literalCount, (size_t)15) << 4) | std::min(matchCode, (size_t)15)));
+    if (literalCount >= 15) {
+        writeLength(output, literalCount - 15);
+    }
+    output.insert(output.end(), literals, literals + literalCount);
+    if (matchLength == 0) {
+        return;
+    }
+    output.push_back((unsigned char)(offset & 0xFF));
+    output.push_back((unsigned char)(offset >> 8));
+    if (matchCode >= 15) {
+        writeLength(output, matchCode - 15);
+    }
+}
+
+void REngine::Lz4::compress(const unsigned char* data, size_t size, std::vector<unsigned char>& compressed) {
+    compressed.clear();
+    compressed.reserve(getBound(size));
+
+    // Формат требует, чтобы совпадение начиналось не ближе 12 байт к концу, а последние 5 байт были литералами
+    size_t anchor = 0;
+    if (size > LZ4_MATCH_LIMIT) {
+        std::vector<size_t> table((size_t)1 << LZ4_HASH_BITS, SIZE_MAX);
+        size_t matchEnd = size - LZ4_LAST_LITERALS;
+        size_t i = 0;
+        while (i + LZ4_MATCH_LIMIT <= size) {
+            uint32_t sequence = read32(data + i);
+            uint32_t hash = hash4(sequence);
+            size_t candidate = table[hash];
+            table[hash] = i;
+            if (candidate == SIZE_MAX || i - candidate > LZ4_MAX_OFFSET || read32(data + candidate) != sequence) {
+                i++;
+                continue;
+            }
+            size_t length = LZ4_MIN_MATCH;
+            while (i + length < matchEnd && data[candidate + length] == data[i + length]) {
+                length++;
+            }
+            writeSequence(compressed, data + anchor, i - anchor, i - candidate, length);
+            i += length;
+            anchor = i;
+        }
+    }
+    writeSequence(compressed, data + anchor, size - anchor, 0, 0);
+}
+
+bool REngine::Lz4::decompress(const unsigned char* data, size_t size, unsigned char* output, size_t outputSize) {
+    const unsigned char* input = data;
+    const unsigned char* inputEnd = data + size;
+    unsigned char* position = output;
+    unsigned char* outputEnd = output + outputSize;
+    auto readLength = [&](size_t& length) {
+        unsigned char byte;
+        do {
+            if (input >= inputEnd) {
+                return false;
+            }
+            byte = *input++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    };
+
+    while (input < inputEnd) {
+        unsigned char token = *input++;
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !readLength(literalCount)) {
+            return false;
+        }
+        if ((size_t)(inputEnd - input) < literalCount || (size_t)(outputEnd - position) < literalCount) {
+            return false;
+        }
+        if (literalCount > 0) {
+            std::memcpy(position, input, literalCount);
+        }
+        input += literalCount;
+        position += literalCount;
+        if (input == inputEnd) {
+            break;
+        }
+
+        if (inputEnd - input < 2) {
+            return false;
+        }
+        size_t offset = input[0] | ((size_t)input[1] << 8);
+        input += 2;
+        if (offset == 0 || offset > (size_t)(position - output)) {
+            return false;
+        }
+        size_t length = token & 15;
+        if (length == 15 && !readLength(length)) {
+            return false;
+        }
+        length += LZ4_MIN_MATCH;
+        if ((size_t)(outputEnd - position) < length) {
+            return false;
+        }
+        // Совпадение может перекрывать записываемые байты, поэтому копируется по одному
+        const unsigned char* match = position - offset;
+        for (size_t i = 0; i < length; i++) {
+            position[i] = match[i];
+        }
+        position += length;
+    }
+    return position == outputEnd;
+}
@@ -0,0 +1,90 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef _WIN32
+bool REngine::MappedFile::open(const std::string& path) {
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE fileMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!fileMapping) {
+        return false;
+    }
+
+    void* view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(fileMapping);
+        return false;
+    }
+
+    mapping = fileMapping;
+    bytes = static_cast<const unsigned char*>(view);
+    length = (size_t)fileSize.QuadPart;
+    return true;
+}
+
+void REngine::MappedFile::close() {
+    if (bytes) {
+        UnmapViewOfFile(bytes);
+        CloseHandle(mapping);
+    }
+    bytes = nullptr;
+    mapping = nullptr;
+    length = 0;
+}
+#else
+bool REngine::MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    // Файл читается целиком и по порядку
+    madvise(view, (size_t)info.st_size, MADV_WILLNEED);
+
+    bytes = static_cast<const unsigned char*>(view);
+    length = (size_t)info.st_size;
+    return true;
+}
+
+void REngine::MappedFile::close() {
+    if (bytes) {
+        munmap(const_cast<unsigned char*>(bytes), length);
+    }
+    bytes = nullptr;
+    length = 0;
+}
+#endif
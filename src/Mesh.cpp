@@ -1,7 +1,33 @@
 #include "Mesh.h"
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
 #include <glad/glad.h>
 
-REngine::Mesh::Mesh(std::vector<float> vertices, std::vector<unsigned> indices) : vertices(vertices) {
+#include "CookedMesh.h"
+#include "VirtualFS.h"
+
+// Чтение индекса заданного типа
+static unsigned readIndex(const void* indices, size_t i, unsigned int indexType) {
+    if (indexType == GL_UNSIGNED_BYTE) {
+        return ((const unsigned char*)indices)[i];
+    }
+    if (indexType == GL_UNSIGNED_SHORT) {
+        return ((const unsigned short*)indices)[i];
+    }
+    return ((const unsigned*)indices)[i];
+}
+
+REngine::Mesh::Mesh(std::vector<float> vertices, std::vector<unsigned> indices)
+    : Mesh(vertices.data(), vertices.size() / 8, indices.data(), indices.size(), GL_UNSIGNED_INT) {
+    this->vertices = std::move(vertices);
+}
+
+REngine::Mesh::Mesh(const float* vertices, size_t vertexCount, const void* indices, size_t indexCount, unsigned int indexType,
+                    bool flipTexCoords)
+    : indexType(indexType) {
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
@@ -9,12 +35,58 @@ REngine::Mesh::Mesh(std::vector<float> vertices, std::vector<unsigned> indices)
     glBindVertexArray(VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    size_t vertexBytes = vertexCount * 8 * sizeof(float);
+    if (flipTexCoords) {
+        // V переворачивается при записи в буфер, без промежуточной копии в куче
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, nullptr, GL_STATIC_DRAW);
+        float* mapped = vertexBytes ? (float*)glMapBufferRange(GL_ARRAY_BUFFER, 0, vertexBytes,
+                                                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT) : nullptr;
+        bool uploaded = false;
+        if (mapped) {
+            for (size_t i = 0; i < vertexCount * 8; i += 8) {
+                std::memcpy(mapped + i, vertices + i, 7 * sizeof(float));
+                mapped[i + 7] = 1.0f - vertices[i + 7];
+            }
+            uploaded = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+        }
+        // Если буфер не отобразился или его содержимое потеряно, V переворачивается в копии
+        if (!uploaded && vertexBytes) {
+            std::vector<float> flipped(vertices, vertices + vertexCount * 8);
+            for (size_t i = 7; i < flipped.size(); i += 8) {
+                flipped[i] = 1.0f - flipped[i];
+            }
+            glBufferSubData(GL_ARRAY_BUFFER, 0, vertexBytes, flipped.data());
+        }
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertices, GL_STATIC_DRAW);
+    }
 
+    size_t indexBytes = indexType == GL_UNSIGNED_BYTE ? 1 : indexType == GL_UNSIGNED_SHORT ? 2 : 4;
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), indices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexBytes, indices, GL_STATIC_DRAW);
 
-    indexSize = indices.size();
+    indexSize = indexCount;
+
+    min = max = vertexCount ? glm::vec3(vertices[0], vertices[1], vertices[2]) : glm::vec3(0.0f);
+    for (size_t i = 0; i < vertexCount * 8; i += 8) {
+        min = glm::min(min, glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]));
+        max = glm::max(max, glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]));
+    }
+
+    // Отношение площадей треугольников в UV и в пространстве сетки задаёт нужное разрешение текстуры,
+    // переворот V площадь не меняет
+    float area = 0.0f, uvArea = 0.0f;
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        const float* a = &vertices[readIndex(indices, i, indexType) * 8];
+        const float* b = &vertices[readIndex(indices, i + 1, indexType) * 8];
+        const float* c = &vertices[readIndex(indices, i + 2, indexType) * 8];
+        glm::vec3 edge1(b[0] - a[0], b[1] - a[1], b[2] - a[2]), edge2(c[0] - a[0], c[1] - a[1], c[2] - a[2]);
+        area += glm::length(glm::cross(edge1, edge2));
+        uvArea += std::abs((b[6] - a[6]) * (c[7] - a[7]) - (c[6] - a[6]) * (b[7] - a[7]));
+    }
+    if (area > 0.0f && uvArea > 0.0f) {
+        uvDensity = std::sqrt(uvArea / area);
+    }
 
     // Положение
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
@@ -28,6 +100,11 @@ REngine::Mesh::Mesh(std::vector<float> vertices, std::vector<unsigned> indices)
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
 
+    // Данные объекта: две матрицы по четыре столбца, параметры материала, уровни текстур и сплошные цвета
+    for (int i = 0; i < 12; i++) {
+        glVertexAttribDivisor(MESH_INSTANCE_ATTRIBUTE + i, 1);
+    }
+
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 }
@@ -38,35 +115,93 @@ REngine::Mesh::~Mesh() {
     glDeleteBuffers(1, &EBO);
 }
 
+float REngine::Mesh::getMaterialSource(const Texture* texture) {
+    if (texture->isSolid()) {
+        return MESH_SOURCE_COLOR;
+    }
+    return texture->getArray() ? (float)texture->getLayer() : MESH_SOURCE_TEXTURE;
+}
+
+// Привязка текстуры материала: отдельная текстура к блоку unit, слой массива к блоку arrayUnit, цвет без привязки.
+// Шейдеру без переменной сплошного цвета вместо цвета привязывается общая текстура 1x1
+static void bindMaterialTexture(const REngine::Shader& shader, const REngine::Texture* texture, int unit, int arrayUnit,
+                                const char* sourceName, const char* minLodName, const char* colorName) {
+    if (texture->isSolid()) {
+        if (shader.hasUniform(colorName)) {
+            const float* color = texture->getColor();
+            shader.setFloat(sourceName, MESH_SOURCE_COLOR);
+            shader.setVec3(colorName, glm::vec3(color[0], color[1], color[2]));
+            return;
+        }
+        texture = texture->getColorTexture();
+    }
+    shader.setFloat(sourceName, REngine::Mesh::getMaterialSource(texture));
+    if (texture->getArray()) {
+        glActiveTexture(GL_TEXTURE0 + arrayUnit);
+        shader.setFloat(minLodName, (float)texture->getBaseLevel());
+    } else {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    texture->bind();
+}
+
 void REngine::Mesh::draw(const Shader& shader) {
     glBindVertexArray(VAO);
     if (texture && texture->isValid()) {
         shader.setBool("useTexture", true);
         shader.setInt("material.diffuse", 0);
-        glActiveTexture(GL_TEXTURE0);
-        texture->bind();
+        shader.setInt("diffuseArray", MESH_DIFFUSE_ARRAY_UNIT);
+        bindMaterialTexture(shader, texture, 0, MESH_DIFFUSE_ARRAY_UNIT, "diffuseSource", "diffuseMinLod", "diffuseSolidColor");
     } else {
         shader.setBool("useTexture", false);
     }
     if (specularTexture && specularTexture->isValid()) {
         shader.setBool("useSpecularTexture", true);
         shader.setInt("material.specular", 1);
-        glActiveTexture(GL_TEXTURE1);
-        specularTexture->bind();
+        shader.setInt("specularArray", MESH_SPECULAR_ARRAY_UNIT);
+        bindMaterialTexture(shader, specularTexture, 1, MESH_SPECULAR_ARRAY_UNIT, "specularSource", "specularMinLod", "specularSolidColor");
     } else {
         shader.setBool("useSpecularTexture", false);
     }
-    glDrawElements(GL_TRIANGLES, indexSize, GL_UNSIGNED_INT, 0);
-    if (texture && texture->isValid()) {
+    glDrawElements(GL_TRIANGLES, indexSize, indexType, 0);
+    if (texture && texture->isValid() && !texture->getArray()) {
         Texture::unbind();
     }
-    if (specularTexture && specularTexture->isValid()) {
+    if (specularTexture && specularTexture->isValid() && !specularTexture->getArray()) {
         Texture::unbind();
     }
     glBindVertexArray(0);
 }
 
+void REngine::Mesh::drawInstanced(unsigned int instanceBuffer, size_t offset, int count) {
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    for (int i = 0; i < 9; i++) {
+        GLuint location = MESH_INSTANCE_ATTRIBUTE + i;
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + i * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(location);
+    }
+    glVertexAttribPointer(MESH_INSTANCE_ATTRIBUTE + 9, 2, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offset + 9 * sizeof(glm::vec4)));
+    glEnableVertexAttribArray(MESH_INSTANCE_ATTRIBUTE + 9);
+    glVertexAttribPointer(MESH_INSTANCE_ATTRIBUTE + 10, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                          (void*)(offset + offsetof(InstanceData, diffuseColor)));
+    glEnableVertexAttribArray(MESH_INSTANCE_ATTRIBUTE + 10);
+    glVertexAttribPointer(MESH_INSTANCE_ATTRIBUTE + 11, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                          (void*)(offset + offsetof(InstanceData, specularColor)));
+    glEnableVertexAttribArray(MESH_INSTANCE_ATTRIBUTE + 11);
+    glDrawElementsInstanced(GL_TRIANGLES, indexSize, indexType, 0, count);
+    // Обычная отрисовка берёт данные объекта из uniform-переменных
+    for (int i = 0; i < 12; i++) {
+        glDisableVertexAttribArray(MESH_INSTANCE_ATTRIBUTE + i);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
 void REngine::Mesh::computeAABB() {
+    if (vertices.empty()) {
+        return;
+    }
     min = glm::vec3(vertices[0], vertices[1], vertices[2]);
     max = glm::vec3(vertices[0], vertices[1], vertices[2]);
     for (int i = 0; i < vertices.size(); i += 8) {
@@ -126,9 +261,25 @@ REngine::Mesh REngine::Mesh::createCube() {
     return Mesh(vertices, indices);
 }
 
+std::string REngine::Mesh::getSphereName(int vslices, int hslices) {
+    return "meshes/sphere_" + std::to_string(vslices) + "x" + std::to_string(hslices) + ".rmesh";
+}
+
 REngine::Mesh REngine::Mesh::createSphere(int vslices, int hslices) {
-    std::vector<float> vertices((vslices + 1) * (hslices + 1) * 8);
-    std::vector<unsigned> indices(vslices * hslices * 6);
+    std::vector<float> vertices;
+    std::vector<unsigned> indices;
+    // Подготовленная сетка уже квантована и упорядочена для кэша вершин. Сферы сохраняются только
+    // в архивах, поэтому без архива диск не проверяется
+    std::string name = getSphereName(vslices, hslices);
+    if (!VirtualFS::isPacked(name) || !CookedMesh::load(name, vertices, indices)) {
+        tessellateSphere(vslices, hslices, vertices, indices);
+    }
+    return Mesh(vertices, indices);
+}
+
+void REngine::Mesh::tessellateSphere(int vslices, int hslices, std::vector<float>& vertices, std::vector<unsigned>& indices) {
+    vertices.assign((vslices + 1) * (hslices + 1) * 8, 0.0f);
+    indices.assign(vslices * hslices * 6, 0);
 
     int vindex = 0;
     int iindex = 0;
@@ -178,5 +329,4 @@ REngine::Mesh REngine::Mesh::createSphere(int vslices, int hslices) {
             indices[iindex++] = v3;
         }
     }
-    return Mesh(vertices, indices);
 }
@@ -0,0 +1,493 @@
+#include "ObjImporter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+
+#include "Logging.h"
+#include "VirtualFS.h"
+
+// Отрицательный индекс OBJ отсчитывается от конца уже прочитанных вершин. Фрагмент не знает, сколько вершин
+// было до него, поэтому хранит такой индекс относительно своего начала со смещением OBJ_RELATIVE
+static const int OBJ_RELATIVE = 1 << 30;
+// Индекс отсутствующих UV или нормали
+static const int OBJ_MISSING = -1;
+
+// Смена материала или имени объекта, действует с треугольника start
+struct ObjRun {
+    size_t start;
+    std::string material;
+    std::string name;
+    bool hasMaterial;
+    bool hasName;
+};
+
+// Результат разбора одного фрагмента файла
+struct ObjChunk {
+    const char* begin;
+    const char* end;
+    std::vector<float> positions;
+    std::vector<float> texcoords;
+    std::vector<float> normals;
+    // Индексы координат, UV и нормали для каждой вершины треугольников, от 0
+    std::vector<int> corners;
+    std::vector<ObjRun> runs;
+    std::vector<std::string> libraries;
+    size_t positionBase = 0, texcoordBase = 0, normalBase = 0;
+    const char* error = nullptr;
+};
+
+// Потоки берут задания по очереди, один из них вызывающий
+template <typename Function>
+static void parallelFor(size_t count, int threads, Function function) {
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            function(i);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads && (size_t)i < count; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+}
+
+static const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    return p;
+}
+
+static bool isLineEnd(const char* p, const char* end) {
+    return p >= end || *p == '\n' || *p == '\r';
+}
+
+static const char* parseFloats(const char* p, const char* end, float* values, int count, int required) {
+    for (int i = 0; i < count; i++) {
+        p = skipSpaces(p, end);
+        if (isLineEnd(p, end) && i >= required) {
+            values[i] = 0.0f;
+            continue;
+        }
+        std::from_chars_result result = std::from_chars(p, end, values[i]);
+        if (result.ec != std::errc()) {
+            return nullptr;
+        }
+        p = result.ptr;
+    }
+    return p;
+}
+
+// Разбор индекса вершины грани: положительный от начала файла, отрицательный от последней прочитанной вершины
+static const char* parseIndex(const char* p, const char* end, size_t localCount, int& index) {
+    int value = 0;
+    std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec != std::errc() || value == 0) {
+        return nullptr;
+    }
+    index = value > 0 ? value - 1 : (int)localCount + value - OBJ_RELATIVE;
+    return result.ptr;
+}
+
+// Остаток строки без пробелов в конце
+static std::string readRest(const char* p, const char* end) {
+    p = skipSpaces(p, end);
+    const char* last = p;
+    while (!isLineEnd(last, end)) {
+        last++;
+    }
+    while (last > p && (last[-1] == ' ' || last[-1] == '\t')) {
+        last--;
+    }
+    return std::string(p, last);
+}
+
+static bool startsWith(const char* p, const char* end, const char* keyword) {
+    size_t length = std::strlen(keyword);
+    return (size_t)(end - p) > length && std::memcmp(p, keyword, length) == 0 && (p[length] == ' ' || p[length] == '\t');
+}
+
+static void parseChunk(ObjChunk& chunk) {
+    chunk.runs.push_back({0, "", "", false, false});
+    std::vector<int> face;
+    const char* end = chunk.end;
+    for (const char* p = chunk.begin; p < end;) {
+        const char* line = p;
+        p = skipSpaces(p, end);
+        if (startsWith(p, end, "v")) {
+            float values[3];
+            p = parseFloats(p + 1, end, values, 3, 3);
+            if (p) {
+                chunk.positions.insert(chunk.positions.end(), values, values + 3);
+            }
+        } else if (startsWith(p, end, "vt")) {
+            float values[2];
+            p = parseFloats(p + 2, end, values, 2, 1);
+            if (p) {
+                chunk.texcoords.insert(chunk.texcoords.end(), values, values + 2);
+            }
+        } else if (startsWith(p, end, "vn")) {
+            float values[3];
+            p = parseFloats(p + 2, end, values, 3, 3);
+            if (p) {
+                chunk.normals.insert(chunk.normals.end(), values, values + 3);
+            }
+        } else if (startsWith(p, end, "f")) {
+            face.clear();
+            p = skipSpaces(p + 1, end);
+            while (p && !isLineEnd(p, end)) {
+                // Вершина грани: v, v/vt, v//vn или v/vt/vn
+                int corner[3] = {0, OBJ_MISSING, OBJ_MISSING};
+                p = parseIndex(p, end, chunk.positions.size() / 3, corner[0]);
+                for (int k = 1; p && k < 3 && p < end && *p == '/'; k++) {
+                    p++;
+                    if (k == 1 && p < end && *p == '/') {
+                        continue;
+                    }
+                    p = parseIndex(p, end, k == 1 ? chunk.texcoords.size() / 2 : chunk.normals.size() / 3, corner[k]);
+                }
+                if (p) {
+                    face.insert(face.end(), corner, corner + 3);
+                    p = skipSpaces(p, end);
+                }
+            }
+            if (p && face.size() < 9) {
+                p = nullptr;
+            }
+            // Многоугольник разбивается веером вокруг первой вершины
+            for (size_t i = 2; p && i < face.size() / 3; i++) {
+                chunk.corners.insert(chunk.corners.end(), face.begin(), face.begin() + 3);
+                chunk.corners.insert(chunk.corners.end(), face.begin() + (i - 1) * 3, face.begin() + (i + 1) * 3);
+            }
+        } else if (startsWith(p, end, "usemtl")) {
+            chunk.runs.push_back({chunk.corners.size() / 9, readRest(p + 6, end), "", true, false});
+        } else if (startsWith(p, end, "o") || startsWith(p, end, "g")) {
+            chunk.runs.push_back({chunk.corners.size() / 9, "", readRest(p + 1, end), false, true});
+        } else if (startsWith(p, end, "mtllib")) {
+            chunk.libraries.push_back(readRest(p + 6, end));
+        }
+        if (!p) {
+            chunk.error = line;
+            return;
+        }
+        // Прочие строки, включая комментарии и неподдерживаемые команды, пропускаются
+        p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        p = p ? p + 1 : end;
+    }
+}
+
+static std::string getDirectory(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+static bool isAbsolutePath(const std::string& path) {
+    return !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+}
+
+// Чтение материалов MTL, пути к текстурам отсчитываются от каталога файла
+static void parseMaterials(const std::string& path, std::vector<REngine::ObjMaterial>& materials) {
+    REngine::AssetFile file(path);
+    if (!file.isOpen()) {
+        WARN("Material library not found: " + path);
+        return;
+    }
+    std::string directory = getDirectory(path);
+    const char* data = reinterpret_cast<const char*>(file.data());
+    const char* end = data + file.size();
+    auto texturePath = [&](const char* p) {
+        // Параметры вроде -s или -bm идут до имени файла, поэтому берётся последнее слово
+        std::string value = readRest(p, end);
+        size_t space = value.find_last_of(" \t");
+        std::string name = space == std::string::npos ? value : value.substr(space + 1);
+        std::replace(name.begin(), name.end(), '\\', '/');
+        return isAbsolutePath(name) ? name : directory + name;
+    };
+    REngine::ObjMaterial* material = nullptr;
+    for (const char* p = data; p < end;) {
+        p = skipSpaces(p, end);
+        if (startsWith(p, end, "newmtl")) {
+            materials.push_back({readRest(p + 6, end), "", "", 32.0f});
+            material = &materials.back();
+        } else if (material && startsWith(p, end, "map_Kd")) {
+            material->texturePath = texturePath(p + 6);
+        } else if (material && startsWith(p, end, "map_Ks")) {
+            material->specularPath = texturePath(p + 6);
+        } else if (material && startsWith(p, end, "Ns")) {
+            float shininess;
+            if (parseFloats(p + 2, end, &shininess, 1, 1)) {
+                material->shininess = shininess;
+            }
+        }
+        p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        p = p ? p + 1 : end;
+    }
+}
+
+// Хэш вершины из индексов координат, UV и нормали
+static uint32_t hashCorner(const int* corner) {
+    uint32_t hash = (uint32_t)corner[0] * 0x9E3779B1u;
+    hash ^= (uint32_t)corner[1] * 0x85EBCA77u + (hash << 6) + (hash >> 2);
+    hash ^= (uint32_t)corner[2] * 0xC2B2AE3Du + (hash << 6) + (hash >> 2);
+    return hash ^ (hash >> 15);
+}
+
+// Треугольники фрагмента first..last одной части модели
+struct ObjRange {
+    const ObjChunk* chunk;
+    size_t first, last;
+};
+
+static void buildShape(REngine::ObjShape& shape, const std::vector<ObjRange>& ranges, const std::vector<float>& positions,
+                       const std::vector<float>& texcoords, const std::vector<float>& normals, const std::vector<float>& smoothNormals) {
+    size_t cornerCount = 0;
+    for (const ObjRange& range : ranges) {
+        cornerCount += (range.last - range.first) * 3;
+    }
+    // Открытая адресация: таблица не меньше удвоенного числа вершин треугольников
+    size_t tableSize = 16;
+    while (tableSize < cornerCount * 2) {
+        tableSize *= 2;
+    }
+    std::vector<int> table(tableSize, -1);
+    std::vector<int> keys;
+    keys.reserve(cornerCount);
+    shape.indices.reserve(cornerCount);
+    for (const ObjRange& range : ranges) {
+        const int* corners = range.chunk->corners.data();
+        for (size_t i = range.first * 9; i < range.last * 9; i += 3) {
+            const int* corner = corners + i;
+            size_t slot = hashCorner(corner) & (tableSize - 1);
+            while (table[slot] >= 0 && std::memcmp(&keys[table[slot] * 3], corner, sizeof(int) * 3) != 0) {
+                slot = (slot + 1) & (tableSize - 1);
+            }
+            if (table[slot] < 0) {
+                table[slot] = (int)(keys.size() / 3);
+                keys.insert(keys.end(), corner, corner + 3);
+            }
+            shape.indices.push_back((unsigned)table[slot]);
+        }
+    }
+
+    shape.vertices.resize(keys.size() / 3 * 8);
+    for (size_t v = 0; v < keys.size() / 3; v++) {
+        const int* key = &keys[v * 3];
+        float* vertex = &shape.vertices[v * 8];
+        std::memcpy(vertex, &positions[(size_t)key[0] * 3], sizeof(float) * 3);
+        const float* normal = key[2] == OBJ_MISSING ? &smoothNormals[(size_t)key[0] * 3] : &normals[(size_t)key[2] * 3];
+        std::memcpy(vertex + 3, normal, sizeof(float) * 3);
+        if (key[1] == OBJ_MISSING) {
+            vertex[6] = vertex[7] = 0.0f;
+        } else {
+            std::memcpy(vertex + 6, &texcoords[(size_t)key[1] * 2], sizeof(float) * 2);
+        }
+    }
+}
+
+bool REngine::ObjImporter::parse(const char* data, size_t size, const std::string& directory, ObjModel& model, int threads) {
+    model.shapes.clear();
+    model.materials.clear();
+    if (threads <= 0) {
+        threads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+
+    // Фрагменты заканчиваются на границе строки
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threads, size / OBJ_CHUNK_MIN));
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char* end = data + size;
+    const char* begin = data;
+    for (size_t i = 0; i < chunkCount; i++) {
+        const char* split = i + 1 == chunkCount ? end : data + size / chunkCount * (i + 1);
+        if (split < begin) {
+            split = begin;
+        }
+        const char* newline = static_cast<const char*>(std::memchr(split, '\n', end - split));
+        split = newline ? newline + 1 : end;
+        chunks[i].begin = begin;
+        chunks[i].end = split;
+        begin = split;
+    }
+    parallelFor(chunks.size(), threads, [&](size_t i) { parseChunk(chunks[i]); });
+
+    size_t positionCount = 0, texcoordCount = 0, normalCount = 0;
+    for (ObjChunk& chunk : chunks) {
+        if (chunk.error) {
+            size_t length = std::find(chunk.error, chunk.end, '\n') - chunk.error;
+            ERROR("Invalid OBJ line: " << std::string(chunk.error, std::min<size_t>(length, 80)));
+            return false;
+        }
+        chunk.positionBase = positionCount;
+        chunk.texcoordBase = texcoordCount;
+        chunk.normalBase = normalCount;
+        positionCount += chunk.positions.size() / 3;
+        texcoordCount += chunk.texcoords.size() / 2;
+        normalCount += chunk.normals.size() / 3;
+    }
+
+    // Сшивка фрагментов: относительные индексы переводятся в индексы от начала файла
+    std::vector<float> positions, texcoords, normals;
+    positions.reserve(positionCount * 3);
+    texcoords.reserve(texcoordCount * 2);
+    normals.reserve(normalCount * 3);
+    for (const ObjChunk& chunk : chunks) {
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        texcoords.insert(texcoords.end(), chunk.texcoords.begin(), chunk.texcoords.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+    }
+    std::atomic<bool> valid{true};
+    std::atomic<bool> missingNormals{false};
+    parallelFor(chunks.size(), threads, [&](size_t c) {
+        ObjChunk& chunk = chunks[c];
+        const size_t bases[3] = {chunk.positionBase, chunk.texcoordBase, chunk.normalBase};
+        const size_t counts[3] = {positionCount, texcoordCount, normalCount};
+        for (size_t i = 0; i < chunk.corners.size(); i++) {
+            int& index = chunk.corners[i];
+            int k = (int)(i % 3);
+            if (index == OBJ_MISSING) {
+                if (k == 2) {
+                    missingNormals = true;
+                }
+                continue;
+            }
+            long long value = index < OBJ_MISSING ? (long long)bases[k] + index + OBJ_RELATIVE : index;
+            if (value < 0 || (size_t)value >= counts[k]) {
+                valid = false;
+                return;
+            }
+            index = (int)value;
+        }
+    });
+    if (!valid) {
+        ERROR("OBJ face references a missing vertex");
+        return false;
+    }
+
+    // Без нормалей в файле нормаль вершины складывается из нормалей треугольников с весом по площади
+    std::vector<float> smoothNormals;
+    if (missingNormals) {
+        smoothNormals.assign(positions.size(), 0.0f);
+        for (const ObjChunk& chunk : chunks) {
+            for (size_t i = 0; i < chunk.corners.size(); i += 9) {
+                const float* a = &positions[(size_t)chunk.corners[i] * 3];
+                const float* b = &positions[(size_t)chunk.corners[i + 3] * 3];
+                const float* c = &positions[(size_t)chunk.corners[i + 6] * 3];
+                glm::vec3 normal = glm::cross(glm::vec3(b[0] - a[0], b[1] - a[1], b[2] - a[2]), glm::vec3(c[0] - a[0], c[1] - a[1], c[2] - a[2]));
+                for (int k = 0; k < 3; k++) {
+                    float* sum = &smoothNormals[(size_t)chunk.corners[i + k * 3] * 3];
+                    sum[0] += normal.x;
+                    sum[1] += normal.y;
+                    sum[2] += normal.z;
+                }
+            }
+        }
+        for (size_t i = 0; i < smoothNormals.size(); i += 3) {
+            float length = std::sqrt(smoothNormals[i] * smoothNormals[i] + smoothNormals[i + 1] * smoothNormals[i + 1] +
+                                     smoothNormals[i + 2] * smoothNormals[i + 2]);
+            if (length > 0.0f) {
+                smoothNormals[i] /= length;
+                smoothNormals[i + 1] /= length;
+                smoothNormals[i + 2] /= length;
+            }
+        }
+    }
+
+    std::vector<std::string> libraries;
+    for (const ObjChunk& chunk : chunks) {
+        for (const std::string& library : chunk.libraries) {
+            if (std::find(libraries.begin(), libraries.end(), library) == libraries.end()) {
+                libraries.push_back(library);
+                parseMaterials(isAbsolutePath(library) ? library : directory + library, model.materials);
+            }
+        }
+    }
+
+    // Треугольники группируются по материалу, часть получает имя объекта, где материал встретился впервые
+    std::unordered_map<std::string, size_t> shapeIndices;
+    std::vector<std::vector<ObjRange>> shapeRanges;
+    std::string material, name;
+    for (const ObjChunk& chunk : chunks) {
+        for (size_t r = 0; r < chunk.runs.size(); r++) {
+            const ObjRun& run = chunk.runs[r];
+            material = run.hasMaterial ? run.material : material;
+            name = run.hasName ? run.name : name;
+            size_t last = r + 1 < chunk.runs.size() ? chunk.runs[r + 1].start : chunk.corners.size() / 9;
+            if (last == run.start) {
+                continue;
+            }
+            auto it = shapeIndices.find(material);
+            if (it == shapeIndices.end()) {
+                it = shapeIndices.emplace(material, model.shapes.size()).first;
+                ObjShape shape;
+                shape.name = name;
+                for (size_t m = 0; m < model.materials.size(); m++) {
+                    if (model.materials[m].name == material) {
+                        shape.material = (int)m;
+                    }
+                }
+                if (shape.material < 0 && !material.empty()) {
+                    WARN("Unknown OBJ material: " + material);
+                }
+                model.shapes.push_back(std::move(shape));
+                shapeRanges.emplace_back();
+            }
+            shapeRanges[it->second].push_back({&chunk, run.start, last});
+        }
+    }
+
+    parallelFor(model.shapes.size(), threads,
+                [&](size_t i) { buildShape(model.shapes[i], shapeRanges[i], positions, texcoords, normals, smoothNormals); });
+    return true;
+}
+
+bool REngine::ObjImporter::parse(const std::string& path, ObjModel& model, int threads) {
+    AssetFile file(path);
+    if (!file.isOpen()) {
+        ERROR("Failed to open OBJ file: " + path);
+        return false;
+    }
+    if (!parse(reinterpret_cast<const char*>(file.data()), file.size(), getDirectory(path), model, threads)) {
+        ERROR("Failed to import OBJ file: " + path);
+        return false;
+    }
+    return true;
+}
+
+REngine::ObjImporter::~ObjImporter() {
+    for (Mesh* mesh : meshes) {
+        delete mesh;
+    }
+}
+
+bool REngine::ObjImporter::load(const std::string& path, Scene& scene, int threads) {
+    ObjModel model;
+    if (!parse(path, model, threads)) {
+        return false;
+    }
+    for (const ObjShape& shape : model.shapes) {
+        Mesh* mesh = new Mesh(shape.vertices, shape.indices);
+        mesh->computeAABB();
+        meshes.push_back(mesh);
+
+        SceneNode node;
+        node.mesh = mesh;
+        if (shape.material >= 0) {
+            const ObjMaterial& material = model.materials[shape.material];
+            node.texturePath = material.texturePath;
+            node.specularPath = material.specularPath;
+            node.shininess = material.shininess;
+        }
+        scene.nodes.push_back(node);
+    }
+    DEBUG("Imported " << path << ": " << model.shapes.size() << " meshes, " << model.materials.size() << " materials");
+    return true;
+}
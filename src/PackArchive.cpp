@@ -0,0 +1,172 @@
+#include "PackArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+#include "Lz4.h"
+
+std::string REngine::PackArchive::normalizeName(const std::string& path) {
+    std::string name = path;
+    std::replace(name.begin(), name.end(), '\\', '/');
+    if (!name.empty() && name[0] == '/') {
+        return name;
+    }
+    // Пути в архиве отсчитываются от корня ресурсов, поэтому ".." выше корня отбрасывается,
+    // и "../textures/a.bmp" совпадает с "textures/a.bmp"
+    std::string result;
+    for (size_t start = 0; start <= name.size();) {
+        size_t end = std::min(name.find('/', start), name.size());
+        size_t length = end - start;
+        if (length == 2 && name.compare(start, 2, "..") == 0) {
+            size_t slash = result.rfind('/');
+            result.erase(slash == std::string::npos ? 0 : slash);
+        } else if (!(length == 1 && name[start] == '.')) {
+            if (!result.empty()) {
+                result += '/';
+            }
+            result.append(name, start, length);
+        }
+        start = end + 1;
+    }
+    return result;
+}
+
+uint64_t REngine::PackArchive::hashName(const std::string& name) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (unsigned char c : name) {
+        hash ^= c;
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+bool REngine::PackArchive::save(const std::string& path, const std::vector<PackFile>& files) {
+    std::ofstream output(path, std::ios::binary);
+    if (!output.is_open()) {
+        return false;
+    }
+
+    RPakHeader header = {};
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<RPakEntry> entries;
+    std::string names;
+    std::unordered_set<std::string> written;
+    std::vector<unsigned char> compressed;
+    const char padding[RPAK_ALIGNMENT] = {};
+    uint64_t position = sizeof(header);
+    for (const PackFile& file : files) {
+        std::string name = normalizeName(file.name);
+        if (!written.insert(name).second) {
+            return false;
+        }
+
+        const unsigned char* data = file.data.data();
+        RPakEntry entry = {hashName(name), 0, file.data.size(), file.data.size(), (uint32_t)names.size(), (uint32_t)name.size(), 0, 0};
+        if (file.compress && !file.data.empty()) {
+            Lz4::compress(file.data.data(), file.data.size(), compressed);
+            if (compressed.size() < file.data.size()) {
+                data = compressed.data();
+                entry.storedSize = compressed.size();
+                entry.flags = RPAK_FLAG_LZ4;
+            }
+        }
+
+        // Данные выравниваются, чтобы вложенные форматы вроде .rtex сохраняли выравнивание уровней
+        uint64_t offset = (position + RPAK_ALIGNMENT - 1) & ~(uint64_t)(RPAK_ALIGNMENT - 1);
+        output.write(padding, offset - position);
+        output.write(reinterpret_cast<const char*>(data), entry.storedSize);
+        entry.offset = offset;
+        position = offset + entry.storedSize;
+        entries.push_back(entry);
+        names += name;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const RPakEntry& a, const RPakEntry& b) { return a.hash < b.hash; });
+    header.magic = RPAK_MAGIC;
+    header.version = RPAK_VERSION;
+    header.entryCount = (uint32_t)entries.size();
+    header.tableOffset = (position + alignof(RPakEntry) - 1) & ~(uint64_t)(alignof(RPakEntry) - 1);
+    header.namesOffset = header.tableOffset + sizeof(RPakEntry) * entries.size();
+    output.write(padding, header.tableOffset - position);
+    output.write(reinterpret_cast<const char*>(entries.data()), sizeof(RPakEntry) * entries.size());
+    output.write(names.data(), names.size());
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return !output.fail();
+}
+
+bool REngine::PackArchive::open(const std::string& path) {
+    close();
+    if (!file.open(path)) {
+        return false;
+    }
+
+    RPakHeader header;
+    size_t size = file.size();
+    if (size < sizeof(header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != RPAK_MAGIC || header.version != RPAK_VERSION || header.tableOffset % alignof(RPakEntry) != 0 ||
+        header.tableOffset > size || (size - header.tableOffset) / sizeof(RPakEntry) < header.entryCount ||
+        header.namesOffset != header.tableOffset + sizeof(RPakEntry) * header.entryCount) {
+        close();
+        return false;
+    }
+
+    // Отображение выровнено по странице, поэтому таблица читается без копирования
+    const RPakEntry* table = reinterpret_cast<const RPakEntry*>(file.data() + header.tableOffset);
+    size_t namesSize = size - header.namesOffset;
+    for (uint32_t i = 0; i < header.entryCount; i++) {
+        const RPakEntry& entry = table[i];
+        bool compressed = (entry.flags & RPAK_FLAG_LZ4) != 0;
+        if (entry.offset > size || size - entry.offset < entry.storedSize || (!compressed && entry.storedSize != entry.size) ||
+            entry.nameOffset > namesSize || namesSize - entry.nameOffset < entry.nameLength || (i > 0 && table[i - 1].hash > entry.hash)) {
+            close();
+            return false;
+        }
+    }
+
+    this->path = path;
+    entries = table;
+    entryCount = header.entryCount;
+    names = reinterpret_cast<const char*>(file.data() + header.namesOffset);
+    return true;
+}
+
+void REngine::PackArchive::close() {
+    file.close();
+    path.clear();
+    entries = nullptr;
+    entryCount = 0;
+    names = nullptr;
+}
+
+const REngine::RPakEntry* REngine::PackArchive::find(const std::string& name) const {
+    uint64_t hash = hashName(name);
+    const RPakEntry* end = entries + entryCount;
+    const RPakEntry* entry = std::lower_bound(entries, end, hash, [](const RPakEntry& a, uint64_t value) { return a.hash < value; });
+    // При совпадении хэшей имена сравниваются целиком
+    for (; entry != end && entry->hash == hash; entry++) {
+        if (entry->nameLength == name.size() && std::memcmp(names + entry->nameOffset, name.data(), name.size()) == 0) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+const unsigned char* REngine::PackArchive::read(const RPakEntry& entry, std::vector<unsigned char>& buffer) const {
+    const unsigned char* data = file.data() + entry.offset;
+    if ((entry.flags & RPAK_FLAG_LZ4) == 0) {
+        return data;
+    }
+    buffer.resize(entry.size);
+    if (!Lz4::decompress(data, entry.storedSize, buffer.data(), buffer.size())) {
+        return nullptr;
+    }
+    return buffer.data();
+}
@@ -0,0 +1,143 @@
+#include "PixelConvert.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define PIXEL_CONVERT_X86
+    #include <immintrin.h>
+#endif
+
+static void swapRB24Scalar(const unsigned char* src, unsigned char* dst, size_t pixels) {
+    for (size_t i = 0; i < pixels; i++) {
+        unsigned char b = src[i * 3];
+        dst[i * 3 + 1] = src[i * 3 + 1];
+        dst[i * 3] = src[i * 3 + 2];
+        dst[i * 3 + 2] = b;
+    }
+}
+
+static void swapRB32Scalar(const unsigned char* src, unsigned char* dst, size_t pixels) {
+    for (size_t i = 0; i < pixels; i++) {
+        unsigned char b = src[i * 4];
+        dst[i * 4 + 1] = src[i * 4 + 1];
+        dst[i * 4 + 3] = src[i * 4 + 3];
+        dst[i * 4] = src[i * 4 + 2];
+        dst[i * 4 + 2] = b;
+    }
+}
+
+#ifdef PIXEL_CONVERT_X86
+// Перестановка 4 пикселей по 3 байта, последние 4 байта регистра не меняются
+#define SWAP_RB24_MASK 2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15
+#define SWAP_RB32_MASK 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+
+__attribute__((target("ssse3"))) static size_t swapRB24SSSE3(const unsigned char* src, unsigned char* dst,
+                                                              size_t pixels) {
+    const __m128i mask = _mm_setr_epi8(SWAP_RB24_MASK);
+    size_t i = 0;
+    // Читаются и пишутся 16 байт, из которых меняются 12, поэтому нужен запас в пиксель
+    for (; i + 6 <= pixels; i += 4) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 3), _mm_shuffle_epi8(value, mask));
+    }
+    return i;
+}
+
+__attribute__((target("ssse3"))) static size_t swapRB32SSSE3(const unsigned char* src, unsigned char* dst,
+                                                              size_t pixels) {
+    const __m128i mask = _mm_setr_epi8(SWAP_RB32_MASK);
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_shuffle_epi8(value, mask));
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) static size_t swapRB24AVX2(const unsigned char* src, unsigned char* dst,
+                                                            size_t pixels) {
+    const __m256i mask = _mm256_setr_epi8(SWAP_RB24_MASK, SWAP_RB24_MASK);
+    // Байты 12..23 переносятся в верхнюю половину регистра, pshufb работает внутри половин
+    const __m256i spread = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    const __m256i gather = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+    const __m256i storeMask = _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0);
+    size_t i = 0;
+    // Читаются 32 байта, пишутся 24
+    for (; i + 11 <= pixels; i += 8) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 3));
+        value = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(value, spread), mask);
+        _mm256_maskstore_epi32(reinterpret_cast<int*>(dst + i * 3), storeMask, _mm256_permutevar8x32_epi32(value, gather));
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) static size_t swapRB32AVX2(const unsigned char* src, unsigned char* dst,
+                                                            size_t pixels) {
+    const __m256i mask = _mm256_setr_epi8(SWAP_RB32_MASK, SWAP_RB32_MASK);
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_shuffle_epi8(value, mask));
+    }
+    return i;
+}
+#endif
+
+static REngine::SimdLevel detectSimdLevel() {
+#ifdef PIXEL_CONVERT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return REngine::SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return REngine::SimdLevel::SSSE3;
+    }
+#endif
+    return REngine::SimdLevel::Scalar;
+}
+
+static const REngine::SimdLevel supportedLevel = detectSimdLevel();
+static std::atomic<REngine::SimdLevel> activeLevel{supportedLevel};
+
+void REngine::PixelConvert::swapRB24(const unsigned char* src, unsigned char* dst, size_t pixels) {
+    size_t done = 0;
+#ifdef PIXEL_CONVERT_X86
+    switch (getSimdLevel()) {
+        case SimdLevel::AVX2:
+            done = swapRB24AVX2(src, dst, pixels);
+            break;
+        case SimdLevel::SSSE3:
+            done = swapRB24SSSE3(src, dst, pixels);
+            break;
+        case SimdLevel::Scalar:
+            break;
+    }
+#endif
+    swapRB24Scalar(src + done * 3, dst + done * 3, pixels - done);
+}
+
+void REngine::PixelConvert::swapRB32(const unsigned char* src, unsigned char* dst, size_t pixels) {
+    size_t done = 0;
+#ifdef PIXEL_CONVERT_X86
+    switch (getSimdLevel()) {
+        case SimdLevel::AVX2:
+            done = swapRB32AVX2(src, dst, pixels);
+            break;
+        case SimdLevel::SSSE3:
+            done = swapRB32SSSE3(src, dst, pixels);
+            break;
+        case SimdLevel::Scalar:
+            break;
+    }
+#endif
+    swapRB32Scalar(src + done * 4, dst + done * 4, pixels - done);
+}
+
+REngine::SimdLevel REngine::PixelConvert::getSimdLevel() {
+    return activeLevel.load(std::memory_order_relaxed);
+}
+
+void REngine::PixelConvert::setSimdLevel(SimdLevel level) {
+    activeLevel.store(std::min(level, supportedLevel), std::memory_order_relaxed);
+}
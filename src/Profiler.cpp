@@ -0,0 +1,136 @@
+#include "Profiler.h"
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Logging.h"
+
+/// @brief Событие профилировщика
+struct ProfileEvent {
+    const char* name;
+    Uint64 start;
+    Uint64 end;
+};
+
+/// @brief Буфер событий потока
+/// @details Пишется только потоком-владельцем, количество событий публикуется
+/// атомарно, поэтому запись не требует блокировок
+struct ProfileThreadBuffer {
+    std::unique_ptr<ProfileEvent[]> events{new ProfileEvent[PROFILER_THREAD_EVENTS_MAX]};
+    std::atomic<size_t> count{0};
+    std::atomic<size_t> dropped{0};
+    int id = 0;
+    std::string name;
+};
+
+std::atomic<bool> REngine::Profiler::capturing{false};
+
+// Реестр буферов защищён мьютексом, который берётся только при регистрации
+// потока и при записи трассировки
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<ProfileThreadBuffer>> threadBuffers;
+static thread_local ProfileThreadBuffer* threadBuffer = nullptr;
+
+static bool captureArmed = false;
+static unsigned long captureFirst = 0;
+static unsigned long captureLast = 0;
+static std::string capturePath;
+static Uint64 captureStart = 0;
+
+static ProfileThreadBuffer* getThreadBuffer() {
+    if (!threadBuffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threadBuffers.push_back(std::make_unique<ProfileThreadBuffer>());
+        threadBuffer = threadBuffers.back().get();
+        threadBuffer->id = (int)threadBuffers.size();
+        threadBuffer->name = "thread " + std::to_string(threadBuffer->id);
+    }
+    return threadBuffer;
+}
+
+void REngine::Profiler::setCaptureRange(unsigned long firstFrame, unsigned long lastFrame, const std::string& path) {
+    captureFirst = firstFrame;
+    captureLast = lastFrame;
+    capturePath = path;
+    captureArmed = true;
+}
+
+void REngine::Profiler::beginFrame(unsigned long frame) {
+    if (!captureArmed) {
+        return;
+    }
+
+    if (frame >= captureFirst && frame <= captureLast && !isCapturing()) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto& buffer : threadBuffers) {
+            buffer->count.store(0, std::memory_order_relaxed);
+            buffer->dropped.store(0, std::memory_order_relaxed);
+        }
+        captureStart = SDL_GetPerformanceCounter();
+        capturing.store(true, std::memory_order_release);
+        INFO("Profiler capture started at frame " << frame);
+    } else if (frame > captureLast) {
+        capturing.store(false, std::memory_order_release);
+        captureArmed = false;
+        writeChromeTrace(capturePath);
+    }
+}
+
+void REngine::Profiler::setThreadName(const char* name) {
+    getThreadBuffer()->name = name;
+}
+
+void REngine::Profiler::record(const char* name, Uint64 start, Uint64 end) {
+    ProfileThreadBuffer* buffer = getThreadBuffer();
+    size_t index = buffer->count.load(std::memory_order_relaxed);
+    if (index >= PROFILER_THREAD_EVENTS_MAX) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[index] = {name, start, end};
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+bool REngine::Profiler::writeChromeTrace(const std::string& path) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        ERROR("Failed to open trace file: " + path);
+        return false;
+    }
+
+    double toMicroseconds = 1000000.0 / SDL_GetPerformanceFrequency();
+    size_t written = 0;
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    for (auto& buffer : threadBuffers) {
+        file << (first ? "\n" : ",\n")
+             << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->id
+             << ", \"args\": {\"name\": \"" << buffer->name << "\"}}";
+        first = false;
+
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++) {
+            const ProfileEvent& event = buffer->events[i];
+            if (event.start < captureStart) {
+                continue;
+            }
+            file << ",\n{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->id
+                 << ", \"ts\": " << (event.start - captureStart) * toMicroseconds
+                 << ", \"dur\": " << (event.end - event.start) * toMicroseconds << "}";
+        }
+        written += count;
+
+        size_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+        if (dropped > 0) {
+            WARN("Profiler dropped " << dropped << " events on " << buffer->name);
+        }
+    }
+    file << "\n]}\n";
+
+    INFO("Profiler trace with " << written << " events written to " << path);
+    return true;
+}
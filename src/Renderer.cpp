@@ -3,19 +3,97 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
 #include <vector>
 #include <SDL.h>
 
+#include "AllocTracker.h"
 #include "Mesh.h"
 #include "Logging.h"
+#include "Profiler.h"
 #include "Texture.h"
+#include "TextureCache.h"
+#include "TexturePool.h"
+#include "TextureResidency.h"
+#include "TextureStreamer.h"
 #include "Volume.h"
 
-void applyTexture(REngine::SceneNode& node, glm::vec3 defColor = glm::vec3(1.0f));
-void applySpecTexture(REngine::SceneNode& node, glm::vec3 defColor = glm::vec3(0.5f));
+REngine::Texture* applyTexture(REngine::SceneNode& node, glm::vec3 defColor = glm::vec3(1.0f));
+REngine::Texture* applySpecTexture(REngine::SceneNode& node, glm::vec3 defColor = glm::vec3(0.5f));
+
+/// @brief Имена полей точечного источника света в шейдере
+struct PointLightUniformNames {
+    std::string position, ambient, diffuse, specular, constant, linear, quadratic;
+};
+
+// Название области GPU для корзины сетки и материала. На названия ссылаются GpuProfiler и FrameStats,
+// поэтому таблица строится один раз и живёт до конца программы
+static const char* getDrawScopeName(uint32_t bucket) {
+    static const std::vector<std::string> names = []() {
+        std::vector<std::string> result(RENDERER_DRAW_SCOPES);
+        for (int i = 0; i < RENDERER_DRAW_SCOPES; i++) {
+            result[i] = "draw bucket " + std::to_string(i);
+        }
+        return result;
+    }();
+    return names[bucket % RENDERER_DRAW_SCOPES].c_str();
+}
+
+// Имена строятся один раз, чтобы не собирать строки в каждом кадре
+static const std::vector<PointLightUniformNames>& getPointLightUniformNames() {
+    static const std::vector<PointLightUniformNames> names = []() {
+        std::vector<PointLightUniformNames> result(POINT_LIGHTS_MAX);
+        for (int i = 0; i < POINT_LIGHTS_MAX; i++) {
+            std::string prefix = "pointLights[" + std::to_string(i) + "].";
+            result[i] = {prefix + "position", prefix + "ambient", prefix + "diffuse", prefix + "specular",
+                         prefix + "constant", prefix + "linear", prefix + "quadratic"};
+        }
+        return result;
+    }();
+    return names;
+}
 
 REngine::Renderer::Renderer(int width, int height)
-    : width(width), height(height) {}
+    : width(width), height(height), gpuProfiler(new GpuProfiler()),
+      framebuffer(0), colorBuffer(0), depthBuffer(0), instanceBuffers(), instanceBufferSizes(), instancing(false), solidColors(false) {}
+
+REngine::Renderer::~Renderer() {
+    delete gpuProfiler;
+    TexturePool::setEnabled(false);
+    if (instanceBuffers[0] != 0) {
+        glDeleteBuffers(FRAMES_IN_FLIGHT_MAX, instanceBuffers);
+    }
+    if (framebuffer != 0) {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+    }
+}
+
+bool REngine::Renderer::createOffscreenTarget() {
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        ERROR("Offscreen framebuffer is incomplete: " << status);
+        return false;
+    }
+    return true;
+}
 
 void REngine::Renderer::setScene(Scene* scene) {
     this->scene = scene;
@@ -23,6 +101,9 @@ void REngine::Renderer::setScene(Scene* scene) {
 
 void REngine::Renderer::setShader(const char* vertexPath, const char* fragmentPath) {
     shader = new Shader(vertexPath, fragmentPath);
+    instancing = shader->hasUniform("instanced");
+    solidColors = shader->hasUniform("diffuseSolidColor") && shader->hasUniform("specularSolidColor");
+    TexturePool::setEnabled(instancing);
 }
 
 REngine::Renderer* REngine::initRenderer(int width, int height) {
@@ -42,30 +123,180 @@ REngine::Renderer* REngine::initRenderer(int width, int height) {
     return new REngine::Renderer(width, height);
 }
 
-void REngine::Renderer::draw(unsigned long ticks) {
-    glClearColor(scene->skyColor.x, scene->skyColor.y, scene->skyColor.z, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    shader->use();
-    shader->setMat4("view", scene->camera.getViewMatrix());
-    shader->setMat4("projection", scene->camera.getProjectionMatrix());
-    shader->setFloat("u_time", ticks / 1000.0f);
-    shader->setVec3("u_camera_position", scene->camera.position);
-    shader->setVec3("dirLight.direction", scene->dirLight.direction);
-    shader->setVec3("dirLight.ambient", scene->dirLight.ambient);
-    shader->setVec3("dirLight.diffuse", scene->dirLight.diffuse);
-    shader->setVec3("dirLight.specular", scene->dirLight.specular);
-    shader->setInt("pointLightsCount", std::min((int)scene->pointLights.size(), POINT_LIGHTS_MAX));
-    for (int i = 0; i < std::min((int)scene->pointLights.size(), POINT_LIGHTS_MAX); i++) {
-        shader->setVec3("pointLights[" + std::to_string(i) + "].position", scene->pointLights[i].position);
-        shader->setVec3("pointLights[" + std::to_string(i) + "].ambient", scene->pointLights[i].ambient);
-        shader->setVec3("pointLights[" + std::to_string(i) + "].diffuse", scene->pointLights[i].diffuse);
-        shader->setVec3("pointLights[" + std::to_string(i) + "].specular", scene->pointLights[i].specular);
-        shader->setFloat("pointLights[" + std::to_string(i) + "].constant", scene->pointLights[i].constant);
-        shader->setFloat("pointLights[" + std::to_string(i) + "].linear", scene->pointLights[i].linear);
-        shader->setFloat("pointLights[" + std::to_string(i) + "].quadratic", scene->pointLights[i].quadratic);
+GLuint REngine::Renderer::writeInstances(int frameSlot, const InstanceData* instances, size_t count) {
+    if (instanceBuffers[0] == 0) {
+        glGenBuffers(FRAMES_IN_FLIGHT_MAX, instanceBuffers);
+    }
+    GLuint buffer = instanceBuffers[frameSlot];
+    size_t bytes = count * sizeof(InstanceData);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    if (instanceBufferSizes[frameSlot] < bytes) {
+        // Буфер растёт с запасом, чтобы не пересоздаваться при небольших изменениях сцены
+        instanceBufferSizes[frameSlot] = std::max(bytes, instanceBufferSizes[frameSlot] * 2);
+        glBufferData(GL_ARRAY_BUFFER, instanceBufferSizes[frameSlot], nullptr, GL_DYNAMIC_DRAW);
+    }
+    // GPU закончил кадр, читавший этот буфер, поэтому ожидание драйвера не нужно
+    void* mapped = bytes ? glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes,
+                                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT)
+                         : nullptr;
+    bool written = false;
+    if (mapped) {
+        std::memcpy(mapped, instances, bytes);
+        written = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+    }
+    if (!written && bytes) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return buffer;
+}
+
+void REngine::Renderer::draw(unsigned long ticks, int frameSlot) {
+    counters = RenderCounters();
+    unsigned int bindsBefore = Texture::bindCount;
+    AllocScope allocScope;
+    GpuScope frameScope(gpuProfiler, "frame");
+
+    {
+        GpuScope clearScope(gpuProfiler, "clear");
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glClearColor(scene->skyColor.x, scene->skyColor.y, scene->skyColor.z, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    {
+        PROFILE_SCOPE("Renderer::setup");
+        shader->use();
+        shader->setMat4("view", scene->camera.getViewMatrix());
+        shader->setMat4("projection", scene->camera.getProjectionMatrix());
+        shader->setFloat("u_time", ticks / 1000.0f);
+        shader->setVec3("u_camera_position", scene->camera.position);
+        shader->setVec3("dirLight.direction", scene->dirLight.direction);
+        shader->setVec3("dirLight.ambient", scene->dirLight.ambient);
+        shader->setVec3("dirLight.diffuse", scene->dirLight.diffuse);
+        shader->setVec3("dirLight.specular", scene->dirLight.specular);
+        shader->setInt("pointLightsCount", std::min((int)scene->pointLights.size(), POINT_LIGHTS_MAX));
+        const std::vector<PointLightUniformNames>& lightNames = getPointLightUniformNames();
+        for (int i = 0; i < std::min((int)scene->pointLights.size(), POINT_LIGHTS_MAX); i++) {
+            shader->setVec3(lightNames[i].position, scene->pointLights[i].position);
+            shader->setVec3(lightNames[i].ambient, scene->pointLights[i].ambient);
+            shader->setVec3(lightNames[i].diffuse, scene->pointLights[i].diffuse);
+            shader->setVec3(lightNames[i].specular, scene->pointLights[i].specular);
+            shader->setFloat(lightNames[i].constant, scene->pointLights[i].constant);
+            shader->setFloat(lightNames[i].linear, scene->pointLights[i].linear);
+            shader->setFloat(lightNames[i].quadratic, scene->pointLights[i].quadratic);
+        }
+    }
+
+    ArenaVector<DrawPacket> packets;
+    packets.reserve(scene->nodes.size());
+    cull(packets);
+
+    {
+        // Объекты с одной сеткой идут подряд, внутри группы от ближних к дальним
+        PROFILE_SCOPE("Renderer::sort");
+        std::sort(packets.begin(), packets.end(),
+                  [](const DrawPacket& a, const DrawPacket& b) { return a.sortKey < b.sortKey; });
+    }
+
+    GLuint instanceBuffer = 0;
+    if (instancing) {
+        // Данные всех объектов передаются одним буфером слота кадра, группа читает свой диапазон
+        PROFILE_SCOPE("Renderer::instances");
+        ArenaVector<InstanceData> instances;
+        instances.reserve(packets.size());
+        for (const DrawPacket& packet : packets) {
+            glm::vec4 material(Mesh::getMaterialSource(packet.diffuse), Mesh::getMaterialSource(packet.specular), packet.node->shininess,
+                               packet.node->distort ? 1.0f : 0.0f);
+            glm::vec2 minLod((float)packet.diffuse->getBaseLevel(), (float)packet.specular->getBaseLevel());
+            const float* diffuseColor = packet.diffuse->getColor();
+            const float* specularColor = packet.specular->getColor();
+            instances.push_back({packet.model, packet.normalMatrix, material, minLod,
+                                 glm::vec3(diffuseColor[0], diffuseColor[1], diffuseColor[2]),
+                                 glm::vec3(specularColor[0], specularColor[1], specularColor[2])});
+        }
+        instanceBuffer = writeInstances(frameSlot, instances.data(), instances.size());
+        shader->setInt("diffuseArray", MESH_DIFFUSE_ARRAY_UNIT);
+        shader->setInt("specularArray", MESH_SPECULAR_ARRAY_UNIT);
+    }
+
+    GpuScope opaqueScope(gpuProfiler, "opaque");
+    const TextureArray* boundDiffuse = nullptr;
+    const TextureArray* boundSpecular = nullptr;
+    // Подряд идущие объекты одной корзины сетки и материала измеряются одной областью
+    int drawScope = -1;
+    uint32_t drawBucket = 0;
+    for (size_t i = 0; i < packets.size();) {
+        const DrawPacket& packet = packets[i];
+        SceneNode& node = *packet.node;
+        uint32_t bucket = (uint32_t)(packet.sortKey >> 32) % RENDERER_DRAW_SCOPES;
+        if (gpuProfiler->isDetailed() && (drawScope < 0 || bucket != drawBucket)) {
+            gpuProfiler->endScope(drawScope);
+            drawScope = gpuProfiler->beginScope(getDrawScopeName(bucket));
+            drawBucket = bucket;
+        }
+
+        if (isBatchable(packet)) {
+            // Подряд идущие объекты с одной сеткой и массивами текстур или сплошными цветами рисуются одним вызовом
+            size_t end = i + 1;
+            while (end < packets.size() && packets[end].node->mesh == node.mesh && isBatchable(packets[end]) &&
+                   packets[end].diffuse->getArray() == packet.diffuse->getArray() &&
+                   packets[end].specular->getArray() == packet.specular->getArray()) {
+                end++;
+            }
+            {
+                PROFILE_SCOPE("Renderer::material");
+                shader->setBool("instanced", true);
+                if (packet.diffuse->getArray() && boundDiffuse != packet.diffuse->getArray()) {
+                    glActiveTexture(GL_TEXTURE0 + MESH_DIFFUSE_ARRAY_UNIT);
+                    packet.diffuse->bind();
+                    boundDiffuse = packet.diffuse->getArray();
+                }
+                if (packet.specular->getArray() && boundSpecular != packet.specular->getArray()) {
+                    glActiveTexture(GL_TEXTURE0 + MESH_SPECULAR_ARRAY_UNIT);
+                    packet.specular->bind();
+                    boundSpecular = packet.specular->getArray();
+                }
+            }
+            {
+                PROFILE_SCOPE("Renderer::submit");
+                node.mesh->drawInstanced(instanceBuffer, i * sizeof(InstanceData), (int)(end - i));
+            }
+            counters.drawCalls++;
+            counters.triangles += node.mesh->getIndexCount() / 3 * (end - i);
+            i = end;
+            continue;
+        }
+
+        {
+            PROFILE_SCOPE("Renderer::material");
+            shader->setBool("instanced", false);
+            shader->setMat4("model", packet.model);
+            shader->setMat4("normalMatrix", packet.normalMatrix);
+            shader->setBool("distort", node.distort);
+            shader->setFloat("material.shininess", node.shininess);
+            node.mesh->texture = packet.diffuse;
+            node.mesh->specularTexture = packet.specular;
+        }
+        {
+            PROFILE_SCOPE("Renderer::submit");
+            node.mesh->draw(*shader);
+        }
+        // Отдельная отрисовка может привязать к блокам массивов другие текстуры
+        boundDiffuse = nullptr;
+        boundSpecular = nullptr;
+        counters.drawCalls++;
+        counters.triangles += node.mesh->getIndexCount() / 3;
+        i++;
     }
+    gpuProfiler->endScope(drawScope);
 
+    counters.textureBinds = Texture::bindCount - bindsBefore;
+    counters.allocations = allocScope.getStats().allocations;
+}
+
+void REngine::Renderer::cull(ArenaVector<DrawPacket>& packets) {
+    PROFILE_SCOPE("Renderer::cull");
     REngine::Frustum frustum(scene->camera, (float)width / (float)height);
     for (SceneNode& node : scene->nodes) {
         glm::mat4 model = glm::mat4(1.0f);
@@ -77,7 +308,7 @@ void REngine::Renderer::draw(unsigned long ticks) {
         const glm::vec3 min = node.mesh->getMin() * node.scale;
         const glm::vec3 max = node.mesh->getMax() * node.scale;
 
-        const std::vector<glm::vec3> corners = {
+        const glm::vec3 corners[8] = {
             glm::vec3(model * glm::vec4(min.x, min.y, min.z, 1.0f)),
             glm::vec3(model * glm::vec4(min.x, min.y, max.z, 1.0f)),
             glm::vec3(model * glm::vec4(min.x, max.y, min.z, 1.0f)),
@@ -96,74 +327,70 @@ void REngine::Renderer::draw(unsigned long ticks) {
         }
         
         if (!frustum.isBoxInFrustum(worldMin, worldMax)) {
+            counters.culledNodes++;
             continue;
         }
 
-        model = glm::scale(model, node.scale);
-        shader->setMat4("model", model);
-        shader->setMat4("normalMatrix", glm::transpose(glm::inverse(model)));
-        shader->setBool("distort", node.distort);
-        shader->setFloat("material.shininess", node.shininess);
-        applyTexture(node);
-        applySpecTexture(node);
-        node.mesh->draw(*shader);
+        // Матрицы и текстуры готовятся здесь, чтобы цикл отрисовки только загружал их
+        DrawPacket packet;
+        packet.node = &node;
+        packet.model = glm::scale(model, node.scale);
+        packet.normalMatrix = glm::transpose(glm::inverse(packet.model));
+        packet.diffuse = applyTexture(node);
+        packet.specular = applySpecTexture(node);
+
+        // Нужный размер текстуры: пикселей экрана на единицу UV в ближайшей к камере точке объекта
+        float distance = glm::length(node.position - scene->camera.position);
+        float nearest = std::max(distance - glm::length(worldMax - worldMin) * 0.5f, 0.1f);
+        float pixelsPerUnit = (float)height / (2.0f * std::tan(glm::radians(scene->camera.fov) * 0.5f) * nearest);
+        float scale = std::max(std::abs(node.scale.x), std::max(std::abs(node.scale.y), std::abs(node.scale.z)));
+        float texelSize = pixelsPerUnit * scale / node.mesh->getUVDensity();
+        TextureResidency::touch(packet.diffuse, texelSize);
+        TextureResidency::touch(packet.specular, texelSize);
+
+        // Младшие биты адресов сетки и массивов текстур группируют объекты, столкновения лишь смешивают группы.
+        // Для неотрицательных float порядок битов совпадает с порядком чисел
+        uint32_t meshBits = (uint32_t)(reinterpret_cast<uintptr_t>(node.mesh) >> 4);
+        uint32_t arrayBits = (uint32_t)((reinterpret_cast<uintptr_t>(packet.diffuse->getArray()) >> 4) * 31 +
+                                        (reinterpret_cast<uintptr_t>(packet.specular->getArray()) >> 4));
+        uint32_t depthBits;
+        std::memcpy(&depthBits, &distance, sizeof(depthBits));
+        packet.sortKey = ((uint64_t)(meshBits ^ (arrayBits * 0x9E3779B1u)) << 32) | depthBits;
+
+        packets.push_back(packet);
     }
 }
 
-void applyTexture(REngine::SceneNode& node, glm::vec3 defColor) {
-    REngine::Texture* tex = new REngine::Texture();
-    if (node.texturePath.empty()) {
-        node.texturePath = "gen_color_" + std::to_string(defColor.x) + "_" + std::to_string(defColor.y) + "_" + std::to_string(defColor.z);
-        tex->genFromColor(defColor.x, defColor.y, defColor.z);
-        node.mesh->texture = tex;
-        REngine::Texture::textures[node.texturePath] = tex;
-        return;
-    }
-    if (REngine::Texture::textures.count(node.texturePath) > 0) {
-        node.mesh->texture = REngine::Texture::textures[node.texturePath];
-    } else if (tex->loadBMP(node.texturePath)) {
-        REngine::Texture::textures[node.texturePath] = tex;
-        node.mesh->texture = tex;
-    } else if (tex->loadBMP("./textures/" + node.texturePath)) {
-        REngine::Texture::textures[node.texturePath] = tex;
-        node.mesh->texture = tex;
-    } else if (tex->loadBMP("../textures/" + node.texturePath)) {
-        REngine::Texture::textures[node.texturePath] = tex;
-        node.mesh->texture = tex;
-    } else {
-        ERROR("Failed to load texture: " + node.texturePath);
-        node.texturePath = "gen_color_" + std::to_string(defColor.x) + "_" + std::to_string(defColor.y) + "_" + std::to_string(defColor.z);
-        tex->genFromColor(defColor.x, defColor.y, defColor.z);
-        node.mesh->texture = tex;
-        REngine::Texture::textures[node.texturePath] = tex;
+// Назначение текстуры из кэша, файлы загружаются асинхронно, цвет по умолчанию задаётся без текстуры OpenGL.
+// Шейдерам без переменных сплошного цвета Mesh::draw привязывает общую текстуру 1x1 этого цвета
+static REngine::Texture* requestTexture(std::string& path, glm::vec3 defColor) {
+    bool generated = path.empty();
+    if (generated) {
+        path = "gen_color_" + std::to_string(defColor.x) + "_" + std::to_string(defColor.y) + "_" + std::to_string(defColor.z);
     }
-}
 
-void applySpecTexture(REngine::SceneNode& node, glm::vec3 defColor) {
+    // Текстура из кэша назначается без выделения памяти
+    REngine::Texture* cached = REngine::TextureCache::find(path);
+    if (cached) {
+        return cached;
+    }
+
+    if (!generated) {
+        return REngine::TextureStreamer::request(path, defColor);
+    }
     REngine::Texture* tex = new REngine::Texture();
-    if (node.specularPath.empty()) {
-        node.specularPath = "gen_color_" + std::to_string(defColor.x) + "_" + std::to_string(defColor.y) + "_" + std::to_string(defColor.z);
-        tex->genFromColor(defColor.x, defColor.y, defColor.z);
-        node.mesh->specularTexture = tex;
-        REngine::Texture::textures[node.specularPath] = tex;
-        return;
-    }
-    if (REngine::Texture::textures.count(node.specularPath) > 0) {
-        node.mesh->specularTexture = REngine::Texture::textures[node.specularPath];
-    } else if (tex->loadBMP(node.specularPath)) {
-        REngine::Texture::textures[node.specularPath] = tex;
-        node.mesh->specularTexture = tex;
-    } else if (tex->loadBMP("./textures/" + node.specularPath)) {
-        REngine::Texture::textures[node.specularPath] = tex;
-        node.mesh->specularTexture = tex;
-    } else if (tex->loadBMP("../textures/" + node.specularPath)) {
-        REngine::Texture::textures[node.specularPath] = tex;
-        node.mesh->specularTexture = tex;
-    } else {
-        ERROR("Failed to load specular texture: " + node.specularPath);
-        node.specularPath = "gen_color_" + std::to_string(defColor.x) + "_" + std::to_string(defColor.y) + "_" + std::to_string(defColor.z);
-        tex->genFromColor(defColor.x, defColor.y, defColor.z);
-        node.mesh->specularTexture = tex;
-        REngine::Texture::textures[node.specularPath] = tex;
+    tex->setColor(defColor.x, defColor.y, defColor.z);
+    REngine::Texture* stored = REngine::TextureCache::insert(path, tex);
+    if (stored != tex) {
+        delete tex;
     }
+    return stored;
+}
+
+REngine::Texture* applyTexture(REngine::SceneNode& node, glm::vec3 defColor) {
+    return requestTexture(node.texturePath, defColor);
+}
+
+REngine::Texture* applySpecTexture(REngine::SceneNode& node, glm::vec3 defColor) {
+    return requestTexture(node.specularPath, defColor);
 }
@@ -0,0 +1,217 @@
+#include "SceneGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Logging.h"
+
+REngine::Random::Random(uint64_t seed) : state(0) {
+    next();
+    state += seed;
+    next();
+}
+
+uint32_t REngine::Random::next() {
+    uint64_t old = state;
+    state = old * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+float REngine::Random::nextFloat() {
+    return (next() >> 8) * (1.0f / 16777216.0f);
+}
+
+glm::vec3 REngine::Random::range3(const glm::vec3& min, const glm::vec3& max) {
+    // Порядок вычисления аргументов конструктора не определён, поэтому явно
+    float x = range(min.x, max.x);
+    float y = range(min.y, max.y);
+    float z = range(min.z, max.z);
+    return glm::vec3(x, y, z);
+}
+
+uint32_t REngine::Random::below(uint32_t n) {
+    return (uint32_t)(((uint64_t)next() * n) >> 32);
+}
+
+REngine::SceneGenerator::SceneGenerator(const SceneGeneratorConfig& config)
+    : config(config), random(config.seed) {}
+
+REngine::SceneGenerator::~SceneGenerator() {
+    clearMeshes();
+}
+
+void REngine::SceneGenerator::clearMeshes() {
+    for (Mesh* mesh : meshes) {
+        delete mesh;
+    }
+    meshes.clear();
+    sharedCube = nullptr;
+    sharedSphere = nullptr;
+}
+
+void REngine::SceneGenerator::generate(Scene& scene) {
+    clearMeshes();
+    random = Random(config.seed);
+    scene.nodes.clear();
+    scene.pointLights.clear();
+    scene.nodes.reserve(config.nodeCount);
+
+    sharedCube = new Mesh(Mesh::createCube());
+    sharedCube->computeAABB();
+    meshes.push_back(sharedCube);
+    sharedSphere = new Mesh(Mesh::createSphere(config.sphereSlices, config.sphereSlices));
+    sharedSphere->computeAABB();
+    meshes.push_back(sharedSphere);
+
+    switch (config.layout) {
+        case SceneLayout::Grid:
+            generateGrid(scene);
+            break;
+        case SceneLayout::Clusters:
+            generateClusters(scene);
+            break;
+        case SceneLayout::City:
+            generateCity(scene);
+            break;
+    }
+
+    glm::vec3 min(0.0f), max(0.0f);
+    if (!scene.nodes.empty()) {
+        min = max = scene.nodes[0].position;
+    }
+    for (const SceneNode& node : scene.nodes) {
+        min = glm::min(min, node.position - node.scale * 0.5f);
+        max = glm::max(max, node.position + node.scale * 0.5f);
+    }
+    center = (min + max) * 0.5f;
+    extent = max - min;
+
+    generateLights(scene);
+
+    scene.dirLight.direction = glm::vec3(-0.3f, -1.0f, -0.2f);
+    scene.dirLight.ambient = glm::vec3(0.1f);
+    scene.dirLight.diffuse = glm::vec3(0.4f);
+    scene.dirLight.specular = glm::vec3(0.2f);
+
+    scene.camera.position = glm::vec3(center.x, center.y + std::max(extent.y, 10.0f), max.z + 10.0f);
+    scene.camera.setRotation(-20.0f, -90.0f, 0.0f);
+
+    INFO("Generated scene with " << scene.nodes.size() << " nodes, " << scene.pointLights.size()
+         << " point lights and " << meshes.size() << " meshes, seed " << config.seed);
+}
+
+REngine::SceneNode REngine::SceneGenerator::makeNode(const glm::vec3& position, const glm::vec3& scale, bool sphere) {
+    SceneNode node;
+    node.position = position;
+    node.scale = scale;
+    node.rotation = glm::vec3(0.0f, random.range(0.0f, 360.0f), 0.0f);
+    node.shininess = (float)(8 << random.below(5));
+
+    if (random.nextFloat() < config.sharedMeshFraction) {
+        node.mesh = sphere ? sharedSphere : sharedCube;
+    } else {
+        // Собственная сетка, у сфер ещё и с разным числом сегментов
+        int slices = config.sphereSlices / 2 + (int)random.below(config.sphereSlices + 1);
+        node.mesh = new Mesh(sphere ? Mesh::createSphere(slices, slices) : Mesh::createCube());
+        node.mesh->computeAABB();
+        meshes.push_back(node.mesh);
+    }
+
+    if (!config.texturePaths.empty()) {
+        node.texturePath = config.texturePaths[random.below(config.texturePaths.size())];
+    }
+    if (!config.specularPaths.empty()) {
+        node.specularPath = config.specularPaths[random.below(config.specularPaths.size())];
+    }
+    return node;
+}
+
+void REngine::SceneGenerator::generateGrid(Scene& scene) {
+    size_t side = (size_t)std::ceil(std::sqrt((double)config.nodeCount));
+    float offset = (side - 1) * config.spacing * 0.5f;
+    for (size_t i = 0; i < config.nodeCount; i++) {
+        glm::vec3 position((i % side) * config.spacing - offset, 0.0f, (i / side) * config.spacing - offset);
+        float size = random.range(0.5f, 1.5f);
+        bool sphere = random.nextFloat() < config.sphereFraction;
+        scene.nodes.push_back(makeNode(position, glm::vec3(size), sphere));
+    }
+}
+
+void REngine::SceneGenerator::generateClusters(Scene& scene) {
+    size_t clusterCount = std::max<size_t>(config.clusterCount, 1);
+    float area = std::sqrt((float)clusterCount) * config.clusterRadius * 3.0f;
+
+    std::vector<glm::vec3> centers(clusterCount);
+    for (glm::vec3& c : centers) {
+        c = random.range3(glm::vec3(-area * 0.5f, 0.0f, -area * 0.5f), glm::vec3(area * 0.5f, config.clusterRadius, area * 0.5f));
+    }
+
+    for (size_t i = 0; i < config.nodeCount; i++) {
+        // Равномерная точка в шаре, масштабированная к центру скопления
+        glm::vec3 offset;
+        do {
+            offset = random.range3(glm::vec3(-1.0f), glm::vec3(1.0f));
+        } while (glm::dot(offset, offset) > 1.0f);
+        offset *= config.clusterRadius * random.nextFloat();
+
+        float size = random.range(0.3f, 1.2f);
+        bool sphere = random.nextFloat() < config.sphereFraction;
+        scene.nodes.push_back(makeNode(centers[i % clusterCount] + offset, glm::vec3(size), sphere));
+    }
+}
+
+void REngine::SceneGenerator::generateCity(Scene& scene) {
+    // Квартал состоит из здания и мелких объектов на улице вокруг него
+    const size_t propsPerBlock = 8;
+    size_t blocks = (config.nodeCount + propsPerBlock) / (propsPerBlock + 1);
+    size_t side = (size_t)std::ceil(std::sqrt((double)std::max<size_t>(blocks, 1)));
+    float pitch = config.blockSize + config.streetWidth;
+    float offset = (side - 1) * pitch * 0.5f;
+
+    for (size_t b = 0; scene.nodes.size() < config.nodeCount; b++) {
+        glm::vec3 blockCenter((b % side) * pitch - offset, 0.0f, (b / side) * pitch - offset);
+
+        float height = random.range(0.3f, 1.0f) * config.buildingHeight;
+        glm::vec3 size = random.range3(glm::vec3(0.6f, 1.0f, 0.6f), glm::vec3(0.9f, 1.0f, 0.9f)) * glm::vec3(config.blockSize, height, config.blockSize);
+        SceneNode building = makeNode(blockCenter + glm::vec3(0.0f, height * 0.5f, 0.0f), size, false);
+        building.rotation = glm::vec3(0.0f);
+        scene.nodes.push_back(building);
+
+        float street = (config.blockSize + config.streetWidth) * 0.5f;
+        for (size_t p = 0; p < propsPerBlock && scene.nodes.size() < config.nodeCount; p++) {
+            float along = random.range(-street, street);
+            float across = street * (random.below(2) ? 1.0f : -1.0f);
+            glm::vec3 position = blockCenter + (p % 2 ? glm::vec3(along, 0.0f, across) : glm::vec3(across, 0.0f, along));
+            float propSize = random.range(0.3f, 1.0f);
+            position.y = propSize * 0.5f;
+            bool sphere = random.nextFloat() < config.sphereFraction;
+            scene.nodes.push_back(makeNode(position, glm::vec3(propSize), sphere));
+        }
+    }
+}
+
+void REngine::SceneGenerator::generateLights(Scene& scene) {
+    size_t count = std::min<size_t>(config.lightCount, POINT_LIGHTS_MAX);
+    if (count < config.lightCount) {
+        WARN("Point light count clamped to " << POINT_LIGHTS_MAX);
+    }
+
+    glm::vec3 half = extent * 0.5f;
+    for (size_t i = 0; i < count; i++) {
+        PointLight light;
+        light.position = center + random.range3(glm::vec3(-half.x, half.y + 1.0f, -half.z), glm::vec3(half.x, half.y + 5.0f, half.z));
+
+        // Затухание до ~1% на расстоянии lightRange
+        light.constant = 1.0f;
+        light.linear = 4.5f / config.lightRange;
+        light.quadratic = 75.0f / (config.lightRange * config.lightRange);
+
+        glm::vec3 color = random.range3(glm::vec3(0.4f), glm::vec3(1.0f));
+        light.ambient = color * 0.05f;
+        light.diffuse = color;
+        light.specular = color;
+        scene.pointLights.push_back(light);
+    }
+}
@@ -2,57 +2,62 @@
 
 #include <glad/glad.h>
 
-#include <fstream>
 #include <glm/gtc/type_ptr.hpp>
-#include <sstream>
 
 #include "Logging.h"
+#include "VirtualFS.h"
 
 REngine::Shader::Shader(const char* vertexPath, const char* fragmentPath) {
     std::string vertexCode;
     std::string fragmentCode;
 
-    if (vertexPath != NULL && fragmentPath != NULL) {
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
-
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-
-        vShaderFile.close();
-        fShaderFile.close();
-
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
+    AssetFile vertexFile;
+    AssetFile fragmentFile;
+    if (vertexPath != NULL && fragmentPath != NULL && vertexFile.open(vertexPath) && fragmentFile.open(fragmentPath)) {
+        vertexCode.assign(reinterpret_cast<const char*>(vertexFile.data()), vertexFile.size());
+        fragmentCode.assign(reinterpret_cast<const char*>(fragmentFile.data()), fragmentFile.size());
     } else {
+        if (vertexPath != NULL && fragmentPath != NULL) {
+            ERROR("Failed to read shader files: " << vertexPath << ", " << fragmentPath);
+        }
         WARN("Falling back to built-in shader");
         vertexCode = R"(
 #version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in mat4 aNormalMatrix;
+layout (location = 11) in vec4 aMaterial;
+layout (location = 12) in vec2 aMinLod;
+layout (location = 13) in vec3 aDiffuseColor;
+layout (location = 14) in vec3 aSpecularColor;
 
 out vec3 Normal;
 out vec2 TexCoord;
 out vec3 FragPos;
+flat out vec4 Material;
+flat out vec2 MinLod;
+flat out vec3 DiffuseColor;
+flat out vec3 SpecularColor;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 uniform mat4 normalMatrix;
+uniform bool instanced;
 
 void main() {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    Normal = mat3(normalMatrix) * aNormal;
+    mat4 modelMatrix = instanced ? aModel : model;
+    mat4 normalMat = instanced ? aNormalMatrix : normalMatrix;
+    gl_Position = projection * view * modelMatrix * vec4(aPos, 1.0);
+    Normal = mat3(normalMat) * aNormal;
     TexCoord = aTexCoord;
-    FragPos = vec3(model * vec4(aPos, 1.0));
+    FragPos = vec3(modelMatrix * vec4(aPos, 1.0));
+    Material = aMaterial;
+    MinLod = aMinLod;
+    DiffuseColor = aDiffuseColor;
+    SpecularColor = aSpecularColor;
 }
         )";
         fragmentCode = R"(
@@ -60,6 +65,10 @@ void main() {
 in vec3 Normal;
 in vec2 TexCoord;
 in vec3 FragPos;
+flat in vec4 Material;
+flat in vec2 MinLod;
+flat in vec3 DiffuseColor;
+flat in vec3 SpecularColor;
 
 out vec4 FragColor;
 
@@ -89,6 +98,15 @@ struct Material {
 #define POINT_LIGHTS_MAX 128
 
 uniform bool distort;
+uniform bool instanced;
+uniform sampler2DArray diffuseArray;
+uniform sampler2DArray specularArray;
+uniform float diffuseSource;
+uniform float specularSource;
+uniform vec3 diffuseSolidColor;
+uniform vec3 specularSolidColor;
+uniform float diffuseMinLod;
+uniform float specularMinLod;
 uniform float u_time;
 uniform vec3 u_camera_position;
 uniform DirLight dirLight;
@@ -136,37 +154,62 @@ float perlin(vec3 p) {
     return total;
 }
 
-vec3 getAmbient(vec3 ambient, vec2 ourUV) {
-    return ambient * vec3(texture(material.diffuse, ourUV));
+// Уровень детализации считается вручную, чтобы не читать незагруженные уровни слоя
+vec3 sampleLayer(sampler2DArray tex, vec2 uv, float layer, float minLod, vec2 uvDx, vec2 uvDy) {
+    vec2 size = vec2(textureSize(tex, 0).xy);
+    vec2 dx = uvDx * size;
+    vec2 dy = uvDy * size;
+    float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy)));
+    return vec3(textureLod(tex, vec3(uv, layer), max(lod, minLod)));
+}
+
+// Источник не меньше нуля означает слой массива, -1 отдельную текстуру, -2 сплошной цвет
+vec3 sampleMaterial(sampler2DArray array, sampler2D tex, float source, float minLod, vec3 color, vec2 uv, vec2 uvDx, vec2 uvDy) {
+    if (source >= 0.0) {
+        return sampleLayer(array, uv, source, minLod, uvDx, uvDy);
+    }
+    if (source < -1.5) {
+        return color;
+    }
+    return vec3(textureGrad(tex, uv, uvDx, uvDy));
 }
 
-vec3 getDiffuse(vec3 diffuse, vec3 norm, vec3 light_direction, vec2 ourUV) {
+// Цвета материала читаются один раз на фрагмент
+vec3 albedo;
+vec3 specularColor;
+float shininess;
+
+vec3 getAmbient(vec3 ambient) {
+    return ambient * albedo;
+}
+
+vec3 getDiffuse(vec3 diffuse, vec3 norm, vec3 light_direction) {
     float diff = max(dot(norm, light_direction), 0.0);
-    return diffuse * diff * vec3(texture(material.diffuse, ourUV));
+    return diffuse * diff * albedo;
 }
 
-vec3 getSpecular(vec3 specular, vec3 norm, vec3 viewDir, vec3 light_direction, vec2 ourUV) {
+vec3 getSpecular(vec3 specular, vec3 norm, vec3 viewDir, vec3 light_direction) {
     vec3 halfwayDir = normalize(light_direction + viewDir);
-    float spec = pow(max(dot(norm, halfwayDir), 0.0), material.shininess);
-    return specular * spec * vec3(texture(material.specular, ourUV));
+    float spec = pow(max(dot(norm, halfwayDir), 0.0), shininess);
+    return specular * spec * specularColor;
 }
 
-vec3 getDirLight(vec3 norm, vec3 viewDir, vec2 ourUV) {
+vec3 getDirLight(vec3 norm, vec3 viewDir) {
     vec3 light_direction = normalize(-dirLight.direction);
 
-    vec3 ambient = getAmbient(dirLight.ambient, ourUV);
-    vec3 diffuse = getDiffuse(dirLight.diffuse, norm, light_direction, ourUV);
-    vec3 specular = getSpecular(dirLight.specular, norm, viewDir, light_direction, ourUV);
+    vec3 ambient = getAmbient(dirLight.ambient);
+    vec3 diffuse = getDiffuse(dirLight.diffuse, norm, light_direction);
+    vec3 specular = getSpecular(dirLight.specular, norm, viewDir, light_direction);
 
     return ambient + diffuse + specular;
 }
 
-vec3 getPointLight(PointLight light, vec3 norm, vec3 viewDir, vec2 ourUV) {
+vec3 getPointLight(PointLight light, vec3 norm, vec3 viewDir) {
     vec3 light_direction = normalize(light.position - FragPos);
 
-    vec3 ambient = getAmbient(light.ambient, ourUV);
-    vec3 diffuse = getDiffuse(light.diffuse, norm, light_direction, ourUV);
-    vec3 specular = getSpecular(light.specular, norm, viewDir, light_direction, ourUV);
+    vec3 ambient = getAmbient(light.ambient);
+    vec3 diffuse = getDiffuse(light.diffuse, norm, light_direction);
+    vec3 specular = getSpecular(light.specular, norm, viewDir, light_direction);
 
     float distance = length(light.position - FragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * distance * distance);
@@ -179,9 +222,12 @@ void main() {
         return;
     }
 
+    vec4 params = instanced ? Material : vec4(diffuseSource, specularSource, material.shininess, distort ? 1.0 : 0.0);
+    shininess = params.z;
+
     vec2 ourUV;
 
-    if (distort) {
+    if (params.w > 0.5) {
         vec3 noise_coord = vec3(TexCoord * 5.0, u_time * 0.1);
         float noise_value = perlin(noise_coord) * 0.1;
         ourUV = TexCoord + vec2(noise_value);
@@ -189,12 +235,20 @@ void main() {
         ourUV = TexCoord;
     }
 
+    vec2 minLod = instanced ? MinLod : vec2(diffuseMinLod, specularMinLod);
+    vec2 uvDx = dFdx(ourUV);
+    vec2 uvDy = dFdy(ourUV);
+    albedo = sampleMaterial(diffuseArray, material.diffuse, params.x, minLod.x, instanced ? DiffuseColor : diffuseSolidColor,
+                            ourUV, uvDx, uvDy);
+    specularColor = sampleMaterial(specularArray, material.specular, params.y, minLod.y,
+                                   instanced ? SpecularColor : specularSolidColor, ourUV, uvDx, uvDy);
+
     vec3 norm = normalize(Normal);
     vec3 viewDir = normalize(u_camera_position - FragPos);
-    vec3 dirLight = getDirLight(norm, viewDir, ourUV);
+    vec3 dirLight = getDirLight(norm, viewDir);
     vec3 pointLight = vec3(0.0);
     for (int i = 0; i < pointLightsCount; i++) {
-        pointLight += getPointLight(pointLights[i], norm, viewDir, ourUV);
+        pointLight += getPointLight(pointLights[i], norm, viewDir);
     }
     FragColor = vec4(dirLight + pointLight, 1.0);
 }
@@ -230,24 +284,48 @@ void REngine::Shader::use() {
     glUseProgram(ID);
 }
 
+bool REngine::Shader::hasUniform(const char* name) const {
+    return glGetUniformLocation(ID, name) != -1;
+}
+
 void REngine::Shader::setBool(const std::string &name, bool value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    setBool(name.c_str(), value);
+}
+
+void REngine::Shader::setBool(const char* name, bool value) const {
+    glUniform1i(glGetUniformLocation(ID, name), (int)value);
 }
 
 void REngine::Shader::setInt(const std::string &name, int value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    setInt(name.c_str(), value);
+}
+
+void REngine::Shader::setInt(const char* name, int value) const {
+    glUniform1i(glGetUniformLocation(ID, name), value);
 }
 
 void REngine::Shader::setFloat(const std::string &name, float value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    setFloat(name.c_str(), value);
+}
+
+void REngine::Shader::setFloat(const char* name, float value) const {
+    glUniform1f(glGetUniformLocation(ID, name), value);
 }
 
 void REngine::Shader::setMat4(const std::string &name, const glm::mat4 &mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+    setMat4(name.c_str(), mat);
+}
+
+void REngine::Shader::setMat4(const char* name, const glm::mat4 &mat) const {
+    glUniformMatrix4fv(glGetUniformLocation(ID, name), 1, GL_FALSE, glm::value_ptr(mat));
 }
 
 void REngine::Shader::setVec3(const std::string &name, const glm::vec3 &value) const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    setVec3(name.c_str(), value);
+}
+
+void REngine::Shader::setVec3(const char* name, const glm::vec3 &value) const {
+    glUniform3fv(glGetUniformLocation(ID, name), 1, glm::value_ptr(value));
 }
 
 void REngine::Shader::checkCompileErrors(unsigned int shader, std::string type) {
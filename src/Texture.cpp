@@ -1,12 +1,20 @@
-#include <fstream>
+#include <algorithm>
+#include <climits>
+#include <cstring>
 #include <vector>
 
 #include <glad/glad.h>
 
 #include "Texture.h"
+#include "BlockCompression.h"
+#include "CookedTexture.h"
 #include "Logging.h"
+#include "PixelConvert.h"
+#include "TexturePool.h"
+#include "VirtualFS.h"
 
-std::unordered_map<std::string, REngine::Texture*> REngine::Texture::textures;
+unsigned int REngine::Texture::bindCount = 0;
+unsigned int REngine::Texture::placeholderID = 0;
 
 REngine::Texture::Texture() : textureID(0), width(0), height(0), bpp(0) {
 }
@@ -24,109 +32,450 @@ void REngine::Texture::clear() {
         glDeleteTextures(1, &textureID);
         textureID = 0;
     }
+    if (array) {
+        TexturePool::release(array, layer);
+        array = nullptr;
+    }
+    delete colorTexture;
+    colorTexture = nullptr;
+    memorySize = 0;
+    baseLevel = 0;
+    solid = false;
+    source = nullptr;
+}
+
+bool REngine::Texture::parseBMP(const unsigned char* data, size_t size, BMPImage& image) {
+    BMPFileHeader fileHeader;
+    BMPInfoHeader infoHeader;
+    const size_t fileHeaderSize = 14;
+    if (size < fileHeaderSize + sizeof(infoHeader)) {
+        return false;
+    }
+
+    std::memcpy(&fileHeader.signature, data, sizeof(fileHeader.signature));
+    std::memcpy(&fileHeader.dataOffset, data + 10, sizeof(fileHeader.dataOffset));
+    std::memcpy(&infoHeader, data + fileHeaderSize, sizeof(infoHeader));
+
+    // Проверка сигнатуры "BM"
+    if (fileHeader.signature != 0x4D42) {
+        return false;
+    }
+
+    // Высота INT_MIN не имеет положительного модуля в int
+    if (infoHeader.height == INT_MIN) {
+        return false;
+    }
+    image.width = infoHeader.width;
+    image.height = abs(infoHeader.height);
+    image.bpp = infoHeader.bitsPerPixel;
+    image.topDown = infoHeader.height < 0;
+    if (image.width <= 0 || image.height == 0 || (image.bpp != 24 && image.bpp != 32)) {
+        return false;
+    }
+
+    // Размеры из заголовка произвольны, поэтому считаются в 64 битах и сверяются с размером файла до умножения на высоту
+    uint64_t rowSize = ((uint64_t)image.width * (image.bpp / 8) + 3) & ~(uint64_t)3;
+    if (fileHeader.dataOffset > size) {
+        return false;
+    }
+    uint64_t available = size - fileHeader.dataOffset;
+    if (rowSize > available || (uint64_t)image.height > available / rowSize) {
+        return false;
+    }
+    image.rowSize = (int)rowSize;
+
+    image.pixels = data + fileHeader.dataOffset;
+    return true;
 }
 
 bool REngine::Texture::loadBMP(const std::string& path) {
     clear();
 
-    std::ifstream file(path, std::ios::binary);
-    if (!file.is_open()) {
+    AssetFile file(path);
+    if (!file.isOpen()) {
         ERROR("Failed to open BMP file: " + path);
         return false;
     }
-    BMPFileHeader fileHeader;
-    char* headerPtr = reinterpret_cast<char*>(&fileHeader);
-    file.read(headerPtr, sizeof(fileHeader.signature));
-    headerPtr += sizeof(fileHeader.signature) * 2;
-    file.read(headerPtr, sizeof(fileHeader)-sizeof(fileHeader.signature)*2);
 
-    // Проверка сигнатуры "BM"
-    if (fileHeader.signature != 0x4D42) {
-        ERROR("Invalid BMP signature in file: " + path);
+    BMPImage image;
+    if (!parseBMP(file.data(), file.size(), image)) {
+        ERROR("Invalid or unsupported BMP file, only 24-bit and 32-bit formats are supported: " + path);
         return false;
     }
 
-    BMPInfoHeader infoHeader;
-    file.read(reinterpret_cast<char*>(&infoHeader), sizeof(infoHeader));
+    width = image.width;
+    height = image.height;
+    bpp = image.bpp;
 
-    width = infoHeader.width;
-    height = infoHeader.height;
-    bpp = infoHeader.bitsPerPixel;
+    // Порядок байтов BMP совпадает с GL_BGR и GL_BGRA, поэтому данные передаются без преобразования
+    if (bpp == 24) {
+        loadToGL(image.pixels, GL_BGR, GL_UNSIGNED_BYTE, image.topDown, GL_NEAREST_MIPMAP_LINEAR, GL_NEAREST);
+    } else {
+        loadToGL(image.pixels, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, image.topDown, GL_NEAREST_MIPMAP_LINEAR, GL_NEAREST);
+    }
+
+    DEBUG("Loaded BMP texture: " << path << " (" << width << "x" << height << ", " << bpp << " bpp)");
+    return true;
+}
 
-    if (bpp != 24 && bpp != 32) {
-        ERROR("Unsupported BMP format, only 24-bit and 32-bit formats are supported: " + path);
+bool REngine::Texture::decodeBMP(const std::string& path, std::vector<unsigned char>& pixels, int& width, int& height, int& channels) {
+    AssetFile file(path);
+    if (!file.isOpen() || !decodeBMP(file.data(), file.size(), pixels, width, height, channels)) {
+        ERROR("Failed to decode BMP file: " + path);
+        return false;
+    }
+    return true;
+}
+
+bool REngine::Texture::decodeBMP(const unsigned char* data, size_t size, std::vector<unsigned char>& pixels, int& width, int& height,
+                                 int& channels) {
+    BMPImage image;
+    if (!parseBMP(data, size, image)) {
+        return false;
+    }
+
+    width = image.width;
+    height = image.height;
+    channels = image.bpp / 8;
+    size_t rowBytes = (size_t)width * channels;
+    pixels.resize(rowBytes * height);
+
+    for (int y = 0; y < height; y++) {
+        const unsigned char* src = image.pixels + (size_t)(image.topDown ? height - 1 - y : y) * image.rowSize;
+        unsigned char* dst = pixels.data() + y * rowBytes;
+        if (channels == 3) {
+            PixelConvert::swapRB24(src, dst, width);
+        } else {
+            PixelConvert::swapRB32(src, dst, width);
+        }
+    }
+    return true;
+}
+
+bool REngine::Texture::loadDDS(const std::string& path) {
+    clear();
+
+    AssetFile file(path);
+    CompressedImage image;
+    const unsigned char* blocks = nullptr;
+    if (!file.isOpen() || !BlockCompressor::parseDDS(file.data(), file.size(), image, blocks)) {
+        ERROR("Failed to load DDS file: " + path);
         return false;
     }
 
-    int rowSize = ((width * bpp / 8) + 3) & ~3;
-    int dataSize = rowSize * abs(height);
+    TextureFormat format = CookedTexture::fromBlockFormat(image.format);
+    if (!loadLevelsToGL(format, image.levels, blocks)) {
+        ERROR("Failed to decompress DDS file: " + path);
+        clear();
+        return false;
+    }
+    DEBUG("Loaded DDS texture: " << path << " (" << width << "x" << height << ", "
+                                 << BlockCompressor::getFormatName(image.format) << (isFormatSupported(format) ? "" : ", decompressed") << ")");
+    return true;
+}
 
-    file.seekg(fileHeader.dataOffset, std::ios::beg);
+bool REngine::Texture::loadRTEX(const std::string& path) {
+    clear();
 
-    std::vector<unsigned char> pixels(dataSize);
-    file.read(reinterpret_cast<char*>(pixels.data()), dataSize);
-    
-    if (file.fail()) {
-        ERROR("Failed to read BMP data: " + path);
+    AssetFile file(path);
+    CookedImage image;
+    if (!file.isOpen() || !CookedTexture::parse(file.data(), file.size(), image)) {
+        ERROR("Failed to load RTEX file: " + path);
         return false;
     }
 
-    std::vector<unsigned char> rgbData(width * abs(height) * (bpp == 24 ? 3 : 4));
+    if (!loadLevelsToGL(image.format, image.levels, file.data())) {
+        ERROR("Failed to decompress RTEX file: " + path);
+        clear();
+        return false;
+    }
+    DEBUG("Loaded RTEX texture: " << path << " (" << width << "x" << height << ", " << image.levels.size() << " levels, "
+                                  << CookedTexture::getFormatName(image.format) << ")");
+    return true;
+}
 
-    int pixelSize = bpp / 8;
-    for (int y = 0; y < abs(height); y++) {
-        for (int x = 0; x < width; x++) {
-            int bmpOffset = y * rowSize + x * pixelSize;
-            int rgbOffset = y * width * (bpp == 24 ? 3 : 4) + x * (bpp == 24 ? 3 : 4);
+bool REngine::Texture::loadLevelsToGL(TextureFormat format, const std::vector<TextureLevel>& levels, const unsigned char* pixels) {
+    width = levels[0].width;
+    height = levels[0].height;
+    bpp = format == TextureFormat::RGB8 ? 24 : 32;
 
-            // Конвертация BGR в RGB
-            rgbData[rgbOffset] = pixels[bmpOffset + 2]; // R
-            rgbData[rgbOffset + 1] = pixels[bmpOffset + 1]; // G
-            rgbData[rgbOffset + 2] = pixels[bmpOffset]; // B
+    BlockFormat blockFormat = BlockFormat::BC1;
+    bool decompress = !isFormatSupported(format) && getBlockFormat(format, blockFormat);
+    TextureFormat storageFormat = decompress ? TextureFormat::RGBA8 : format;
+    std::vector<unsigned char> rgba;
+    for (const TextureLevel& level : levels) {
+        memorySize += decompress ? (size_t)level.width * level.height * 4 : level.size;
+    }
 
-            if (bpp == 32) {
-                rgbData[rgbOffset + 3] = pixels[bmpOffset + 3]; // Альфа
-            }
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+    bool allocated = allocateLevels(storageFormat, width, height, (int)levels.size());
+    bool success = true;
+    for (size_t i = 0; i < levels.size(); i++) {
+        const TextureLevel& level = levels[i];
+        if (!decompress) {
+            uploadLevel(format, allocated, (int)i, level, pixels + level.offset);
+        } else if (BlockCompressor::decompress(blockFormat, pixels + level.offset, level.width, level.height, rgba)) {
+            uploadLevel(storageFormat, allocated, (int)i, {level.width, level.height, 0, rgba.size()}, rgba.data());
+        } else {
+            success = false;
         }
     }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return success;
+}
+
+bool REngine::Texture::isFormatSupported(BlockFormat format) {
+    if (format == BlockFormat::BC7) {
+        return GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_texture_compression_bptc;
+    }
+    return GLAD_GL_EXT_texture_compression_s3tc;
+}
+
+bool REngine::Texture::isFormatSupported(TextureFormat format) {
+    BlockFormat blockFormat;
+    return !getBlockFormat(format, blockFormat) || isFormatSupported(blockFormat);
+}
+
+unsigned int REngine::Texture::getGLFormat(BlockFormat format) {
+    switch (format) {
+        case BlockFormat::BC1:
+            return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case BlockFormat::BC3:
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case BlockFormat::BC7:
+            return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    }
+    return 0;
+}
+
+unsigned int REngine::Texture::getGLFormat(TextureFormat format) {
+    BlockFormat blockFormat;
+    if (getBlockFormat(format, blockFormat)) {
+        return getGLFormat(blockFormat);
+    }
+    return format == TextureFormat::RGB8 ? GL_RGB8 : GL_RGBA8;
+}
 
-    loadToGL(rgbData, GL_NEAREST_MIPMAP_LINEAR, GL_NEAREST);
+bool REngine::Texture::getBlockFormat(TextureFormat format, BlockFormat& blockFormat) {
+    switch (format) {
+        case TextureFormat::BC1:
+            blockFormat = BlockFormat::BC1;
+            return true;
+        case TextureFormat::BC3:
+            blockFormat = BlockFormat::BC3;
+            return true;
+        case TextureFormat::BC7:
+            blockFormat = BlockFormat::BC7;
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool REngine::Texture::hasImmutableStorage() {
+    // glTexStorage2D входит в OpenGL 4.2, в контексте 3.3 он есть не у всех драйверов
+    return GLAD_GL_VERSION_4_2 && glTexStorage2D;
+}
 
-    DEBUG("Loaded BMP texture: " + path + " (" + std::to_string(width) + "x" + std::to_string(height) + ", " + std::to_string(bpp) + " bpp)");
+bool REngine::Texture::allocateLevels(TextureFormat format, int width, int height, int levelCount) {
+    if (!hasImmutableStorage()) {
+        return false;
+    }
+    glTexStorage2D(GL_TEXTURE_2D, levelCount, getGLFormat(format), width, height);
     return true;
 }
 
-bool REngine::Texture::genFromColor(float r, float g, float b) {
+void REngine::Texture::uploadLevel(TextureFormat format, bool allocated, int level, const TextureLevel& info, const void* data, int y) {
+    BlockFormat blockFormat;
+    bool compressed = getBlockFormat(format, blockFormat);
+    GLenum pixelFormat = format == TextureFormat::RGB8 ? GL_RGB : GL_RGBA;
+    // Строки уровней упакованы без выравнивания
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (compressed && allocated) {
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, y, info.width, info.height, getGLFormat(format), (GLsizei)info.size, data);
+    } else if (compressed) {
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, getGLFormat(format), info.width, info.height, 0, (GLsizei)info.size, data);
+    } else if (allocated) {
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, y, info.width, info.height, pixelFormat, GL_UNSIGNED_BYTE, data);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, level, getGLFormat(format), info.width, info.height, 0, pixelFormat, GL_UNSIGNED_BYTE, data);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void REngine::Texture::buildMipChain(std::vector<unsigned char>& pixels, int width, int height, int channels, std::vector<TextureLevel>& levels) {
+    levels.clear();
+    size_t total = 0;
+    for (int level = 0; level == 0 || (width >> level) > 0 || (height >> level) > 0; level++) {
+        int levelWidth = std::max(1, width >> level), levelHeight = std::max(1, height >> level);
+        size_t size = (size_t)levelWidth * levelHeight * channels;
+        levels.push_back({levelWidth, levelHeight, total, size});
+        total += size;
+    }
+    pixels.resize(total);
+
+    for (size_t level = 1; level < levels.size(); level++) {
+        const TextureLevel& source = levels[level - 1];
+        const TextureLevel& target = levels[level];
+        const unsigned char* src = pixels.data() + source.offset;
+        unsigned char* dst = pixels.data() + target.offset;
+
+        for (int y = 0; y < target.height; y++) {
+            const unsigned char* row0 = src + (size_t)std::min(y * 2, source.height - 1) * source.width * channels;
+            const unsigned char* row1 = src + (size_t)std::min(y * 2 + 1, source.height - 1) * source.width * channels;
+            for (int x = 0; x < target.width; x++) {
+                int x0 = std::min(x * 2, source.width - 1) * channels;
+                int x1 = std::min(x * 2 + 1, source.width - 1) * channels;
+                for (int c = 0; c < channels; c++) {
+                    *dst++ = (unsigned char)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+                }
+            }
+        }
+    }
+}
+
+bool REngine::Texture::genFromColor(float r, float g, float b, bool pooled) {
     clear();
     width = 1;
     height = 1;
     bpp = 24;
-    std::vector<unsigned char> rgbData(width * height * 3);
-    for (int i = 0; i < width * height; i++) {
-        rgbData[i * 3] = r * 255;
-        rgbData[i * 3 + 1] = g * 255;
-        rgbData[i * 3 + 2] = b * 255;
+    unsigned char rgbData[4] = {(unsigned char)(r * 255), (unsigned char)(g * 255), (unsigned char)(b * 255), 255};
+    // Все цвета попадают в один массив 1x1, поэтому объекты разных цветов рисуются вместе
+    TextureArray* colorArray;
+    int colorLayer;
+    if (pooled && TexturePool::acquire(TextureFormat::RGBA8, 1, 1, 1, colorArray, colorLayer)) {
+        colorArray->uploadLayer(colorLayer, 0, {1, 1, 0, 4}, rgbData);
+        array = colorArray;
+        layer = colorLayer;
+        array->setOwner(layer, this);
+        memorySize = 4;
+    } else {
+        loadToGL(rgbData, GL_RGB, GL_UNSIGNED_BYTE, false, GL_NEAREST_MIPMAP_LINEAR, GL_NEAREST);
     }
-    loadToGL(rgbData, GL_NEAREST_MIPMAP_LINEAR, GL_NEAREST);
     DEBUG("Generated color texture: " << r << ", " << g << ", " << b);
     return true;
 }
 
-void REngine::Texture::loadToGL(std::vector<unsigned char>& rgbData, int minFilter, int magFilter) {
+void REngine::Texture::loadToGL(const unsigned char* data, unsigned int format, unsigned int type, bool topDown, int minFilter, int magFilter) {
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_2D, textureID);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
-    GLenum format = (bpp == 24) ? GL_RGB : GL_RGBA;
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, rgbData.data());
+    GLenum internalFormat = (bpp == 24) ? GL_RGB8 : GL_RGBA8;
+    // Строки BMP выровнены до 4 байт
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (topDown) {
+        // OpenGL ожидает строки снизу вверх, поэтому они передаются по одной в обратном порядке
+        int rowSize = ((width * bpp / 8) + 3) & ~3;
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+        for (int y = 0; y < height; y++) {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, width, 1, format, type, data + (size_t)(height - 1 - y) * rowSize);
+        }
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, data);
+    }
     glGenerateMipmap(GL_TEXTURE_2D);
     glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Драйвер хранит RGB8 по 4 байта на пиксель
+    for (int w = width, h = height; ; w = std::max(1, w / 2), h = std::max(1, h / 2)) {
+        memorySize += (size_t)w * h * 4;
+        if (w == 1 && h == 1) {
+            break;
+        }
+    }
+}
+
+void REngine::Texture::adopt(unsigned int id, int width, int height, int bpp, size_t memorySize) {
+    clear();
+    textureID = id;
+    this->width = width;
+    this->height = height;
+    this->bpp = bpp;
+    this->memorySize = memorySize;
+}
+
+void REngine::Texture::adoptLayer(TextureArray* array, int layer, int width, int height, int bpp, size_t memorySize) {
+    clear();
+    this->array = array;
+    this->layer = layer;
+    array->setOwner(layer, this);
+    this->width = width;
+    this->height = height;
+    this->bpp = bpp;
+    this->memorySize = memorySize;
+}
+
+void REngine::Texture::detachLayer() {
+    array = nullptr;
+    layer = 0;
+    memorySize = 0;
+    baseLevel = 0;
+}
+
+void REngine::Texture::setColor(float r, float g, float b) {
+    clear();
+    width = 1;
+    height = 1;
+    bpp = 24;
+    solid = true;
+    color[0] = r;
+    color[1] = g;
+    color[2] = b;
+}
+
+const REngine::Texture* REngine::Texture::getColorTexture() const {
+    if (source) {
+        return source->getColorTexture();
+    }
+    if (!solid) {
+        return nullptr;
+    }
+    if (!colorTexture) {
+        // Шейдер читает цвет из sampler2D, поэтому текстура не размещается в массиве
+        colorTexture = new Texture();
+        colorTexture->genFromColor(color[0], color[1], color[2], false);
+    }
+    return colorTexture;
+}
+
+void REngine::Texture::share(Texture* source) {
+    clear();
+    this->source = source;
+}
+
+void REngine::Texture::setBaseLevel(int level, int maxLevel, size_t bytes) {
+    baseLevel = level;
+    if (!array) {
+        memorySize += bytes;
+    }
+    if (textureID != 0) {
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, maxLevel);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
 }
 
 void REngine::Texture::bind() const {
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    if (source) {
+        source->bind();
+        return;
+    }
+    if (array) {
+        array->bind();
+        return;
+    }
+    glBindTexture(GL_TEXTURE_2D, textureID != 0 ? textureID : placeholderID);
+    bindCount++;
 }
 
 void REngine::Texture::unbind() {
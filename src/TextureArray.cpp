@@ -0,0 +1,95 @@
+#include "TextureArray.h"
+
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include "CookedTexture.h"
+
+REngine::TextureArray::TextureArray(TextureFormat format, int width, int height, int levelCount, int capacity)
+    : format(format), width(width), height(height), levelCount(levelCount), capacity(capacity), layers(capacity, false), owners(capacity, nullptr) {
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+    GLenum internalFormat = Texture::getGLFormat(format);
+    BlockFormat blockFormat;
+    bool compressed = Texture::getBlockFormat(format, blockFormat);
+    if (GLAD_GL_VERSION_4_2 && glTexStorage3D) {
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, levelCount, internalFormat, width, height, capacity);
+    } else {
+        // Без неизменяемой памяти каждый уровень выделяется отдельно с неопределённым содержимым
+        GLenum pixelFormat = format == TextureFormat::RGB8 ? GL_RGB : GL_RGBA;
+        for (int level = 0; level < levelCount; level++) {
+            int levelWidth = std::max(1, width >> level), levelHeight = std::max(1, height >> level);
+            if (compressed) {
+                GLsizei size = (GLsizei)(CookedTexture::getLevelSize(format, levelWidth, levelHeight) * capacity);
+                glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, levelWidth, levelHeight, capacity, 0, size, nullptr);
+            } else {
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, levelWidth, levelHeight, capacity, 0, pixelFormat,
+                             GL_UNSIGNED_BYTE, nullptr);
+            }
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+REngine::TextureArray::~TextureArray() {
+    glDeleteTextures(1, &textureID);
+}
+
+int REngine::TextureArray::allocateLayer() {
+    for (int i = 0; i < capacity; i++) {
+        if (!layers[i]) {
+            layers[i] = true;
+            usedLayers++;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void REngine::TextureArray::releaseLayer(int layer) {
+    if (layer >= 0 && layer < capacity && layers[layer]) {
+        layers[layer] = false;
+        owners[layer] = nullptr;
+        usedLayers--;
+    }
+}
+
+void REngine::TextureArray::setOwner(int layer, Texture* texture) {
+    owners[layer] = texture;
+}
+
+void REngine::TextureArray::uploadLayer(int layer, int level, const TextureLevel& info, const void* data, int y) {
+    BlockFormat blockFormat;
+    bool compressed = Texture::getBlockFormat(format, blockFormat);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (compressed) {
+        glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, y, layer, info.width, info.height, 1,
+                                  Texture::getGLFormat(format), (GLsizei)info.size, data);
+    } else {
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, y, layer, info.width, info.height, 1,
+                        format == TextureFormat::RGB8 ? GL_RGB : GL_RGBA, GL_UNSIGNED_BYTE, data);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+size_t REngine::TextureArray::getLayerSize(TextureFormat format, int width, int height, int levelCount) {
+    size_t bytes = 0;
+    for (int level = 0; level < levelCount; level++) {
+        bytes += CookedTexture::getLevelSize(format, std::max(1, width >> level), std::max(1, height >> level));
+    }
+    return bytes;
+}
+
+void REngine::TextureArray::bind() const {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+    Texture::bindCount++;
+}
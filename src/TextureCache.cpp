@@ -0,0 +1,60 @@
+#include "TextureCache.h"
+
+#include <mutex>
+
+std::shared_mutex REngine::TextureCache::mutex;
+std::unordered_map<std::string, REngine::Texture*> REngine::TextureCache::textures;
+std::unordered_map<REngine::TextureContent, REngine::Texture*, REngine::TextureContentHash> REngine::TextureCache::contents;
+
+REngine::Texture* REngine::TextureCache::find(const std::string& path) {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = textures.find(path);
+    return it != textures.end() ? it->second : nullptr;
+}
+
+REngine::Texture* REngine::TextureCache::insert(const std::string& path, Texture* texture) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto result = textures.emplace(path, texture);
+    return result.first->second;
+}
+
+size_t REngine::TextureCache::size() {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return textures.size();
+}
+
+REngine::Texture* REngine::TextureCache::findContent(const TextureContent& content) {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = contents.find(content);
+    return it != contents.end() ? it->second : nullptr;
+}
+
+void REngine::TextureCache::insertContent(const TextureContent& content, Texture* texture) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    contents.emplace(content, texture);
+}
+
+void REngine::TextureCache::eraseContent(Texture* texture) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    for (auto it = contents.begin(); it != contents.end();) {
+        if (it->second == texture) {
+            it = contents.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t REngine::TextureCache::getContentCount() {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return contents.size();
+}
+
+void REngine::TextureCache::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    for (auto& entry : textures) {
+        delete entry.second;
+    }
+    textures.clear();
+    contents.clear();
+}
@@ -0,0 +1,69 @@
+#include "TexturePool.h"
+
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include "CookedTexture.h"
+#include "Logging.h"
+
+bool REngine::TexturePool::enabled = false;
+std::vector<REngine::TextureArray*> REngine::TexturePool::arrays;
+
+bool REngine::TexturePool::acquire(TextureFormat format, int width, int height, int levelCount, TextureArray*& array, int& layer) {
+    if (!enabled) {
+        return false;
+    }
+
+    // Новые массивы больше, поэтому слои сначала ищутся в них
+    int capacity = TEXTURE_POOL_INITIAL_LAYERS / 2;
+    for (auto it = arrays.rbegin(); it != arrays.rend(); ++it) {
+        if (!(*it)->matches(format, width, height, levelCount)) {
+            continue;
+        }
+        layer = (*it)->allocateLayer();
+        if (layer >= 0) {
+            array = *it;
+            return true;
+        }
+        capacity = std::max(capacity, (*it)->getCapacity());
+    }
+
+    size_t layerBytes = TextureArray::getLayerSize(format, width, height, levelCount);
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    capacity = std::min(capacity * 2, std::max((int)maxLayers, 1));
+    capacity = std::max(1, std::min(capacity, (int)(TEXTURE_POOL_ARRAY_BYTES / layerBytes)));
+
+    array = new TextureArray(format, width, height, levelCount, capacity);
+    arrays.push_back(array);
+    layer = array->allocateLayer();
+    DEBUG("Created texture array " << width << "x" << height << " " << CookedTexture::getFormatName(format)
+                                   << " with " << capacity << " layers");
+    return true;
+}
+
+void REngine::TexturePool::release(TextureArray* array, int layer) {
+    auto it = std::find(arrays.begin(), arrays.end(), array);
+    if (it == arrays.end()) {
+        return;
+    }
+    array->releaseLayer(layer);
+    if (array->getUsedLayers() == 0) {
+        arrays.erase(it);
+        delete array;
+    }
+}
+
+void REngine::TexturePool::clear() {
+    for (TextureArray* array : arrays) {
+        // Оставшиеся текстуры не должны обращаться к удалённому массиву
+        for (int layer = 0; layer < array->getCapacity(); layer++) {
+            if (Texture* owner = array->getOwner(layer)) {
+                owner->detachLayer();
+            }
+        }
+        delete array;
+    }
+    arrays.clear();
+}
@@ -0,0 +1,178 @@
+#include "TextureResidency.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Logging.h"
+#include "Profiler.h"
+#include "TextureArray.h"
+#include "TextureStreamer.h"
+
+size_t REngine::TextureResidency::budget = TEXTURE_RESIDENCY_BUDGET;
+unsigned long REngine::TextureResidency::frame = 0;
+std::unordered_map<REngine::Texture*, REngine::TextureResidency::Entry> REngine::TextureResidency::entries;
+std::vector<std::pair<unsigned long, REngine::Texture*>> REngine::TextureResidency::candidates;
+std::vector<std::pair<REngine::TextureArray*, int>> REngine::TextureResidency::arrayLayers;
+unsigned int REngine::TextureResidency::pendingReloads = 0;
+unsigned int REngine::TextureResidency::frameEvictions = 0;
+unsigned int REngine::TextureResidency::frameReloads = 0;
+unsigned int REngine::TextureResidency::frameRefines = 0;
+unsigned long long REngine::TextureResidency::evictionCount = 0;
+unsigned long long REngine::TextureResidency::reloadCount = 0;
+
+void REngine::TextureResidency::track(Texture* texture, const std::string& path) {
+    Entry& entry = entries[texture];
+    if (entry.path.empty()) {
+        entry.path = path;
+        entry.lastUsed = frame;
+    }
+}
+
+void REngine::TextureResidency::untrack(Texture* texture) {
+    entries.erase(texture);
+}
+
+void REngine::TextureResidency::touch(Texture* texture, float texelSize) {
+    // Текстура с общим содержимым использует память и уровни исходной
+    texture = texture->getSource();
+    auto it = entries.find(texture);
+    if (it == entries.end()) {
+        return;
+    }
+    Entry& entry = it->second;
+    entry.lastUsed = frame;
+    entry.frameSize = std::max(entry.frameSize, texelSize);
+    // Пока идёт вытеснение, загрузка откладывается до следующего использования
+    if (entry.reduced && !texture->isPending()) {
+        entry.reduced = false;
+        pendingReloads++;
+        reloadCount++;
+        TextureStreamer::reload(texture, entry.path);
+    }
+}
+
+void REngine::TextureResidency::update() {
+    PROFILE_SCOPE("TextureResidency::update");
+    frameReloads = pendingReloads;
+    frameEvictions = 0;
+    frameRefines = 0;
+    pendingReloads = 0;
+
+    // Объекты приблизились: недостающие уровни догружаются в уже созданную текстуру
+    for (auto& entry : entries) {
+        Texture* texture = entry.first;
+        entry.second.requiredSize = entry.second.frameSize;
+        entry.second.frameSize = 0.0f;
+        if (entry.second.requiredSize > 0.0f && !entry.second.reduced && !texture->isPending() && texture->isResident() &&
+            getRequiredLevel(texture, texture->getWidth(), texture->getHeight()) < texture->getBaseLevel()) {
+            frameRefines++;
+            TextureStreamer::refine(texture, entry.second.path);
+        }
+    }
+
+    // Вытесняемые текстуры освободят память после загрузки мелких уровней
+    size_t projected = countBytes(true);
+    if (projected > budget) {
+        candidates.clear();
+        for (const auto& entry : entries) {
+            Texture* texture = entry.first;
+            if (entry.second.lastUsed < frame && !entry.second.reduced && !texture->isPending() &&
+                std::max(texture->getWidth(), texture->getHeight()) > TEXTURE_RESIDENCY_LOW_MIP) {
+                candidates.emplace_back(entry.second.lastUsed, texture);
+                if (texture->getArray()) {
+                    findArray(texture->getArray()).second++;
+                }
+            }
+        }
+        // Память массива освобождается только вместе с последним слоем, поэтому его текстуры
+        // вытесняются, только если вытеснить можно все занятые слои
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                        [](const std::pair<unsigned long, Texture*>& candidate) {
+                                            TextureArray* array = candidate.second->getArray();
+                                            return array && findArray(array).second < array->getUsedLayers();
+                                        }),
+                         candidates.end());
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& candidate : candidates) {
+            if (projected <= budget) {
+                break;
+            }
+            Texture* texture = candidate.second;
+            Entry& entry = entries[texture];
+            TextureArray* array = texture->getArray();
+            if (!array) {
+                projected -= texture->getMemorySize();
+            } else if (--findArray(array).second == 0) {
+                projected -= array->getMemorySize();
+            }
+            entry.reduced = true;
+            frameEvictions++;
+            evictionCount++;
+            TextureStreamer::reload(texture, entry.path, TEXTURE_RESIDENCY_LOW_MIP);
+        }
+        if (frameEvictions > 0) {
+            DEBUG("Evicted " << frameEvictions << " textures, " << getResidentBytes() << " of " << budget << " bytes resident");
+        }
+    }
+    frame++;
+}
+
+float REngine::TextureResidency::getRequiredSize(const Texture* texture) {
+    auto it = entries.find(const_cast<Texture*>(texture));
+    return it != entries.end() ? it->second.requiredSize : 0.0f;
+}
+
+int REngine::TextureResidency::getRequiredLevel(const Texture* texture, int width, int height) {
+    float size = getRequiredSize(texture);
+    if (size <= 0.0f) {
+        return 0;
+    }
+    // Уровень не меньше размера на экране, чтобы на пиксель приходилось не меньше текселя
+    return std::max(0, (int)std::floor(std::log2(std::max(width, height) / size)));
+}
+
+size_t REngine::TextureResidency::getResidentBytes() {
+    return countBytes(false);
+}
+
+size_t REngine::TextureResidency::countBytes(bool excludeEvicting) {
+    size_t bytes = 0;
+    arrayLayers.clear();
+    for (const auto& entry : entries) {
+        const Texture* texture = entry.first;
+        bool evicting = entry.second.reduced && texture->isPending();
+        if (!texture->getArray()) {
+            bytes += excludeEvicting && evicting ? 0 : texture->getMemorySize();
+        } else if (!excludeEvicting || !evicting) {
+            findArray(texture->getArray());
+        }
+    }
+    // Слои выделяются вместе с массивом, поэтому массив учитывается целиком
+    for (const auto& array : arrayLayers) {
+        bytes += array.first->getMemorySize();
+    }
+    return bytes;
+}
+
+std::pair<REngine::TextureArray*, int>& REngine::TextureResidency::findArray(TextureArray* array) {
+    for (auto& entry : arrayLayers) {
+        if (entry.first == array) {
+            return entry;
+        }
+    }
+    arrayLayers.emplace_back(array, 0);
+    return arrayLayers.back();
+}
+
+void REngine::TextureResidency::clear() {
+    entries.clear();
+    candidates.clear();
+    arrayLayers.clear();
+    frame = 0;
+    pendingReloads = 0;
+    frameEvictions = 0;
+    frameReloads = 0;
+    frameRefines = 0;
+    evictionCount = 0;
+    reloadCount = 0;
+}
@@ -0,0 +1,631 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "BlockCompression.h"
+#include "CookedTexture.h"
+#include "Logging.h"
+#include "Profiler.h"
+#include "TextureCache.h"
+#include "TexturePool.h"
+#include "TextureResidency.h"
+#include "VirtualFS.h"
+
+/// @brief Задача загрузки текстуры
+struct StreamJob {
+    /// @brief Путь к файлу
+    std::string path;
+    /// @brief Текстура из кэша
+    REngine::Texture* texture = nullptr;
+    /// @brief Цвет текстуры при ошибке загрузки
+    glm::vec3 fallbackColor;
+    /// @brief Наибольшая сторона нулевого уровня, 0 без ограничения
+    int maxSize = 0;
+    /// @brief Удалось ли декодировать файл
+    bool decoded = false;
+    /// @brief Размеры и количество каналов нулевого уровня
+    int width = 0, height = 0, channels = 0;
+    /// @brief Формат пикселей уровней
+    REngine::TextureFormat format = REngine::TextureFormat::RGBA8;
+    /// @brief Пиксели или блоки всех мип-уровней подряд
+    std::vector<unsigned char> pixels;
+    /// @brief Мип-уровни
+    std::vector<REngine::TextureLevel> levels;
+    /// @brief Следующий передаваемый уровень, уровни передаются от мелких к детальным
+    int nextLevel = 0;
+    /// @brief Первая непереданная строка уровня nextLevel, для сжатых форматов в строках блоков
+    int nextRow = 0;
+    /// @brief Передаются ли недостающие уровни в уже загруженную текстуру
+    bool refine = false;
+    /// @brief Искать ли текстуру с тем же содержимым
+    bool deduplicate = false;
+    /// @brief Ключ содержимого
+    REngine::TextureContent content;
+    /// @brief Текстура с тем же содержимым
+    REngine::Texture* source = nullptr;
+    /// @brief Выделена ли память под все уровни заранее
+    bool allocated = false;
+    /// @brief ID текстуры, назначается после передачи всех уровней
+    GLuint textureID = 0;
+    /// @brief Массив текстур, если текстура размещена в слое
+    REngine::TextureArray* array = nullptr;
+    /// @brief Слой в массиве текстур
+    int layer = 0;
+};
+
+static std::vector<std::thread> workers;
+static std::mutex queueMutex;
+static std::condition_variable queueCondition;
+static std::deque<std::unique_ptr<StreamJob>> requests;
+static std::deque<std::unique_ptr<StreamJob>> completed;
+static bool stopping = false;
+
+// Дальше только поток с контекстом OpenGL
+static std::unique_ptr<StreamJob> uploading;
+static std::atomic<size_t> pendingCount{0};
+static size_t uploadBudget = TEXTURE_STREAMER_UPLOAD_BUDGET;
+static size_t frameUploadBytes = 0;
+// Буферы пикселей по слотам кадров FrameSync, уровни кадра дописываются в буфер его слота
+static GLuint pixelBuffers[FRAMES_IN_FLIGHT_MAX] = {};
+static size_t pixelBufferSizes[FRAMES_IN_FLIGHT_MAX] = {};
+static int pixelBufferSlot = -1;
+static size_t pixelBufferOffset = 0;
+
+// Копирование готовых уровней, без поддержки формата драйвером блоки распаковываются
+static bool readLevels(REngine::TextureFormat format, const std::vector<REngine::TextureLevel>& levels,
+                       const unsigned char* pixels, StreamJob& job) {
+    job.width = levels[0].width;
+    job.height = levels[0].height;
+    job.channels = format == REngine::TextureFormat::RGB8 ? 3 : 4;
+    job.format = format;
+
+    REngine::BlockFormat blockFormat;
+    if (REngine::Texture::isFormatSupported(format) || !REngine::Texture::getBlockFormat(format, blockFormat)) {
+        size_t offset = 0;
+        for (const REngine::TextureLevel& level : levels) {
+            job.pixels.insert(job.pixels.end(), pixels + level.offset, pixels + level.offset + level.size);
+            job.levels.push_back({level.width, level.height, offset, level.size});
+            offset += level.size;
+        }
+        return true;
+    }
+
+    job.format = REngine::TextureFormat::RGBA8;
+    std::vector<unsigned char> rgba;
+    size_t offset = 0;
+    for (const REngine::TextureLevel& level : levels) {
+        if (!REngine::BlockCompressor::decompress(blockFormat, pixels + level.offset, level.width, level.height, rgba)) {
+            return false;
+        }
+        job.pixels.insert(job.pixels.end(), rgba.begin(), rgba.end());
+        job.levels.push_back({level.width, level.height, offset, rgba.size()});
+        offset += rgba.size();
+    }
+    return true;
+}
+
+static bool readDDS(const std::string& path, StreamJob& job) {
+    REngine::AssetFile file(path);
+    REngine::CompressedImage image;
+    const unsigned char* blocks = nullptr;
+    if (!file.isOpen() || !REngine::BlockCompressor::parseDDS(file.data(), file.size(), image, blocks)) {
+        return false;
+    }
+    return readLevels(REngine::CookedTexture::fromBlockFormat(image.format), image.levels, blocks, job);
+}
+
+static bool readRTEX(const std::string& path, StreamJob& job) {
+    REngine::AssetFile file(path);
+    REngine::CookedImage image;
+    if (!file.isOpen() || !REngine::CookedTexture::parse(file.data(), file.size(), image)) {
+        return false;
+    }
+    return readLevels(image.format, image.levels, file.data(), job);
+}
+
+// Два независимых хэша пикселей всех уровней вместе с форматом и размерами, по 8 байт за шаг
+static REngine::TextureContent hashContent(const StreamJob& job) {
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    uint64_t hash = ((uint64_t)job.format << 48) ^ ((uint64_t)job.width << 24) ^ (uint64_t)job.height ^ (job.levels.size() * multiplier);
+    uint64_t check = hash ^ 0xC2B2AE3D27D4EB4Full;
+    auto mix = [&](uint64_t word) {
+        check = ((check ^ word) * 0x100000001B3ull) + (check >> 29);
+        word *= 0x87C37B91114253D5ull;
+        word = (word << 31) | (word >> 33);
+        hash ^= word * 0x4CF5AD432745937Full;
+        hash = ((hash << 27) | (hash >> 37)) * 5 + 0x52DCE729;
+    };
+    const unsigned char* data = job.pixels.data();
+    size_t size = job.pixels.size();
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        mix(word);
+    }
+    // Для пустых пикселей data равен nullptr, и копировать нечего
+    uint64_t tail = 0;
+    if (size > i) {
+        std::memcpy(&tail, data + i, size - i);
+    }
+    mix(tail ^ size);
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    return {hash, check, size};
+}
+
+static void decodeJob(StreamJob& job) {
+    std::filesystem::path source(job.path);
+    std::string extension = source.extension().string();
+    // Подготовленный файл рядом с исходником загружается без декодирования, если он не устарел
+    std::string cooked = std::filesystem::path(source).replace_extension(".rtex").string();
+    if (extension != ".rtex" && REngine::VirtualFS::isNewer(cooked, job.path)) {
+        job.decoded = readRTEX(cooked, job);
+        if (!job.decoded) {
+            job.pixels.clear();
+            job.levels.clear();
+        }
+    }
+    if (!job.decoded) {
+        if (extension == ".dds" || extension == ".DDS") {
+            job.decoded = readDDS(job.path, job);
+        } else if (extension == ".rtex") {
+            job.decoded = readRTEX(job.path, job);
+        } else {
+            job.decoded = REngine::Texture::decodeBMP(job.path, job.pixels, job.width, job.height, job.channels);
+            if (job.decoded) {
+                job.format = job.channels == 3 ? REngine::TextureFormat::RGB8 : REngine::TextureFormat::RGBA8;
+                REngine::Texture::buildMipChain(job.pixels, job.width, job.height, job.channels, job.levels);
+            }
+        }
+    }
+
+    // Уровни крупнее maxSize не передаются, смещения оставшихся уровней не меняются
+    size_t first = 0;
+    while (job.maxSize > 0 && first + 1 < job.levels.size() && std::max(job.levels[first].width, job.levels[first].height) > job.maxSize) {
+        first++;
+    }
+    if (job.decoded && first > 0) {
+        job.levels.erase(job.levels.begin(), job.levels.begin() + first);
+        job.width = job.levels[0].width;
+        job.height = job.levels[0].height;
+    }
+    if (job.decoded && job.deduplicate) {
+        job.content = hashContent(job);
+    }
+}
+
+static void workerLoop() {
+    PROFILE_THREAD("texture worker");
+    while (true) {
+        std::unique_ptr<StreamJob> job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, []() { return stopping || !requests.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = std::move(requests.front());
+            requests.pop_front();
+        }
+        {
+            PROFILE_SCOPE("TextureStreamer::decode");
+            decodeJob(*job);
+        }
+        std::lock_guard<std::mutex> lock(queueMutex);
+        completed.push_back(std::move(job));
+    }
+}
+
+// Количество строк уровня и их высота в пикселях, сжатые форматы делятся по строкам блоков 4x4
+static int getRowCount(const StreamJob& job, const REngine::TextureLevel& info, int& rowHeight) {
+    REngine::BlockFormat blockFormat;
+    rowHeight = REngine::Texture::getBlockFormat(job.format, blockFormat) ? 4 : 1;
+    return (info.height + rowHeight - 1) / rowHeight;
+}
+
+// Размер строки следующего уровня в байтах
+static size_t getRowSize(const StreamJob& job) {
+    const REngine::TextureLevel& info = job.levels[job.nextLevel];
+    int rowHeight;
+    return info.size / getRowCount(job, info, rowHeight);
+}
+
+// Передача следующих строк мип-уровня объёмом не больше budget, но хотя бы одной строки, возвращает объём в байтах
+static size_t uploadLevel(StreamJob& job, size_t budget) {
+    int level = job.nextLevel;
+    const REngine::TextureLevel& info = job.levels[level];
+    int rowHeight;
+    int rowCount = getRowCount(job, info, rowHeight);
+    size_t rowSize = info.size / rowCount;
+    int rows = (int)std::clamp<size_t>(budget / rowSize, 1, (size_t)(rowCount - job.nextRow));
+    int y = job.nextRow * rowHeight;
+    REngine::TextureLevel band = {info.width, std::min(rows * rowHeight, info.height - y), 0, rows * rowSize};
+    bool whole = rows == rowCount;
+    size_t size = band.size;
+    const unsigned char* data = job.pixels.data() + info.offset + job.nextRow * rowSize;
+
+    // Текстура размещается в слое массива, если пул включён, иначе создаётся отдельно
+    if (job.textureID == 0 && !job.array &&
+        !REngine::TexturePool::acquire(job.format, job.width, job.height, (int)job.levels.size(), job.array, job.layer)) {
+        glGenTextures(1, &job.textureID);
+        glBindTexture(GL_TEXTURE_2D, job.textureID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)job.levels.size() - 1);
+        job.allocated = REngine::Texture::allocateLevels(job.format, job.width, job.height, (int)job.levels.size());
+    } else if (!job.array) {
+        glBindTexture(GL_TEXTURE_2D, job.textureID);
+    }
+    // Без заранее выделенной памяти уровень, передаваемый по частям, выделяется перед первой полосой
+    if (!job.array && !job.allocated && !whole && job.nextRow == 0) {
+        REngine::Texture::uploadLevel(job.format, false, level, info, nullptr);
+    }
+
+    // GPU закончил кадр, читавший буфер слота, поэтому он отображается без синхронизации.
+    // Без слота или места в буфере данные передаются из памяти задачи
+    size_t offset = (pixelBufferOffset + 15) & ~(size_t)15;
+    void* mapped = nullptr;
+    if (pixelBufferSlot >= 0 && offset + size <= pixelBufferSizes[pixelBufferSlot]) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers[pixelBufferSlot]);
+        mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, size,
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+    if (mapped) {
+        std::memcpy(mapped, data, size);
+    }
+    if (mapped && glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE) {
+        // Далее данные берутся из буфера по смещению
+        data = reinterpret_cast<const unsigned char*>(offset);
+        pixelBufferOffset = offset + size;
+    } else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    if (job.array) {
+        job.array->uploadLayer(job.layer, level, band, data, y);
+    } else {
+        REngine::Texture::uploadLevel(job.format, job.allocated || !whole, level, band, data, y);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    job.nextRow += rows;
+    if (job.nextRow < rowCount) {
+        return size;
+    }
+    // Догружаемая текстура сразу начинает читать новый уровень
+    if (job.refine) {
+        job.texture->setBaseLevel(level, (int)job.levels.size() - 1, info.size);
+    }
+    job.nextRow = 0;
+    job.nextLevel--;
+    return size;
+}
+
+// Подготовка к передаче уровней, вызывается в потоке с контекстом OpenGL
+static void beginUpload(StreamJob& job) {
+    job.nextLevel = (int)job.levels.size() - 1;
+    if (job.deduplicate) {
+        // Одинаковое содержимое под разными путями хранится в одной текстуре
+        job.source = REngine::TextureCache::findContent(job.content);
+        if (job.source) {
+            job.nextLevel = -1;
+        } else {
+            REngine::TextureCache::insertContent(job.content, job.texture);
+        }
+    }
+    if (!job.refine) {
+        return;
+    }
+    REngine::Texture* texture = job.texture;
+    if (!texture->isResident() || texture->getWidth() != job.width || texture->getHeight() != job.height) {
+        // Файл изменился, текстура создаётся заново
+        job.refine = false;
+        return;
+    }
+    job.textureID = texture->getID();
+    job.array = texture->getArray();
+    job.layer = texture->getLayer();
+    job.allocated = REngine::Texture::hasImmutableStorage();
+    job.nextLevel = std::min(job.nextLevel, texture->getBaseLevel() - 1);
+}
+
+// Самый детальный уровень, который нужно передать
+static int getTargetLevel(const StreamJob& job) {
+    if (job.maxSize > 0) {
+        return 0;
+    }
+    int level = REngine::TextureResidency::getRequiredLevel(job.texture, job.width, job.height);
+    return std::min(level, (int)job.levels.size() - 1);
+}
+
+// Сначала текстуры, вместо которых привязана заглушка, затем занимающие больше места на экране
+static bool isMoreUrgent(const std::unique_ptr<StreamJob>& a, const std::unique_ptr<StreamJob>& b) {
+    bool aVisible = a->texture->isResident(), bVisible = b->texture->isResident();
+    if (aVisible != bVisible) {
+        return !aVisible;
+    }
+    return REngine::TextureResidency::getRequiredSize(a->texture) > REngine::TextureResidency::getRequiredSize(b->texture);
+}
+
+// Передача текстуры в кэш после загрузки всех уровней или ошибки
+static void completeJob(StreamJob& job) {
+    REngine::Texture* texture = job.texture;
+    texture->setPending(false);
+    if (!job.decoded && job.refine) {
+        ERROR("Failed to refine texture: " + job.path);
+        return;
+    }
+    if (!job.decoded) {
+        ERROR("Failed to load texture: " + job.path);
+        texture->setColor(job.fallbackColor.x, job.fallbackColor.y, job.fallbackColor.z);
+        REngine::TextureResidency::untrack(texture);
+        return;
+    }
+    if (job.refine) {
+        DEBUG("Refined texture: " << job.path << " to level " << texture->getBaseLevel());
+        return;
+    }
+    if (job.source) {
+        texture->share(job.source);
+        REngine::TextureResidency::untrack(texture);
+        DEBUG("Shared texture: " << job.path << " has the same content as another texture");
+        return;
+    }
+
+    int baseLevel = job.nextLevel + 1;
+    int levelCount = (int)job.levels.size();
+    if (job.array) {
+        // Память слоя выделена под все уровни вместе с массивом
+        size_t layerSize = REngine::TextureArray::getLayerSize(job.format, job.width, job.height, levelCount);
+        texture->adoptLayer(job.array, job.layer, job.width, job.height, job.channels * 8, layerSize);
+    } else {
+        size_t memorySize = 0;
+        for (int i = baseLevel; i < levelCount; i++) {
+            memorySize += job.levels[i].size;
+        }
+        texture->adopt(job.textureID, job.width, job.height, job.channels * 8, memorySize);
+    }
+    texture->setBaseLevel(baseLevel, levelCount - 1);
+    DEBUG("Streamed texture: " << job.path << " (" << job.width << "x" << job.height << ", "
+                               << job.levels.size() - baseLevel << " of " << job.levels.size() << " levels" << ", "
+                               << REngine::CookedTexture::getFormatName(job.format) << ")");
+}
+
+// Загрузка без рабочих потоков
+static void loadJob(StreamJob& job) {
+    decodeJob(job);
+    if (job.decoded) {
+        beginUpload(job);
+    }
+    while (job.decoded && job.nextLevel >= getTargetLevel(job)) {
+        uploadLevel(job, SIZE_MAX);
+    }
+    completeJob(job);
+}
+
+// Постановка задачи для текстуры из кэша
+static void enqueueJob(std::unique_ptr<StreamJob> job) {
+    if (!REngine::TextureStreamer::isRunning()) {
+        loadJob(*job);
+        return;
+    }
+
+    // Прежняя текстура остаётся привязанной до окончания загрузки
+    job->texture->setPending(true);
+    pendingCount++;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        requests.push_back(std::move(job));
+    }
+    queueCondition.notify_one();
+}
+
+void REngine::TextureStreamer::start(int workerCount) {
+    if (isRunning()) {
+        return;
+    }
+    if (workerCount <= 0) {
+        workerCount = std::clamp((int)std::thread::hardware_concurrency() - 1, 1, TEXTURE_STREAMER_WORKERS_MAX);
+    }
+
+    // Заглушка 1x1 серого цвета
+    const unsigned char grey[4] = {128, 128, 128, 255};
+    glGenTextures(1, &Texture::placeholderID);
+    glBindTexture(GL_TEXTURE_2D, Texture::placeholderID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glGenBuffers(FRAMES_IN_FLIGHT_MAX, pixelBuffers);
+
+    stopping = false;
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back(workerLoop);
+    }
+    DEBUG("Texture streamer started with " << workerCount << " workers");
+}
+
+void REngine::TextureStreamer::stop() {
+    if (!isRunning()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    // Незавершённые текстуры остаются пустыми
+    auto abandon = [](StreamJob& job) {
+        job.texture->setPending(false);
+        // Догружаемые уровни остаются в текстуре
+        if (job.refine) {
+            return;
+        }
+        REngine::TextureCache::eraseContent(job.texture);
+        if (job.textureID != 0) {
+            glDeleteTextures(1, &job.textureID);
+        }
+        if (job.array) {
+            REngine::TexturePool::release(job.array, job.layer);
+        }
+    };
+    for (auto& job : requests) {
+        abandon(*job);
+    }
+    for (auto& job : completed) {
+        abandon(*job);
+    }
+    if (uploading) {
+        abandon(*uploading);
+    }
+    requests.clear();
+    completed.clear();
+    uploading.reset();
+    pendingCount = 0;
+
+    glDeleteBuffers(FRAMES_IN_FLIGHT_MAX, pixelBuffers);
+    std::fill(std::begin(pixelBuffers), std::end(pixelBuffers), 0);
+    std::fill(std::begin(pixelBufferSizes), std::end(pixelBufferSizes), 0);
+    glDeleteTextures(1, &Texture::placeholderID);
+    Texture::placeholderID = 0;
+}
+
+bool REngine::TextureStreamer::isRunning() {
+    return !workers.empty();
+}
+
+REngine::Texture* REngine::TextureStreamer::request(const std::string& path, const glm::vec3& fallbackColor) {
+    Texture* cached = TextureCache::find(path);
+    if (cached) {
+        return cached;
+    }
+
+    auto job = std::make_unique<StreamJob>();
+    job->path = path;
+    job->fallbackColor = fallbackColor;
+    job->deduplicate = true;
+    job->texture = new Texture();
+    Texture* stored = TextureCache::insert(path, job->texture);
+    if (stored != job->texture) {
+        delete job->texture;
+        return stored;
+    }
+    // Нужный размер известен к передаче уровней, если текстура используется в кадре
+    TextureResidency::track(stored, path);
+    enqueueJob(std::move(job));
+    return stored;
+}
+
+void REngine::TextureStreamer::reload(Texture* texture, const std::string& path, int maxSize) {
+    // Новое содержимое может отличаться, поэтому другие пути больше не находят эту текстуру по содержимому
+    TextureCache::eraseContent(texture);
+    auto job = std::make_unique<StreamJob>();
+    job->path = path;
+    job->texture = texture;
+    job->fallbackColor = glm::vec3(1.0f);
+    job->maxSize = maxSize;
+    enqueueJob(std::move(job));
+}
+
+void REngine::TextureStreamer::refine(Texture* texture, const std::string& path) {
+    auto job = std::make_unique<StreamJob>();
+    job->path = path;
+    job->texture = texture;
+    job->fallbackColor = glm::vec3(1.0f);
+    job->refine = true;
+    enqueueJob(std::move(job));
+}
+
+void REngine::TextureStreamer::update(int frameSlot) {
+    frameUploadBytes = 0;
+    if (pendingCount.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    pixelBufferSlot = frameSlot >= 0 && frameSlot < FRAMES_IN_FLIGHT_MAX && pixelBuffers[frameSlot] != 0 ? frameSlot : -1;
+    pixelBufferOffset = 0;
+    if (pixelBufferSlot >= 0 && pixelBufferSizes[pixelBufferSlot] != uploadBudget) {
+        // Буфер слота вмещает объём передачи за кадр, более крупные строки передаются из памяти задачи
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffers[pixelBufferSlot]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, uploadBudget, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        pixelBufferSizes[pixelBufferSlot] = uploadBudget;
+    }
+
+    while (true) {
+        if (!uploading) {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (completed.empty()) {
+                break;
+            }
+            // При ограниченном объёме передачи важные текстуры обгоняют остальные
+            auto next = std::min_element(completed.begin(), completed.end(), isMoreUrgent);
+            uploading = std::move(*next);
+            completed.erase(next);
+            if (uploading->decoded) {
+                beginUpload(*uploading);
+            }
+        }
+
+        StreamJob& job = *uploading;
+        if (job.decoded && job.nextLevel >= getTargetLevel(job)) {
+            // Объём за кадр ограничен, крупные уровни передаются по частям, но хотя бы одна строка передаётся всегда
+            size_t remaining = frameUploadBytes < uploadBudget ? uploadBudget - frameUploadBytes : 0;
+            if (frameUploadBytes > 0 && remaining < getRowSize(job)) {
+                break;
+            }
+            frameUploadBytes += uploadLevel(job, remaining);
+            continue;
+        }
+
+        completeJob(job);
+        uploading.reset();
+        pendingCount--;
+    }
+    pixelBufferSlot = -1;
+}
+
+void REngine::TextureStreamer::finish() {
+    size_t budget = uploadBudget;
+    uploadBudget = SIZE_MAX;
+    while (getPendingCount() > 0) {
+        update();
+        if (getPendingCount() > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    uploadBudget = budget;
+}
+
+void REngine::TextureStreamer::setUploadBudget(size_t bytes) {
+    uploadBudget = bytes;
+}
+
+size_t REngine::TextureStreamer::getPendingCount() {
+    return pendingCount.load(std::memory_order_relaxed);
+}
+
+size_t REngine::TextureStreamer::getFrameUploadBytes() {
+    return frameUploadBytes;
+}
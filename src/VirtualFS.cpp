@@ -0,0 +1,152 @@
+#include "VirtualFS.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+
+#include "Logging.h"
+
+std::shared_mutex REngine::VirtualFS::mutex;
+std::vector<std::unique_ptr<REngine::PackArchive>> REngine::VirtualFS::archives;
+std::vector<std::string> REngine::VirtualFS::searchPaths = {"", "textures/", "../textures/"};
+
+bool REngine::AssetFile::open(const std::string& path) {
+    return VirtualFS::open(path, *this);
+}
+
+void REngine::AssetFile::close() {
+    mapped.close();
+    buffer.clear();
+    bytes = nullptr;
+    length = 0;
+    packed = false;
+}
+
+bool REngine::VirtualFS::mount(const std::string& path) {
+    std::unique_ptr<PackArchive> archive(new PackArchive());
+    if (!archive->open(path)) {
+        ERROR("Failed to mount archive: " + path);
+        return false;
+    }
+    DEBUG("Mounted archive " << path << " with " << archive->getEntryCount() << " files");
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    archives.push_back(std::move(archive));
+    return true;
+}
+
+void REngine::VirtualFS::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    archives.clear();
+}
+
+size_t REngine::VirtualFS::getArchiveCount() {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return archives.size();
+}
+
+void REngine::VirtualFS::addSearchPath(const std::string& prefix) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (std::find(searchPaths.begin(), searchPaths.end(), prefix) == searchPaths.end()) {
+        searchPaths.push_back(prefix);
+    }
+}
+
+const REngine::RPakEntry* REngine::VirtualFS::findPacked(const std::string& path, const PackArchive*& archive) {
+    if (archives.empty()) {
+        return nullptr;
+    }
+    // Каталоги поиска применяются и к архивам, поэтому "a.bmp" находится как "textures/a.bmp"
+    for (const std::string& prefix : searchPaths) {
+        if (isAbsolute(path) && !prefix.empty()) {
+            continue;
+        }
+        std::string name = PackArchive::normalizeName(prefix + path);
+        // Последний подключённый архив перекрывает предыдущие
+        for (auto it = archives.rbegin(); it != archives.rend(); ++it) {
+            const RPakEntry* entry = (*it)->find(name);
+            if (entry) {
+                archive = it->get();
+                return entry;
+            }
+        }
+    }
+    return nullptr;
+}
+
+bool REngine::VirtualFS::isAbsolute(const std::string& path) {
+    return !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+}
+
+bool REngine::VirtualFS::open(const std::string& path, AssetFile& file) {
+    file.close();
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const PackArchive* archive = nullptr;
+    const RPakEntry* entry = findPacked(path, archive);
+    if (entry) {
+        file.bytes = archive->read(*entry, file.buffer);
+        if (!file.bytes) {
+            ERROR("Corrupted file " << path << " in archive " << archive->getPath());
+            return false;
+        }
+        file.length = (size_t)entry->size;
+        file.packed = true;
+        return true;
+    }
+
+    // Каждый каталог поиска стоит одного вызова open
+    for (const std::string& prefix : searchPaths) {
+        if (isAbsolute(path) && !prefix.empty()) {
+            continue;
+        }
+        if (file.mapped.open(prefix + path)) {
+            file.bytes = file.mapped.data();
+            file.length = file.mapped.size();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool REngine::VirtualFS::exists(const std::string& path) {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const PackArchive* archive = nullptr;
+    if (findPacked(path, archive)) {
+        return true;
+    }
+    std::error_code error;
+    for (const std::string& prefix : searchPaths) {
+        if ((prefix.empty() || !isAbsolute(path)) && std::filesystem::is_regular_file(prefix + path, error)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool REngine::VirtualFS::isPacked(const std::string& path) {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const PackArchive* archive = nullptr;
+    return findPacked(path, archive) != nullptr;
+}
+
+bool REngine::VirtualFS::isNewer(const std::string& path, const std::string& source) {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const PackArchive* archive = nullptr;
+    if (findPacked(path, archive)) {
+        return true;
+    }
+    std::error_code error;
+    bool pathFound = false;
+    for (const std::string& prefix : searchPaths) {
+        if (!prefix.empty() && isAbsolute(path)) {
+            continue;
+        }
+        std::string candidate = prefix + path;
+        bool found = std::filesystem::is_regular_file(candidate, error);
+        if (std::filesystem::is_regular_file(prefix + source, error)) {
+            return found && std::filesystem::last_write_time(candidate, error) >= std::filesystem::last_write_time(prefix + source, error);
+        }
+        // Без исходника производный файл используется как есть
+        pathFound = pathFound || found;
+    }
+    return pathFound;
+}
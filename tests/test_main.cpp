@@ -1,22 +1,52 @@
 #include <SDL.h>
 #include <gtest/gtest.h>
 
+#include <climits>
 #include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <thread>
 #include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/epsilon.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "AllocTracker.h"
+#include "AssetCooker.h"
+#include "BlockCompression.h"
 #include "Camera.h"
+#include "CameraPath.h"
+#include "CookedMesh.h"
+#include "CookedTexture.h"
+#include "GltfImporter.h"
 #include "Mesh.h"
+#include "ObjImporter.h"
+#include "PixelConvert.h"
+#include "Profiler.h"
 #include "Renderer.h"
 #include "Scene.h"
 #include "Shader.h"
 #include "Engine.h"
+#include "FrameArena.h"
+#include "FrameClock.h"
+#include "FrameStats.h"
+#include "FrameSync.h"
+#include "InputHandler.h"
+#include "Logging.h"
+#include "Lz4.h"
+#include "MappedFile.h"
+#include "PackArchive.h"
+#include "SceneGenerator.h"
+#include "Texture.h"
+#include "TextureCache.h"
+#include "TexturePool.h"
+#include "TextureResidency.h"
+#include "TextureStreamer.h"
+#include "VirtualFS.h"
 
 TEST(Camera, DefaultViewProjection) {
     const int w = 800, h = 600;
@@ -39,6 +69,40 @@ TEST(Camera, DefaultViewProjection) {
     EXPECT_NE(initialRotation.x, newRotation.x);
 }
 
+TEST(CameraPath, Interpolation) {
+    const char* path = "camera_path_test.txt";
+    {
+        std::ofstream file(path);
+        file << "# time x y z pitch yaw\n"
+             << "0 0 0 0 0 170\n"
+             << "1 10 0 0 10 -170\n"
+             << "\n"
+             << "2 10 0 10 0 -90\n";
+    }
+
+    REngine::CameraPath cameraPath;
+    ASSERT_TRUE(cameraPath.loadFromFile(path));
+    std::remove(path);
+    ASSERT_EQ(cameraPath.getKeyframes().size(), 3);
+    EXPECT_FLOAT_EQ(cameraPath.getDuration(), 2.0f);
+
+    // Сплайн проходит через ключевые кадры
+    REngine::CameraKeyframe key = cameraPath.sample(1.0f);
+    EXPECT_NEAR(glm::length(key.position - glm::vec3(10, 0, 0)), 0.0f, 1e-4f);
+    EXPECT_NEAR(key.pitch, 10.0f, 1e-4f);
+
+    // Поворот идёт через 180, а не через 0
+    EXPECT_NEAR(key.yaw, 190.0f, 1e-4f);
+    EXPECT_GT(cameraPath.sample(0.5f).yaw, 170.0f);
+
+    REngine::CameraKeyframe middle = cameraPath.sample(1.5f);
+    EXPECT_GT(middle.position.z, 0.0f);
+    EXPECT_LT(middle.position.z, 10.0f);
+
+    EXPECT_EQ(cameraPath.sample(5.0f).position, glm::vec3(10, 0, 10));
+    EXPECT_FALSE(cameraPath.addKeyframe(REngine::CameraKeyframe()));
+}
+
 TEST(Renderer, Initialization) {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         FAIL() << "SDL could not initialize! SDL_Error: " << SDL_GetError();
@@ -161,9 +225,1491 @@ TEST(Scene, NodeManipulation) {
     EXPECT_EQ(scene.dirLight.specular, glm::vec3(1.0f));
 }
 
-TEST(Engine, WindowCreation) {
+TEST(FrameStats, Percentiles) {
+    REngine::FrameStats stats(200);
+
+    for (unsigned long i = 0; i < 300; i++) {
+        REngine::FrameRecord record;
+        record.frame = i;
+        record.frameTime = (i % 100) + 1.0f;
+        record.cpuTime = 1.0f;
+        stats.record(record);
+    }
+
+    ASSERT_EQ(stats.size(), 200);
+    EXPECT_EQ(stats.get(0).frame, 100);
+    EXPECT_EQ(stats.last().frame, 299);
+
+    REngine::FrameSummary summary = stats.summarize();
+    EXPECT_EQ(summary.frames, 200);
+    EXPECT_DOUBLE_EQ(summary.mean, 50.5);
+    EXPECT_DOUBLE_EQ(summary.p50, 50.0);
+    EXPECT_DOUBLE_EQ(summary.p95, 95.0);
+    EXPECT_DOUBLE_EQ(summary.p99, 99.0);
+    EXPECT_DOUBLE_EQ(summary.max, 100.0);
+    EXPECT_EQ(summary.hitches, 0);
+    EXPECT_DOUBLE_EQ(summary.gpuMean, 0.0);
+
+    stats.setGpuTime(250, 4.0f);
+    EXPECT_FLOAT_EQ(stats.get(150).gpuTime, 4.0f);
+    EXPECT_DOUBLE_EQ(stats.summarize().gpuMean, 4.0);
+
+    REngine::FrameRecord hitch;
+    hitch.frame = 300;
+    hitch.frameTime = 500.0f;
+    stats.record(hitch);
+    summary = stats.summarize(10);
+    EXPECT_EQ(summary.frames, 10);
+    EXPECT_DOUBLE_EQ(summary.max, 500.0);
+    EXPECT_EQ(summary.hitches, 1);
+
+    // Области с одним названием суммируются, новые названия сверх FRAME_STATS_GPU_SCOPES_MAX отбрасываются
+    std::vector<std::string> names(FRAME_STATS_GPU_SCOPES_MAX + 2);
+    std::vector<REngine::GpuScopeResult> results;
+    for (size_t i = 0; i < names.size(); i++) {
+        names[i] = "scope " + std::to_string(i);
+        results.push_back({names[i].c_str(), 0, 1.0});
+    }
+    results.push_back({names[0].c_str(), 0, 2.0});
+    stats.setGpuScopeTimes(300, results);
+    EXPECT_EQ(stats.getGpuScopeNames().size(), FRAME_STATS_GPU_SCOPES_MAX);
+    EXPECT_FLOAT_EQ(stats.getGpuScopeTime(stats.size() - 1, 0), 3.0f);
+    EXPECT_DOUBLE_EQ(stats.getGpuScopeMean(names.back().c_str()), 0.0);
+}
+
+TEST(FrameClock, FixedTimeStep) {
+    // Шаг и времена кадров точно представимы в double
+    REngine::FixedTimeStep timeStep(1.0 / 64.0);
+    EXPECT_EQ(timeStep.advance(2.5 / 64.0), 2);
+    EXPECT_DOUBLE_EQ(timeStep.getAlpha(), 0.5);
+    EXPECT_DOUBLE_EQ(timeStep.getSimulationTime(), 2.0 / 64.0);
+    EXPECT_DOUBLE_EQ(timeStep.getInterpolatedTime(), 2.5 / 64.0);
+
+    // Остаток переносится в следующий кадр
+    EXPECT_EQ(timeStep.advance(0.25 / 64.0), 0);
+    EXPECT_DOUBLE_EQ(timeStep.getAlpha(), 0.75);
+    EXPECT_EQ(timeStep.advance(0.25 / 64.0), 1);
+    EXPECT_DOUBLE_EQ(timeStep.getAlpha(), 0.0);
+    EXPECT_DOUBLE_EQ(timeStep.getSimulationTime(), 3.0 / 64.0);
+
+    // Долгий кадр ограничивается FIXED_UPDATE_MAX_FRAME_TIME, а при пролёте по пути время не ограничивается
+    EXPECT_EQ(timeStep.advance(10.0), (int)(FIXED_UPDATE_MAX_FRAME_TIME * 64));
+    EXPECT_EQ(timeStep.advance(1.0, false), 64);
+    EXPECT_DOUBLE_EQ(timeStep.getAlpha(), 0.0);
+
+    // Ограничитель выдерживает бюджет кадра
+    REngine::FrameClock clock;
+    clock.setTargetFrameRate(100.0);
+    clock.tick();
+    clock.limit();
+    EXPECT_GE(clock.getFrameElapsed(), 0.0099);
+    EXPECT_GE(clock.tick(), 0.0099);
+    EXPECT_GE(clock.getTime(), clock.getDeltaTime());
+}
+
+TEST(Profiler, CaptureRange) {
+    const char* path = "profiler_test.json";
+    REngine::Profiler::setCaptureRange(2, 3, path);
+
+    // До диапазона области не записываются
+    REngine::Profiler::beginFrame(1);
+    EXPECT_FALSE(REngine::Profiler::isCapturing());
+    { REngine::ProfileScope scope("before capture"); }
+
+    // Каждый поток пишет в свой буфер, потоки подписываются названиями
+    REngine::Profiler::beginFrame(2);
+    EXPECT_TRUE(REngine::Profiler::isCapturing());
+    { REngine::ProfileScope scope("main scope"); }
+    std::thread worker([]() {
+        REngine::Profiler::setThreadName("profiler worker");
+        REngine::ProfileScope scope("worker scope");
+    });
+    worker.join();
+    REngine::Profiler::beginFrame(3);
+    EXPECT_TRUE(REngine::Profiler::isCapturing());
+
+    // После последнего кадра диапазона запись останавливается и трассировка сохраняется
+    REngine::Profiler::beginFrame(4);
+    EXPECT_FALSE(REngine::Profiler::isCapturing());
+    { REngine::ProfileScope scope("after capture"); }
+
+    std::ifstream file(path);
+    ASSERT_TRUE(file.is_open());
+    std::string trace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::remove(path);
+    EXPECT_EQ(trace.compare(0, 42, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": ["), 0);
+    EXPECT_EQ(trace.substr(trace.size() - 4), "\n]}\n");
+    EXPECT_NE(trace.find("{\"name\": \"main scope\", \"ph\": \"X\""), std::string::npos);
+    EXPECT_NE(trace.find("{\"name\": \"worker scope\", \"ph\": \"X\""), std::string::npos);
+    EXPECT_NE(trace.find("\"args\": {\"name\": \"profiler worker\"}"), std::string::npos);
+    EXPECT_EQ(trace.find("before capture"), std::string::npos);
+    EXPECT_EQ(trace.find("after capture"), std::string::npos);
+}
+
+TEST(FrameArena, BumpAndGrow) {
+    REngine::FrameArena arena(256);
+
+    char* bytes = arena.allocate<char>(3);
+    double* values = arena.allocate<double>(4);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(values) % alignof(double), 0);
+    EXPECT_GE(reinterpret_cast<char*>(values), bytes + 3);
+    EXPECT_EQ(arena.getUsed(), (size_t)(reinterpret_cast<char*>(values + 4) - bytes));
+
+    // Память после сброса выделяется заново с начала буфера
+    arena.reset();
+    EXPECT_EQ(arena.allocate<char>(1), bytes);
+
+    {
+        REngine::ArenaVector<int> numbers{REngine::ArenaAllocator<int>(arena)};
+        for (int i = 0; i < 200; i++) {
+            numbers.push_back(i);
+        }
+        EXPECT_EQ(numbers[199], 199);
+    }
+    EXPECT_GT(arena.getHighWater(), 256);
+
+    arena.reset();
+    EXPECT_GE(arena.getCapacity(), arena.getHighWater());
+    EXPECT_EQ(arena.getUsed(), 0);
+
+    // Нехватка только из-за отступа выравнивания тоже учитывается в пиковом объёме
+    REngine::FrameArena padded(64);
+    padded.allocate<char>(1);
+    padded.allocate<double>(8);
+    EXPECT_EQ(padded.getHighWater(), 8 + 8 * sizeof(double));
+
+    // После увеличения те же выделения помещаются в буфер и он больше не растёт
+    padded.reset();
+    size_t grown = padded.getCapacity();
+    char* first = padded.allocate<char>(1);
+    EXPECT_EQ(reinterpret_cast<char*>(padded.allocate<double>(8)), first + 8);
+    padded.reset();
+    EXPECT_EQ(padded.getCapacity(), grown);
+}
+
+TEST(PixelConvert, MatchesScalar) {
+    std::vector<unsigned char> source(101 * 4);
+    for (size_t i = 0; i < source.size(); i++) {
+        source[i] = (unsigned char)(i * 37 + 11);
+    }
+
+    for (size_t pixels : {1, 7, 16, 101}) {
+        std::vector<unsigned char> expected24(pixels * 3), expected32(pixels * 4);
+        for (size_t i = 0; i < pixels; i++) {
+            for (int c = 0; c < 3; c++) {
+                expected24[i * 3 + c] = source[i * 3 + 2 - c];
+                expected32[i * 4 + c] = source[i * 4 + 2 - c];
+            }
+            expected32[i * 4 + 3] = source[i * 4 + 3];
+        }
+
+        for (REngine::SimdLevel level : {REngine::SimdLevel::Scalar, REngine::SimdLevel::SSSE3, REngine::SimdLevel::AVX2}) {
+            REngine::PixelConvert::setSimdLevel(level);
+            std::vector<unsigned char> result24(pixels * 3), result32(source.begin(), source.begin() + pixels * 4);
+            REngine::PixelConvert::swapRB24(source.data(), result24.data(), pixels);
+            // Преобразование на месте
+            REngine::PixelConvert::swapRB32(result32.data(), result32.data(), pixels);
+            EXPECT_EQ(result24, expected24);
+            EXPECT_EQ(result32, expected32);
+        }
+    }
+    REngine::PixelConvert::setSimdLevel(REngine::SimdLevel::AVX2);
+}
+
+// Запись BMP 24 бита: синий канал 10 * y, зелёный x, красный red в порядке строк файла
+static void writeTestBMP(const char* path, int width, int height, bool topDown, unsigned char red = 200) {
+    int rowSize = (width * 3 + 3) & ~3;
+    std::ofstream file(path, std::ios::binary);
+    auto put16 = [&](uint16_t v) { file.write(reinterpret_cast<const char*>(&v), 2); };
+    auto put32 = [&](uint32_t v) { file.write(reinterpret_cast<const char*>(&v), 4); };
+    put16(0x4D42);
+    put32(54 + rowSize * height);
+    put32(0);
+    put32(54);
+    put32(40);
+    put32(width);
+    put32(topDown ? -height : height);
+    put16(1);
+    put16(24);
+    for (int i = 0; i < 6; i++) {
+        put32(0);
+    }
+    std::vector<unsigned char> row(rowSize);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            row[x * 3] = 10 * y;
+            row[x * 3 + 1] = x;
+            row[x * 3 + 2] = red;
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), rowSize);
+    }
+}
+
+TEST(Texture, DecodeBMP) {
+    const char* path = "decode_test.bmp";
+    const int width = 5, height = 3;
+    // Строки сверху вниз и выравнивание строк
+    writeTestBMP(path, width, height, true);
+
+    std::vector<unsigned char> pixels;
+    int w, h, channels;
+    ASSERT_TRUE(REngine::Texture::decodeBMP(path, pixels, w, h, channels));
+    EXPECT_EQ(w, width);
+    EXPECT_EQ(h, height);
+    EXPECT_EQ(channels, 3);
+    ASSERT_EQ(pixels.size(), width * height * 3);
+    // Первая строка результата соответствует нижней строке изображения
+    EXPECT_EQ(pixels[0], 200);
+    EXPECT_EQ(pixels[2], 20);
+    EXPECT_EQ(pixels[(2 * width + 4) * 3 + 1], 4);
+    EXPECT_EQ(pixels[(2 * width + 4) * 3 + 2], 0);
+
+    // Обрезанный файл не читается за пределами отображения
+    std::filesystem::resize_file(path, 60);
+    EXPECT_FALSE(REngine::Texture::decodeBMP(path, pixels, w, h, channels));
+    std::remove(path);
+}
+
+TEST(Texture, ParseBMPRejectsBadSizes) {
+    std::vector<unsigned char> file(54 + 64);
+    auto put32 = [&](size_t offset, int32_t v) { std::memcpy(file.data() + offset, &v, 4); };
+    file[0] = 'B';
+    file[1] = 'M';
+    put32(10, 54);
+    put32(14, 40);
+    file[28] = 32;
+    REngine::BMPImage image;
+
+    put32(18, 4);
+    put32(22, 4);
+    EXPECT_TRUE(REngine::Texture::parseBMP(file.data(), file.size(), image));
+
+    // Модуль INT_MIN не помещается в int
+    put32(22, INT_MIN);
+    EXPECT_FALSE(REngine::Texture::parseBMP(file.data(), file.size(), image));
+
+    // Произведение размеров переполняет 32 бита, но не должно пройти проверку размера файла
+    put32(18, 0x40000001);
+    put32(22, 4);
+    EXPECT_FALSE(REngine::Texture::parseBMP(file.data(), file.size(), image));
+    put32(18, 1);
+    put32(22, 0x7FFFFFFF);
+    EXPECT_FALSE(REngine::Texture::parseBMP(file.data(), file.size(), image));
+}
+
+TEST(BlockCompression, RoundTrip) {
+    const int width = 30, height = 18;
+    std::vector<unsigned char> rgba(width * height * 4);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            unsigned char* pixel = &rgba[(y * width + x) * 4];
+            pixel[0] = x * 8;
+            pixel[1] = y * 14;
+            pixel[2] = 128;
+            pixel[3] = 255 - x * 8;
+        }
+    }
+
+    const REngine::BlockFormat formats[] = {REngine::BlockFormat::BC1, REngine::BlockFormat::BC3,
+                                            REngine::BlockFormat::BC7};
+    for (REngine::BlockFormat format : formats) {
+        SCOPED_TRACE(REngine::BlockCompressor::getFormatName(format));
+        REngine::CompressedImage image;
+        REngine::BlockCompressor::compressMipChain(format, rgba.data(), width, height, image, 2);
+        // 30x18, 15x9, 7x4, 3x2, 1x1
+        ASSERT_EQ(image.levels.size(), 5);
+        EXPECT_EQ(image.levels[4].width, 1);
+        EXPECT_EQ(image.levels[0].size, REngine::BlockCompressor::getImageSize(format, width, height));
+        EXPECT_EQ(image.data.size(), image.levels[4].offset + image.levels[4].size);
+
+        std::vector<unsigned char> decoded;
+        ASSERT_TRUE(REngine::BlockCompressor::decompress(format, image.data.data(), width, height, decoded));
+        ASSERT_EQ(decoded.size(), rgba.size());
+        int channels = format == REngine::BlockFormat::BC1 ? 3 : 4;
+        EXPECT_GT(REngine::BlockCompressor::computePSNR(rgba.data(), decoded.data(), rgba.size(), 4, channels), 30.0);
+
+        // Запись и разбор DDS возвращают те же блоки
+        const char* path = "compress_test.dds";
+        ASSERT_TRUE(REngine::BlockCompressor::saveDDS(path, image));
+        std::ifstream file(path, std::ios::binary);
+        std::vector<unsigned char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        file.close();
+        std::remove(path);
+        REngine::CompressedImage parsed;
+        const unsigned char* blocks;
+        ASSERT_TRUE(REngine::BlockCompressor::parseDDS(contents.data(), contents.size(), parsed, blocks));
+        EXPECT_EQ(parsed.format, format);
+        ASSERT_EQ(parsed.levels.size(), image.levels.size());
+        EXPECT_EQ(std::memcmp(blocks, image.data.data(), image.data.size()), 0);
+        EXPECT_FALSE(REngine::BlockCompressor::parseDDS(contents.data(), contents.size() - 1, parsed, blocks));
+    }
+}
+
+TEST(CookedTexture, RoundTrip) {
+    const int width = 13, height = 6;
+    std::vector<unsigned char> rgba(width * height * 4);
+    for (size_t i = 0; i < rgba.size(); i++) {
+        rgba[i] = (unsigned char)(i * 7);
+    }
+
+    const char* path = "cooked_test.rtex";
+    const REngine::TextureFormat formats[] = {REngine::TextureFormat::RGB8, REngine::TextureFormat::BC1};
+    for (REngine::TextureFormat format : formats) {
+        SCOPED_TRACE(REngine::CookedTexture::getFormatName(format));
+        REngine::CookedImage image;
+        REngine::CookedTexture::cook(format, rgba.data(), width, height, image);
+        ASSERT_EQ(image.levels.size(), 4);
+        ASSERT_TRUE(REngine::CookedTexture::save(path, image));
+
+        REngine::MappedFile file(path);
+        ASSERT_TRUE(file.isOpen());
+        REngine::CookedImage parsed;
+        ASSERT_TRUE(REngine::CookedTexture::parse(file.data(), file.size(), parsed));
+        EXPECT_EQ(parsed.format, format);
+        ASSERT_EQ(parsed.levels.size(), image.levels.size());
+        for (size_t i = 0; i < parsed.levels.size(); i++) {
+            // Уровни выровнены и совпадают с записанными
+            EXPECT_EQ(parsed.levels[i].offset % RTEX_ALIGNMENT, 0);
+            EXPECT_EQ(parsed.levels[i].width, image.levels[i].width);
+            ASSERT_EQ(parsed.levels[i].size, image.levels[i].size);
+            EXPECT_EQ(std::memcmp(file.data() + parsed.levels[i].offset, image.data.data() + image.levels[i].offset,
+                                  image.levels[i].size), 0);
+        }
+        EXPECT_FALSE(REngine::CookedTexture::parse(file.data(), file.size() - 1, parsed));
+    }
+    // Без сжатия нулевой уровень содержит исходные пиксели без альфа-канала
+    REngine::CookedImage image;
+    REngine::CookedTexture::cook(REngine::TextureFormat::RGB8, rgba.data(), width, height, image);
+    EXPECT_EQ(image.data[3], rgba[4]);
+    std::remove(path);
+}
+
+TEST(CookedMesh, RoundTrip) {
+    std::vector<float> vertices;
+    std::vector<unsigned> indices;
+    REngine::Mesh::tessellateSphere(24, 24, vertices, indices);
+
+    // Построчный обход сферы промахивается почти на каждой вершине при кэше меньше строки
+    std::vector<unsigned> optimized = indices;
+    REngine::CookedMesh::optimizeVertexCache(optimized, vertices.size() / 8);
+    EXPECT_LT(REngine::CookedMesh::getACMR(optimized, vertices.size() / 8, 16), REngine::CookedMesh::getACMR(indices, vertices.size() / 8, 16) * 0.8);
+
+    std::vector<unsigned char> data;
+    REngine::CookedMesh::cook(vertices, indices, data);
+    EXPECT_EQ(data.size(), sizeof(REngine::RMeshHeader) + sizeof(REngine::RMeshVertex) * vertices.size() / 8 + indices.size() * 2);
+
+    std::vector<float> restoredVertices;
+    std::vector<unsigned> restoredIndices;
+    ASSERT_TRUE(REngine::CookedMesh::parse(data.data(), data.size(), restoredVertices, restoredIndices));
+    ASSERT_EQ(restoredIndices.size(), indices.size());
+    ASSERT_EQ(restoredVertices.size(), vertices.size());
+    // Треугольники те же с точностью квантования, меняется только порядок
+    auto triangleKey = [](const std::vector<float>& v, const std::vector<unsigned>& idx, size_t t) {
+        glm::vec3 sum(0.0f);
+        for (int k = 0; k < 3; k++) {
+            sum += glm::vec3(v[idx[t * 3 + k] * 8], v[idx[t * 3 + k] * 8 + 1], v[idx[t * 3 + k] * 8 + 2]);
+        }
+        return sum;
+    };
+    glm::vec3 original(0.0f), restored(0.0f);
+    for (size_t t = 0; t < indices.size() / 3; t++) {
+        original += triangleKey(vertices, indices, t);
+        restored += triangleKey(restoredVertices, restoredIndices, t);
+    }
+    EXPECT_NEAR(glm::length(original - restored), 0.0f, 1e-2f);
+    for (size_t i = 0; i < restoredVertices.size(); i += 8) {
+        glm::vec3 normal(restoredVertices[i + 3], restoredVertices[i + 4], restoredVertices[i + 5]);
+        EXPECT_NEAR(glm::length(normal), 1.0f, 0.02f);
+        EXPECT_NEAR(glm::length(glm::vec3(restoredVertices[i], restoredVertices[i + 1], restoredVertices[i + 2])), 1.0f / M_PI, 1e-4f);
+    }
+
+    data[0] ^= 0xFF;
+    EXPECT_FALSE(REngine::CookedMesh::parse(data.data(), data.size(), restoredVertices, restoredIndices));
+    EXPECT_FALSE(REngine::CookedMesh::parse(data.data(), 10, restoredVertices, restoredIndices));
+}
+
+TEST(ObjImporter, Parse) {
+    std::ofstream("test_import.mtl") << "newmtl brick\nNs 64\nmap_Kd -s 1 1 1 brick.bmp\nmap_Ks brick_spec.bmp\n"
+                                     << "newmtl plain\nNs 8\n";
+    std::string obj =
+        "# квадрат из двух треугольников и треугольник без нормалей\n"
+        "mtllib test_import.mtl\n"
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+        "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+        "vn 0 0 1\n"
+        "o wall\nusemtl brick\n"
+        "f 1/1/1 2/2/1 3/3/1 4/4/1\r\n"
+        "o floor\nusemtl plain\n"
+        "v 0 0 1\nv 1 0 1\nv 0 0 2\n"
+        "f -3 -1 -2\n";
+    REngine::ObjModel model;
+    ASSERT_TRUE(REngine::ObjImporter::parse(obj.data(), obj.size(), "", model, 1));
+    std::remove("test_import.mtl");
+    ASSERT_EQ(model.materials.size(), 2);
+    EXPECT_EQ(model.materials[0].texturePath, "brick.bmp");
+    EXPECT_EQ(model.materials[0].specularPath, "brick_spec.bmp");
+    EXPECT_FLOAT_EQ(model.materials[0].shininess, 64.0f);
+
+    // Четырёхугольник разбит на два треугольника с четырьмя общими вершинами
+    ASSERT_EQ(model.shapes.size(), 2);
+    EXPECT_EQ(model.shapes[0].name, "wall");
+    EXPECT_EQ(model.shapes[0].material, 0);
+    EXPECT_EQ(model.shapes[0].indices, std::vector<unsigned>({0, 1, 2, 0, 2, 3}));
+    EXPECT_EQ(model.shapes[0].vertices.size(), 4 * 8);
+    EXPECT_FLOAT_EQ(model.shapes[0].vertices[2 * 8 + 6], 1.0f);
+    // Нормаль вычисляется по треугольнику, отрицательные индексы отсчитываются от последней вершины
+    ASSERT_EQ(model.shapes[1].vertices.size(), 3 * 8);
+    EXPECT_EQ(model.shapes[1].material, 1);
+    EXPECT_FLOAT_EQ(model.shapes[1].vertices[8 + 2], 2.0f);
+    EXPECT_FLOAT_EQ(model.shapes[1].vertices[4], 1.0f);
+
+    // Большой файл разбирается по фрагментам с тем же результатом
+    std::string grid;
+    const int size = 300;
+    for (int y = 0; y <= size; y++) {
+        for (int x = 0; x <= size; x++) {
+            grid += "v " + std::to_string(x) + " " + std::to_string(y) + " 0.5\nvt 0.25 0.75\n";
+        }
+    }
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int v = y * (size + 1) + x + 1;
+            grid += "f " + std::to_string(v) + "/1 " + std::to_string(v + 1) + "/1 " + std::to_string(v + size + 2) + "/1 " +
+                    std::to_string(v + size + 1) + "/1\n";
+        }
+    }
+    ASSERT_GT(grid.size(), OBJ_CHUNK_MIN * 4);
+    REngine::ObjModel serial, parallel;
+    ASSERT_TRUE(REngine::ObjImporter::parse(grid.data(), grid.size(), "", serial, 1));
+    ASSERT_TRUE(REngine::ObjImporter::parse(grid.data(), grid.size(), "", parallel, 4));
+    ASSERT_EQ(parallel.shapes.size(), 1);
+    EXPECT_EQ(parallel.shapes[0].vertices.size(), (size + 1) * (size + 1) * 8);
+    EXPECT_EQ(parallel.shapes[0].indices, serial.shapes[0].indices);
+    EXPECT_EQ(parallel.shapes[0].vertices, serial.shapes[0].vertices);
+
+    EXPECT_FALSE(REngine::ObjImporter::parse("f 1 2 3\n", 8, "", model, 1));
+}
+
+TEST(GltfImporter, Parse) {
+    // Треугольник в формате сетки с индексами uint16 и треугольник только с координатами
+    std::vector<float> engine = {0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 1, 1, 0, 0, 1, 0, 0, 0, 1, 0, 1};
+    uint16_t indices[4] = {0, 1, 2, 0};
+    float positions[9] = {0, 0, 0, 0, 0, 1, 1, 0, 0};
+    std::string bin(engine.size() * sizeof(float) + sizeof(indices) + sizeof(positions), '\0');
+    std::memcpy(&bin[0], engine.data(), 96);
+    std::memcpy(&bin[96], indices, sizeof(indices));
+    std::memcpy(&bin[104], positions, sizeof(positions));
+    std::string json = R"({"asset":{"version":"2.0"},"scene":0,"scenes":[{"nodes":[0]}],
+        "nodes":[{"name":"root","translation":[1,2,3],"children":[1]},
+                 {"name":"child","mesh":0,"rotation":[0,0.70710678,0,0.70710678],"scale":[2,2,2]}],
+        "meshes":[{"name":"caf\u00e9","primitives":[
+            {"attributes":{"POSITION":0,"NORMAL":1,"TEXCOORD_0":2},"indices":3,"material":0},
+            {"attributes":{"POSITION":4}},{"attributes":{"POSITION":4},"mode":1}]}],
+        "materials":[{"pbrMetallicRoughness":{"baseColorTexture":{"index":0},"roughnessFactor":0.5},
+                      "extensions":{"KHR_materials_specular":{"specularColorTexture":{"index":1}}}}],
+        "textures":[{"source":0},{"source":1}],"images":[{"uri":"brick%20wall.bmp"},{"uri":"spec.bmp"}],
+        "buffers":[{"byteLength":140}],
+        "bufferViews":[{"buffer":0,"byteLength":96,"byteStride":32},{"buffer":0,"byteOffset":96,"byteLength":6},
+                       {"buffer":0,"byteOffset":104,"byteLength":36}],
+        "accessors":[{"bufferView":0,"componentType":5126,"count":3,"type":"VEC3"},
+                     {"bufferView":0,"byteOffset":12,"componentType":5126,"count":3,"type":"VEC3"},
+                     {"bufferView":0,"byteOffset":24,"componentType":5126,"count":3,"type":"VEC2"},
+                     {"bufferView":1,"componentType":5123,"count":3,"type":"SCALAR"},
+                     {"bufferView":2,"componentType":5126,"count":3,"type":"VEC3"}]})";
+    json.append((4 - json.size() % 4) % 4, ' ');
+    std::vector<unsigned char> glb(12 + 8 + json.size() + 8 + bin.size());
+    uint32_t header[5] = {GLB_MAGIC, GLB_VERSION, (uint32_t)glb.size(), (uint32_t)json.size(), GLB_CHUNK_JSON};
+    uint32_t binHeader[2] = {(uint32_t)bin.size(), GLB_CHUNK_BIN};
+    std::memcpy(glb.data(), header, sizeof(header));
+    std::memcpy(glb.data() + 20, json.data(), json.size());
+    std::memcpy(glb.data() + 20 + json.size(), binHeader, sizeof(binHeader));
+    std::memcpy(glb.data() + 28 + json.size(), bin.data(), bin.size());
+
+    REngine::GltfModel model;
+    ASSERT_TRUE(REngine::GltfImporter::parse(glb.data(), glb.size(), "models/", model));
+    ASSERT_EQ(model.meshes.size(), 1);
+    EXPECT_EQ(model.meshes[0].name, "caf\xC3\xA9");
+    ASSERT_EQ(model.meshes[0].primitives.size(), 2);
+
+    // Совпадающая раскладка читается прямо из файла, V переворачивается при загрузке
+    const REngine::GltfPrimitive& direct = model.meshes[0].primitives[0];
+    const unsigned char* binData = glb.data() + 28 + json.size();
+    EXPECT_EQ((const void*)direct.vertexData, (const void*)binData);
+    EXPECT_EQ(direct.indexData, (const void*)(binData + 96));
+    EXPECT_TRUE(direct.vertices.empty());
+    EXPECT_TRUE(direct.flipTexCoords);
+    EXPECT_EQ(direct.indexSize, 2);
+    EXPECT_EQ(direct.indexCount, 3);
+    EXPECT_EQ(direct.material, 0);
+
+    // Без нормалей и индексов вершины преобразуются, нормаль вычисляется по треугольнику
+    const REngine::GltfPrimitive& converted = model.meshes[0].primitives[1];
+    EXPECT_EQ(converted.vertexData, nullptr);
+    ASSERT_EQ(converted.vertices.size(), 3 * 8);
+    EXPECT_FLOAT_EQ(converted.vertices[8 + 2], 1.0f);
+    EXPECT_FLOAT_EQ(converted.vertices[4], 1.0f);
+    EXPECT_EQ(converted.indices, std::vector<unsigned>({0, 1, 2}));
+
+    ASSERT_EQ(model.materials.size(), 1);
+    EXPECT_EQ(model.materials[0].texturePath, "models/brick wall.bmp");
+    EXPECT_EQ(model.materials[0].specularPath, "models/spec.bmp");
+    EXPECT_FLOAT_EQ(model.materials[0].shininess, 30.0f);
+
+    // Дочерний узел наследует сдвиг родителя, поворот и масштаб восстанавливаются из мировой матрицы
+    ASSERT_EQ(model.roots, std::vector<int>({0}));
+    REngine::SceneNode node;
+    REngine::GltfImporter::decompose(model.nodes[1].world, node);
+    EXPECT_NEAR(glm::length(node.position - glm::vec3(1.0f, 2.0f, 3.0f)), 0.0f, 1e-5f);
+    EXPECT_NEAR(glm::length(node.rotation - glm::vec3(0.0f, 90.0f, 0.0f)), 0.0f, 1e-2f);
+    EXPECT_NEAR(glm::length(node.scale - glm::vec3(2.0f)), 0.0f, 1e-5f);
+
+    // Разложение обратно сборке матрицы в Renderer
+    glm::mat4 matrix = glm::translate(glm::mat4(1.0f), glm::vec3(-4.0f, 0.5f, 7.0f));
+    matrix = glm::rotate(matrix, glm::radians(30.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    matrix = glm::rotate(matrix, glm::radians(-20.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    matrix = glm::rotate(matrix, glm::radians(75.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    matrix = glm::scale(matrix, glm::vec3(-1.0f, 3.0f, 0.5f));
+    REngine::GltfImporter::decompose(matrix, node);
+    glm::mat4 rebuilt = glm::translate(glm::mat4(1.0f), node.position);
+    rebuilt = glm::rotate(rebuilt, glm::radians(node.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+    rebuilt = glm::rotate(rebuilt, glm::radians(node.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+    rebuilt = glm::rotate(rebuilt, glm::radians(node.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+    rebuilt = glm::scale(rebuilt, node.scale);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_NEAR(glm::length(glm::vec3(rebuilt[i]) - glm::vec3(matrix[i])), 0.0f, 1e-4f);
+    }
+
+    // Индекс за пределами вершин и обрезанный файл отклоняются
+    REngine::GltfModel invalid;
+    std::vector<unsigned char> broken = glb;
+    broken[28 + json.size() + 96] = 7;
+    EXPECT_FALSE(REngine::GltfImporter::parse(broken.data(), broken.size(), "", invalid));
+    REngine::GltfModel truncated;
+    EXPECT_FALSE(REngine::GltfImporter::parse(glb.data(), glb.size() - 40, "", truncated));
+}
+
+TEST(Log, AsyncWriter) {
+    const char* path = "log_test.txt";
+    ASSERT_TRUE(REngine::Log::setOutputFile(path));
+    unsigned long dropped = REngine::Log::getDropped();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < 250; i++) {
+                WARN("thread " << t << " message " << i << " value " << i * 0.5f);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ERROR(std::string(LOG_RECORD_SIZE * 2, 'x'));
+    REngine::Log::flush();
+    EXPECT_TRUE(REngine::Log::setOutputFile(""));
+
+    std::ifstream file(path);
+    std::string line;
+    size_t lines = 0;
+    bool longFound = false;
+    while (std::getline(file, line)) {
+        lines++;
+        longFound |= line == "[ERROR] " + std::string(LOG_RECORD_SIZE * 2, 'x');
+    }
+    EXPECT_EQ(lines + REngine::Log::getDropped() - dropped, 1001);
+    EXPECT_TRUE(longFound);
+    std::remove(path);
+}
+
+TEST(InputHandler, RecordReplay) {
+    ASSERT_EQ(SDL_Init(SDL_INIT_EVENTS), 0);
+    const char* path = "input_test.rinp";
+
+    SDL_Event keyDown = {};
+    keyDown.type = SDL_KEYDOWN;
+    keyDown.key.keysym.sym = SDLK_w;
+    SDL_Event keyUp = keyDown;
+    keyUp.type = SDL_KEYUP;
+    SDL_Event motion = {};
+    motion.type = SDL_MOUSEMOTION;
+    motion.motion.xrel = 7;
+    motion.motion.yrel = -3;
+
+    ASSERT_TRUE(REngine::InputHandler::startRecording(path));
+    double deltas[3] = {0.016, 0.021, 0.0333};
+    for (double& delta : deltas) {
+        EXPECT_TRUE(REngine::InputHandler::beginFrame(delta));
+    }
+    REngine::InputHandler::handleEvent(keyDown);
+    REngine::InputHandler::handleEvent(motion);
+    REngine::InputHandler::handleEvent(keyUp);
+    REngine::InputHandler::stopRecording();
+
+    int keyPresses = 0;
+    int motionX = 0;
+    REngine::InputHandler::setKeyDownCallback(SDLK_w, [&]() { keyPresses++; });
+    REngine::InputHandler::setMouseMotionCallback([&](int x, int y, int xrel, int yrel) { motionX += xrel; });
+
+    ASSERT_TRUE(REngine::InputHandler::startReplay(path));
+    double delta = 1.0;
+    ASSERT_TRUE(REngine::InputHandler::beginFrame(delta));
+    EXPECT_EQ(delta, (double)(float)deltas[0]);
+    REngine::InputHandler::pollEvents();
+    EXPECT_EQ(keyPresses, 0);
+
+    ASSERT_TRUE(REngine::InputHandler::beginFrame(delta));
+    ASSERT_TRUE(REngine::InputHandler::beginFrame(delta));
+    EXPECT_EQ(delta, deltas[2]);
+    REngine::InputHandler::pollEvents();
+    EXPECT_EQ(keyPresses, 1);
+    EXPECT_EQ(motionX, 7);
+    EXPECT_FALSE(REngine::InputHandler::isKeyDown(SDLK_w));
+
+    EXPECT_FALSE(REngine::InputHandler::beginFrame(delta));
+    EXPECT_FALSE(REngine::InputHandler::isReplaying());
+
+    REngine::InputHandler::setKeyDownCallback(SDLK_w, nullptr);
+    REngine::InputHandler::setMouseMotionCallback(nullptr);
+    std::remove(path);
+    SDL_Quit();
+}
+
+TEST(Engine, HeadlessFrames) {
+    ASSERT_EQ(REngine::createHeadless(320, 240), 0) << "Headless context could not be created!";
+    EXPECT_TRUE(REngine::isHeadless());
+
     REngine::Scene scene;
-    
+    REngine::Mesh* cube = new REngine::Mesh(REngine::Mesh::createCube());
+    cube->computeAABB();
+    for (int i = 0; i < 3; i++) {
+        REngine::SceneNode node;
+        node.mesh = cube;
+        node.position = glm::vec3(i - 1.0f, 0, 0);
+        scene.nodes.push_back(node);
+    }
+    REngine::SceneNode hidden;
+    hidden.mesh = cube;
+    hidden.position = glm::vec3(0, 0, 50);
+    scene.nodes.push_back(hidden);
+
+    scene.camera.position = glm::vec3(0, 0, 5);
+    scene.camera.setRotation(0.0f, -90.0f, 0.0f);
+    REngine::setScene(&scene);
+    REngine::setShader(NULL, NULL);
+
+    REngine::FrameSummary summary = REngine::runFrames(20);
+    EXPECT_EQ(summary.frames, 20);
+    EXPECT_GT(summary.max, 0.0);
+    // Время кадра относится к тому же кадру, что и его время на CPU
+    const REngine::FrameStats* stats = REngine::getFrameStats();
+    for (size_t i = stats->size() - 20; i < stats->size(); i++) {
+        EXPECT_GE(stats->get(i).frameTime, stats->get(i).cpuTime) << "Frame " << stats->get(i).frame;
+    }
+
+    const REngine::FrameRecord& last = REngine::getFrameStats()->last();
+    // Видимые кубы с одной сеткой и цветом рисуются одним вызовом
+    EXPECT_EQ(last.drawCalls, 1);
+    EXPECT_EQ(last.culledNodes, 1);
+    EXPECT_EQ(last.triangles, 36);
+
+    delete cube;
+    REngine::destroyWindow();
+}
+
+TEST(FrameSync, SlotsAndFences) {
+    ASSERT_EQ(REngine::createHeadless(64, 64), 0) << "Headless context could not be created!";
+
+    {
+        REngine::FrameSync sync(3);
+        EXPECT_EQ(sync.getFramesInFlight(), 3);
+
+        // Слоты идут по кругу, начало кадра дожидается барьера кадра, ранее занимавшего слот
+        for (unsigned long frame = 0; frame < 12; frame++) {
+            sync.beginFrame();
+            EXPECT_EQ(sync.getFrameNumber(), frame);
+            EXPECT_EQ(sync.getFrameSlot(), (int)(frame % 3));
+            if (frame >= 3) {
+                EXPECT_EQ(sync.getResolvedFrameNumber(), frame - 3);
+                EXPECT_GE(sync.getGpuFrameTime(), 0.0);
+            }
+            glClear(GL_COLOR_BUFFER_BIT);
+            sync.endFrame();
+        }
+        sync.waitIdle();
+        EXPECT_EQ(sync.getResolvedFrameNumber(), 11u);
+
+        // Количество ограничивается, после смены слоты свободны
+        sync.setFramesInFlight(FRAMES_IN_FLIGHT_MAX + 1);
+        EXPECT_EQ(sync.getFramesInFlight(), FRAMES_IN_FLIGHT_MAX);
+        sync.setFramesInFlight(0);
+        EXPECT_EQ(sync.getFramesInFlight(), 1);
+        sync.beginFrame();
+        EXPECT_EQ(sync.getFrameSlot(), 0);
+        EXPECT_EQ(sync.getResolvedFrameNumber(), 11u);
+        sync.endFrame();
+        sync.beginFrame();
+        EXPECT_EQ(sync.getResolvedFrameNumber(), 12u);
+        sync.endFrame();
+    }
+
+    REngine::destroyWindow();
+}
+
+TEST(GpuProfiler, Latency) {
+    ASSERT_EQ(REngine::createHeadless(64, 64), 0) << "Headless context could not be created!";
+
+    {
+        REngine::GpuProfiler profiler;
+        auto renderFrame = [&](unsigned long frame) {
+            {
+                REngine::GpuScope scope(&profiler, "clear");
+                glClear(GL_COLOR_BUFFER_BIT);
+            }
+            profiler.endFrame();
+        };
+
+        // Без ожидания GPU результаты приходят позже кадра, по порядку и без потерь
+        unsigned long frame = 0, expected = 0;
+        for (; frame < GPU_PROFILER_LATENCY * 3; frame++) {
+            profiler.beginFrame(frame);
+            while (profiler.consumeResults()) {
+                EXPECT_LT(profiler.getResolvedFrame(), frame);
+                EXPECT_EQ(profiler.getResolvedFrame(), expected + profiler.getDroppedFrames());
+                expected++;
+            }
+            renderFrame(frame);
+        }
+        glFinish();
+
+        // Завершённый кадр читается в начале следующего, кольцо запросов проходит несколько кругов
+        unsigned long dropped = profiler.getDroppedFrames();
+        for (unsigned long end = frame + GPU_PROFILER_LATENCY * 3; frame < end; frame++) {
+            profiler.beginFrame(frame);
+            while (profiler.consumeResults() && profiler.getResolvedFrame() + 1 < frame) {
+            }
+            EXPECT_EQ(profiler.getResolvedFrame(), frame - 1);
+            ASSERT_EQ(profiler.getResults().size(), 1);
+            EXPECT_STREQ(profiler.getResults()[0].name, "clear");
+            EXPECT_GE(profiler.getScopeTime("clear"), 0.0);
+            renderFrame(frame);
+            glFinish();
+        }
+        EXPECT_EQ(profiler.getDroppedFrames(), dropped);
+
+        // Кадры, готовые за один вызов, ставятся в очередь, сверх GPU_PROFILER_LATENCY вытесняются старые
+        profiler.beginFrame(frame);
+        while (profiler.consumeResults()) {
+        }
+        renderFrame(frame++);
+        glFinish();
+        unsigned long first = frame;
+        for (int i = 0; i < GPU_PROFILER_LATENCY + 2; i++) {
+            profiler.beginFrame(frame);
+            renderFrame(frame++);
+            glFinish();
+        }
+        profiler.beginFrame(frame);
+        EXPECT_EQ(profiler.getDroppedFrames(), dropped + 3);
+        for (unsigned long resolved = first + 2; resolved < frame; resolved++) {
+            ASSERT_TRUE(profiler.consumeResults());
+            EXPECT_EQ(profiler.getResolvedFrame(), resolved);
+        }
+        EXPECT_FALSE(profiler.consumeResults());
+        profiler.endFrame();
+    }
+
+    REngine::destroyWindow();
+}
+
+TEST(Engine, ZeroAllocSteadyState) {
+    if (!REngine::AllocTracker::isEnabled()) {
+        GTEST_SKIP() << "Built without RENGINE_ALLOC_TRACKING";
+    }
+    ASSERT_EQ(REngine::createHeadless(320, 240), 0) << "Headless context could not be created!";
+
+    REngine::Scene scene;
+    REngine::Mesh* cube = new REngine::Mesh(REngine::Mesh::createCube());
+    cube->computeAABB();
+    for (int i = 0; i < 16; i++) {
+        REngine::SceneNode node;
+        node.mesh = cube;
+        node.position = glm::vec3(i % 4 - 1.5f, i / 4 - 1.5f, 0);
+        node.scale = glm::vec3(0.5f);
+        scene.nodes.push_back(node);
+    }
+    for (int i = 0; i < 4; i++) {
+        REngine::PointLight light = {glm::vec3(i, 1, 2), 1.0f, 0.09f, 0.032f, glm::vec3(0.05f), glm::vec3(0.8f), glm::vec3(1.0f)};
+        scene.pointLights.push_back(light);
+    }
+    scene.camera.position = glm::vec3(0, 0, 6);
+    scene.camera.setRotation(0.0f, -90.0f, 0.0f);
+    REngine::setScene(&scene);
+    REngine::setShader(NULL, NULL);
+
+    // Первые кадры загружают текстуры и заполняют кэши
+    REngine::runFrames(10);
+    REngine::runFrames(60);
+
+    const REngine::FrameStats* stats = REngine::getFrameStats();
+    for (size_t i = stats->size() - 60; i < stats->size(); i++) {
+        EXPECT_EQ(stats->get(i).allocations, 0) << "Frame " << stats->get(i).frame << " allocated "
+                                                << stats->get(i).allocatedBytes << " bytes";
+    }
+
+    delete cube;
+    REngine::destroyWindow();
+}
+
+TEST(TextureStreamer, AsyncLoad) {
+    ASSERT_EQ(REngine::createHeadless(64, 64), 0) << "Headless context could not be created!";
+    ASSERT_TRUE(REngine::TextureStreamer::isRunning());
+    const char* path = "stream_test.bmp";
+    writeTestBMP(path, 37, 20, false);
+
+    REngine::Texture* texture = REngine::TextureStreamer::request(path, glm::vec3(1.0f));
+    REngine::Texture* missing = REngine::TextureStreamer::request("stream_missing.bmp", glm::vec3(0.5f));
+    // До загрузки текстура считается валидной и привязывается заглушка
+    EXPECT_TRUE(texture->isValid());
+    EXPECT_EQ(REngine::TextureStreamer::request(path, glm::vec3(1.0f)), texture);
+    EXPECT_EQ(REngine::TextureCache::find(path), texture);
+
+    // Объём за кадр меньше нулевого уровня, поэтому уровень передаётся полосами в нескольких кадрах,
+    // и до окончания передачи привязывается заглушка
+    const size_t budget = 37 * 3 * 4;
+    REngine::TextureStreamer::setUploadBudget(budget);
+    // Уровни пишутся в буфер пикселей слота кадра
+    REngine::FrameSync* frameSync = REngine::getFrameSync();
+    int uploadFrames = 0;
+    while (REngine::TextureStreamer::getPendingCount() > 0) {
+        frameSync->beginFrame();
+        REngine::TextureStreamer::update(frameSync->getFrameSlot());
+        frameSync->endFrame();
+        size_t bytes = REngine::TextureStreamer::getFrameUploadBytes();
+        EXPECT_LE(bytes, budget);
+        uploadFrames += bytes > 0;
+        if (texture->isPending()) {
+            EXPECT_FALSE(texture->isResident());
+            GLint bound = 0;
+            texture->bind();
+            glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+            EXPECT_EQ((GLuint)bound, REngine::Texture::placeholderID);
+        }
+    }
+    EXPECT_GE(uploadFrames, 37 * 20 * 3 / (int)budget);
+    REngine::TextureStreamer::setUploadBudget(TEXTURE_STREAMER_UPLOAD_BUDGET);
+    REngine::TextureStreamer::finish();
+
+    EXPECT_TRUE(texture->isResident());
+    EXPECT_EQ(texture->getWidth(), 37);
+    EXPECT_EQ(texture->getHeight(), 20);
+    EXPECT_TRUE(missing->isResident());
+    EXPECT_EQ(missing->getWidth(), 1);
+
+    // Подготовленный файл загружается вместо BMP с тем же именем
+    const char* cookedPath = "stream_cooked.bmp";
+    writeTestBMP(cookedPath, 8, 8, false);
+    std::vector<unsigned char> rgba(16 * 4 * 4, 255);
+    REngine::CookedImage image;
+    REngine::CookedTexture::cook(REngine::TextureFormat::RGBA8, rgba.data(), 16, 4, image);
+    ASSERT_TRUE(REngine::CookedTexture::save("stream_cooked.rtex", image));
+    REngine::Texture* cooked = REngine::TextureStreamer::request(cookedPath, glm::vec3(1.0f));
+    REngine::TextureStreamer::finish();
+    EXPECT_TRUE(cooked->isResident());
+    EXPECT_EQ(cooked->getWidth(), 16);
+    EXPECT_EQ(cooked->getHeight(), 4);
+    std::remove(cookedPath);
+    std::remove("stream_cooked.rtex");
+
+    REngine::destroyWindow();
+    EXPECT_EQ(REngine::TextureCache::size(), 0);
+    std::remove(path);
+}
+
+TEST(VirtualFS, PackedArchive) {
+    // Повторяющиеся данные сжимаются, повреждённые не распаковываются
+    std::vector<unsigned char> text(4000);
+    for (size_t i = 0; i < text.size(); i++) {
+        text[i] = "vec3 albedo;\n"[i % 13];
+    }
+    std::vector<unsigned char> compressed, restored(text.size());
+    REngine::Lz4::compress(text.data(), text.size(), compressed);
+    EXPECT_LT(compressed.size(), text.size() / 10);
+    ASSERT_TRUE(REngine::Lz4::decompress(compressed.data(), compressed.size(), restored.data(), restored.size()));
+    EXPECT_EQ(restored, text);
+    EXPECT_FALSE(REngine::Lz4::decompress(compressed.data(), compressed.size() - 1, restored.data(), restored.size()));
+
+    writeTestBMP("pack_source.bmp", 8, 4, false);
+    std::ifstream source("pack_source.bmp", std::ios::binary);
+    std::vector<REngine::PackFile> files(3);
+    files[0].name = "packed/texture.bmp";
+    files[0].data.assign(std::istreambuf_iterator<char>(source), std::istreambuf_iterator<char>());
+    source.close();
+    std::remove("pack_source.bmp");
+    files[1].name = "packed\\shader.glsl";
+    files[1].data = text;
+    files[1].compress = true;
+    files[2].name = "textures/prefixed.bmp";
+    files[2].data = files[0].data;
+    ASSERT_TRUE(REngine::PackArchive::save("test.rpak", files));
+
+    // Компоненты "." и ".." убираются, ".." выше корня отбрасывается
+    EXPECT_EQ(REngine::PackArchive::normalizeName("./a\\./b/../c.bmp"), "a/c.bmp");
+    EXPECT_EQ(REngine::PackArchive::normalizeName("../textures/a.bmp"), "textures/a.bmp");
+
+    REngine::PackArchive archive;
+    ASSERT_TRUE(archive.open("test.rpak"));
+    EXPECT_EQ(archive.getEntryCount(), 3);
+    const REngine::RPakEntry* entry = archive.find("packed/shader.glsl");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->flags, RPAK_FLAG_LZ4);
+    EXPECT_EQ(archive.find("packed/missing.bmp"), nullptr);
+    archive.close();
+
+    // Файлы из архива читаются без обращения к диску
+    ASSERT_TRUE(REngine::VirtualFS::mount("test.rpak"));
+    REngine::AssetFile shader("./packed/shader.glsl");
+    ASSERT_TRUE(shader.isOpen());
+    EXPECT_TRUE(shader.isPacked());
+    EXPECT_EQ(std::vector<unsigned char>(shader.data(), shader.data() + shader.size()), text);
+    std::vector<unsigned char> pixels;
+    int width, height, channels;
+    ASSERT_TRUE(REngine::Texture::decodeBMP("packed/texture.bmp", pixels, width, height, channels));
+    EXPECT_EQ(width, 8);
+    EXPECT_EQ(height, 4);
+
+    // Каталоги поиска применяются и к архиву
+    REngine::AssetFile prefixed("prefixed.bmp");
+    ASSERT_TRUE(prefixed.isOpen());
+    EXPECT_TRUE(prefixed.isPacked());
+    EXPECT_EQ(prefixed.size(), files[2].data.size());
+    EXPECT_TRUE(REngine::AssetFile("../textures/prefixed.bmp").isPacked());
+    EXPECT_TRUE(REngine::VirtualFS::exists("prefixed.bmp"));
+
+    // Остальные файлы ищутся на диске
+    writeTestBMP("loose.bmp", 4, 4, false);
+    REngine::AssetFile loose("loose.bmp");
+    EXPECT_TRUE(loose.isOpen());
+    EXPECT_FALSE(loose.isPacked());
+    EXPECT_FALSE(REngine::VirtualFS::isPacked("loose.bmp"));
+    EXPECT_TRUE(REngine::VirtualFS::isPacked("prefixed.bmp"));
+    loose.close();
+    std::remove("loose.bmp");
+
+    REngine::VirtualFS::clear();
+    EXPECT_FALSE(REngine::VirtualFS::exists("packed/texture.bmp"));
+    std::remove("test.rpak");
+}
+
+static void writeTextFile(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream file(path, std::ios::binary);
+    file << text;
+}
+
+TEST(AssetCooker, ShaderIncludes) {
+    std::filesystem::create_directories("cook_shaders");
+    writeTextFile("cook_shaders/common.glsl", "uniform vec3 shared; /* общий */\n");
+    // Директивы в комментариях не раскрываются, повторное включение пропускается
+    writeTextFile("cook_shaders/main.frag",
+                  "#version 330 core\r\n"
+                  "// #include \"missing.glsl\"\n"
+                  "/* отключено:\n"
+                  "#include \"missing.glsl\"\n"
+                  "*/\n"
+                  "#include \"common.glsl\"\n"
+                  "  #include \"common.glsl\"\n"
+                  "#define SCALE 2.0 // масштаб\n"
+                  "\n"
+                  "void main() {} \t\n");
+    std::string text;
+    ASSERT_TRUE(REngine::AssetCooker::expandIncludes("cook_shaders/main.frag", text));
+    EXPECT_EQ(text.find("uniform vec3 shared;"), text.rfind("uniform vec3 shared;"));
+    EXPECT_NE(text.find("uniform vec3 shared;"), std::string::npos);
+
+    // Комментарии, пробелы в конце строк и пустые строки удаляются
+    EXPECT_EQ(REngine::AssetCooker::stripShader(text), "#version 330 core\n"
+                                                       "uniform vec3 shared;\n"
+                                                       "#define SCALE 2.0\n"
+                                                       "void main() {}\n");
+
+    writeTextFile("cook_shaders/broken.frag", "#include \"missing.glsl\"\n");
+    EXPECT_FALSE(REngine::AssetCooker::expandIncludes("cook_shaders/broken.frag", text));
+    std::filesystem::remove_all("cook_shaders");
+}
+
+TEST(AssetCooker, IncrementalCook) {
+    std::filesystem::create_directories("cook_source");
+    writeTestBMP("cook_source/brick.bmp", 8, 8, false);
+    writeTextFile("cook_source/common.glsl", "uniform float scale;\n");
+    writeTextFile("cook_source/main.frag", "#include \"common.glsl\"\nvoid main() {}\n");
+    writeTextFile("cook_source/notes.txt", "notes");
+    REngine::CookOptions options;
+    options.format = REngine::TextureFormat::RGBA8;
+    options.formatSet = true;
+    options.threads = 2;
+    options.slices = {8};
+
+    std::vector<REngine::CookedAsset> assets;
+    ASSERT_TRUE(REngine::AssetCooker::cook("cook_source", "cooked.rpak", options, assets));
+    ASSERT_EQ(assets.size(), 5);
+    for (const REngine::CookedAsset& asset : assets) {
+        EXPECT_FALSE(asset.cached) << asset.name;
+    }
+    EXPECT_EQ(assets[0].name, "brick.rtex");
+
+    // Повторная подготовка берёт все ресурсы из прошлого архива
+    ASSERT_TRUE(REngine::AssetCooker::cook("cook_source", "cooked.rpak", options, assets));
+    for (const REngine::CookedAsset& asset : assets) {
+        EXPECT_TRUE(asset.cached) << asset.name;
+    }
+
+    // Изменение включённого файла подготавливает заново и включающий шейдер
+    writeTextFile("cook_source/common.glsl", "uniform float bias;\n");
+    ASSERT_TRUE(REngine::AssetCooker::cook("cook_source", "cooked.rpak", options, assets));
+    for (const REngine::CookedAsset& asset : assets) {
+        bool changed = asset.name == "common.glsl" || asset.name == "main.frag";
+        EXPECT_EQ(asset.cached, !changed) << asset.name;
+    }
+    REngine::PackArchive archive;
+    ASSERT_TRUE(archive.open("cooked.rpak"));
+    const REngine::RPakEntry* entry = archive.find("main.frag");
+    ASSERT_NE(entry, nullptr);
+    std::vector<unsigned char> buffer;
+    const unsigned char* data = archive.read(*entry, buffer);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(data), (size_t)entry->size), "uniform float bias;\nvoid main() {}\n");
+    archive.close();
+
+    // Другой формат текстур меняет ключи всех ресурсов
+    options.format = REngine::TextureFormat::RGB8;
+    ASSERT_TRUE(REngine::AssetCooker::cook("cook_source", "cooked.rpak", options, assets));
+    for (const REngine::CookedAsset& asset : assets) {
+        EXPECT_FALSE(asset.cached) << asset.name;
+    }
+
+    std::filesystem::remove_all("cook_source");
+    std::remove("cooked.rpak");
+}
+
+TEST(TextureResidency, EvictAndReload) {
+    ASSERT_EQ(REngine::createHeadless(64, 64), 0) << "Headless context could not be created!";
+    const char* paths[] = {"resident_a.bmp", "resident_b.bmp"};
+    REngine::Texture* textures[2];
+    for (int i = 0; i < 2; i++) {
+        writeTestBMP(paths[i], 128, 128, false, 200 + i);
+        textures[i] = REngine::TextureStreamer::request(paths[i], glm::vec3(1.0f));
+    }
+    REngine::TextureStreamer::finish();
+    EXPECT_EQ(REngine::TextureResidency::getTrackedCount(), 2);
+    size_t full = REngine::TextureResidency::getResidentBytes();
+    EXPECT_EQ(full, textures[0]->getMemorySize() * 2);
+
+    // Неиспользованная текстура заменяется мелкими уровнями
+    REngine::TextureResidency::update();
+    REngine::TextureResidency::setBudget(full - 1);
+    REngine::TextureResidency::touch(textures[0]);
+    REngine::TextureResidency::update();
+    EXPECT_EQ(REngine::TextureResidency::getFrameEvictions(), 1);
+    REngine::TextureStreamer::finish();
+    EXPECT_EQ(textures[0]->getWidth(), 128);
+    EXPECT_EQ(textures[1]->getWidth(), TEXTURE_RESIDENCY_LOW_MIP);
+    EXPECT_TRUE(textures[1]->isResident());
+    EXPECT_LT(REngine::TextureResidency::getResidentBytes(), full);
+
+    // При использовании все уровни загружаются снова
+    REngine::TextureResidency::touch(textures[1]);
+    REngine::TextureResidency::update();
+    EXPECT_EQ(REngine::TextureResidency::getFrameReloads(), 1);
+    EXPECT_EQ(REngine::TextureResidency::getFrameEvictions(), 0);
+    REngine::TextureStreamer::finish();
+    EXPECT_EQ(textures[1]->getWidth(), 128);
+    EXPECT_EQ(REngine::TextureResidency::getEvictionCount(), 1);
+    EXPECT_EQ(REngine::TextureResidency::getReloadCount(), 1);
+
+    REngine::TextureResidency::setBudget(TEXTURE_RESIDENCY_BUDGET);
+    REngine::destroyWindow();
+    EXPECT_EQ(REngine::TextureResidency::getTrackedCount(), 0);
+    for (const char* path : paths) {
+        std::remove(path);
+    }
+}
+
+TEST(TextureResidency, EvictPooledTextures) {
+    ASSERT_EQ(REngine::createHeadless(64, 64), 0) << "Headless context could not be created!";
+    REngine::TexturePool::setEnabled(true);
+    // Первая текстура занимает отдельный массив, две другие делят массив 128x64
+    const char* paths[] = {"pooled_a.bmp", "pooled_b.bmp", "pooled_c.bmp"};
+    REngine::Texture* textures[3];
+    for (int i = 0; i < 3; i++) {
+        writeTestBMP(paths[i], 128, i == 0 ? 128 : 64, false, 200 + i);
+        textures[i] = REngine::TextureStreamer::request(paths[i], glm::vec3(1.0f));
+    }
+    REngine::TextureStreamer::finish();
+    REngine::TextureArray* shared = textures[1]->getArray();
+    ASSERT_NE(shared, nullptr);
+    ASSERT_EQ(textures[2]->getArray(), shared);
+    ASSERT_NE(textures[0]->getArray(), shared);
+    // Учитываются массивы целиком вместе со свободными слоями
+    size_t full = REngine::TextureResidency::getResidentBytes();
+    size_t sharedBytes = shared->getMemorySize();
+    EXPECT_EQ(full, textures[0]->getArray()->getMemorySize() + sharedBytes);
+    EXPECT_GT(full, textures[0]->getMemorySize() + textures[1]->getMemorySize() + textures[2]->getMemorySize());
+
+    // Вытеснение одного слоя не освобождает массив, пока другой слой используется
+    REngine::TextureResidency::update();
+    REngine::TextureResidency::setBudget(full - 1);
+    REngine::TextureResidency::touch(textures[0]);
+    REngine::TextureResidency::touch(textures[1]);
+    REngine::TextureResidency::update();
+    EXPECT_EQ(REngine::TextureResidency::getFrameEvictions(), 0);
+
+    // Без использования массив вытесняется целиком и удаляется
+    REngine::TextureResidency::touch(textures[0]);
+    REngine::TextureResidency::update();
+    EXPECT_EQ(REngine::TextureResidency::getFrameEvictions(), 2);
+    REngine::TextureStreamer::finish();
+    EXPECT_EQ(textures[1]->getWidth(), TEXTURE_RESIDENCY_LOW_MIP);
+    EXPECT_EQ(REngine::TexturePool::getArrayCount(), 2);
+    EXPECT_EQ(REngine::TextureResidency::getResidentBytes(), full - sharedBytes + textures[1]->getArray()->getMemorySize());
+    EXPECT_LT(REngine::TextureResidency::getResidentBytes(), full);
+
+    REngine::TextureResidency::setBudget(TEXTURE_RESIDENCY_BUDGET);
+    REngine::TexturePool::setEnabled(false);
+    REngine::destroyWindow();
+    for (const char* path : paths) {
+        std::remove(path);
+    }
+}
+
+TEST(TextureStreamer, MipStreaming) {
+    ASSERT_EQ(REngine::createHeadless(64, 64), 0) << "Headless context could not be created!";
+    {
+        // Грань куба 1x1 занимает четверть текстуры по каждой оси
+        REngine::Mesh cube = REngine::Mesh::createCube();
+        EXPECT_NEAR(cube.getUVDensity(), 0.25f, 1e-4f);
+    }
+
+    // Объекту на экране хватает уровня 8x8
+    const char* path = "mip_test.bmp";
+    writeTestBMP(path, 64, 64, false);
+    REngine::Texture* texture = REngine::TextureStreamer::request(path, glm::vec3(1.0f));
+    REngine::TextureResidency::touch(texture, 8.0f);
+    REngine::TextureResidency::update();
+    REngine::TextureStreamer::finish();
+    EXPECT_TRUE(texture->isResident());
+    EXPECT_EQ(texture->getWidth(), 64);
+    EXPECT_EQ(texture->getBaseLevel(), 3);
+    EXPECT_EQ(texture->getMemorySize(), (size_t)(8 * 8 + 4 * 4 + 2 * 2 + 1) * 3);
+
+    // При приближении догружаются недостающие уровни
+    REngine::TextureResidency::touch(texture, 20.0f);
+    REngine::TextureResidency::update();
+    EXPECT_EQ(REngine::TextureResidency::getFrameRefines(), 1);
+    // Уровни 2 и 1 не помещаются в объём кадра и передаются по частям, текстура читает только готовые уровни
+    const size_t budget = 1024;
+    REngine::TextureStreamer::setUploadBudget(budget);
+    int uploadFrames = 0;
+    while (REngine::TextureStreamer::getPendingCount() > 0) {
+        REngine::TextureStreamer::update();
+        EXPECT_LE(REngine::TextureStreamer::getFrameUploadBytes(), budget);
+        uploadFrames += REngine::TextureStreamer::getFrameUploadBytes() > 0;
+    }
+    EXPECT_GE(uploadFrames, (int)((32 * 32 + 16 * 16) * 3 / budget));
+    REngine::TextureStreamer::setUploadBudget(TEXTURE_STREAMER_UPLOAD_BUDGET);
+    EXPECT_EQ(texture->getBaseLevel(), 1);
+    EXPECT_EQ(texture->getMemorySize(), (size_t)(32 * 32 + 16 * 16 + 8 * 8 + 4 * 4 + 2 * 2 + 1) * 3);
+
+    // Без объектов в кадре загруженные уровни остаются
+    REngine::TextureResidency::update();
+    EXPECT_EQ(REngine::TextureResidency::getFrameRefines(), 0);
+    EXPECT_EQ(texture->getBaseLevel(), 1);
+
+    // Слой массива занимает память под все уровни, поэтому догрузка не меняет объём
+    REngine::TexturePool::setEnabled(true);
+    const char* pooledPath = "mip_pooled.bmp";
+    writeTestBMP(pooledPath, 64, 64, false, 100);
+    REngine::Texture* pooled = REngine::TextureStreamer::request(pooledPath, glm::vec3(1.0f));
+    REngine::TextureResidency::touch(pooled, 8.0f);
+    REngine::TextureResidency::update();
+    REngine::TextureStreamer::finish();
+    ASSERT_NE(pooled->getArray(), nullptr);
+    EXPECT_EQ(pooled->getBaseLevel(), 3);
+    size_t layerSize = REngine::TextureArray::getLayerSize(REngine::TextureFormat::RGB8, 64, 64, 7);
+    EXPECT_EQ(pooled->getMemorySize(), layerSize);
+    REngine::TextureResidency::touch(pooled, 20.0f);
+    REngine::TextureResidency::update();
+    REngine::TextureStreamer::finish();
+    EXPECT_EQ(pooled->getBaseLevel(), 1);
+    EXPECT_EQ(pooled->getMemorySize(), layerSize);
+    REngine::TexturePool::setEnabled(false);
+
+    REngine::destroyWindow();
+    std::remove(path);
+    std::remove(pooledPath);
+}
+
+TEST(TextureStreamer, Deduplication) {
+    ASSERT_EQ(REngine::createHeadless(64, 64), 0) << "Headless context could not be created!";
+    const char* paths[] = {"dedup_a.bmp", "dedup_b.bmp", "dedup_c.bmp"};
+    writeTestBMP(paths[0], 32, 16, false);
+    writeTestBMP(paths[1], 32, 16, false);
+    writeTestBMP(paths[2], 32, 16, false, 100);
+    REngine::Texture* textures[3];
+    for (int i = 0; i < 3; i++) {
+        textures[i] = REngine::TextureStreamer::request(paths[i], glm::vec3(1.0f));
+    }
+    REngine::TextureStreamer::finish();
+
+    // Одинаковое содержимое под разными путями загружается один раз
+    EXPECT_EQ(REngine::TextureCache::size(), 3);
+    EXPECT_EQ(REngine::TextureCache::getContentCount(), 2);
+    EXPECT_EQ(textures[0]->getSource(), textures[1]->getSource());
+    EXPECT_EQ(textures[2]->getSource(), textures[2]);
+    EXPECT_TRUE(textures[0]->isResident() && textures[1]->isResident());
+    EXPECT_EQ(textures[1]->getWidth(), 32);
+    EXPECT_EQ(textures[1]->getID(), textures[0]->getID());
+    EXPECT_EQ(textures[0]->getMemorySize() + textures[1]->getMemorySize(), textures[2]->getMemorySize());
+    EXPECT_EQ(REngine::TextureResidency::getTrackedCount(), 2);
+
+    // Совпадение одного хэша без совпадения второго хэша и размера не объединяет текстуры
+    REngine::TextureContent content = {1, 2, 3};
+    REngine::TextureCache::insertContent(content, textures[2]);
+    EXPECT_EQ(REngine::TextureCache::findContent(content), textures[2]);
+    EXPECT_EQ(REngine::TextureCache::findContent({1, 5, 3}), nullptr);
+    EXPECT_EQ(REngine::TextureCache::findContent({1, 2, 4}), nullptr);
+
+    // После перезагрузки с мелкими уровнями содержимое текстуры больше не находится
+    REngine::TextureStreamer::reload(textures[2], paths[2], 8);
+    REngine::TextureStreamer::finish();
+    EXPECT_EQ(textures[2]->getWidth(), 8);
+    EXPECT_EQ(REngine::TextureCache::getContentCount(), 1);
+    const char* copyPath = "dedup_d.bmp";
+    writeTestBMP(copyPath, 32, 16, false, 100);
+    REngine::Texture* copy = REngine::TextureStreamer::request(copyPath, glm::vec3(1.0f));
+    REngine::TextureStreamer::finish();
+    EXPECT_EQ(copy->getSource(), copy);
+    EXPECT_EQ(copy->getWidth(), 32);
+    EXPECT_EQ(REngine::TextureCache::getContentCount(), 2);
+    std::remove(copyPath);
+
+    // Сплошной цвет не создаёт текстуру OpenGL
+    REngine::Texture* missing = REngine::TextureStreamer::request("dedup_missing.bmp", glm::vec3(0.5f, 0.25f, 1.0f));
+    REngine::TextureStreamer::finish();
+    EXPECT_TRUE(missing->isSolid());
+    EXPECT_TRUE(missing->isValid());
+    EXPECT_EQ(missing->getID(), 0);
+    EXPECT_FLOAT_EQ(missing->getColor()[1], 0.25f);
+    EXPECT_EQ(REngine::Mesh::getMaterialSource(missing), MESH_SOURCE_COLOR);
+    EXPECT_EQ(REngine::Mesh::getMaterialSource(textures[0]), MESH_SOURCE_TEXTURE);
+
+    REngine::destroyWindow();
+    EXPECT_EQ(REngine::TextureCache::getContentCount(), 0);
+    for (const char* path : paths) {
+        std::remove(path);
+    }
+}
+
+TEST(TexturePool, Layers) {
+    ASSERT_EQ(REngine::createHeadless(64, 64), 0) << "Headless context could not be created!";
+    REngine::TexturePool::setEnabled(true);
+
+    // Заполненный массив не растёт, следующий создаётся вдвое больше
+    std::vector<std::pair<REngine::TextureArray*, int>> layers(TEXTURE_POOL_INITIAL_LAYERS + 1);
+    for (auto& entry : layers) {
+        ASSERT_TRUE(REngine::TexturePool::acquire(REngine::TextureFormat::RGBA8, 4, 4, 3, entry.first, entry.second));
+    }
+    EXPECT_EQ(REngine::TexturePool::getArrayCount(), 2);
+    EXPECT_EQ(layers[0].first->getCapacity(), TEXTURE_POOL_INITIAL_LAYERS);
+    EXPECT_EQ(layers.back().first->getCapacity(), TEXTURE_POOL_INITIAL_LAYERS * 2);
+    EXPECT_EQ(layers[1].first, layers[0].first);
+    EXPECT_EQ(layers[1].second, 1);
+
+    {
+        // Цвета размещаются в общем массиве 1x1
+        REngine::Texture red, green;
+        red.genFromColor(1.0f, 0.0f, 0.0f);
+        green.genFromColor(0.0f, 1.0f, 0.0f);
+        ASSERT_NE(red.getArray(), nullptr);
+        EXPECT_EQ(red.getArray(), green.getArray());
+        EXPECT_NE(red.getLayer(), green.getLayer());
+        EXPECT_TRUE(red.isResident());
+        EXPECT_EQ(REngine::TexturePool::getArrayCount(), 3);
+
+        // Текстура 1x1 для шейдеров без переменных сплошного цвета создаётся один раз и не попадает в массив
+        REngine::Texture solid;
+        solid.setColor(0.5f, 0.5f, 0.5f);
+        const REngine::Texture* colorTexture = solid.getColorTexture();
+        ASSERT_NE(colorTexture, nullptr);
+        EXPECT_EQ(colorTexture->getArray(), nullptr);
+        EXPECT_NE(colorTexture->getID(), 0u);
+        EXPECT_EQ(solid.getColorTexture(), colorTexture);
+        EXPECT_EQ(red.getColorTexture(), nullptr);
+        EXPECT_EQ(REngine::TexturePool::getArrayCount(), 3);
+
+        // Пустые массивы удаляются
+        for (auto& entry : layers) {
+            REngine::TexturePool::release(entry.first, entry.second);
+        }
+        EXPECT_EQ(REngine::TexturePool::getArrayCount(), 1);
+        red.genFromColor(0.0f, 0.0f, 1.0f);
+        EXPECT_EQ(red.getArray(), green.getArray());
+
+        // Текстуры, пережившие удаление массивов, становятся пустыми и не освобождают слои повторно
+        REngine::TexturePool::clear();
+        EXPECT_EQ(REngine::TexturePool::getArrayCount(), 0);
+        EXPECT_EQ(red.getArray(), nullptr);
+        EXPECT_FALSE(green.isResident());
+    }
+
+    REngine::TexturePool::setEnabled(false);
+    REngine::destroyWindow();
+}
+
+TEST(Engine, TextureArrayBatching) {
+    ASSERT_EQ(REngine::createHeadless(320, 240), 0) << "Headless context could not be created!";
+
+    REngine::Scene scene;
+    REngine::Mesh* cube = new REngine::Mesh(REngine::Mesh::createCube());
+    cube->computeAABB();
+    const char* paths[] = {"batch_a.bmp", "batch_b.bmp", "batch_c.bmp"};
+    for (int i = 0; i < 3; i++) {
+        writeTestBMP(paths[i], 16, 16 + i % 2 * 16, false);
+    }
+    for (int i = 0; i < 6; i++) {
+        REngine::SceneNode node;
+        node.mesh = cube;
+        node.position = glm::vec3(i % 3 - 1.0f, i / 3 - 0.5f, 0);
+        node.scale = glm::vec3(0.5f);
+        node.texturePath = paths[i % 3];
+        node.shininess = 8.0f + i;
+        scene.nodes.push_back(node);
+    }
+    scene.camera.position = glm::vec3(0, 0, 5);
+    scene.camera.setRotation(0.0f, -90.0f, 0.0f);
+    REngine::setScene(&scene);
+    REngine::setShader(NULL, NULL);
+
+    REngine::runFrames(1);
+    REngine::TextureStreamer::finish();
+    REngine::runFrames(2);
+
+    // Текстуры 16x16 попадают в один массив, 16x32 в другой
+    const REngine::FrameRecord& last = REngine::getFrameStats()->last();
+    EXPECT_EQ(last.drawCalls, 2);
+    EXPECT_EQ(last.triangles, 6 * 12);
+    EXPECT_LE(last.textureBinds, 3);
+    EXPECT_EQ(REngine::TextureCache::find(paths[0])->getArray(), REngine::TextureCache::find(paths[2])->getArray());
+
+    delete cube;
+    REngine::destroyWindow();
+    EXPECT_EQ(REngine::TexturePool::getArrayCount(), 0);
+    for (const char* path : paths) {
+        std::remove(path);
+    }
+}
+
+TEST(Engine, FlyThrough) {
+    ASSERT_EQ(REngine::createHeadless(320, 240), 0) << "Headless context could not be created!";
+
+    REngine::Scene scene;
+    REngine::Mesh* cube = new REngine::Mesh(REngine::Mesh::createCube());
+    cube->computeAABB();
+    REngine::SceneNode node;
+    node.mesh = cube;
+    scene.nodes.push_back(node);
+    REngine::setScene(&scene);
+    REngine::setShader(NULL, NULL);
+
+    // Камера отворачивается от куба к середине пути
+    REngine::CameraPath cameraPath;
+    cameraPath.addKeyframe({0.0f, glm::vec3(0, 0, 5), 0.0f, -90.0f});
+    cameraPath.addKeyframe({1.0f, glm::vec3(0, 0, 5), 0.0f, 90.0f});
+
+    const char* report = "fly_through_test.csv";
+    REngine::FrameSummary summary = REngine::runFlyThrough(cameraPath, 0.1, report);
+    EXPECT_EQ(summary.frames, 11);
+    EXPECT_EQ(REngine::getFrameStats()->get(REngine::getFrameStats()->size() - 11).drawCalls, 1);
+    EXPECT_EQ(REngine::getFrameStats()->last().drawCalls, 0);
+    // Время GPU последних кадров, ещё бывших в полёте, записывается после их завершения
+    EXPECT_GT(REngine::getFrameStats()->last().gpuTime, 0.0f);
+    EXPECT_EQ(scene.camera.position, glm::vec3(0, 0, 3));
+
+    // Строка отчёта содержит время того же кадра, что и вид камеры в ней
+    std::ifstream file(report);
+    ASSERT_TRUE(file.is_open());
+    int lines = 0;
+    std::string line;
+    const REngine::FrameStats* stats = REngine::getFrameStats();
+    while (std::getline(file, line)) {
+        if (lines > 0) {
+            const REngine::FrameRecord& record = stats->get(stats->size() - 11 + lines - 1);
+            unsigned long frame;
+            float pathTime, distance, x, y, z, pitch, yaw, frameTime, cpuTime;
+            ASSERT_EQ(std::sscanf(line.c_str(), "%lu,%f,%f,%f,%f,%f,%f,%f,%f,%f", &frame, &pathTime, &distance, &x, &y, &z,
+                                  &pitch, &yaw, &frameTime, &cpuTime),
+                      10);
+            EXPECT_EQ(frame, record.frame);
+            EXPECT_NEAR(pathTime, (lines - 1) * 0.1f, 1e-4f);
+            EXPECT_NEAR(frameTime, record.frameTime, record.frameTime * 1e-5f + 1e-4f);
+            EXPECT_GE(frameTime, cpuTime);
+        }
+        lines++;
+    }
+    EXPECT_EQ(lines, 12);
+    file.close();
+    std::remove(report);
+
+    delete cube;
+    REngine::destroyWindow();
+}
+
+TEST(SceneGenerator, Deterministic) {
+    ASSERT_EQ(REngine::createHeadless(320, 240), 0) << "Headless context could not be created!";
+
+    {
+        REngine::SceneGeneratorConfig config;
+        config.seed = 1234;
+        config.nodeCount = 500;
+        config.layout = REngine::SceneLayout::City;
+        config.lightCount = 16;
+        config.sharedMeshFraction = 0.9f;
+        config.texturePaths = {"uv-test.bmp", "alpha.bmp"};
+
+        REngine::Scene first, second, other;
+        REngine::SceneGenerator firstGenerator(config), secondGenerator(config);
+        firstGenerator.generate(first);
+        secondGenerator.generate(second);
+        config.seed = 4321;
+        REngine::SceneGenerator otherGenerator(config);
+        otherGenerator.generate(other);
+
+        ASSERT_EQ(first.nodes.size(), 500);
+        ASSERT_EQ(second.nodes.size(), 500);
+        EXPECT_EQ(first.pointLights.size(), 16);
+        EXPECT_EQ(firstGenerator.getMeshes().size(), secondGenerator.getMeshes().size());
+        EXPECT_GT(firstGenerator.getMeshes().size(), 2);
+        EXPECT_LT(firstGenerator.getMeshes().size(), 500);
+
+        bool differs = false;
+        for (size_t i = 0; i < first.nodes.size(); i++) {
+            EXPECT_EQ(first.nodes[i].position, second.nodes[i].position);
+            EXPECT_EQ(first.nodes[i].scale, second.nodes[i].scale);
+            EXPECT_EQ(first.nodes[i].texturePath, second.nodes[i].texturePath);
+            differs |= first.nodes[i].position != other.nodes[i].position;
+        }
+        for (size_t i = 0; i < first.pointLights.size(); i++) {
+            EXPECT_EQ(first.pointLights[i].position, second.pointLights[i].position);
+            EXPECT_EQ(first.pointLights[i].diffuse, second.pointLights[i].diffuse);
+        }
+        EXPECT_TRUE(differs);
+    }
+
+    REngine::destroyWindow();
+}
+
+TEST(Engine, TexturedScene) {
+    REngine::Scene scene;
+
     REngine::SceneNode n_sphere, n_noTexture, n_texture, n_specular, n_alpha, n_garbage, n_garbageWithBm, n_16bit, n_notReal;
     n_texture.texturePath = "uv-test.bmp";
     n_specular.specularPath = "uv-test.bmp";
@@ -193,13 +1739,19 @@ TEST(Engine, WindowCreation) {
     scene.camera.position = glm::vec3(0, 0, 5);
     scene.camera.setRotation(0.0f, -90.0f, 0.0f);
 
-    REngine::createWindow("test", 800, 600);
+    // Интерактивный mainLoop ждёт нажатия Q, поэтому сцена отрисовывает фиксированное число кадров без окна
+    ASSERT_EQ(REngine::createHeadless(800, 600), 0) << "Headless context could not be created!";
     REngine::setScene(&scene);
 
     REngine::setShader(NULL, NULL);
 
-    REngine::mainLoop();
+    REngine::FrameSummary summary = REngine::runFrames(30);
+    EXPECT_EQ(summary.frames, 30);
+    EXPECT_GT(REngine::getFrameStats()->last().drawCalls, 0);
 
+    for (const REngine::SceneNode& node : scene.nodes) {
+        delete node.mesh;
+    }
     REngine::destroyWindow();
 }
 
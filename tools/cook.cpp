@@ -0,0 +1,85 @@
+#include <SDL.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AssetCooker.h"
+#include "CookedTexture.h"
+
+// Подготовка каталога ресурсов в один архив .rpak через REngine::AssetCooker
+// rengine-cook [-f bc1|bc3|bc7|rgb8|rgba8] [-j потоки] [-s 8-24,100] source output.rpak
+
+static std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return text;
+}
+
+static void printUsage() {
+    std::printf("Usage: rengine-cook [-f bc1|bc3|bc7|rgb8|rgba8] [-j threads] [-s slices] source output.rpak\n");
+}
+
+int main(int argc, char** argv) {
+    const char* formatName = nullptr;
+    int threads = 0;
+    std::string slicesText = "8-24,100";
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            formatName = argv[++i];
+        } else if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            slicesText = argv[++i];
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    REngine::CookOptions options;
+    if (paths.size() != 2 || !std::filesystem::is_directory(paths[0]) || !REngine::AssetCooker::parseSlices(slicesText, options.slices)) {
+        printUsage();
+        return 1;
+    }
+
+    if (formatName) {
+        const REngine::TextureFormat formats[] = {REngine::TextureFormat::RGB8, REngine::TextureFormat::RGBA8, REngine::TextureFormat::BC1,
+                                                  REngine::TextureFormat::BC3, REngine::TextureFormat::BC7};
+        for (REngine::TextureFormat candidate : formats) {
+            if (toLower(formatName) == toLower(REngine::CookedTexture::getFormatName(candidate))) {
+                options.format = candidate;
+                options.formatSet = true;
+            }
+        }
+        if (!options.formatSet) {
+            printUsage();
+            return 1;
+        }
+    }
+    options.threads = threads > 0 ? threads : (int)std::max(1u, std::thread::hardware_concurrency());
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<REngine::CookedAsset> assets;
+    if (!REngine::AssetCooker::cook(paths[0], paths[1], options, assets)) {
+        return 1;
+    }
+
+    size_t cachedCount = 0, sourceBytes = 0, cookedBytes = 0;
+    for (const REngine::CookedAsset& asset : assets) {
+        std::printf("%-40s %-8s %10zu -> %10zu bytes %9.1f ms%s\n", asset.name.c_str(), asset.kind, asset.sourceSize, asset.cookedSize,
+                    asset.milliseconds, asset.cached ? " (cached)" : "");
+        cachedCount += asset.cached ? 1 : 0;
+        sourceBytes += asset.sourceSize;
+        cookedBytes += asset.cookedSize;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%zu assets, %zu cooked, %zu cached, %zu -> %zu bytes, %d threads, %.1f ms\n", assets.size(), assets.size() - cachedCount,
+                cachedCount, sourceBytes, cookedBytes, options.threads, seconds * 1000.0);
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <SDL.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "BlockCompression.h"
+#include "CookedTexture.h"
+#include "Texture.h"
+
+// Подготовка BMP к загрузке: все мип-уровни в формате видеопамяти в DDS или RTEX с выводом PSNR
+// rengine-texconv [-f rgb8|rgba8|bc1|bc3|bc7] [-j потоки] input.bmp output.dds|output.rtex
+
+static std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return text;
+}
+
+static void printUsage() {
+    std::printf("Usage: rengine-texconv [-f rgb8|rgba8|bc1|bc3|bc7] [-j threads] input.bmp output.dds|output.rtex\n");
+}
+
+int main(int argc, char** argv) {
+    const char* formatName = nullptr;
+    int threads = 0;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            formatName = argv[++i];
+        } else if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.size() != 2) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<unsigned char> pixels;
+    int width, height, channels;
+    if (!REngine::Texture::decodeBMP(paths[0], pixels, width, height, channels)) {
+        std::fprintf(stderr, "Failed to read %s\n", paths[0]);
+        return 1;
+    }
+
+    // По умолчанию BC1 для изображений без альфа-канала и BC3 для остальных
+    REngine::TextureFormat format = channels == 4 ? REngine::TextureFormat::BC3 : REngine::TextureFormat::BC1;
+    if (formatName) {
+        const REngine::TextureFormat formats[] = {REngine::TextureFormat::RGB8, REngine::TextureFormat::RGBA8, REngine::TextureFormat::BC1,
+                                                  REngine::TextureFormat::BC3, REngine::TextureFormat::BC7};
+        bool found = false;
+        for (REngine::TextureFormat candidate : formats) {
+            if (toLower(formatName) == toLower(REngine::CookedTexture::getFormatName(candidate))) {
+                format = candidate;
+                found = true;
+            }
+        }
+        if (!found) {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::string output = paths[1];
+    bool dds = output.size() >= 4 && toLower(output.substr(output.size() - 4)) == ".dds";
+    REngine::BlockFormat blockFormat;
+    bool compressed = REngine::Texture::getBlockFormat(format, blockFormat);
+    if (dds && !compressed) {
+        std::fprintf(stderr, "DDS output supports only BC1, BC3 and BC7\n");
+        return 1;
+    }
+
+    std::vector<unsigned char> rgba((size_t)width * height * 4);
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        for (int c = 0; c < 4; c++) {
+            rgba[i * 4 + c] = c < channels ? pixels[i * channels + c] : 255;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    REngine::CookedImage image;
+    REngine::CookedTexture::cook(format, rgba.data(), width, height, image, threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Несжатые форматы совпадают с исходником, кроме отброшенного альфа-канала
+    double psnr = std::numeric_limits<double>::infinity();
+    if (compressed) {
+        std::vector<unsigned char> decoded;
+        REngine::BlockCompressor::decompress(blockFormat, image.data.data(), width, height, decoded);
+        psnr = REngine::BlockCompressor::computePSNR(rgba.data(), decoded.data(), rgba.size(), 4,
+                                                     format == REngine::TextureFormat::BC1 ? 3 : channels);
+    }
+
+    bool saved;
+    if (dds) {
+        REngine::CompressedImage blocks;
+        blocks.format = blockFormat;
+        blocks.levels = image.levels;
+        blocks.data = std::move(image.data);
+        saved = REngine::BlockCompressor::saveDDS(output, blocks);
+        image.data = std::move(blocks.data);
+    } else {
+        saved = REngine::CookedTexture::save(output, image);
+    }
+    if (!saved) {
+        std::fprintf(stderr, "Failed to write %s\n", output.c_str());
+        return 1;
+    }
+
+    // Несжатая текстура в видеопамяти занимает 4 байта на пиксель с мип-уровнями
+    size_t uncompressed = 0;
+    for (const REngine::TextureLevel& level : image.levels) {
+        uncompressed += (size_t)level.width * level.height * 4;
+    }
+    std::printf("%s: %dx%d, %zu levels, %s, %.1f ms\n", output.c_str(), width, height, image.levels.size(),
+                REngine::CookedTexture::getFormatName(format), seconds * 1000.0);
+    std::printf("size %zu bytes, %.1fx smaller than RGBA8, PSNR %.2f dB\n", image.data.size(),
+                (double)uncompressed / image.data.size(), psnr);
+    return 0;
+}